@@ -0,0 +1,430 @@
+// madvise
+#define _DEFAULT_SOURCE
+
+#include "asset_pack.h"
+#include "pixel_convert.h"
+#include "texture_compress.h"
+
+#ifdef SDL_PLATFORM_WINDOWS
+#define WIN32_LEAN_AND_MEAN
+#include <windows.h>
+#else
+#include <errno.h>
+#include <fcntl.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+static bool map_file(asset_pack_t *pack, const char *path) {
+#ifdef SDL_PLATFORM_WINDOWS
+    HANDLE file = CreateFileA(path, GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN,
+                              NULL);
+    if (file == INVALID_HANDLE_VALUE) {
+        return SDL_SetError("can't open %s", path);
+    }
+    LARGE_INTEGER size;
+    if (!GetFileSizeEx(file, &size) || size.QuadPart == 0) {
+        CloseHandle(file);
+        return SDL_SetError("can't map empty file %s", path);
+    }
+    HANDLE mapping = CreateFileMappingA(file, NULL, PAGE_READONLY, 0, 0, NULL);
+    void *data = mapping ? MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0) : NULL;
+    if (data == NULL) {
+        if (mapping) {
+            CloseHandle(mapping);
+        }
+        CloseHandle(file);
+        return SDL_SetError("can't map %s", path);
+    }
+    pack->file = file;
+    pack->mapping = mapping;
+    pack->data = data;
+    pack->size = (size_t) size.QuadPart;
+#else
+    int fd = open(path, O_RDONLY);
+    if (fd < 0) {
+        return SDL_SetError("can't open %s: %s", path, strerror(errno));
+    }
+    struct stat st;
+    if (fstat(fd, &st) != 0 || st.st_size == 0) {
+        close(fd);
+        return SDL_SetError("can't map empty file %s", path);
+    }
+    void *data = mmap(NULL, (size_t) st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    // the mapping keeps its own reference to the file
+    close(fd);
+    if (data == MAP_FAILED) {
+        return SDL_SetError("can't map %s: %s", path, strerror(errno));
+    }
+    // textures are copied front to back, let the kernel read ahead
+    madvise(data, (size_t) st.st_size, MADV_SEQUENTIAL);
+    pack->data = data;
+    pack->size = (size_t) st.st_size;
+#endif
+    return true;
+}
+
+// texels per block edge of the formats a pack can hold, 0 for anything else
+static uint32_t block_extent(uint32_t format) {
+    switch ((SDL_GPUTextureFormat) format) {
+        case SDL_GPU_TEXTUREFORMAT_R8G8B8A8_UNORM:
+            return 1;
+        case SDL_GPU_TEXTUREFORMAT_BC1_RGBA_UNORM:
+        case SDL_GPU_TEXTUREFORMAT_BC3_RGBA_UNORM:
+        case SDL_GPU_TEXTUREFORMAT_BC7_RGBA_UNORM:
+            return 4;
+        default:
+            return 0;
+    }
+}
+
+static bool validate_levels(const asset_pack_entry_t *entry) {
+    if (block_extent(entry->format) == 0) {
+        return SDL_SetError("asset %s has unknown format %u", entry->name, entry->format);
+    }
+    if (entry->width == 0 || entry->height == 0 || entry->width > 16384 || entry->height > 16384 ||
+        entry->num_levels == 0 || entry->num_levels > ASSET_PACK_MAX_LEVELS ||
+        entry->num_levels > texture_mip_count(entry->width, entry->height)) {
+        return SDL_SetError("asset %s has bad dimensions", entry->name);
+    }
+    asset_pack_level_t last;
+    asset_pack_level(entry, entry->num_levels - 1, &last);
+    if (last.offset + last.size != entry->size) {
+        return SDL_SetError("asset %s levels don't add up to its size", entry->name);
+    }
+    return true;
+}
+
+// points pack->entries at the table once the header says where it is and the table fits in the file
+static bool validate(asset_pack_t *pack) {
+    const asset_pack_header_t *header = pack->header;
+    if (pack->size < sizeof(asset_pack_header_t) || header->magic != ASSET_PACK_MAGIC) {
+        return SDL_SetError("not an asset pack");
+    }
+    if (header->version != ASSET_PACK_VERSION) {
+        return SDL_SetError("asset pack version %u, expected %u", header->version, ASSET_PACK_VERSION);
+    }
+    uint64_t table_size = (uint64_t) header->num_entries * sizeof(asset_pack_entry_t);
+    if (header->entries_offset % 8 != 0 || header->entries_offset > pack->size ||
+        table_size > pack->size - header->entries_offset) {
+        return SDL_SetError("asset pack entry table out of bounds");
+    }
+    pack->entries = (const asset_pack_entry_t *) (pack->data + header->entries_offset);
+    // everything past this point trusts the entries, so a truncated or corrupted pack fails here and not later
+    for (uint32_t i = 0; i < header->num_entries; i++) {
+        const asset_pack_entry_t *entry = &pack->entries[i];
+        if (SDL_memchr(entry->name, 0, ASSET_PACK_NAME_LENGTH) == NULL) {
+            return SDL_SetError("asset pack entry %u has no name", i);
+        }
+        if (entry->offset > header->entries_offset || entry->size > header->entries_offset - entry->offset) {
+            return SDL_SetError("asset %s out of bounds", entry->name);
+        }
+        if (!validate_levels(entry)) {
+            return false;
+        }
+        int order = i > 0 ? SDL_strcmp(pack->entries[i - 1].name, entry->name) : -1;
+        if (order > 0 || (order == 0 && pack->entries[i - 1].offset >= entry->offset)) {
+            return SDL_SetError("asset pack entries are not sorted");
+        }
+    }
+    return true;
+}
+
+bool asset_pack_open(asset_pack_t *pack, const char *path) {
+    SDL_zerop(pack);
+    if (!map_file(pack, path)) {
+        return false;
+    }
+    pack->header = (const asset_pack_header_t *) pack->data;
+    if (!validate(pack)) {
+        asset_pack_close(pack);
+        return false;
+    }
+    return true;
+}
+
+void asset_pack_close(asset_pack_t *pack) {
+    if (pack->data) {
+#ifdef SDL_PLATFORM_WINDOWS
+        UnmapViewOfFile(pack->data);
+        CloseHandle(pack->mapping);
+        CloseHandle(pack->file);
+#else
+        munmap((void *) pack->data, pack->size);
+#endif
+    }
+    SDL_zerop(pack);
+}
+
+const asset_pack_entry_t *asset_pack_find(const asset_pack_t *pack, const char *name) {
+    uint32_t lo = 0;
+    uint32_t hi = pack->header->num_entries;
+    // lower bound, the first of the variants
+    while (lo < hi) {
+        uint32_t mid = lo + (hi - lo) / 2;
+        if (SDL_strcmp(pack->entries[mid].name, name) < 0) {
+            lo = mid + 1;
+        } else {
+            hi = mid;
+        }
+    }
+    if (lo < pack->header->num_entries && SDL_strcmp(pack->entries[lo].name, name) == 0) {
+        return &pack->entries[lo];
+    }
+    return NULL;
+}
+
+const asset_pack_entry_t *asset_pack_next_variant(const asset_pack_t *pack, const asset_pack_entry_t *entry) {
+    const asset_pack_entry_t *next = entry + 1;
+    if (next < pack->entries + pack->header->num_entries && SDL_strcmp(next->name, entry->name) == 0) {
+        return next;
+    }
+    return NULL;
+}
+
+void asset_pack_level(const asset_pack_entry_t *entry, uint32_t level, asset_pack_level_t *out) {
+    SDL_GPUTextureFormat format = (SDL_GPUTextureFormat) entry->format;
+    uint32_t block = SDL_max(block_extent(entry->format), 1);
+    out->offset = 0;
+    for (uint32_t i = 0;; i++) {
+        out->width = SDL_max(entry->width >> i, 1);
+        out->height = SDL_max(entry->height >> i, 1);
+        out->size = SDL_CalculateGPUTextureFormatSize(format, out->width, out->height, 1);
+        if (i == level) {
+            break;
+        }
+        out->offset += out->size;
+    }
+    out->pixels_per_row = (out->width + block - 1) / block * block;
+    out->rows = (out->height + block - 1) / block * block;
+}
+
+void asset_pack_release(const asset_pack_t *pack, const asset_pack_entry_t *entry) {
+#ifdef SDL_PLATFORM_WINDOWS
+    // the working set manager trims clean file pages on its own
+    (void) pack;
+    (void) entry;
+#else
+    // only whole pages inside the entry, its neighbours may not be uploaded yet
+    uintptr_t page = (uintptr_t) sysconf(_SC_PAGESIZE);
+    uintptr_t begin = ((uintptr_t) asset_pack_texels(pack, entry) + page - 1) & ~(page - 1);
+    uintptr_t end = ((uintptr_t) asset_pack_texels(pack, entry) + entry->size) & ~(page - 1);
+    if (begin < end) {
+        madvise((void *) begin, end - begin, MADV_DONTNEED);
+    }
+#endif
+}
+
+static bool write_padding(SDL_IOStream *out, uint64_t *offset) {
+    static const uint8_t zeros[ASSET_PACK_DATA_ALIGNMENT] = {0};
+    size_t padding = (ASSET_PACK_DATA_ALIGNMENT - *offset % ASSET_PACK_DATA_ALIGNMENT) % ASSET_PACK_DATA_ALIGNMENT;
+    *offset += padding;
+    return SDL_WriteIO(out, zeros, padding) == padding;
+}
+
+// rgba8 levels of one texture back to back, largest first
+typedef struct {
+    uint8_t *texels;
+    uint32_t width;
+    uint32_t height;
+    uint32_t num_levels;
+    size_t level_offset[ASSET_PACK_MAX_LEVELS];
+} mip_chain_t;
+
+static bool build_mip_chain(const converted_pixels_t *converted, mip_chain_t *chain) {
+    if (converted->format != SDL_GPU_TEXTUREFORMAT_R8G8B8A8_UNORM) {
+        return SDL_SetError("mip generation needs rgba8 texels");
+    }
+    chain->width = converted->width;
+    chain->height = converted->height;
+    chain->num_levels = SDL_min(texture_mip_count(chain->width, chain->height), ASSET_PACK_MAX_LEVELS);
+    size_t total = 0;
+    for (uint32_t level = 0; level < chain->num_levels; level++) {
+        chain->level_offset[level] = total;
+        total += texture_encoded_size(TEXTURE_ENCODING_RGBA8, SDL_max(chain->width >> level, 1),
+                                      SDL_max(chain->height >> level, 1));
+    }
+    chain->texels = SDL_malloc(total);
+    if (chain->texels == NULL) {
+        return false;
+    }
+    for (uint32_t y = 0; y < chain->height; y++) {
+        SDL_memcpy(chain->texels + (size_t) y * chain->width * 4,
+                   converted->pixels + (size_t) y * converted->pixels_per_row * 4, (size_t) chain->width * 4);
+    }
+    for (uint32_t level = 1; level < chain->num_levels; level++) {
+        texture_downsample(chain->texels + chain->level_offset[level - 1], SDL_max(chain->width >> (level - 1), 1),
+                           SDL_max(chain->height >> (level - 1), 1), chain->texels + chain->level_offset[level]);
+    }
+    return true;
+}
+
+// every level of the chain in one encoding, as one entry
+static bool write_variant(SDL_IOStream *out, const char *name, const mip_chain_t *chain, texture_encoding_t encoding,
+                          asset_pack_entry_t *entry, uint64_t *offset, uint64_t *encode_ns) {
+    uint8_t *scratch = NULL;
+    if (encoding != TEXTURE_ENCODING_RGBA8) {
+        scratch = SDL_malloc(texture_encoded_size(encoding, chain->width, chain->height));
+        if (scratch == NULL) {
+            return false;
+        }
+    }
+    bool ok = write_padding(out, offset);
+    SDL_strlcpy(entry->name, name, ASSET_PACK_NAME_LENGTH);
+    entry->offset = *offset;
+    entry->size = 0;
+    entry->format = texture_encoding_format(encoding);
+    entry->width = chain->width;
+    entry->height = chain->height;
+    entry->num_levels = chain->num_levels;
+    for (uint32_t level = 0; ok && level < chain->num_levels; level++) {
+        uint32_t width = SDL_max(chain->width >> level, 1);
+        uint32_t height = SDL_max(chain->height >> level, 1);
+        const uint8_t *texels = chain->texels + chain->level_offset[level];
+        size_t size = texture_encoded_size(encoding, width, height);
+        if (scratch) {
+            uint64_t start = SDL_GetTicksNS();
+            texture_encode(encoding, texels, width, height, scratch);
+            *encode_ns += SDL_GetTicksNS() - start;
+            texels = scratch;
+        }
+        ok = SDL_WriteIO(out, texels, size) == size;
+        entry->size += size;
+    }
+    *offset += entry->size;
+    SDL_free(scratch);
+    return ok;
+}
+
+static bool write_texture(SDL_IOStream *out, const char *input, asset_pack_compression_t compression,
+                          asset_pack_entry_t *entries, uint32_t *num_entries, uint64_t *offset,
+                          asset_pack_build_stats_t *stats) {
+    const char *name = input;
+    for (const char *c = input; *c; c++) {
+        if (*c == '/' || *c == '\\') {
+            name = c + 1;
+        }
+    }
+    if (SDL_strlen(name) >= ASSET_PACK_NAME_LENGTH) {
+        return SDL_SetError("asset name %s is too long", name);
+    }
+    // variants share a name, so duplicates have to be caught before the table is sorted
+    for (uint32_t i = 0; i < *num_entries; i++) {
+        if (SDL_strcmp(entries[i].name, name) == 0) {
+            return SDL_SetError("two assets named %s", name);
+        }
+    }
+
+    SDL_Surface *surface = SDL_LoadBMP(input);
+    if (surface == NULL) {
+        return false;
+    }
+    // without a device every format is converted to rgba8, the pack has to load on any gpu
+    converted_pixels_t converted;
+    if (!pixel_convert_surface(NULL, surface, &converted)) {
+        SDL_DestroySurface(surface);
+        return false;
+    }
+    mip_chain_t chain = {0};
+    bool ok = build_mip_chain(&converted, &chain);
+    pixel_convert_free(&converted);
+    SDL_DestroySurface(surface);
+    if (!ok) {
+        return false;
+    }
+
+    texture_encoding_t encoding = TEXTURE_ENCODING_RGBA8;
+    switch (compression) {
+        case ASSET_PACK_COMPRESSION_AUTO:
+            encoding = texture_has_alpha(chain.texels, chain.width, chain.height) ? TEXTURE_ENCODING_BC7
+                                                                                    : TEXTURE_ENCODING_BC1;
+            break;
+        case ASSET_PACK_COMPRESSION_BC1:
+            encoding = TEXTURE_ENCODING_BC1;
+            break;
+        case ASSET_PACK_COMPRESSION_BC3:
+            encoding = TEXTURE_ENCODING_BC3;
+            break;
+        case ASSET_PACK_COMPRESSION_BC7:
+            encoding = TEXTURE_ENCODING_BC7;
+            break;
+        default:
+            break;
+    }
+    // the compressed variant first, asset_pack_find hands out the best one and the loader walks down from there
+    if (encoding != TEXTURE_ENCODING_RGBA8) {
+        asset_pack_entry_t *entry = &entries[(*num_entries)++];
+        ok = write_variant(out, name, &chain, encoding, entry, offset, &stats->encode_ns);
+        stats->compressed_bytes += entry->size;
+    }
+    if (ok) {
+        asset_pack_entry_t *entry = &entries[(*num_entries)++];
+        ok = write_variant(out, name, &chain, TEXTURE_ENCODING_RGBA8, entry, offset, &stats->encode_ns);
+        stats->rgba8_bytes += entry->size;
+        if (encoding == TEXTURE_ENCODING_RGBA8) {
+            stats->compressed_bytes += entry->size;
+        }
+    }
+    stats->textures++;
+    SDL_free(chain.texels);
+    return ok;
+}
+
+static int compare_entries(const void *a, const void *b) {
+    const asset_pack_entry_t *entry_a = a;
+    const asset_pack_entry_t *entry_b = b;
+    int order = SDL_strcmp(entry_a->name, entry_b->name);
+    if (order != 0) {
+        return order;
+    }
+    // variants keep the order they were written in
+    return entry_a->offset < entry_b->offset ? -1 : entry_a->offset > entry_b->offset;
+}
+
+bool asset_pack_build(const char *path, const char *const *inputs, uint32_t num_inputs,
+                      asset_pack_compression_t compression, asset_pack_build_stats_t *stats) {
+    // a compressed variant and the rgba8 fallback per input at most
+    asset_pack_entry_t *entries = SDL_calloc(SDL_max(num_inputs, 1) * 2, sizeof(asset_pack_entry_t));
+    if (entries == NULL) {
+        return false;
+    }
+    SDL_IOStream *out = SDL_IOFromFile(path, "wb");
+    if (out == NULL) {
+        SDL_free(entries);
+        return false;
+    }
+
+    // written a second time at the end, once the number of entries and the position of their table are known
+    asset_pack_header_t header = {
+            .magic = ASSET_PACK_MAGIC,
+            .version = ASSET_PACK_VERSION,
+    };
+    asset_pack_build_stats_t totals = {0};
+    uint32_t num_entries = 0;
+    uint64_t offset = sizeof(header);
+    bool ok = SDL_WriteIO(out, &header, sizeof(header)) == sizeof(header);
+    for (uint32_t i = 0; ok && i < num_inputs; i++) {
+        ok = write_texture(out, inputs[i], compression, entries, &num_entries, &offset, &totals);
+    }
+
+    if (ok) {
+        SDL_qsort(entries, num_entries, sizeof(asset_pack_entry_t), compare_entries);
+        size_t table_size = num_entries * sizeof(asset_pack_entry_t);
+        ok = write_padding(out, &offset);
+        header.num_entries = num_entries;
+        header.entries_offset = offset;
+        ok = ok && SDL_WriteIO(out, entries, table_size) == table_size &&
+             SDL_SeekIO(out, 0, SDL_IO_SEEK_SET) == 0 && SDL_WriteIO(out, &header, sizeof(header)) == sizeof(header);
+    }
+
+    if (!SDL_CloseIO(out)) {
+        ok = false;
+    }
+    SDL_free(entries);
+    if (stats) {
+        *stats = totals;
+    }
+    return ok;
+}
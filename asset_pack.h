@@ -0,0 +1,99 @@
+#ifndef KINGDOM_DEFENSE_ASSET_PACK_H
+#define KINGDOM_DEFENSE_ASSET_PACK_H
+
+#include <SDL3/SDL.h>
+
+// "KDPK" little endian
+#define ASSET_PACK_MAGIC 0x4b50444bu
+#define ASSET_PACK_VERSION 2
+#define ASSET_PACK_NAME_LENGTH 64
+#define ASSET_PACK_MAX_LEVELS 16
+// texel data starts on a page boundary, copies out of the mapping stay aligned and asset_pack_release can drop
+// every page of an entry
+#define ASSET_PACK_DATA_ALIGNMENT 4096
+#define ASSET_PACK_DEFAULT_PATH "assets.pack"
+
+// on disk layout, little endian: header, texel data of every entry, entry table sorted by name and then by offset
+typedef struct {
+    uint32_t magic;
+    uint32_t version;
+    uint32_t num_entries;
+    uint32_t reserved;
+    uint64_t entries_offset;
+} asset_pack_header_t;
+
+// one encoding of a texture with its whole mip chain, largest level first, every level stored the way
+// SDL_UploadToGPUTexture wants it (see asset_pack_level). a texture can come in several variants that sit next to
+// each other in the table, best first. the last one is rgba8, which every device can sample
+typedef struct {
+    char name[ASSET_PACK_NAME_LENGTH];
+    uint64_t offset;
+    uint64_t size;
+    uint32_t format;
+    uint32_t width;
+    uint32_t height;
+    uint32_t num_levels;
+} asset_pack_entry_t;
+
+// where one mip level of an entry lives and how to upload it. block compressed levels cover whole 4x4 blocks
+// even when the level itself is smaller
+typedef struct {
+    // from the first texel of the entry
+    uint64_t offset;
+    uint32_t size;
+    uint32_t width;
+    uint32_t height;
+    uint32_t pixels_per_row;
+    uint32_t rows;
+} asset_pack_level_t;
+
+typedef enum {
+    // bc1 for opaque textures, bc7 for the ones with alpha
+    ASSET_PACK_COMPRESSION_AUTO,
+    // rgba8 only
+    ASSET_PACK_COMPRESSION_NONE,
+    ASSET_PACK_COMPRESSION_BC1,
+    ASSET_PACK_COMPRESSION_BC3,
+    ASSET_PACK_COMPRESSION_BC7,
+} asset_pack_compression_t;
+
+typedef struct {
+    uint32_t textures;
+    // every level of every texture, as rgba8 and in the compressed variant
+    uint64_t rgba8_bytes;
+    uint64_t compressed_bytes;
+    uint64_t encode_ns;
+} asset_pack_build_stats_t;
+
+// a read only view of a pack file mapped into memory, nothing is read until the texels are touched
+typedef struct {
+    const uint8_t *data;
+    size_t size;
+    const asset_pack_header_t *header;
+    const asset_pack_entry_t *entries;
+#ifdef SDL_PLATFORM_WINDOWS
+    void *file;
+    void *mapping;
+#endif
+} asset_pack_t;
+
+bool asset_pack_open(asset_pack_t *pack, const char *path);
+void asset_pack_close(asset_pack_t *pack);
+// binary search over the sorted entry table for the first variant of an asset, NULL if there is no such asset
+const asset_pack_entry_t *asset_pack_find(const asset_pack_t *pack, const char *name);
+// the next variant of the same asset, NULL after the last one
+const asset_pack_entry_t *asset_pack_next_variant(const asset_pack_t *pack, const asset_pack_entry_t *entry);
+void asset_pack_level(const asset_pack_entry_t *entry, uint32_t level, asset_pack_level_t *out);
+static inline const uint8_t *asset_pack_texels(const asset_pack_t *pack, const asset_pack_entry_t *entry) {
+    return pack->data + entry->offset;
+}
+// drops the pages of an entry that was uploaded, so a level load doesn't keep the whole pack resident
+void asset_pack_release(const asset_pack_t *pack, const asset_pack_entry_t *entry);
+
+// the offline side: decodes the bmp files in `inputs`, generates their mip chains and writes them to `path`, block
+// compressed as `compression` asks with an rgba8 fallback next to it. entries are named after the file name
+// without its directory. `stats` may be NULL
+bool asset_pack_build(const char *path, const char *const *inputs, uint32_t num_inputs,
+                      asset_pack_compression_t compression, asset_pack_build_stats_t *stats);
+
+#endif //KINGDOM_DEFENSE_ASSET_PACK_H
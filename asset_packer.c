@@ -0,0 +1,109 @@
+#include <stdio.h>
+
+#include "asset_pack.h"
+
+static bool parse_compression(const char *name, asset_pack_compression_t *compression) {
+    static const char *names[] = {"auto", "none", "bc1", "bc3", "bc7"};
+    for (int i = 0; i < (int) SDL_arraysize(names); i++) {
+        if (SDL_strcmp(name, names[i]) == 0) {
+            *compression = (asset_pack_compression_t) i;
+            return true;
+        }
+    }
+    return false;
+}
+
+// `@list` arguments stand for the paths in that file, one per line, so inputs that only exist after another
+// build step (the atlas pages) can be passed without knowing them up front
+static bool expand_inputs(char **args, int num_args, char ***inputs, uint32_t *num_inputs, char **lists) {
+    uint32_t count = 0;
+    uint32_t capacity = (uint32_t) num_args;
+    char **paths = SDL_malloc(SDL_max(capacity, 1) * sizeof(char *));
+    if (paths == NULL) {
+        return false;
+    }
+    for (int i = 0; i < num_args; i++) {
+        if (args[i][0] != '@') {
+            paths[count++] = args[i];
+            continue;
+        }
+        char *list = SDL_LoadFile(args[i] + 1, NULL);
+        if (list == NULL) {
+            SDL_free(paths);
+            return false;
+        }
+        lists[i] = list;
+        for (char *line = list; *line;) {
+            char *end = SDL_strchr(line, '\n');
+            if (end) {
+                *end = '\0';
+            }
+            if (*line) {
+                if (count == capacity) {
+                    capacity *= 2;
+                    char **grown = SDL_realloc(paths, capacity * sizeof(char *));
+                    if (grown == NULL) {
+                        SDL_free(paths);
+                        return false;
+                    }
+                    paths = grown;
+                }
+                paths[count++] = line;
+            }
+            line = end ? end + 1 : line + SDL_strlen(line);
+        }
+    }
+    *inputs = paths;
+    *num_inputs = count;
+    return true;
+}
+
+// usage: kingdom_defense_packer [--compression auto|none|bc1|bc3|bc7] <out.pack> <texture.bmp|@list>...
+int main(int argc, char **argv) {
+    asset_pack_compression_t compression = ASSET_PACK_COMPRESSION_AUTO;
+    int first = 1;
+    if (argc > 2 && SDL_strcmp(argv[1], "--compression") == 0) {
+        if (!parse_compression(argv[2], &compression)) {
+            fprintf(stderr, "unknown compression %s\n", argv[2]);
+            return 1;
+        }
+        first = 3;
+    }
+    if (argc - first < 1) {
+        fprintf(stderr, "usage: %s [--compression auto|none|bc1|bc3|bc7] <out.pack> <texture.bmp|@list>...\n",
+                argv[0]);
+        return 1;
+    }
+    if (!SDL_Init(0)) {
+        fprintf(stderr, "SDL_Init: %s\n", SDL_GetError());
+        return 1;
+    }
+    int result = 0;
+    asset_pack_build_stats_t stats;
+    const char *path = argv[first];
+    int num_args = argc - first - 1;
+    char **lists = SDL_calloc(SDL_max(num_args, 1), sizeof(char *));
+    char **inputs = NULL;
+    uint32_t num_inputs = 0;
+    if (lists == NULL || !expand_inputs(argv + first + 1, num_args, &inputs, &num_inputs, lists)) {
+        fprintf(stderr, "failed to read the inputs: %s\n", SDL_GetError());
+        result = 1;
+    } else if (!asset_pack_build(path, (const char *const *) inputs, num_inputs, compression, &stats)) {
+        fprintf(stderr, "failed to write %s: %s\n", path, SDL_GetError());
+        result = 1;
+    } else if (stats.textures > 0) {
+        // what the game uploads on a device that takes the compressed variants, against plain rgba8
+        double encode_s = (double) stats.encode_ns / SDL_NS_PER_SECOND;
+        printf("%s: %u textures, upload %.1f KiB instead of %.1f KiB (%.1fx smaller), encoded at %.1f MiB/s\n", path,
+               stats.textures, (double) stats.compressed_bytes / 1024.0, (double) stats.rgba8_bytes / 1024.0,
+               (double) stats.rgba8_bytes / (double) stats.compressed_bytes,
+               encode_s > 0.0 ? (double) stats.rgba8_bytes / encode_s / (1024.0 * 1024.0) : 0.0);
+    }
+    for (int i = 0; lists != NULL && i < num_args; i++) {
+        SDL_free(lists[i]);
+    }
+    SDL_free(lists);
+    SDL_free(inputs);
+    SDL_Quit();
+    return result;
+}
@@ -0,0 +1,319 @@
+#include "asset_stream.h"
+#include "gpu_resources.h"
+
+static int loader_main(void *data);
+
+static SDL_GPUTexture *create_placeholder(SDL_GPUDevice *device, upload_ring_t *upload_ring) {
+    SDL_GPUTextureCreateInfo texture_info = {
+            .width = 1,
+            .height = 1,
+            .format = SDL_GPU_TEXTUREFORMAT_R8G8B8A8_UNORM,
+            .layer_count_or_depth = 1,
+            .num_levels = 1,
+            .usage = SDL_GPU_TEXTUREUSAGE_SAMPLER,
+    };
+    SDL_GPUTexture *texture = gpu_create_texture(device, &texture_info, GPU_CALLSITE);
+    if (texture == NULL) {
+        return NULL;
+    }
+    // white, so sprites still show their tint while the real texture streams in
+    uint8_t *mem = upload_ring_stage_texture(upload_ring,
+                                             &(SDL_GPUTextureRegion) {
+                                                     .texture = texture,
+                                                     .w = 1,
+                                                     .h = 1,
+                                                     .d = 1,
+                                             }, 1, 1, 4);
+    if (mem == NULL) {
+        gpu_release_texture(device, texture);
+        return NULL;
+    }
+    SDL_memset(mem, 0xff, 4);
+    return texture;
+}
+
+bool asset_stream_init(asset_stream_t *stream, SDL_GPUDevice *device, upload_ring_t *upload_ring,
+                       const asset_pack_t *pack) {
+    SDL_zerop(stream);
+    stream->device = device;
+    stream->upload_ring = upload_ring;
+    stream->pack = pack;
+    stream->frame_budget = ASSET_STREAM_DEFAULT_FRAME_BUDGET;
+    stream->placeholder = create_placeholder(device, upload_ring);
+    stream->mutex = SDL_CreateMutex();
+    stream->wake = SDL_CreateCondition();
+    if (stream->placeholder == NULL || stream->mutex == NULL || stream->wake == NULL) {
+        asset_stream_destroy(stream);
+        return false;
+    }
+    stream->thread = SDL_CreateThread(loader_main, "asset loader", stream);
+    if (stream->thread == NULL) {
+        asset_stream_destroy(stream);
+        return false;
+    }
+    return true;
+}
+
+static void free_loaded(asset_t *asset) {
+    pixel_convert_free(&asset->converted);
+    if (asset->surface) {
+        SDL_DestroySurface(asset->surface);
+        asset->surface = NULL;
+    }
+}
+
+void asset_stream_destroy(asset_stream_t *stream) {
+    if (stream->thread) {
+        SDL_LockMutex(stream->mutex);
+        stream->quit = true;
+        SDL_SignalCondition(stream->wake);
+        SDL_UnlockMutex(stream->mutex);
+        SDL_WaitThread(stream->thread, NULL);
+    }
+    for (uint32_t i = 0; i < stream->num_assets; i++) {
+        asset_t *asset = &stream->assets[i];
+        free_loaded(asset);
+        if (asset->texture) {
+            gpu_release_texture(stream->device, asset->texture);
+        }
+    }
+    if (stream->placeholder) {
+        gpu_release_texture(stream->device, stream->placeholder);
+    }
+    SDL_DestroyCondition(stream->wake);
+    SDL_DestroyMutex(stream->mutex);
+    SDL_zerop(stream);
+}
+
+// the loader side of one asset. pack entries are only touched here so their pages are read from disk on this
+// thread, bmp files are decoded and converted into what the device samples
+static void load_asset(asset_stream_t *stream, asset_t *asset) {
+    uint64_t start = SDL_GetTicksNS();
+    if (asset->entry) {
+        const volatile uint8_t *texels = asset_pack_texels(stream->pack, asset->entry);
+        for (uint64_t offset = 0; offset < asset->entry->size; offset += ASSET_PACK_DATA_ALIGNMENT) {
+            (void) texels[offset];
+        }
+        asset->ok = true;
+    } else {
+        char path[1024];
+        SDL_snprintf(path, sizeof(path), "assets/%s", asset->name);
+        asset->surface = SDL_LoadBMP(path);
+        // the format query is read only, it is safe next to the render thread
+        asset->ok = asset->surface && pixel_convert_surface(stream->device, asset->surface, &asset->converted);
+        if (!asset->ok) {
+            SDL_strlcpy(asset->error, SDL_GetError(), sizeof(asset->error));
+            free_loaded(asset);
+        }
+    }
+    asset->load_ns = SDL_GetTicksNS() - start;
+}
+
+static int loader_main(void *data) {
+    asset_stream_t *stream = data;
+    SDL_LockMutex(stream->mutex);
+    while (!stream->quit) {
+        if (stream->request_count == 0) {
+            SDL_WaitCondition(stream->wake, stream->mutex);
+            continue;
+        }
+        uint32_t id = stream->requests[stream->request_head];
+        stream->request_head = (stream->request_head + 1) % ASSET_STREAM_MAX_ASSETS;
+        stream->request_count--;
+        SDL_UnlockMutex(stream->mutex);
+
+        load_asset(stream, &stream->assets[id]);
+
+        SDL_LockMutex(stream->mutex);
+        stream->loaded[(stream->loaded_head + stream->loaded_count) % ASSET_STREAM_MAX_ASSETS] = id;
+        stream->loaded_count++;
+    }
+    SDL_UnlockMutex(stream->mutex);
+    return 0;
+}
+
+// picks the first variant of a packed texture the device can sample, NULL if there is none
+static const asset_pack_entry_t *find_variant(asset_stream_t *stream, const char *name) {
+    const asset_pack_entry_t *entry = stream->pack ? asset_pack_find(stream->pack, name) : NULL;
+    while (entry && !SDL_GPUTextureSupportsFormat(stream->device, (SDL_GPUTextureFormat) entry->format,
+                                                  SDL_GPU_TEXTURETYPE_2D, SDL_GPU_TEXTUREUSAGE_SAMPLER)) {
+        entry = asset_pack_next_variant(stream->pack, entry);
+    }
+    return entry;
+}
+
+uint32_t asset_stream_request(asset_stream_t *stream, const char *name) {
+    for (uint32_t i = 0; i < stream->num_assets; i++) {
+        if (SDL_strcmp(stream->assets[i].name, name) == 0) {
+            return i;
+        }
+    }
+    if (stream->num_assets == ASSET_STREAM_MAX_ASSETS || SDL_strlen(name) >= ASSET_PACK_NAME_LENGTH) {
+        SDL_SetError("can't stream %s", name);
+        return ASSET_STREAM_INVALID;
+    }
+    uint32_t id = stream->num_assets++;
+    asset_t *asset = &stream->assets[id];
+    SDL_zerop(asset);
+    SDL_strlcpy(asset->name, name, ASSET_PACK_NAME_LENGTH);
+    asset->state = ASSET_STATE_QUEUED;
+    asset->requested_ns = SDL_GetTicksNS();
+    asset->entry = find_variant(stream, name);
+    stream->stats.requested++;
+
+    SDL_LockMutex(stream->mutex);
+    stream->requests[(stream->request_head + stream->request_count) % ASSET_STREAM_MAX_ASSETS] = id;
+    stream->request_count++;
+    stream->stats.max_request_depth = SDL_max(stream->stats.max_request_depth, stream->request_count);
+    SDL_SignalCondition(stream->wake);
+    SDL_UnlockMutex(stream->mutex);
+    return id;
+}
+
+// every mip level of a packed texture, straight from the mapping into staging memory
+static bool stage_packed(asset_stream_t *stream, asset_t *asset) {
+    const asset_pack_entry_t *entry = asset->entry;
+    SDL_GPUTextureCreateInfo texture_info = {
+            .width = entry->width,
+            .height = entry->height,
+            .format = (SDL_GPUTextureFormat) entry->format,
+            .layer_count_or_depth = 1,
+            .num_levels = entry->num_levels,
+            .usage = SDL_GPU_TEXTUREUSAGE_SAMPLER,
+    };
+    asset->texture = gpu_create_texture(stream->device, &texture_info, GPU_CALLSITE);
+    if (asset->texture == NULL) {
+        return false;
+    }
+    for (uint32_t i = 0; i < entry->num_levels; i++) {
+        asset_pack_level_t level;
+        asset_pack_level(entry, i, &level);
+        void *mem = upload_ring_stage_texture(stream->upload_ring,
+                                              &(SDL_GPUTextureRegion) {
+                                                      .texture = asset->texture,
+                                                      .mip_level = i,
+                                                      .w = level.width,
+                                                      .h = level.height,
+                                                      .d = 1,
+                                              }, level.pixels_per_row, level.rows, level.size);
+        if (mem == NULL) {
+            return false;
+        }
+        SDL_memcpy(mem, asset_pack_texels(stream->pack, entry) + level.offset, level.size);
+    }
+    asset_pack_release(stream->pack, entry);
+    return true;
+}
+
+static bool stage_converted(asset_stream_t *stream, asset_t *asset) {
+    const converted_pixels_t *converted = &asset->converted;
+    SDL_GPUTextureCreateInfo texture_info = {
+            .width = converted->width,
+            .height = converted->height,
+            .format = converted->format,
+            .layer_count_or_depth = 1,
+            .num_levels = 1,
+            .usage = SDL_GPU_TEXTUREUSAGE_SAMPLER,
+    };
+    asset->texture = gpu_create_texture(stream->device, &texture_info, GPU_CALLSITE);
+    if (asset->texture == NULL) {
+        return false;
+    }
+    void *mem = upload_ring_stage_texture(stream->upload_ring,
+                                          &(SDL_GPUTextureRegion) {
+                                                  .texture = asset->texture,
+                                                  .w = converted->width,
+                                                  .h = converted->height,
+                                                  .d = 1,
+                                          }, converted->pixels_per_row, converted->height,
+                                          (uint32_t) converted->size_bytes);
+    if (mem == NULL) {
+        return false;
+    }
+    SDL_memcpy(mem, converted->pixels, converted->size_bytes);
+    return true;
+}
+
+static uint64_t staged_bytes(const asset_t *asset) {
+    return asset->entry ? asset->entry->size : asset->converted.size_bytes;
+}
+
+static void fail(asset_stream_t *stream, asset_t *asset, const char *error) {
+    SDL_Log("asset %s failed, keeping the placeholder: %s", asset->name, error);
+    if (asset->texture) {
+        gpu_release_texture(stream->device, asset->texture);
+        asset->texture = NULL;
+    }
+    asset->state = ASSET_STATE_FAILED;
+    stream->stats.failed++;
+}
+
+void asset_stream_update(asset_stream_t *stream) {
+    uint64_t now = SDL_GetTicksNS();
+    for (uint32_t i = 0; i < stream->num_assets; i++) {
+        asset_t *asset = &stream->assets[i];
+        if (asset->state != ASSET_STATE_UPLOADING ||
+            !upload_ring_is_complete(stream->upload_ring, asset->upload_serial)) {
+            continue;
+        }
+        asset->state = ASSET_STATE_RESIDENT;
+        uint64_t latency = now - asset->requested_ns;
+        stream->stats.resident++;
+        stream->stats.last_latency_ns = latency;
+        stream->stats.max_latency_ns = SDL_max(stream->stats.max_latency_ns, latency);
+        stream->stats.total_latency_ns += latency;
+        stream->stats.total_load_ns += asset->load_ns;
+        SDL_Log("asset %s resident after %.2f ms (%s, loader %.2f ms)", asset->name,
+                (double) latency / SDL_NS_PER_MS, asset->entry ? "pack" : "bmp",
+                (double) asset->load_ns / SDL_NS_PER_MS);
+    }
+
+    uint64_t budget_used = 0;
+    SDL_LockMutex(stream->mutex);
+    while (stream->loaded_count > 0) {
+        asset_t *asset = &stream->assets[stream->loaded[stream->loaded_head]];
+        // at least one per frame, a texture bigger than the budget would never go out otherwise
+        if (budget_used > 0 && asset->ok && budget_used + staged_bytes(asset) > stream->frame_budget) {
+            break;
+        }
+        stream->loaded_head = (stream->loaded_head + 1) % ASSET_STREAM_MAX_ASSETS;
+        stream->loaded_count--;
+        SDL_UnlockMutex(stream->mutex);
+
+        if (!asset->ok) {
+            fail(stream, asset, asset->error);
+        } else {
+            budget_used += staged_bytes(asset);
+            if (asset->entry ? stage_packed(stream, asset) : stage_converted(stream, asset)) {
+                asset->state = ASSET_STATE_UPLOADING;
+                asset->upload_serial = upload_ring_staged_serial(stream->upload_ring);
+            } else {
+                fail(stream, asset, SDL_GetError());
+            }
+            free_loaded(asset);
+        }
+
+        SDL_LockMutex(stream->mutex);
+    }
+    SDL_UnlockMutex(stream->mutex);
+}
+
+SDL_GPUTexture *asset_stream_texture(const asset_stream_t *stream, uint32_t id) {
+    return asset_stream_is_resident(stream, id) ? stream->assets[id].texture : stream->placeholder;
+}
+
+bool asset_stream_is_resident(const asset_stream_t *stream, uint32_t id) {
+    return id < stream->num_assets && stream->assets[id].state == ASSET_STATE_RESIDENT;
+}
+
+void asset_stream_stats(asset_stream_t *stream, asset_stream_stats_t *out) {
+    *out = stream->stats;
+    SDL_LockMutex(stream->mutex);
+    out->request_depth = stream->request_count;
+    out->staging_depth = stream->loaded_count;
+    SDL_UnlockMutex(stream->mutex);
+    out->upload_depth = 0;
+    for (uint32_t i = 0; i < stream->num_assets; i++) {
+        out->upload_depth += stream->assets[i].state == ASSET_STATE_UPLOADING;
+    }
+}
@@ -0,0 +1,104 @@
+#ifndef KINGDOM_DEFENSE_ASSET_STREAM_H
+#define KINGDOM_DEFENSE_ASSET_STREAM_H
+
+#include <SDL3/SDL.h>
+
+#include "asset_pack.h"
+#include "pixel_convert.h"
+#include "upload_ring.h"
+
+#define ASSET_STREAM_MAX_ASSETS 256
+#define ASSET_STREAM_INVALID UINT32_MAX
+// staging bytes recorded per frame, a wave's worth of textures is spread over a few frames instead of one hitch
+#define ASSET_STREAM_DEFAULT_FRAME_BUDGET (8 * 1024 * 1024)
+
+typedef enum {
+    // with the loader thread, or loaded and waiting for the render thread to stage it
+    ASSET_STATE_QUEUED,
+    // staged, waiting for the fence of its upload
+    ASSET_STATE_UPLOADING,
+    ASSET_STATE_RESIDENT,
+    // missing or broken file, drawn with the placeholder for good
+    ASSET_STATE_FAILED,
+} asset_state_t;
+
+typedef struct {
+    char name[ASSET_PACK_NAME_LENGTH];
+    // render thread only
+    asset_state_t state;
+    SDL_GPUTexture *texture;
+    uint64_t upload_serial;
+    uint64_t requested_ns;
+
+    // variant picked on the render thread at request time, NULL when the asset comes from a bmp file
+    const asset_pack_entry_t *entry;
+    // filled by the loader thread before it hands the asset over
+    SDL_Surface *surface;
+    converted_pixels_t converted;
+    bool ok;
+    char error[128];
+    uint64_t load_ns;
+} asset_t;
+
+typedef struct {
+    uint32_t requested;
+    uint32_t resident;
+    uint32_t failed;
+    // requests the loader thread hasn't picked up yet, loads the render thread hasn't staged yet, uploads whose
+    // fence hasn't signaled yet
+    uint32_t request_depth;
+    uint32_t staging_depth;
+    uint32_t upload_depth;
+    uint32_t max_request_depth;
+    // request to resident, and the share of it spent on the loader thread
+    uint64_t last_latency_ns;
+    uint64_t max_latency_ns;
+    uint64_t total_latency_ns;
+    uint64_t total_load_ns;
+} asset_stream_stats_t;
+
+// textures load on a background thread and reach the gpu through the upload ring, the render thread never waits
+// on a file. until an asset is resident asset_stream_texture hands out a placeholder
+typedef struct {
+    SDL_GPUDevice *device;
+    upload_ring_t *upload_ring;
+    // may be NULL, assets missing from it are decoded from assets/<name>
+    const asset_pack_t *pack;
+    SDL_GPUTexture *placeholder;
+    uint32_t frame_budget;
+
+    asset_t assets[ASSET_STREAM_MAX_ASSETS];
+    uint32_t num_assets;
+
+    // ids in flight between the threads. an asset sits in at most one queue at a time, so neither can overflow
+    SDL_Thread *thread;
+    SDL_Mutex *mutex;
+    SDL_Condition *wake;
+    bool quit;
+    uint32_t requests[ASSET_STREAM_MAX_ASSETS];
+    uint32_t request_head;
+    uint32_t request_count;
+    uint32_t loaded[ASSET_STREAM_MAX_ASSETS];
+    uint32_t loaded_head;
+    uint32_t loaded_count;
+
+    asset_stream_stats_t stats;
+} asset_stream_t;
+
+// `pack` may be NULL and has to outlive the stream. the placeholder is staged on `upload_ring` right away
+bool asset_stream_init(asset_stream_t *stream, SDL_GPUDevice *device, upload_ring_t *upload_ring,
+                       const asset_pack_t *pack);
+// stops the loader thread and releases every texture, the gpu must be done with them
+void asset_stream_destroy(asset_stream_t *stream);
+
+// queues a texture for loading, asking twice returns the same id. ASSET_STREAM_INVALID when the table is full
+uint32_t asset_stream_request(asset_stream_t *stream, const char *name);
+// once per frame before upload_ring_submit: marks finished uploads resident and stages newly loaded assets, up to
+// `frame_budget` bytes
+void asset_stream_update(asset_stream_t *stream);
+// the asset's texture once it is resident, the placeholder until then
+SDL_GPUTexture *asset_stream_texture(const asset_stream_t *stream, uint32_t id);
+bool asset_stream_is_resident(const asset_stream_t *stream, uint32_t id);
+void asset_stream_stats(asset_stream_t *stream, asset_stream_stats_t *out);
+
+#endif //KINGDOM_DEFENSE_ASSET_STREAM_H
@@ -0,0 +1,359 @@
+#include "atlas.h"
+
+void atlas_skyline_init(atlas_skyline_t *skyline, uint32_t width, uint32_t height) {
+    SDL_zerop(skyline);
+    skyline->width = SDL_min(width, ATLAS_PAGE_SIZE);
+    skyline->height = height;
+    skyline->nodes[0].width = skyline->width;
+    skyline->num_nodes = 1;
+}
+
+// where a rectangle with its left edge on node i would rest, UINT32_MAX if it runs off the page
+static uint32_t skyline_fit(const atlas_skyline_t *skyline, uint32_t i, uint32_t width, uint32_t height) {
+    if (skyline->nodes[i].x + width > skyline->width) {
+        return UINT32_MAX;
+    }
+    uint32_t y = 0;
+    uint32_t left = width;
+    for (uint32_t j = i; left > 0; j++) {
+        y = SDL_max(y, skyline->nodes[j].y);
+        if (y + height > skyline->height) {
+            return UINT32_MAX;
+        }
+        left -= SDL_min(left, skyline->nodes[j].width);
+    }
+    return y;
+}
+
+bool atlas_skyline_insert(atlas_skyline_t *skyline, uint32_t width, uint32_t height, uint32_t *x, uint32_t *y) {
+    uint32_t best = UINT32_MAX;
+    uint32_t best_y = UINT32_MAX;
+    for (uint32_t i = 0; i < skyline->num_nodes; i++) {
+        uint32_t fit_y = skyline_fit(skyline, i, width, height);
+        if (fit_y < best_y) {
+            best = i;
+            best_y = fit_y;
+        }
+    }
+    if (best == UINT32_MAX) {
+        return false;
+    }
+
+    // the rectangle's top becomes a new node, the ones it covers shrink or go away
+    atlas_skyline_node_t *nodes = skyline->nodes;
+    atlas_skyline_node_t placed = {nodes[best].x, best_y + height, width};
+    SDL_memmove(&nodes[best + 1], &nodes[best], (skyline->num_nodes - best) * sizeof(atlas_skyline_node_t));
+    nodes[best] = placed;
+    skyline->num_nodes++;
+    uint32_t right = placed.x + placed.width;
+    while (best + 1 < skyline->num_nodes && nodes[best + 1].x < right) {
+        atlas_skyline_node_t *next = &nodes[best + 1];
+        uint32_t covered = right - next->x;
+        if (covered < next->width) {
+            next->x += covered;
+            next->width -= covered;
+            break;
+        }
+        skyline->num_nodes--;
+        SDL_memmove(next, next + 1, (skyline->num_nodes - best - 1) * sizeof(atlas_skyline_node_t));
+    }
+    // neighbours at the same height are one node
+    for (uint32_t i = 0; i + 1 < skyline->num_nodes;) {
+        if (nodes[i].y == nodes[i + 1].y) {
+            nodes[i].width += nodes[i + 1].width;
+            skyline->num_nodes--;
+            SDL_memmove(&nodes[i + 1], &nodes[i + 2], (skyline->num_nodes - i - 1) * sizeof(atlas_skyline_node_t));
+        } else {
+            i++;
+        }
+    }
+
+    skyline->used_width = SDL_max(skyline->used_width, right);
+    skyline->used_height = SDL_max(skyline->used_height, placed.y);
+    *x = placed.x;
+    *y = best_y;
+    return true;
+}
+
+typedef struct {
+    uint32_t index;
+    // with padding, on the ATLAS_ALIGN grid
+    uint32_t width;
+    uint32_t height;
+} pack_item_t;
+
+static int compare_items(const void *a, const void *b) {
+    const pack_item_t *item_a = a;
+    const pack_item_t *item_b = b;
+    if (item_a->height != item_b->height) {
+        return item_a->height > item_b->height ? -1 : 1;
+    }
+    if (item_a->width != item_b->width) {
+        return item_a->width > item_b->width ? -1 : 1;
+    }
+    return item_a->index < item_b->index ? -1 : item_a->index > item_b->index;
+}
+
+uint32_t atlas_padded_size(uint32_t size) {
+    return (size + 2 * ATLAS_EXTRUDE + ATLAS_ALIGN - 1) / ATLAS_ALIGN * ATLAS_ALIGN;
+}
+
+// one attempt with pages `page_width` wide, false if a sprite doesn't fit or the pages run out
+static bool pack_pages(const pack_item_t *items, uint32_t num_items, uint32_t page_width, atlas_skyline_t *pages,
+                       atlas_placement_t *placements, uint32_t *num_pages) {
+    uint32_t used_pages = 0;
+    for (uint32_t i = 0; i < num_items; i++) {
+        const pack_item_t *item = &items[i];
+        uint32_t x = 0;
+        uint32_t y = 0;
+        uint32_t page = 0;
+        while (page < used_pages && !atlas_skyline_insert(&pages[page], item->width, item->height, &x, &y)) {
+            page++;
+        }
+        if (page == used_pages) {
+            if (used_pages == ATLAS_MAX_PAGES) {
+                return false;
+            }
+            atlas_skyline_init(&pages[used_pages++], page_width, ATLAS_PAGE_SIZE);
+            if (!atlas_skyline_insert(&pages[page], item->width, item->height, &x, &y)) {
+                return false;
+            }
+        }
+        placements[item->index] = (atlas_placement_t) {page, x + ATLAS_EXTRUDE, y + ATLAS_EXTRUDE};
+    }
+    *num_pages = used_pages;
+    return true;
+}
+
+bool atlas_pack(const uint32_t *widths, const uint32_t *heights, uint32_t num_sprites,
+                atlas_placement_t *placements, uint32_t *num_pages, uint32_t (*page_sizes)[2], atlas_stats_t *stats) {
+    uint64_t start = SDL_GetTicksNS();
+    pack_item_t *items = SDL_malloc(SDL_max(num_sprites, 1) * sizeof(pack_item_t));
+    atlas_placement_t *candidate = SDL_malloc(SDL_max(num_sprites, 1) * sizeof(atlas_placement_t));
+    atlas_skyline_t *pages = SDL_malloc(ATLAS_MAX_PAGES * sizeof(atlas_skyline_t));
+    if (items == NULL || candidate == NULL || pages == NULL) {
+        SDL_free(items);
+        SDL_free(candidate);
+        SDL_free(pages);
+        return false;
+    }
+    atlas_stats_t totals = {.sprites = num_sprites};
+    bool ok = true;
+    for (uint32_t i = 0; i < num_sprites; i++) {
+        items[i] = (pack_item_t) {i, atlas_padded_size(widths[i]), atlas_padded_size(heights[i])};
+        totals.sprite_texels += (uint64_t) widths[i] * heights[i];
+        totals.padded_texels += (uint64_t) items[i].width * items[i].height;
+        if (ok && (items[i].width > ATLAS_PAGE_SIZE || items[i].height > ATLAS_PAGE_SIZE)) {
+            ok = SDL_SetError("sprite %u (%ux%u) doesn't fit on an atlas page", i, widths[i], heights[i]);
+        }
+    }
+    SDL_qsort(items, num_sprites, sizeof(pack_item_t), compare_items);
+
+    // full width pages leave a few sprites in one long strip, so narrower ones get a go as well. fewest pages
+    // wins, then fewest texels
+    uint32_t best_pages = UINT32_MAX;
+    for (uint32_t page_width = ATLAS_PAGE_SIZE; ok && page_width >= ATLAS_MIN_PAGE_WIDTH; page_width /= 2) {
+        uint32_t used_pages = 0;
+        if (!pack_pages(items, num_sprites, page_width, pages, candidate, &used_pages)) {
+            continue;
+        }
+        uint64_t page_texels = 0;
+        for (uint32_t page = 0; page < used_pages; page++) {
+            page_texels += (uint64_t) pages[page].used_width * pages[page].used_height;
+        }
+        if (used_pages > best_pages || (used_pages == best_pages && page_texels >= totals.page_texels)) {
+            continue;
+        }
+        best_pages = used_pages;
+        totals.page_texels = page_texels;
+        SDL_memcpy(placements, candidate, num_sprites * sizeof(atlas_placement_t));
+        for (uint32_t page = 0; page < used_pages; page++) {
+            // still on the ATLAS_ALIGN grid, so every level down to ATLAS_MAX_LOD halves exactly
+            page_sizes[page][0] = pages[page].used_width;
+            page_sizes[page][1] = pages[page].used_height;
+        }
+    }
+    if (ok && best_pages == UINT32_MAX) {
+        ok = SDL_SetError("sprites need more than %d atlas pages", ATLAS_MAX_PAGES);
+    }
+    if (ok) {
+        *num_pages = best_pages;
+        totals.pages = best_pages;
+    }
+    totals.pack_ns = SDL_GetTicksNS() - start;
+    if (stats) {
+        *stats = totals;
+    }
+    SDL_free(items);
+    SDL_free(candidate);
+    SDL_free(pages);
+    return ok;
+}
+
+// copies `sprite` to (x, y) and repeats its outermost texels over the whole padding around it, at least
+// ATLAS_EXTRUDE deep
+static void blit_extruded(SDL_Surface *page, const SDL_Surface *sprite, uint32_t x, uint32_t y) {
+    int32_t w = sprite->w;
+    int32_t h = sprite->h;
+    int32_t right = (int32_t) atlas_padded_size((uint32_t) w) - ATLAS_EXTRUDE;
+    int32_t top = (int32_t) atlas_padded_size((uint32_t) h) - ATLAS_EXTRUDE;
+    for (int32_t row = -ATLAS_EXTRUDE; row < top; row++) {
+        const uint32_t *src = (const uint32_t *) ((const uint8_t *) sprite->pixels +
+                                                  (size_t) SDL_clamp(row, 0, h - 1) * sprite->pitch);
+        uint32_t *dst = (uint32_t *) ((uint8_t *) page->pixels + (size_t) ((int32_t) y + row) * page->pitch) + x;
+        for (int32_t column = -ATLAS_EXTRUDE; column < right; column++) {
+            dst[column] = src[SDL_clamp(column, 0, w - 1)];
+        }
+    }
+}
+
+// GRASS for assets/grass.bmp
+static bool sprite_name(const char *input, char *name, size_t size) {
+    const char *base = input;
+    for (const char *c = input; *c; c++) {
+        if (*c == '/' || *c == '\\') {
+            base = c + 1;
+        }
+    }
+    size_t length = 0;
+    for (const char *c = base; *c && *c != '.'; c++) {
+        if (length + 1 >= size) {
+            return SDL_SetError("sprite name %s is too long", base);
+        }
+        name[length++] = SDL_isalnum(*c) ? (char) SDL_toupper(*c) : '_';
+    }
+    name[length] = '\0';
+    if (length == 0 || SDL_isdigit(name[0])) {
+        return SDL_SetError("%s doesn't make a sprite name", base);
+    }
+    return true;
+}
+
+// leaves the file alone when it already says the same, everything including the table would rebuild otherwise
+static bool write_if_different(const char *path, const char *text, size_t length) {
+    size_t old_length = 0;
+    void *old = SDL_LoadFile(path, &old_length);
+    bool same = old != NULL && old_length == length && SDL_memcmp(old, text, length) == 0;
+    SDL_free(old);
+    return same || SDL_SaveFile(path, text, length);
+}
+
+typedef struct {
+    char name[64];
+    SDL_Surface *surface;
+} atlas_sprite_source_t;
+
+static bool write_pages(const char *out_dir, const char *list_path, const atlas_sprite_source_t *sprites,
+                        const atlas_placement_t *placements, uint32_t num_sprites, uint32_t num_pages,
+                        uint32_t (*page_sizes)[2]) {
+    SDL_IOStream *list = SDL_IOFromFile(list_path, "wb");
+    if (list == NULL) {
+        return false;
+    }
+    bool ok = true;
+    for (uint32_t page = 0; ok && page < num_pages; page++) {
+        SDL_Surface *surface = SDL_CreateSurface((int) page_sizes[page][0], (int) page_sizes[page][1],
+                                                 SDL_PIXELFORMAT_RGBA32);
+        if (surface == NULL) {
+            ok = false;
+            break;
+        }
+        // transparent between sprites
+        for (int row = 0; row < surface->h; row++) {
+            SDL_memset((uint8_t *) surface->pixels + (size_t) row * surface->pitch, 0, (size_t) surface->w * 4);
+        }
+        for (uint32_t i = 0; i < num_sprites; i++) {
+            if (placements[i].page == page) {
+                blit_extruded(surface, sprites[i].surface, placements[i].x, placements[i].y);
+            }
+        }
+        char name[32];
+        char path[1024];
+        SDL_snprintf(name, sizeof(name), ATLAS_PAGE_NAME_FORMAT, page);
+        SDL_snprintf(path, sizeof(path), "%s/%s", out_dir, name);
+        ok = SDL_SaveBMP(surface, path) && SDL_IOprintf(list, "%s\n", path) > 0;
+        SDL_DestroySurface(surface);
+    }
+    return SDL_CloseIO(list) && ok;
+}
+
+// longest line of the table: an ATLAS_SPRITE with a name of 63 characters and four %.9g numbers
+#define HEADER_LINE_LENGTH 192
+
+static bool write_header(const char *header_path, const atlas_sprite_source_t *sprites,
+                         const atlas_placement_t *placements, uint32_t num_sprites, uint32_t num_pages,
+                         uint32_t (*page_sizes)[2]) {
+    size_t capacity = (size_t) (1 + num_pages + num_sprites) * HEADER_LINE_LENGTH;
+    char *text = SDL_malloc(capacity);
+    if (text == NULL) {
+        return false;
+    }
+    size_t length = (size_t) SDL_snprintf(text, capacity, "// generated by kingdom_defense_atlas, do not edit\n");
+    for (uint32_t page = 0; page < num_pages; page++) {
+        char name[32];
+        SDL_snprintf(name, sizeof(name), ATLAS_PAGE_NAME_FORMAT, page);
+        length += (size_t) SDL_snprintf(text + length, capacity - length, "ATLAS_PAGE(\"%s\")\n", name);
+    }
+    // x, y, w, h in the uv space of the page, without the extruded border
+    for (uint32_t i = 0; i < num_sprites; i++) {
+        const atlas_placement_t *placement = &placements[i];
+        double page_w = (double) page_sizes[placement->page][0];
+        double page_h = (double) page_sizes[placement->page][1];
+        length += (size_t) SDL_snprintf(text + length, capacity - length,
+                                        "ATLAS_SPRITE(%s, %u, %.9g, %.9g, %.9g, %.9g)\n", sprites[i].name,
+                                        placement->page, (double) placement->x / page_w,
+                                        (double) placement->y / page_h, (double) sprites[i].surface->w / page_w,
+                                        (double) sprites[i].surface->h / page_h);
+    }
+    bool ok = write_if_different(header_path, text, length);
+    SDL_free(text);
+    return ok;
+}
+
+bool atlas_build(const char *out_dir, const char *list_path, const char *header_path, const char *const *inputs,
+                 uint32_t num_inputs, atlas_stats_t *stats) {
+    if (num_inputs == 0) {
+        return SDL_SetError("no sprites to pack, the game needs at least one atlas page");
+    }
+    atlas_sprite_source_t *sprites = SDL_calloc(num_inputs, sizeof(atlas_sprite_source_t));
+    uint32_t *sizes = SDL_malloc(num_inputs * 2 * sizeof(uint32_t));
+    atlas_placement_t *placements = SDL_malloc(num_inputs * sizeof(atlas_placement_t));
+    bool ok = sprites != NULL && sizes != NULL && placements != NULL;
+
+    for (uint32_t i = 0; ok && i < num_inputs; i++) {
+        ok = sprite_name(inputs[i], sprites[i].name, sizeof(sprites[i].name));
+        for (uint32_t j = 0; ok && j < i; j++) {
+            if (SDL_strcmp(sprites[i].name, sprites[j].name) == 0) {
+                ok = SDL_SetError("%s and %s are both sprite %s", inputs[j], inputs[i], sprites[i].name);
+            }
+        }
+        if (!ok) {
+            break;
+        }
+        // one layout for every page, whatever the bmp was saved as
+        SDL_Surface *loaded = SDL_LoadBMP(inputs[i]);
+        sprites[i].surface = loaded ? SDL_ConvertSurface(loaded, SDL_PIXELFORMAT_RGBA32) : NULL;
+        SDL_DestroySurface(loaded);
+        ok = sprites[i].surface != NULL;
+        if (ok) {
+            sizes[i] = (uint32_t) sprites[i].surface->w;
+            sizes[num_inputs + i] = (uint32_t) sprites[i].surface->h;
+        }
+    }
+
+    uint32_t num_pages = 0;
+    uint32_t page_sizes[ATLAS_MAX_PAGES][2];
+    ok = ok && atlas_pack(sizes, sizes + num_inputs, num_inputs, placements, &num_pages, page_sizes, stats) &&
+         write_pages(out_dir, list_path, sprites, placements, num_inputs, num_pages, page_sizes) &&
+         write_header(header_path, sprites, placements, num_inputs, num_pages, page_sizes);
+
+    if (sprites != NULL) {
+        for (uint32_t i = 0; i < num_inputs; i++) {
+            SDL_DestroySurface(sprites[i].surface);
+        }
+    }
+    SDL_free(sprites);
+    SDL_free(sizes);
+    SDL_free(placements);
+    return ok;
+}
@@ -0,0 +1,76 @@
+#ifndef KINGDOM_DEFENSE_ATLAS_H
+#define KINGDOM_DEFENSE_ATLAS_H
+
+#include <SDL3/SDL.h>
+
+// largest page, finished pages are cropped to what was placed on them
+#define ATLAS_PAGE_SIZE 2048
+#define ATLAS_MAX_PAGES 16
+// narrowest page atlas_pack tries
+#define ATLAS_MIN_PAGE_WIDTH 256
+// the deepest mip level that only ever sees a sprite's own texels, samplers of atlas pages stop there
+#define ATLAS_MAX_LOD 3
+// edge texels repeated around every sprite, so filtering down to ATLAS_MAX_LOD samples the sprite's own border
+// instead of a neighbour
+#define ATLAS_EXTRUDE (1 << ATLAS_MAX_LOD)
+// sprites and their padding start and end on this grid, no texel of ATLAS_MAX_LOD and no compressed block of the
+// top level mixes two of them
+#define ATLAS_ALIGN ATLAS_EXTRUDE
+#define ATLAS_PAGE_NAME_FORMAT "atlas_%u.bmp"
+
+// the top of the packed area across the page, x sorted with no gaps
+typedef struct {
+    uint32_t x;
+    uint32_t y;
+    uint32_t width;
+} atlas_skyline_node_t;
+
+typedef struct {
+    uint32_t width;
+    uint32_t height;
+    atlas_skyline_node_t nodes[ATLAS_PAGE_SIZE / ATLAS_ALIGN + 1];
+    uint32_t num_nodes;
+    // bounding box of everything placed
+    uint32_t used_width;
+    uint32_t used_height;
+} atlas_skyline_t;
+
+// where atlas_pack put a sprite: its own texels start at (x, y) on `page`, the extruded border is around them
+typedef struct {
+    uint32_t page;
+    uint32_t x;
+    uint32_t y;
+} atlas_placement_t;
+
+typedef struct {
+    uint32_t sprites;
+    uint32_t pages;
+    // sprite texels without and with their padding against the texels of the cropped pages
+    uint64_t sprite_texels;
+    uint64_t padded_texels;
+    uint64_t page_texels;
+    uint64_t pack_ns;
+} atlas_stats_t;
+
+// texels a sprite `size` texels wide takes up on its page: the sprite, ATLAS_EXTRUDE on both sides, rounded up to
+// ATLAS_ALIGN. the placement is ATLAS_EXTRUDE into it
+uint32_t atlas_padded_size(uint32_t size);
+
+void atlas_skyline_init(atlas_skyline_t *skyline, uint32_t width, uint32_t height);
+// bottom left: the lowest spot the rectangle fits, leftmost among equals. false if it fits nowhere
+bool atlas_skyline_insert(atlas_skyline_t *skyline, uint32_t width, uint32_t height, uint32_t *x, uint32_t *y);
+
+// places `num_sprites` sprites of widths[i] x heights[i] texels, tallest first, on as few pages as the skyline
+// manages and then on as few texels. page_sizes gets the cropped size of every page. fails if a sprite is larger
+// than a page or more than ATLAS_MAX_PAGES are needed
+bool atlas_pack(const uint32_t *widths, const uint32_t *heights, uint32_t num_sprites,
+                atlas_placement_t *placements, uint32_t *num_pages, uint32_t (*page_sizes)[2], atlas_stats_t *stats);
+
+// the offline side: packs the bmp files in `inputs` and writes the pages as `out_dir`/ATLAS_PAGE_NAME_FORMAT,
+// their paths one per line to `list_path` and the sprite table to `header_path`: one ATLAS_PAGE(name) line per
+// page, then one ATLAS_SPRITE(NAME, page, u, v, w, h) line per sprite named after its file. fails without inputs,
+// the game needs at least one page. `stats` may be NULL
+bool atlas_build(const char *out_dir, const char *list_path, const char *header_path, const char *const *inputs,
+                 uint32_t num_inputs, atlas_stats_t *stats);
+
+#endif //KINGDOM_DEFENSE_ATLAS_H
@@ -0,0 +1,29 @@
+#include <stdio.h>
+
+#include "atlas.h"
+
+// usage: kingdom_defense_atlas <out_dir> <pages.txt> <atlas.gen.h> <sprite.bmp>...
+int main(int argc, char **argv) {
+    if (argc < 4) {
+        fprintf(stderr, "usage: %s <out_dir> <pages.txt> <atlas.gen.h> <sprite.bmp>...\n", argv[0]);
+        return 1;
+    }
+    if (!SDL_Init(0)) {
+        fprintf(stderr, "SDL_Init: %s\n", SDL_GetError());
+        return 1;
+    }
+    int result = 0;
+    atlas_stats_t stats;
+    if (!atlas_build(argv[1], argv[2], argv[3], (const char *const *) argv + 4, (uint32_t) (argc - 4), &stats)) {
+        fprintf(stderr, "failed to build the atlas: %s\n", SDL_GetError());
+        result = 1;
+    } else if (stats.pages > 0) {
+        // how much of the pages is sprite, and how much of them the skyline filled once padding is counted in
+        double page_texels = (double) stats.page_texels;
+        printf("%s: %u sprites on %u pages, packing ratio %.1f%% (%.1f%% with padding), packed in %.2f ms\n",
+               argv[3], stats.sprites, stats.pages, 100.0 * (double) stats.sprite_texels / page_texels,
+               100.0 * (double) stats.padded_texels / page_texels, (double) stats.pack_ns / SDL_NS_PER_MS);
+    }
+    SDL_Quit();
+    return result;
+}
@@ -0,0 +1,76 @@
+#include <stdarg.h>
+#include <stdio.h>
+
+#include "bench.h"
+
+static const bench_suite_t suites[] = {
+        {"pixel_convert", bench_pixel_convert},
+        {"entity", bench_entity},
+        {"sim_kernels", bench_sim_kernels},
+        {"flow_field", bench_flow_field},
+        {"spatial_hash", bench_spatial_hash},
+        {"quadtree", bench_quadtree},
+        {"job_system", bench_job_system},
+        {"sprite_batch", bench_sprite_batch},
+        {"asset_pack", bench_asset_pack},
+        {"atlas", bench_atlas},
+        {"texture_compress", bench_texture_compress},
+        // needs a gpu (or lavapipe) and the compiled shaders
+        {"render", bench_render, true},
+};
+
+uint64_t bench_now_ns(void) {
+    return SDL_GetTicksNS();
+}
+
+double bench_elapsed_s(uint64_t start_ns) {
+    return (double) (SDL_GetTicksNS() - start_ns) / (double) SDL_NS_PER_SECOND;
+}
+
+void bench_report(const char *suite, const char *name, const char *fmt, ...) {
+    printf("%s %s ", suite, name);
+    va_list args;
+    va_start(args, fmt);
+    vprintf(fmt, args);
+    va_end(args);
+    printf("\n");
+    fflush(stdout);
+}
+
+uint32_t bench_rand(uint32_t *state) {
+    // xorshift32
+    uint32_t x = *state;
+    x ^= x << 13;
+    x ^= x >> 17;
+    x ^= x << 5;
+    *state = x;
+    return x;
+}
+
+// usage: kingdom_defense_bench [suite] [suite args...], no suite runs all but the on demand ones with defaults
+int main(int argc, char **argv) {
+    if (!SDL_Init(0)) {
+        fprintf(stderr, "SDL_Init: %s\n", SDL_GetError());
+        return 1;
+    }
+
+    int result = 0;
+    bool found = false;
+    for (size_t i = 0; i < SDL_arraysize(suites); i++) {
+        if (argc > 1 ? SDL_strcmp(argv[1], suites[i].name) != 0 : suites[i].on_demand) {
+            continue;
+        }
+        found = true;
+        int suite_result = argc > 1 ? suites[i].run(argc - 1, argv + 1) : suites[i].run(0, NULL);
+        if (suite_result != 0) {
+            result = suite_result;
+        }
+    }
+    if (!found) {
+        fprintf(stderr, "unknown suite: %s\n", argv[1]);
+        result = 1;
+    }
+
+    SDL_Quit();
+    return result;
+}
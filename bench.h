@@ -0,0 +1,36 @@
+#ifndef KINGDOM_DEFENSE_BENCH_H
+#define KINGDOM_DEFENSE_BENCH_H
+
+#include <SDL3/SDL.h>
+
+// every suite prints one line per measurement: `<suite> <case> key=value ...`, easy to grep and diff between runs
+
+typedef int (*bench_fun_t)(int argc, char **argv);
+
+typedef struct {
+    const char *name;
+    bench_fun_t run;
+    // left out of the run-everything default, only runs when named
+    bool on_demand;
+} bench_suite_t;
+
+uint64_t bench_now_ns(void);
+double bench_elapsed_s(uint64_t start_ns);
+void bench_report(const char *suite, const char *name, const char *fmt, ...);
+// cheap deterministic filler so runs are comparable
+uint32_t bench_rand(uint32_t *state);
+
+int bench_asset_pack(int argc, char **argv);
+int bench_atlas(int argc, char **argv);
+int bench_entity(int argc, char **argv);
+int bench_flow_field(int argc, char **argv);
+int bench_job_system(int argc, char **argv);
+int bench_pixel_convert(int argc, char **argv);
+int bench_quadtree(int argc, char **argv);
+int bench_render(int argc, char **argv);
+int bench_sim_kernels(int argc, char **argv);
+int bench_spatial_hash(int argc, char **argv);
+int bench_sprite_batch(int argc, char **argv);
+int bench_texture_compress(int argc, char **argv);
+
+#endif //KINGDOM_DEFENSE_BENCH_H
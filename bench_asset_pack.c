@@ -0,0 +1,220 @@
+#include <stdio.h>
+
+#include "asset_pack.h"
+#include "bench.h"
+#include "pixel_convert.h"
+
+#define SUITE "asset_pack"
+#define TEXTURES 32
+#define TEXTURE_SIZE 512
+#define BENCH_RUNS 5
+
+// restarts the peak resident set (VmHWM) from the current one, linux only
+static void reset_peak_rss(void) {
+#ifdef SDL_PLATFORM_LINUX
+    FILE *file = fopen("/proc/self/clear_refs", "w");
+    if (file) {
+        fputs("5", file);
+        fclose(file);
+    }
+#endif
+}
+
+// a kib value out of /proc/self/status, -1 where the os doesn't tell
+static long read_status_kib(const char *key) {
+#ifdef SDL_PLATFORM_LINUX
+    FILE *file = fopen("/proc/self/status", "r");
+    if (file == NULL) {
+        return -1;
+    }
+    char line[256];
+    long value = -1;
+    size_t key_length = SDL_strlen(key);
+    while (fgets(line, sizeof(line), file)) {
+        if (SDL_strncmp(line, key, key_length) == 0) {
+            value = SDL_atoi(line + key_length + 1);
+            break;
+        }
+    }
+    fclose(file);
+    return value;
+#else
+    (void) key;
+    return -1;
+#endif
+}
+
+static bool write_textures(char paths[TEXTURES][64]) {
+    uint32_t seed = 99;
+    for (uint32_t i = 0; i < TEXTURES; i++) {
+        SDL_Surface *surface = SDL_CreateSurface(TEXTURE_SIZE, TEXTURE_SIZE, SDL_PIXELFORMAT_BGR24);
+        if (surface == NULL) {
+            return false;
+        }
+        uint8_t *pixels = surface->pixels;
+        for (size_t b = 0; b < (size_t) surface->pitch * surface->h; b++) {
+            pixels[b] = (uint8_t) bench_rand(&seed);
+        }
+        SDL_snprintf(paths[i], 64, "bench_asset_%02u.bmp", i);
+        bool ok = SDL_SaveBMP(surface, paths[i]);
+        SDL_DestroySurface(surface);
+        if (!ok) {
+            return false;
+        }
+    }
+    return true;
+}
+
+// what startup did before the pack: decode, convert, copy into staging
+static bool load_bmp(char paths[TEXTURES][64], uint8_t *staging) {
+    for (uint32_t i = 0; i < TEXTURES; i++) {
+        SDL_Surface *surface = SDL_LoadBMP(paths[i]);
+        if (surface == NULL) {
+            return false;
+        }
+        converted_pixels_t converted;
+        if (!pixel_convert_surface(NULL, surface, &converted)) {
+            SDL_DestroySurface(surface);
+            return false;
+        }
+        SDL_memcpy(staging, converted.pixels, converted.size_bytes);
+        pixel_convert_free(&converted);
+        SDL_DestroySurface(surface);
+    }
+    return true;
+}
+
+static bool load_pack(const char *pack_path, char paths[TEXTURES][64], uint8_t *staging) {
+    asset_pack_t pack;
+    if (!asset_pack_open(&pack, pack_path)) {
+        return false;
+    }
+    for (uint32_t i = 0; i < TEXTURES; i++) {
+        const asset_pack_entry_t *entry = asset_pack_find(&pack, paths[i]);
+        if (entry == NULL) {
+            asset_pack_close(&pack);
+            return SDL_SetError("%s missing from the pack", paths[i]);
+        }
+        // the top level only, the same bytes the bmp path produces
+        asset_pack_level_t level;
+        asset_pack_level(entry, 0, &level);
+        SDL_memcpy(staging, asset_pack_texels(&pack, entry), level.size);
+        asset_pack_release(&pack, entry);
+    }
+    asset_pack_close(&pack);
+    return true;
+}
+
+// the pack has to hold exactly what the bmp path uploads
+static bool verify(const char *pack_path, char paths[TEXTURES][64]) {
+    asset_pack_t pack;
+    if (!asset_pack_open(&pack, pack_path)) {
+        return false;
+    }
+    bool ok = true;
+    for (uint32_t i = 0; ok && i < TEXTURES; i++) {
+        const asset_pack_entry_t *entry = asset_pack_find(&pack, paths[i]);
+        SDL_Surface *surface = SDL_LoadBMP(paths[i]);
+        converted_pixels_t converted;
+        if (entry == NULL || surface == NULL || !pixel_convert_surface(NULL, surface, &converted)) {
+            ok = false;
+        } else {
+            asset_pack_level_t level;
+            asset_pack_level(entry, 0, &level);
+            ok = entry->format == (uint32_t) converted.format && level.size == converted.size_bytes &&
+                 SDL_memcmp(asset_pack_texels(&pack, entry), converted.pixels, converted.size_bytes) == 0;
+            pixel_convert_free(&converted);
+        }
+        if (surface) {
+            SDL_DestroySurface(surface);
+        }
+    }
+    asset_pack_close(&pack);
+    return ok;
+}
+
+static void report(const char *name, double seconds, long peak_kib) {
+    double bytes = (double) TEXTURES * TEXTURE_SIZE * TEXTURE_SIZE * 4;
+    bench_report(SUITE, name, "textures=%u ms=%.2f mib_per_s=%.0f peak_rss_growth_kib=%ld", TEXTURES, seconds * 1e3,
+                 bytes / seconds / (1024.0 * 1024.0), peak_kib);
+}
+
+// startup texture load of TEXTURES textures, bmp decode against the mapped pack. the files were just written so
+// this is the warm page cache case, the cold one needs the caches dropped between runs
+int bench_asset_pack(int argc, char **argv) {
+    (void) argc;
+    (void) argv;
+    static char paths[TEXTURES][64];
+    const char *pack_path = "bench_assets.pack";
+    const char *inputs[TEXTURES];
+    for (uint32_t i = 0; i < TEXTURES; i++) {
+        inputs[i] = paths[i];
+    }
+
+    int result = 0;
+    size_t staging_size = (size_t) TEXTURE_SIZE * TEXTURE_SIZE * 4;
+    uint8_t *staging = SDL_malloc(staging_size);
+    if (staging == NULL || !write_textures(paths) || !asset_pack_build(pack_path, inputs, TEXTURES, ASSET_PACK_COMPRESSION_NONE, NULL)) {
+        SDL_Log("%s: %s", SUITE, SDL_GetError());
+        result = 1;
+        goto cleanup;
+    }
+    SDL_memset(staging, 0, staging_size);
+    if (!verify(pack_path, paths)) {
+        SDL_Log("%s: pack texels differ from the decoded bmp files", SUITE);
+        result = 1;
+        goto cleanup;
+    }
+
+    // peak rss of the first run of each path, before the allocator holds on to memory from earlier runs
+    reset_peak_rss();
+    long base_kib = read_status_kib("VmRSS:");
+    uint64_t start = bench_now_ns();
+    if (!load_bmp(paths, staging)) {
+        result = 1;
+        goto cleanup;
+    }
+    double best_bmp = bench_elapsed_s(start);
+    long bmp_peak_kib = read_status_kib("VmHWM:") - base_kib;
+
+    reset_peak_rss();
+    base_kib = read_status_kib("VmRSS:");
+    start = bench_now_ns();
+    if (!load_pack(pack_path, paths, staging)) {
+        result = 1;
+        goto cleanup;
+    }
+    double best_pack = bench_elapsed_s(start);
+    long pack_peak_kib = read_status_kib("VmHWM:") - base_kib;
+
+    for (uint32_t run = 1; run < BENCH_RUNS; run++) {
+        start = bench_now_ns();
+        if (!load_bmp(paths, staging)) {
+            result = 1;
+            goto cleanup;
+        }
+        best_bmp = SDL_min(best_bmp, bench_elapsed_s(start));
+
+        start = bench_now_ns();
+        if (!load_pack(pack_path, paths, staging)) {
+            result = 1;
+            goto cleanup;
+        }
+        best_pack = SDL_min(best_pack, bench_elapsed_s(start));
+    }
+
+    report("bmp", best_bmp, base_kib >= 0 ? bmp_peak_kib : -1);
+    report("pack", best_pack, base_kib >= 0 ? pack_peak_kib : -1);
+    bench_report(SUITE, "speedup", "x=%.1f", best_bmp / best_pack);
+
+    cleanup:
+    if (result) {
+        SDL_Log("%s: %s", SUITE, SDL_GetError());
+    }
+    SDL_free(staging);
+    for (uint32_t i = 0; i < TEXTURES; i++) {
+        SDL_RemovePath(paths[i]);
+    }
+    SDL_RemovePath(pack_path);
+    return result;
+}
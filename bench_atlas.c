@@ -0,0 +1,88 @@
+#include "atlas.h"
+#include "bench.h"
+
+#define SUITE "atlas"
+#define BENCH_RUNS 5
+
+// sprite sheets of a 2d game: mostly small sprites, a few large ones
+static uint32_t random_size(uint32_t *seed) {
+    uint32_t roll = bench_rand(seed) % 100;
+    if (roll < 70) {
+        return 16 + bench_rand(seed) % 49;
+    }
+    if (roll < 95) {
+        return 64 + bench_rand(seed) % 129;
+    }
+    return 192 + bench_rand(seed) % 321;
+}
+
+static int bench_sprites(uint32_t n) {
+    uint32_t *widths = SDL_malloc(n * sizeof(uint32_t));
+    uint32_t *heights = SDL_malloc(n * sizeof(uint32_t));
+    atlas_placement_t *placements = SDL_malloc(n * sizeof(atlas_placement_t));
+    if (widths == NULL || heights == NULL || placements == NULL) {
+        SDL_free(widths);
+        SDL_free(heights);
+        SDL_free(placements);
+        return 1;
+    }
+    uint32_t seed = 1234;
+    for (uint32_t i = 0; i < n; i++) {
+        widths[i] = random_size(&seed);
+        heights[i] = random_size(&seed);
+    }
+
+    bool ok = true;
+    uint32_t num_pages = 0;
+    uint32_t page_sizes[ATLAS_MAX_PAGES][2];
+    atlas_stats_t stats = {0};
+    uint64_t best_ns = UINT64_MAX;
+    for (int run = 0; ok && run < BENCH_RUNS; run++) {
+        ok = atlas_pack(widths, heights, n, placements, &num_pages, page_sizes, &stats);
+        best_ns = SDL_min(best_ns, stats.pack_ns);
+    }
+    // every padded rectangle the packer reserved lies on its cropped page, and no two of them overlap
+    for (uint32_t i = 0; ok && i < n; i++) {
+        const atlas_placement_t *a = &placements[i];
+        if (a->page >= num_pages || a->x < ATLAS_EXTRUDE || a->y < ATLAS_EXTRUDE ||
+            a->x - ATLAS_EXTRUDE + atlas_padded_size(widths[i]) > page_sizes[a->page][0] ||
+            a->y - ATLAS_EXTRUDE + atlas_padded_size(heights[i]) > page_sizes[a->page][1]) {
+            ok = SDL_SetError("sprite %u runs off page %u", i, a->page);
+        }
+        for (uint32_t j = i + 1; ok && j < n; j++) {
+            const atlas_placement_t *b = &placements[j];
+            if (a->page == b->page && a->x + atlas_padded_size(widths[i]) > b->x &&
+                b->x + atlas_padded_size(widths[j]) > a->x && a->y + atlas_padded_size(heights[i]) > b->y &&
+                b->y + atlas_padded_size(heights[j]) > a->y) {
+                ok = SDL_SetError("sprites %u and %u overlap on page %u", i, j, a->page);
+            }
+        }
+    }
+
+    char name[64];
+    SDL_snprintf(name, sizeof(name), "pack/%u", n);
+    double page_texels = (double) SDL_max(stats.page_texels, 1);
+    bench_report(SUITE, name, "pages=%u ratio=%.1f%% padded_ratio=%.1f%% pack_us=%.1f ok=%d", stats.pages,
+                 100.0 * (double) stats.sprite_texels / page_texels, 100.0 * (double) stats.padded_texels / page_texels,
+                 (double) best_ns / 1e3, ok);
+    if (!ok) {
+        SDL_Log("%s: %u sprites: %s", SUITE, n, SDL_GetError());
+    }
+    SDL_free(widths);
+    SDL_free(heights);
+    SDL_free(placements);
+    return !ok;
+}
+
+// args: [sprites]
+int bench_atlas(int argc, char **argv) {
+    if (argc > 1) {
+        return bench_sprites((uint32_t) SDL_atoi(argv[1]));
+    }
+    static const uint32_t counts[] = {16, 128, 1024};
+    int result = 0;
+    for (size_t i = 0; i < SDL_arraysize(counts); i++) {
+        result |= bench_sprites(counts[i]);
+    }
+    return result;
+}
@@ -0,0 +1,83 @@
+#include "bench.h"
+#include "entity.h"
+
+#define SUITE "entity"
+#define MIN_BENCH_SECONDS 0.25
+
+// late wave churn: `live` entities on the field, every frame `churn` spawn, everything integrates, then `churn`
+// random ones die
+static int bench_churn(uint32_t live, uint32_t churn) {
+    entity_store_t store;
+    if (!entity_store_init(&store, live + churn)) {
+        SDL_Log("entity_store_init: %s", SDL_GetError());
+        return 1;
+    }
+    uint32_t seed = 1234;
+    for (uint32_t i = 0; i < live; i++) {
+        entity_t entity = entity_spawn(&store, ENTITY_KIND_ENEMY, (float) i, 0.0f);
+        store.vel_x[entity_index(&store, entity)] = 1.0f;
+    }
+
+    uint64_t spawn_ns = 0;
+    uint64_t update_ns = 0;
+    uint64_t despawn_ns = 0;
+    size_t frames = 0;
+    entity_t stale = ENTITY_NULL;
+    uint64_t start = bench_now_ns();
+    do {
+        uint64_t t0 = bench_now_ns();
+        for (uint32_t i = 0; i < churn; i++) {
+            entity_t entity = entity_spawn(&store, ENTITY_KIND_PROJECTILE, 0.0f, (float) i);
+            store.vel_y[store.count - 1] = 1.0f;
+            (void) entity;
+        }
+        uint64_t t1 = bench_now_ns();
+        entity_store_integrate(&store, 1.0f / 60.0f);
+        uint64_t t2 = bench_now_ns();
+        for (uint32_t i = 0; i < churn; i++) {
+            entity_t entity = store.handle[bench_rand(&seed) % store.count];
+            stale = entity;
+            entity_despawn(&store, entity);
+        }
+        uint64_t t3 = bench_now_ns();
+        spawn_ns += t1 - t0;
+        update_ns += t2 - t1;
+        despawn_ns += t3 - t2;
+        frames++;
+    } while (bench_elapsed_s(start) < MIN_BENCH_SECONDS);
+
+    int result = 0;
+    if (store.count != live || (stale != ENTITY_NULL && entity_alive(&store, stale))) {
+        SDL_Log("%s: store is inconsistent after churn", SUITE);
+        result = 1;
+    }
+
+    char name[64];
+    SDL_snprintf(name, sizeof(name), "churn/%u", live);
+    double ops = (double) churn * frames;
+    double updated = (double) (live + churn) * frames;
+    bench_report(SUITE, name, "churn=%u spawn_ns=%.1f despawn_ns=%.1f update_ns_per_entity=%.3f mentities_per_s=%.1f "
+                              "us_per_frame=%.1f",
+                 churn, (double) spawn_ns / ops, (double) despawn_ns / ops, (double) update_ns / updated,
+                 updated / ((double) update_ns / 1e9) / 1e6,
+                 (double) (spawn_ns + update_ns + despawn_ns) / 1e3 / frames);
+    entity_store_destroy(&store);
+    return result;
+}
+
+// args: [live] [churn per frame]
+int bench_entity(int argc, char **argv) {
+    if (argc > 1) {
+        uint32_t live = (uint32_t) SDL_atoi(argv[1]);
+        uint32_t churn = argc > 2 ? (uint32_t) SDL_atoi(argv[2]) : live / 100;
+        return bench_churn(live, churn);
+    }
+    static const uint32_t counts[] = {1000, 10000, 100000, 500000};
+    int result = 0;
+    for (size_t i = 0; i < SDL_arraysize(counts); i++) {
+        // a few thousand deaths per second at 60 fps is ~1% of a big wave per frame
+        result |= bench_churn(counts[i], SDL_max(counts[i] / 100, 16));
+        result |= bench_churn(counts[i], counts[i] / 10);
+    }
+    return result;
+}
@@ -0,0 +1,137 @@
+#include "bench.h"
+#include "flow_field.h"
+
+#define SUITE "flow_field"
+#define MIN_BENCH_SECONDS 0.25
+#define VERIFY_OPS 2000
+
+static bool setup_field(flow_field_t *field, uint32_t size) {
+    if (!flow_field_init(field, size, size, size - 1, size / 2)) {
+        return false;
+    }
+    for (uint32_t y = 0; y < size; y += 8) {
+        flow_field_add_spawn(field, 0, y);
+    }
+    return true;
+}
+
+// place a tower on a random free cell or remove the one that is there, like a player rearranging defenses
+static void random_edit(flow_field_t *field, uint32_t size, uint32_t *seed) {
+    uint32_t x = bench_rand(seed) % size;
+    uint32_t y = bench_rand(seed) % size;
+    if (field->blocked[flow_field_cell(field, x, y)]) {
+        flow_field_remove_tower(field, x, y);
+    } else {
+        flow_field_place_tower(field, x, y);
+    }
+}
+
+// scatters towers until `density` of the map is blocked, every placement validated
+static void populate(flow_field_t *field, uint32_t size, float density, uint32_t *seed) {
+    uint32_t target = (uint32_t) ((float) (size * size) * density);
+    uint32_t blocked = 0;
+    for (uint32_t attempts = 0; blocked < target && attempts < target * 4; attempts++) {
+        if (flow_field_place_tower(field, bench_rand(seed) % size, bench_rand(seed) % size)) {
+            blocked++;
+        }
+    }
+}
+
+static void bench_rebuild(uint32_t size, float density) {
+    flow_field_t field;
+    if (!setup_field(&field, size)) {
+        SDL_Log("flow_field_init: %s", SDL_GetError());
+        return;
+    }
+    uint32_t seed = 1234;
+    populate(&field, size, density, &seed);
+
+    size_t rebuilds = 0;
+    uint64_t start = bench_now_ns();
+    do {
+        flow_field_rebuild(&field);
+        rebuilds++;
+    } while (bench_elapsed_s(start) < MIN_BENCH_SECONDS);
+    double seconds = bench_elapsed_s(start);
+
+    char name[64];
+    SDL_snprintf(name, sizeof(name), "rebuild/%ux%u", size, size);
+    bench_report(SUITE, name, "density=%.2f us_per_rebuild=%.1f ns_per_cell=%.2f", density, seconds * 1e6 / rebuilds,
+                 seconds * 1e9 / ((double) rebuilds * size * size));
+    flow_field_destroy(&field);
+}
+
+static void bench_update(uint32_t size, float density) {
+    flow_field_t field;
+    if (!setup_field(&field, size)) {
+        SDL_Log("flow_field_init: %s", SDL_GetError());
+        return;
+    }
+    uint32_t seed = 1234;
+    populate(&field, size, density, &seed);
+
+    size_t ops = 0;
+    uint64_t cells = 0;
+    uint64_t start = bench_now_ns();
+    do {
+        random_edit(&field, size, &seed);
+        cells += field.stats.last_cells;
+        ops++;
+    } while (bench_elapsed_s(start) < MIN_BENCH_SECONDS);
+    double seconds = bench_elapsed_s(start);
+
+    char name[64];
+    SDL_snprintf(name, sizeof(name), "update/%ux%u", size, size);
+    bench_report(SUITE, name, "density=%.2f us_per_edit=%.2f cells_per_edit=%.1f", density, seconds * 1e6 / ops,
+                 (double) cells / ops);
+    flow_field_destroy(&field);
+}
+
+// after every incremental edit the field has to match one rebuilt from scratch
+static int verify(uint32_t size, float density) {
+    flow_field_t field;
+    flow_field_t reference;
+    if (!setup_field(&field, size) || !setup_field(&reference, size)) {
+        SDL_Log("flow_field_init: %s", SDL_GetError());
+        return 1;
+    }
+    uint32_t seed = 4321;
+    populate(&field, size, density, &seed);
+    int result = 0;
+    uint32_t cells = field.cells;
+    for (uint32_t op = 0; op < VERIFY_OPS && result == 0; op++) {
+        random_edit(&field, size, &seed);
+        SDL_memcpy(reference.blocked, field.blocked, cells);
+        flow_field_rebuild(&reference);
+        if (SDL_memcmp(reference.cost, field.cost, cells * sizeof(uint16_t)) != 0 ||
+            SDL_memcmp(reference.direction, field.direction, cells) != 0) {
+            SDL_Log("%s: incremental field diverged from a rebuild after %u edits", SUITE, op + 1);
+            result = 1;
+        }
+    }
+    char name[64];
+    SDL_snprintf(name, sizeof(name), "verify/%ux%u", size, size);
+    bench_report(SUITE, name, "density=%.2f edits=%u ok=%d", density, VERIFY_OPS, result == 0);
+    flow_field_destroy(&reference);
+    flow_field_destroy(&field);
+    return result;
+}
+
+// args: [size] [density]
+int bench_flow_field(int argc, char **argv) {
+    uint32_t size = argc > 1 ? (uint32_t) SDL_atoi(argv[1]) : 256;
+    float density = argc > 2 ? (float) SDL_atof(argv[2]) : 0.0f;
+    if (argc > 1) {
+        bench_rebuild(size, density);
+        bench_update(size, density);
+        return verify(size, density);
+    }
+    static const float densities[] = {0.0f, 0.1f, 0.3f};
+    int result = 0;
+    for (size_t i = 0; i < SDL_arraysize(densities); i++) {
+        bench_rebuild(size, densities[i]);
+        bench_update(size, densities[i]);
+        result |= verify(64, densities[i]);
+    }
+    return result;
+}
@@ -0,0 +1,164 @@
+#include "bench.h"
+#include "game_state.h"
+#include "job_system.h"
+
+#define SUITE "job_system"
+#define MIN_BENCH_SECONDS 0.25
+#define EMPTY_JOBS 10000
+#define SIM_ENEMIES 40000
+#define SIM_TICKS 120
+
+static void empty_job(void *data, uint32_t begin, uint32_t end) {
+    (void) data;
+    (void) begin;
+    (void) end;
+}
+
+static void scale_job(void *data, uint32_t begin, uint32_t end) {
+    float *values = data;
+    for (uint32_t i = begin; i < end; i++) {
+        values[i] = values[i] * 0.5f + 1.0f;
+    }
+}
+
+// what the pool itself costs: single jobs through push and wait, and a parallel for too cheap to be worth it
+static void bench_overhead(uint32_t workers) {
+    job_system_t jobs;
+    if (!job_system_init(&jobs, workers)) {
+        SDL_Log("%s: %s", SUITE, SDL_GetError());
+        return;
+    }
+    char name[64];
+
+    size_t runs = 0;
+    uint64_t start = bench_now_ns();
+    do {
+        job_counter_t counter;
+        SDL_SetAtomicInt(&counter.pending, 0);
+        for (uint32_t i = 0; i < EMPTY_JOBS; i++) {
+            job_system_push(&jobs, empty_job, NULL, 0, 0, &counter);
+        }
+        job_system_wait(&jobs, &counter);
+        runs++;
+    } while (bench_elapsed_s(start) < MIN_BENCH_SECONDS);
+    SDL_snprintf(name, sizeof(name), "empty_jobs/%ut", jobs.num_threads);
+    bench_report(SUITE, name, "ns_per_job=%.1f", bench_elapsed_s(start) * 1e9 / ((double) runs * EMPTY_JOBS));
+
+    uint32_t count = 1024 * 1024;
+    float *values = SDL_calloc(count, sizeof(float));
+    runs = 0;
+    start = bench_now_ns();
+    do {
+        job_system_parallel_for(&jobs, count, 4096, scale_job, values);
+        runs++;
+    } while (bench_elapsed_s(start) < MIN_BENCH_SECONDS);
+    SDL_snprintf(name, sizeof(name), "parallel_for/%ut", jobs.num_threads);
+    bench_report(SUITE, name, "items=%u us_per_call=%.1f", count, bench_elapsed_s(start) * 1e6 / runs);
+
+    job_thread_stats_t stats;
+    job_system_stats(&jobs, &stats);
+    SDL_snprintf(name, sizeof(name), "stats/%ut", jobs.num_threads);
+    bench_report(SUITE, name, "executed=%" SDL_PRIu64 " stolen=%" SDL_PRIu64 " sleeps=%" SDL_PRIu64, stats.executed,
+                 stats.stolen, stats.sleeps);
+    SDL_free(values);
+    job_system_destroy(&jobs);
+}
+
+// a late wave: a wall of towers across the middle of the map and SIM_ENEMIES enemies scattered over it
+static bool populate(game_state_t *state) {
+    for (uint32_t x = 10; x < GAME_STATE_MAP_SIZE - 6; x += 3) {
+        for (uint32_t y = 0; y < GAME_STATE_MAP_SIZE; y += 2) {
+            float wx = ((float) x + 0.5f) * (2.0f / GAME_STATE_MAP_SIZE) - 1.0f;
+            float wy = ((float) y + 0.5f) * (2.0f / GAME_STATE_MAP_SIZE) - 1.0f;
+            // a tower that would cut the path is refused, that's fine
+            game_state_place_tower(state, wx, wy);
+        }
+    }
+    uint32_t seed = 4321;
+    for (uint32_t i = 0; i < SIM_ENEMIES; i++) {
+        float x = (float) (bench_rand(&seed) >> 8) * (1.6f / 16777216.0f) - 1.0f;
+        float y = (float) (bench_rand(&seed) >> 8) * (2.0f / 16777216.0f) - 1.0f;
+        entity_t enemy = entity_spawn(&state->entities, ENTITY_KIND_ENEMY, x, y);
+        uint32_t index = entity_index(&state->entities, enemy);
+        if (index == ENTITY_INVALID_INDEX) {
+            return false;
+        }
+        state->entities.health[index] = 1000.0f;
+    }
+    return true;
+}
+
+// ticks per second of the late wave on `threads` threads, 0 on failure
+static double bench_sim(uint32_t threads, uint64_t *checksum) {
+    job_system_t jobs;
+    game_state_t *state = SDL_malloc(sizeof(game_state_t));
+    if (state == NULL || !job_system_init(&jobs, threads - 1)) {
+        SDL_free(state);
+        return 0.0;
+    }
+    if (!game_state_init(state, 1, &jobs) || !populate(state)) {
+        SDL_Log("%s: %s", SUITE, SDL_GetError());
+        game_state_destroy(state);
+        SDL_free(state);
+        job_system_destroy(&jobs);
+        return 0.0;
+    }
+    uint32_t entities = state->entities.count;
+
+    uint64_t start = bench_now_ns();
+    for (uint32_t i = 0; i < SIM_TICKS; i++) {
+        sim_step(state, SIM_DT);
+    }
+    double seconds = bench_elapsed_s(start);
+    *checksum = game_state_checksum(state);
+
+    job_thread_stats_t stats;
+    job_system_stats(&jobs, &stats);
+    char name[64];
+    SDL_snprintf(name, sizeof(name), "sim/%ut", threads);
+    bench_report(SUITE, name, "entities=%u ticks_per_s=%.1f ms_per_tick=%.3f stolen=%" SDL_PRIu64, entities,
+                 SIM_TICKS / seconds, seconds * 1e3 / SIM_TICKS, stats.stolen);
+    game_state_destroy(state);
+    SDL_free(state);
+    job_system_destroy(&jobs);
+    return SIM_TICKS / seconds;
+}
+
+// args: [max threads], defaults to the logical core count
+int bench_job_system(int argc, char **argv) {
+    uint32_t cores = (uint32_t) SDL_max(SDL_GetNumLogicalCPUCores(), 1);
+    uint32_t max_threads = argc > 1 ? (uint32_t) SDL_atoi(argv[1]) : cores;
+    max_threads = SDL_clamp(max_threads, 1, JOB_SYSTEM_MAX_THREADS);
+
+    bench_overhead(0);
+    bench_overhead(max_threads - 1);
+
+    // tick rate per thread count, powers of two plus the maximum. the checksum has to match the single threaded
+    // run, the simulation may not depend on how the work was split
+    uint64_t reference = 0;
+    double base = 0.0;
+    int result = 0;
+    for (uint32_t threads = 1;; threads = SDL_min(threads * 2, max_threads)) {
+        uint64_t checksum = 0;
+        double rate = bench_sim(threads, &checksum);
+        if (rate == 0.0) {
+            return 1;
+        }
+        if (threads == 1) {
+            reference = checksum;
+            base = rate;
+        }
+        char name[64];
+        SDL_snprintf(name, sizeof(name), "scaling/%ut", threads);
+        bench_report(SUITE, name, "speedup=%.2f efficiency=%.2f deterministic=%d", rate / base,
+                     rate / base / threads, checksum == reference);
+        if (checksum != reference) {
+            SDL_Log("%s: checksum on %u threads differs from the single threaded run", SUITE, threads);
+            result = 1;
+        }
+        if (threads == max_threads) {
+            break;
+        }
+    }
+    return result;
+}
@@ -0,0 +1,140 @@
+#include <stdio.h>
+
+#include "bench.h"
+#include "pixel_convert.h"
+
+#define SUITE "pixel_convert"
+#define MIN_BENCH_SECONDS 0.25
+
+// the loop upload_texture_to_gpu used before the conversion engine, kept as the baseline
+static void legacy_convert_bgr24_to_rgba8(void *input, size_t input_size, void *out, size_t *out_size) {
+    uint8_t *input_as_bytes = (uint8_t *) input;
+    uint8_t *out_as_bytes = (uint8_t *) out;
+    size_t pixels = input_size;
+    for (size_t i = 0; i < pixels; i++) {
+        size_t input_px = i * 3;
+        size_t out_px = i * 4;
+
+        uint8_t b = input_as_bytes[input_px + 0];
+        uint8_t g = input_as_bytes[input_px + 1];
+        uint8_t r = input_as_bytes[input_px + 2];
+
+        out_as_bytes[out_px + 0] = r;
+        out_as_bytes[out_px + 1] = g;
+        out_as_bytes[out_px + 2] = b;
+        out_as_bytes[out_px + 3] = UINT8_MAX;
+
+        *out_size += 4;
+    }
+}
+
+static SDL_Surface *make_surface(SDL_PixelFormat format, int w, int h) {
+    SDL_Surface *surface = SDL_CreateSurface(w, h, format);
+    if (surface == NULL) {
+        return NULL;
+    }
+    uint32_t seed = 0x9E3779B9u;
+    uint8_t *pixels = surface->pixels;
+    for (size_t i = 0; i < (size_t) surface->pitch * h; i++) {
+        pixels[i] = (uint8_t) bench_rand(&seed);
+    }
+    if (SDL_ISPIXELFORMAT_INDEXED(format)) {
+        SDL_Palette *palette = SDL_CreateSurfacePalette(surface);
+        for (int i = 0; palette && i < palette->ncolors; i++) {
+            palette->colors[i] = (SDL_Color) {(uint8_t) i, (uint8_t) (255 - i), (uint8_t) (i * 7), 255};
+        }
+    }
+    return surface;
+}
+
+static void bench_legacy(int w, int h) {
+    SDL_Surface *surface = make_surface(SDL_PIXELFORMAT_BGR24, w, h);
+    // old code only worked on unpadded rows and allocated 1 GiB per call, only the loop is timed here
+    uint8_t *out = SDL_malloc((size_t) w * h * 4);
+    uint8_t *tight = SDL_malloc((size_t) w * h * 3);
+    for (int y = 0; y < h; y++) {
+        SDL_memcpy(tight + (size_t) y * w * 3, (uint8_t *) surface->pixels + (size_t) y * surface->pitch,
+                   (size_t) w * 3);
+    }
+
+    size_t iterations = 0;
+    uint64_t start = bench_now_ns();
+    do {
+        size_t out_size = 0;
+        legacy_convert_bgr24_to_rgba8(tight, (size_t) w * h, out, &out_size);
+        iterations++;
+    } while (bench_elapsed_s(start) < MIN_BENCH_SECONDS);
+    double seconds = bench_elapsed_s(start);
+
+    double mpix = (double) w * h * iterations / 1e6;
+    bench_report(SUITE, "bgr24/legacy", "w=%d h=%d mpix_per_s=%.1f ns_per_px=%.3f", w, h, mpix / seconds,
+                 seconds * 1e3 / mpix);
+    SDL_free(tight);
+    SDL_free(out);
+    SDL_DestroySurface(surface);
+}
+
+// returns false if the kernel output does not match the scalar reference
+static bool bench_format(SDL_PixelFormat format, const char *format_name, int w, int h) {
+    SDL_Surface *surface = make_surface(format, w, h);
+    if (surface == NULL) {
+        fprintf(stderr, "failed to create %s surface: %s\n", format_name, SDL_GetError());
+        return false;
+    }
+
+    bool ok = true;
+    converted_pixels_t reference = {0};
+    pixel_convert_set_isa(PIXEL_CONVERT_ISA_SCALAR);
+    pixel_convert_surface(NULL, surface, &reference);
+
+    for (int isa = 0; isa < PIXEL_CONVERT_ISA_COUNT; isa++) {
+        if (!pixel_convert_set_isa((pixel_convert_isa_t) isa)) {
+            continue;
+        }
+
+        size_t iterations = 0;
+        uint64_t start = bench_now_ns();
+        do {
+            converted_pixels_t converted;
+            pixel_convert_surface(NULL, surface, &converted);
+            if (iterations == 0 && SDL_memcmp(converted.pixels, reference.pixels, reference.size_bytes) != 0) {
+                fprintf(stderr, "%s/%s does not match scalar output\n", format_name,
+                        pixel_convert_isa_name((pixel_convert_isa_t) isa));
+                ok = false;
+            }
+            pixel_convert_free(&converted);
+            iterations++;
+        } while (bench_elapsed_s(start) < MIN_BENCH_SECONDS);
+        double seconds = bench_elapsed_s(start);
+
+        char name[64];
+        SDL_snprintf(name, sizeof(name), "%s/%s", format_name, pixel_convert_isa_name((pixel_convert_isa_t) isa));
+        double mpix = (double) w * h * iterations / 1e6;
+        bench_report(SUITE, name, "w=%d h=%d mpix_per_s=%.1f ns_per_px=%.3f", w, h, mpix / seconds,
+                     seconds * 1e3 / mpix);
+    }
+
+    pixel_convert_free(&reference);
+    SDL_DestroySurface(surface);
+    return ok;
+}
+
+// args: [width] [height]
+int bench_pixel_convert(int argc, char **argv) {
+    int w = argc > 1 ? SDL_atoi(argv[1]) : 1024;
+    int h = argc > 2 ? SDL_atoi(argv[2]) : 1024;
+    pixel_convert_init();
+    pixel_convert_isa_t best = pixel_convert_get_isa();
+
+    bool ok = true;
+    bench_legacy(w, h);
+    ok &= bench_format(SDL_PIXELFORMAT_BGR24, "bgr24", w, h);
+    ok &= bench_format(SDL_PIXELFORMAT_RGB24, "rgb24", w, h);
+    ok &= bench_format(SDL_PIXELFORMAT_BGRA32, "bgra32", w, h);
+    ok &= bench_format(SDL_PIXELFORMAT_XRGB32, "xrgb32", w, h);
+    ok &= bench_format(SDL_PIXELFORMAT_INDEX8, "index8", w, h);
+    ok &= bench_format(SDL_PIXELFORMAT_RGB565, "rgb565", w, h);
+
+    pixel_convert_set_isa(best);
+    return ok ? 0 : 1;
+}
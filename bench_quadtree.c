@@ -0,0 +1,136 @@
+#include "bench.h"
+#include "quadtree.h"
+
+#define SUITE "quadtree"
+#define MIN_BENCH_SECONDS 0.25
+#define VIEWS 64
+// a map four screens wide and high, the view is one 4:3 screen of it
+#define WORLD_SIZE 8.0f
+#define VIEW_HALF_HEIGHT 1.0f
+#define VIEW_ASPECT (4.0f / 3.0f)
+#define ITEM_HALF_SIZE 0.025f
+#define TREE_DEPTH 7
+
+static float random_unit(uint32_t *seed) {
+    return (float) (bench_rand(seed) >> 8) * (1.0f / 16777216.0f);
+}
+
+static uint32_t brute_query(const float (*bounds)[4], uint32_t n, const float view[4]) {
+    uint32_t found = 0;
+    for (uint32_t i = 0; i < n; i++) {
+        found += bounds[i][0] <= view[2] && bounds[i][2] >= view[0] && bounds[i][1] <= view[3] &&
+                 bounds[i][3] >= view[1];
+    }
+    return found;
+}
+
+// false with the error set if the setup failed or the tree disagrees with brute force
+static bool bench_items(uint32_t n) {
+    float (*bounds)[4] = SDL_malloc(n * sizeof(float[4]));
+    uint32_t *out = SDL_malloc(n * sizeof(uint32_t));
+    quadtree_t tree;
+    if (bounds == NULL || out == NULL || !quadtree_init(&tree, 0.0f, 0.0f, WORLD_SIZE, TREE_DEPTH, n)) {
+        SDL_free(out);
+        SDL_free(bounds);
+        return false;
+    }
+    float views[VIEWS][4];
+    uint32_t seed = 4321;
+    for (uint32_t i = 0; i < n; i++) {
+        float x = random_unit(&seed) * WORLD_SIZE;
+        float y = random_unit(&seed) * WORLD_SIZE;
+        bounds[i][0] = x - ITEM_HALF_SIZE;
+        bounds[i][1] = y - ITEM_HALF_SIZE;
+        bounds[i][2] = x + ITEM_HALF_SIZE;
+        bounds[i][3] = y + ITEM_HALF_SIZE;
+    }
+    for (uint32_t v = 0; v < VIEWS; v++) {
+        float x = random_unit(&seed) * WORLD_SIZE;
+        float y = random_unit(&seed) * WORLD_SIZE;
+        views[v][0] = x - VIEW_HALF_HEIGHT * VIEW_ASPECT;
+        views[v][1] = y - VIEW_HALF_HEIGHT;
+        views[v][2] = x + VIEW_HALF_HEIGHT * VIEW_ASPECT;
+        views[v][3] = y + VIEW_HALF_HEIGHT;
+    }
+
+
+    // rebuilt after every sim step in the game, so the build is part of the price
+    size_t builds = 0;
+    uint64_t start = bench_now_ns();
+    do {
+        quadtree_begin(&tree);
+        for (uint32_t i = 0; i < n; i++) {
+            quadtree_insert(&tree, i, bounds[i][0], bounds[i][1], bounds[i][2], bounds[i][3]);
+        }
+        quadtree_end(&tree);
+        builds++;
+    } while (bench_elapsed_s(start) < MIN_BENCH_SECONDS);
+    double build_s = bench_elapsed_s(start);
+
+    bool ok = true;
+    uint64_t visible = 0;
+    uint64_t nodes = 0;
+    for (uint32_t v = 0; v < VIEWS; v++) {
+        uint32_t found = quadtree_query(&tree, views[v], out);
+        ok &= found == brute_query(bounds, n, views[v]);
+        visible += found;
+        nodes += tree.stats.nodes_visited;
+    }
+
+    volatile uint32_t sink = 0;
+    size_t tree_runs = 0;
+    start = bench_now_ns();
+    do {
+        for (uint32_t v = 0; v < VIEWS; v++) {
+            sink += quadtree_query(&tree, views[v], out);
+        }
+        tree_runs++;
+    } while (bench_elapsed_s(start) < MIN_BENCH_SECONDS);
+    double tree_s = bench_elapsed_s(start);
+    size_t brute_runs = 0;
+    start = bench_now_ns();
+    do {
+        for (uint32_t v = 0; v < VIEWS; v++) {
+            sink += brute_query(bounds, n, views[v]);
+        }
+        brute_runs++;
+    } while (bench_elapsed_s(start) < MIN_BENCH_SECONDS);
+    double brute_s = bench_elapsed_s(start);
+
+    char name[64];
+    SDL_snprintf(name, sizeof(name), "view/%u", n);
+    double tree_us = tree_s * 1e6 / ((double) tree_runs * VIEWS);
+    double brute_us = brute_s * 1e6 / ((double) brute_runs * VIEWS);
+    bench_report(SUITE, name, "visible=%.1f%% nodes=%.0f build_us=%.1f query_us=%.2f brute_us=%.2f speedup=%.1f ok=%d",
+                 100.0 * (double) visible / ((double) n * VIEWS), (double) nodes / VIEWS, build_s * 1e6 / builds,
+                 tree_us, brute_us, brute_us / tree_us, ok);
+
+    quadtree_destroy(&tree);
+    SDL_free(out);
+    SDL_free(bounds);
+    if (!ok) {
+        return SDL_SetError("tree and brute force disagree with %u items", n);
+    }
+    return true;
+}
+
+// args: [items]
+int bench_quadtree(int argc, char **argv) {
+    static const uint32_t counts[] = {1000, 10000, 65536};
+    const uint32_t *items = counts;
+    size_t num_items = SDL_arraysize(counts);
+    uint32_t single;
+    if (argc > 1) {
+        single = (uint32_t) SDL_atoi(argv[1]);
+        items = &single;
+        num_items = 1;
+    }
+    int result = 0;
+    for (size_t i = 0; i < num_items; i++) {
+        if (!bench_items(items[i])) {
+            SDL_Log("%s: %s", SUITE, SDL_GetError());
+            result = 1;
+        }
+    }
+    return result;
+}
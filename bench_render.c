@@ -0,0 +1,573 @@
+#include "bench.h"
+#include "camera.h"
+#include "frame_ring.h"
+#include "particles.h"
+#include "render_pipelines.h"
+#include "shader_inputs.h"
+#include "sprite_batch.h"
+#include "tilemap.h"
+#include "upload_ring.h"
+
+#define SUITE "render"
+#define TARGET_WIDTH 1280
+#define TARGET_HEIGHT 720
+#define TARGET_FORMAT SDL_GPU_TEXTUREFORMAT_R8G8B8A8_UNORM
+#define DEFAULT_FRAMES 300
+// pipelines, first uploads and driver caches settle before anything is measured
+#define WARMUP_FRAMES 10
+#define SPRITE_TEXTURE_SIZE 64
+// every upload of the uploads scenario is one tile of the atlas
+#define UPLOAD_TILE_SIZE 64
+#define UPLOAD_ATLAS_SIZE 1024
+#define UPLOAD_ATLAS_TILES (UPLOAD_ATLAS_SIZE / UPLOAD_TILE_SIZE)
+// tiles as large as the game's, the view covers 32x32 of them wherever the map ends
+#define TILEMAP_TILE_SIZE (2.0f / 32.0f)
+#define TILEMAP_EDITS_PER_FRAME 8
+// the particles scenario steps a fixed 60 Hz and emits as many every frame as live for PARTICLE_FRAMES frames, so
+// about N are alive once it runs. the lifetime sits half a step past the last frame, float drift can't flip it
+#define PARTICLE_BURSTS 16
+#define PARTICLE_FRAMES 60
+#define PARTICLE_DT (1.0f / 60.0f)
+#define PARTICLE_LIFETIME ((PARTICLE_FRAMES + 0.5f) * PARTICLE_DT)
+
+typedef enum {
+    // N sprites through the sprite batch, one instanced draw
+    RENDER_SCENARIO_SPRITES,
+    // N textured quads through the quad pipeline, one draw each
+    RENDER_SCENARIO_QUADS,
+    // M texture uploads per frame through the upload ring, no draws
+    RENDER_SCENARIO_UPLOADS,
+    // an NxN tilemap with a few tile edits per frame, drawn through a view that only covers part of it
+    RENDER_SCENARIO_TILEMAP,
+    // about N live gpu particles, emitted, simulated and compacted by compute passes and drawn indirectly
+    RENDER_SCENARIO_PARTICLES,
+    RENDER_SCENARIO_COUNT,
+} render_scenario_t;
+
+static const char *scenario_names[RENDER_SCENARIO_COUNT] = {
+        [RENDER_SCENARIO_SPRITES] = "sprites",
+        [RENDER_SCENARIO_QUADS] = "quads",
+        [RENDER_SCENARIO_UPLOADS] = "uploads",
+        [RENDER_SCENARIO_TILEMAP] = "tilemap",
+        [RENDER_SCENARIO_PARTICLES] = "particles",
+};
+
+typedef struct {
+    SDL_GPUDevice *device;
+    // stands in for the swapchain, nothing is ever presented
+    SDL_GPUTexture *target;
+    SDL_GPUTexture *sprite_texture;
+    SDL_GPUTexture *atlas;
+    SDL_GPUSampler *sampler;
+    render_pipelines_t render_pipelines;
+    SDL_GPUGraphicsPipeline *quad_pipeline;
+    SDL_GPUGraphicsPipeline *sprite_pipeline;
+    SDL_GPUGraphicsPipeline *particle_pipeline;
+    SDL_GPUBuffer *quad_buffer;
+    SDL_GPUBuffer *quad_index_buffer;
+    upload_ring_t upload_ring;
+    frame_ring_t frame_ring;
+    // cpu time recording particle updates, the part that would grow with the count if anything did
+    uint64_t particle_update_ns;
+    // aspect 1, clip space is [-1, 1] of the world like before there was a camera
+    camera_t camera;
+} render_bench_t;
+
+static const quad_vert unit_quad[] = {
+        {.xy_pos = {SNORM16(-0.5f), SNORM16(0.5f)}, .uv = {0, 0}, .color = {255, 255, 255, 255}},
+        {.xy_pos = {SNORM16(0.5f), SNORM16(0.5f)}, .uv = {UINT16_MAX, 0}, .color = {255, 255, 255, 255}},
+        {.xy_pos = {SNORM16(-0.5f), SNORM16(-0.5f)}, .uv = {0, UINT16_MAX}, .color = {255, 255, 255, 255}},
+        {.xy_pos = {SNORM16(0.5f), SNORM16(-0.5f)}, .uv = {UINT16_MAX, UINT16_MAX}, .color = {255, 255, 255, 255}},
+};
+// corners of the unit quad, unit_quad is already quantized
+static const float unit_quad_corners[][2] = {
+        {-0.5f, 0.5f},
+        {0.5f, 0.5f},
+        {-0.5f, -0.5f},
+        {0.5f, -0.5f},
+};
+static const uint16_t quad_index[] = {
+        0, 3, 1,
+        0, 2, 3,
+};
+
+static float random_unit(uint32_t *seed) {
+    return (float) (bench_rand(seed) % 2001) / 1000.0f - 1.0f;
+}
+
+static SDL_GPUTexture *create_texture(SDL_GPUDevice *device, uint32_t size, SDL_GPUTextureUsageFlags usage) {
+    SDL_GPUTextureCreateInfo info = {
+            .type = SDL_GPU_TEXTURETYPE_2D,
+            .format = TARGET_FORMAT,
+            .usage = usage,
+            .width = size,
+            .height = size,
+            .layer_count_or_depth = 1,
+            .num_levels = 1,
+    };
+    return SDL_CreateGPUTexture(device, &info);
+}
+
+static SDL_GPUBuffer *create_buffer(render_bench_t *bench, SDL_GPUBufferUsageFlags usage, const void *data,
+                                    uint32_t size) {
+    SDL_GPUBuffer *buffer = SDL_CreateGPUBuffer(bench->device, &(SDL_GPUBufferCreateInfo) {
+            .usage = usage,
+            .size = size,
+    });
+    if (buffer == NULL || !upload_ring_upload_buffer(&bench->upload_ring, buffer, 0, data, size)) {
+        SDL_ReleaseGPUBuffer(bench->device, buffer);
+        return NULL;
+    }
+    return buffer;
+}
+
+// texel pattern of one upload, changes with `frame` so the driver can't skip identical copies
+static bool stage_tile(upload_ring_t *ring, SDL_GPUTexture *texture, uint32_t tile, uint32_t frame) {
+    uint32_t size = UPLOAD_TILE_SIZE * UPLOAD_TILE_SIZE * 4;
+    SDL_GPUTextureRegion region = {
+            .texture = texture,
+            .x = (tile % UPLOAD_ATLAS_TILES) * UPLOAD_TILE_SIZE,
+            .y = (tile / UPLOAD_ATLAS_TILES % UPLOAD_ATLAS_TILES) * UPLOAD_TILE_SIZE,
+            .w = UPLOAD_TILE_SIZE,
+            .h = UPLOAD_TILE_SIZE,
+            .d = 1,
+    };
+    uint8_t *texels = upload_ring_stage_texture(ring, &region, UPLOAD_TILE_SIZE, UPLOAD_TILE_SIZE, size);
+    if (texels == NULL) {
+        return false;
+    }
+    SDL_memset(texels, (int) ((tile + frame) & 0xff), size);
+    return true;
+}
+
+static bool render_bench_init(render_bench_t *bench) {
+    SDL_zerop(bench);
+    // the vulkan backend loads its library through the video subsystem, ci boxes have no display to offer
+    if (!SDL_InitSubSystem(SDL_INIT_VIDEO)) {
+        SDL_SetHint(SDL_HINT_VIDEO_DRIVER, "offscreen");
+        if (!SDL_InitSubSystem(SDL_INIT_VIDEO)) {
+            return false;
+        }
+    }
+    bench->device = SDL_CreateGPUDevice(SDL_GPU_SHADERFORMAT_SPIRV, false, NULL);
+    if (bench->device == NULL) {
+        return false;
+    }
+    camera_init(&bench->camera, 0.0f, 0.0f, 1.0f);
+    if (!render_pipelines_init(&bench->render_pipelines, bench->device, TARGET_FORMAT) ||
+        !upload_ring_init(&bench->upload_ring, bench->device, UPLOAD_RING_DEFAULT_SIZE)) {
+        return false;
+    }
+
+    bench->target = SDL_CreateGPUTexture(bench->device, &(SDL_GPUTextureCreateInfo) {
+            .type = SDL_GPU_TEXTURETYPE_2D,
+            .format = TARGET_FORMAT,
+            .usage = SDL_GPU_TEXTUREUSAGE_COLOR_TARGET,
+            .width = TARGET_WIDTH,
+            .height = TARGET_HEIGHT,
+            .layer_count_or_depth = 1,
+            .num_levels = 1,
+    });
+    bench->sprite_texture = create_texture(bench->device, SPRITE_TEXTURE_SIZE, SDL_GPU_TEXTUREUSAGE_SAMPLER);
+    bench->atlas = create_texture(bench->device, UPLOAD_ATLAS_SIZE, SDL_GPU_TEXTUREUSAGE_SAMPLER);
+    bench->sampler = SDL_CreateGPUSampler(bench->device, &(SDL_GPUSamplerCreateInfo) {
+            .min_filter = SDL_GPU_FILTER_LINEAR,
+            .mag_filter = SDL_GPU_FILTER_LINEAR,
+            .compare_op = SDL_GPU_COMPAREOP_ALWAYS,
+    });
+    if (bench->target == NULL || bench->sprite_texture == NULL || bench->atlas == NULL || bench->sampler == NULL) {
+        return false;
+    }
+
+    render_pipelines_request(&bench->render_pipelines, RENDER_PIPELINE_QUAD);
+    bench->sprite_pipeline = render_pipelines_wait(&bench->render_pipelines, RENDER_PIPELINE_SPRITE);
+    bench->quad_pipeline = render_pipelines_wait(&bench->render_pipelines, RENDER_PIPELINE_QUAD);
+    if (bench->quad_pipeline == NULL || bench->sprite_pipeline == NULL) {
+        return false;
+    }
+    if (!frame_ring_init(&bench->frame_ring, bench->device, bench->sprite_pipeline, FRAME_RING_DEFAULT_FRAMES)) {
+        return false;
+    }
+
+    bench->quad_buffer = create_buffer(bench, SDL_GPU_BUFFERUSAGE_VERTEX, unit_quad, sizeof(unit_quad));
+    bench->quad_index_buffer = create_buffer(bench, SDL_GPU_BUFFERUSAGE_INDEX, quad_index, sizeof(quad_index));
+    if (bench->quad_buffer == NULL || bench->quad_index_buffer == NULL) {
+        return false;
+    }
+    // a small checkerboard, the sprites sample it like the game samples its textures
+    SDL_GPUTextureRegion region = {
+            .texture = bench->sprite_texture,
+            .w = SPRITE_TEXTURE_SIZE,
+            .h = SPRITE_TEXTURE_SIZE,
+            .d = 1,
+    };
+    uint32_t *texels = upload_ring_stage_texture(&bench->upload_ring, &region, SPRITE_TEXTURE_SIZE,
+                                                 SPRITE_TEXTURE_SIZE, SPRITE_TEXTURE_SIZE * SPRITE_TEXTURE_SIZE * 4);
+    if (texels == NULL) {
+        return false;
+    }
+    for (uint32_t i = 0; i < SPRITE_TEXTURE_SIZE * SPRITE_TEXTURE_SIZE; i++) {
+        bool dark = ((i % SPRITE_TEXTURE_SIZE) / 8 + (i / SPRITE_TEXTURE_SIZE) / 8) % 2 == 0;
+        texels[i] = dark ? 0xff404040u : 0xffc0c0c0u;
+    }
+    return upload_ring_submit(&bench->upload_ring);
+}
+
+static void render_bench_destroy(render_bench_t *bench) {
+    if (bench->device == NULL) {
+        return;
+    }
+    SDL_WaitForGPUIdle(bench->device);
+    frame_ring_destroy(&bench->frame_ring);
+    upload_ring_destroy(&bench->upload_ring);
+    render_pipelines_destroy(&bench->render_pipelines);
+    SDL_ReleaseGPUBuffer(bench->device, bench->quad_buffer);
+    SDL_ReleaseGPUBuffer(bench->device, bench->quad_index_buffer);
+    SDL_ReleaseGPUSampler(bench->device, bench->sampler);
+    SDL_ReleaseGPUTexture(bench->device, bench->atlas);
+    SDL_ReleaseGPUTexture(bench->device, bench->sprite_texture);
+    SDL_ReleaseGPUTexture(bench->device, bench->target);
+    SDL_DestroyGPUDevice(bench->device);
+    SDL_QuitSubSystem(SDL_INIT_VIDEO);
+    SDL_zerop(bench);
+}
+
+// quads scattered over the target, 4 vertices each, drawn one by one with the shared index buffer
+static SDL_GPUBuffer *create_quads(render_bench_t *bench, uint32_t count) {
+    quad_vert *vertices = SDL_malloc(count * sizeof(unit_quad));
+    if (vertices == NULL) {
+        return NULL;
+    }
+    uint32_t seed = 99;
+    for (uint32_t i = 0; i < count; i++) {
+        float x = random_unit(&seed);
+        float y = random_unit(&seed);
+        for (uint32_t v = 0; v < 4; v++) {
+            quad_vert *vertex = &vertices[i * 4 + v];
+            *vertex = unit_quad[v];
+            vertex->xy_pos[0] = pack_snorm16(x + unit_quad_corners[v][0] * 0.04f);
+            vertex->xy_pos[1] = pack_snorm16(y + unit_quad_corners[v][1] * 0.04f);
+        }
+    }
+    SDL_GPUBuffer *buffer = create_buffer(bench, SDL_GPU_BUFFERUSAGE_VERTEX, vertices,
+                                          count * (uint32_t) sizeof(unit_quad));
+    SDL_free(vertices);
+    return buffer;
+}
+
+static sprite_t *create_sprites(uint32_t count) {
+    sprite_t *sprites = SDL_malloc(count * sizeof(sprite_t));
+    if (sprites == NULL) {
+        return NULL;
+    }
+    uint32_t seed = 42;
+    for (uint32_t i = 0; i < count; i++) {
+        sprites[i] = (sprite_t) {
+                .xy_pos = {random_unit(&seed), random_unit(&seed)},
+                .scale = {0.03f, 0.03f},
+                .uv_rect = {0.0f, 0.0f, 1.0f, 1.0f},
+                .color = {1.0f, 1.0f, 1.0f, 1.0f},
+                .rotation = random_unit(&seed) * SDL_PI_F,
+        };
+    }
+    return sprites;
+}
+
+// particles per burst of the particles scenario
+static uint32_t burst_size(uint32_t count) {
+    return SDL_max(count / (PARTICLE_FRAMES * PARTICLE_BURSTS), 1);
+}
+
+static void emit_bursts(particles_t *particles, uint32_t count, uint32_t frame_number) {
+    uint32_t seed = frame_number + 1;
+    for (uint32_t i = 0; i < PARTICLE_BURSTS; i++) {
+        particle_burst_t burst = {
+                .x = random_unit(&seed) * 0.8f,
+                .y = random_unit(&seed) * 0.8f,
+                .count = burst_size(count),
+                .speed = 0.5f,
+                .lifetime = PARTICLE_LIFETIME,
+                .size = 0.01f,
+                .color = {1.0f, 0.6f, 0.2f, 1.0f},
+        };
+        particles_emit(particles, &burst);
+    }
+}
+
+// the live count straight from the gpu, waits for it
+static bool read_particle_count(render_bench_t *bench, particles_t *particles, uint32_t *count) {
+    SDL_GPUCommandBuffer *command_buffer = SDL_AcquireGPUCommandBuffer(bench->device);
+    if (command_buffer == NULL) {
+        return false;
+    }
+    particles_request_count(particles, command_buffer);
+    SDL_GPUFence *fence = SDL_SubmitGPUCommandBufferAndAcquireFence(command_buffer);
+    if (fence == NULL) {
+        return false;
+    }
+    bool ok = SDL_WaitForGPUFences(bench->device, true, &fence, 1) && particles_read_count(particles, count);
+    SDL_ReleaseGPUFence(bench->device, fence);
+    return ok;
+}
+
+// after `frames` the last PARTICLE_FRAMES frames' bursts are alive, update times were taken over the last
+// `measured_frames` of them. one more update that emits a whole buffer's worth without advancing time has to stop at
+// the capacity
+static bool check_particles(render_bench_t *bench, particles_t *particles, uint32_t count, uint32_t frames,
+                            uint32_t measured_frames) {
+    uint32_t expected = SDL_min(frames, PARTICLE_FRAMES) * PARTICLE_BURSTS * burst_size(count);
+    uint32_t live = 0;
+    uint32_t full = 0;
+    bool ok = read_particle_count(bench, particles, &live);
+    if (ok) {
+        particle_burst_t burst = {.count = particles->capacity, .lifetime = PARTICLE_LIFETIME, .size = 0.01f};
+        particles_emit(particles, &burst);
+        SDL_GPUCommandBuffer *command_buffer = SDL_AcquireGPUCommandBuffer(bench->device);
+        ok = command_buffer != NULL;
+        if (ok) {
+            particles_update(particles, command_buffer, 0.0f);
+            ok = SDL_SubmitGPUCommandBuffer(command_buffer) && read_particle_count(bench, particles, &full);
+        }
+    }
+    if (!ok) {
+        return false;
+    }
+    bool exact = live == expected && full == particles->capacity;
+    char name[64];
+    SDL_snprintf(name, sizeof(name), "%s/%u/readback", scenario_names[RENDER_SCENARIO_PARTICLES], count);
+    bench_report(SUITE, name, "live=%u expected=%u full=%u capacity=%u update_us_per_frame=%.2f ok=%d", live,
+                 expected, full, particles->capacity,
+                 (double) bench->particle_update_ns / measured_frames / SDL_NS_PER_US, exact);
+    return exact || SDL_SetError("%u particles alive, expected %u (%u of %u after filling up)", live, expected, full,
+                                 particles->capacity);
+}
+
+static int compare_ns(const void *a, const void *b) {
+    uint64_t x = *(const uint64_t *) a;
+    uint64_t y = *(const uint64_t *) b;
+    return (x > y) - (x < y);
+}
+
+static bool record_frame(render_bench_t *bench, render_scenario_t scenario, uint32_t count,
+                         const sprite_t *sprites, SDL_GPUBuffer *quads, tilemap_t *tilemap, particles_t *particles,
+                         uint32_t frame_number) {
+    upload_ring_retire(&bench->upload_ring);
+    if (scenario == RENDER_SCENARIO_UPLOADS) {
+        for (uint32_t i = 0; i < count; i++) {
+            if (!stage_tile(&bench->upload_ring, bench->atlas, frame_number * count + i, frame_number)) {
+                return false;
+            }
+        }
+    } else if (scenario == RENDER_SCENARIO_TILEMAP) {
+        // anywhere on the map, mostly out of view
+        uint32_t seed = frame_number + 1;
+        for (uint32_t i = 0; i < TILEMAP_EDITS_PER_FRAME; i++) {
+            uint32_t x = bench_rand(&seed) % count;
+            uint32_t y = bench_rand(&seed) % count;
+            tilemap_set(tilemap, x, y, (tile_kind_t) (bench_rand(&seed) % TILE_KIND_COUNT));
+        }
+        if (!tilemap_upload(tilemap, &bench->upload_ring)) {
+            return false;
+        }
+    }
+    if (!upload_ring_submit(&bench->upload_ring)) {
+        return false;
+    }
+
+    frame_context_t *frame = frame_ring_begin(&bench->frame_ring);
+    SDL_GPUCommandBuffer *command_buffer = SDL_AcquireGPUCommandBuffer(bench->device);
+    if (command_buffer == NULL) {
+        return false;
+    }
+    if (scenario == RENDER_SCENARIO_SPRITES) {
+        sprite_batch_begin(&frame->sprite_batch);
+        for (uint32_t i = 0; i < count; i++) {
+            sprite_batch_submit(&frame->sprite_batch, bench->sprite_texture, bench->sampler, 0, &sprites[i]);
+        }
+        if (!sprite_batch_upload(&frame->sprite_batch, command_buffer)) {
+            SDL_CancelGPUCommandBuffer(command_buffer);
+            return false;
+        }
+    } else if (scenario == RENDER_SCENARIO_PARTICLES) {
+        uint64_t update_start = bench_now_ns();
+        emit_bursts(particles, count, frame_number);
+        particles_update(particles, command_buffer, PARTICLE_DT);
+        bench->particle_update_ns += bench_now_ns() - update_start;
+    }
+
+    SDL_GPUColorTargetInfo target_info = {
+            .texture = bench->target,
+            .clear_color = (SDL_FColor) {.r = 0.1f, .g = 0.1f, .b = 0.1f, .a = 1.0f},
+            .load_op = SDL_GPU_LOADOP_CLEAR,
+            .store_op = SDL_GPU_STOREOP_STORE,
+    };
+    camera_uniform camera_data;
+    camera_uniform_data(&bench->camera, &camera_data);
+    SDL_PushGPUVertexUniformData(command_buffer, CAMERA_UNIFORM_SLOT, &camera_data, sizeof(camera_data));
+    SDL_GPURenderPass *render_pass = SDL_BeginGPURenderPass(command_buffer, &target_info, 1, NULL);
+    if (scenario == RENDER_SCENARIO_SPRITES) {
+        sprite_batch_flush(&frame->sprite_batch, render_pass, bench->quad_buffer, bench->quad_index_buffer);
+    } else if (scenario == RENDER_SCENARIO_QUADS) {
+        SDL_BindGPUGraphicsPipeline(render_pass, bench->quad_pipeline);
+        SDL_BindGPUVertexBuffers(render_pass, 0, &(SDL_GPUBufferBinding) {.buffer = quads}, 1);
+        SDL_BindGPUIndexBuffer(render_pass, &(SDL_GPUBufferBinding) {.buffer = bench->quad_index_buffer},
+                               SDL_GPU_INDEXELEMENTSIZE_16BIT);
+        SDL_BindGPUFragmentSamplers(render_pass, 0, &(SDL_GPUTextureSamplerBinding) {
+                .texture = bench->sprite_texture,
+                .sampler = bench->sampler,
+        }, 1);
+        for (uint32_t i = 0; i < count; i++) {
+            SDL_DrawGPUIndexedPrimitives(render_pass, 6, 1, 0, (Sint32) (i * 4), 0);
+        }
+    } else if (scenario == RENDER_SCENARIO_TILEMAP) {
+        float view[4];
+        camera_view_rect(&bench->camera, view);
+        tilemap_draw(tilemap, render_pass, bench->sprite_pipeline, bench->quad_buffer, bench->quad_index_buffer,
+                     bench->sprite_texture, bench->sampler, view);
+    } else if (scenario == RENDER_SCENARIO_PARTICLES) {
+        particles_draw(particles, render_pass, bench->particle_pipeline);
+    }
+    SDL_EndGPURenderPass(render_pass);
+
+    SDL_GPUFence *fence = SDL_SubmitGPUCommandBufferAndAcquireFence(command_buffer);
+    if (fence == NULL) {
+        return false;
+    }
+    frame_ring_end(&bench->frame_ring, fence);
+    return true;
+}
+
+// frame times include the fence wait, so once the frames in flight are used up they follow the gpu
+static bool run_scenario(render_bench_t *bench, render_scenario_t scenario, uint32_t count, uint32_t frames) {
+    sprite_t *sprites = NULL;
+    SDL_GPUBuffer *quads = NULL;
+    tilemap_t tilemap = {0};
+    particles_t particles = {0};
+    uint64_t *frame_ns = SDL_malloc(frames * sizeof(uint64_t));
+    bool ok = frame_ns != NULL;
+    if (ok && scenario == RENDER_SCENARIO_SPRITES) {
+        sprites = create_sprites(count);
+        ok = sprites != NULL;
+    } else if (ok && scenario == RENDER_SCENARIO_QUADS) {
+        quads = create_quads(bench, count);
+        ok = quads != NULL;
+    } else if (ok && scenario == RENDER_SCENARIO_TILEMAP) {
+        // the bottom left corner of the map in the bottom left corner of the view
+        ok = tilemap_init(&tilemap, bench->device, count, count, -1.0f, -1.0f, TILEMAP_TILE_SIZE,
+                          (const float[4]) {0.0f, 0.0f, 1.0f, 1.0f});
+    } else if (ok && scenario == RENDER_SCENARIO_PARTICLES) {
+        // room for every burst that is alive at once, even when N is too small for one particle per burst. new
+        // bursts arrive before the oldest expire, so that is one frame's worth more than stays alive
+        uint32_t capacity = SDL_max(count, (PARTICLE_FRAMES + 1) * PARTICLE_BURSTS * burst_size(count));
+        arena_t scratch = {0};
+        bench->particle_pipeline = render_pipelines_wait(&bench->render_pipelines, RENDER_PIPELINE_PARTICLE);
+        ok = bench->particle_pipeline != NULL && arena_init(&scratch, RENDER_PIPELINES_SCRATCH_SIZE) &&
+             particles_init(&particles, bench->device, &scratch, capacity);
+        arena_destroy(&scratch);
+    }
+    uint64_t chunk_uploads = 0;
+
+    uint64_t upload_bytes = bench->upload_ring.stats.bytes;
+    uint64_t stalls = bench->upload_ring.stats.stalls;
+    uint64_t start = 0;
+    for (uint32_t i = 0; ok && i < WARMUP_FRAMES + frames; i++) {
+        if (i == WARMUP_FRAMES) {
+            upload_bytes = bench->upload_ring.stats.bytes;
+            stalls = bench->upload_ring.stats.stalls;
+            chunk_uploads = tilemap.stats.chunk_uploads;
+            bench->particle_update_ns = 0;
+            start = bench_now_ns();
+        }
+        uint64_t frame_start = bench_now_ns();
+        ok = record_frame(bench, scenario, count, sprites, quads, &tilemap, &particles, i);
+        if (i >= WARMUP_FRAMES) {
+            frame_ns[i - WARMUP_FRAMES] = bench_now_ns() - frame_start;
+        }
+    }
+    // the last frames are only done once the gpu is
+    ok = ok && SDL_WaitForGPUIdle(bench->device);
+
+    if (ok) {
+        double seconds = bench_elapsed_s(start);
+        upload_bytes = bench->upload_ring.stats.bytes - upload_bytes;
+        SDL_qsort(frame_ns, frames, sizeof(uint64_t), compare_ns);
+        char name[64];
+        SDL_snprintf(name, sizeof(name), "%s/%u", scenario_names[scenario], count);
+        bench_report(SUITE, name, "frames=%u p50_ms=%.3f p99_ms=%.3f max_ms=%.3f fps=%.1f items_per_s=%.0f "
+                     "upload_mib_per_s=%.1f upload_stalls=%" SDL_PRIu64, frames,
+                     (double) frame_ns[(frames - 1) / 2] / SDL_NS_PER_MS,
+                     (double) frame_ns[(frames * 99 + 99) / 100 - 1] / SDL_NS_PER_MS,
+                     (double) frame_ns[frames - 1] / SDL_NS_PER_MS, frames / seconds,
+                     (double) count * frames / seconds, (double) upload_bytes / seconds / (1024.0 * 1024.0),
+                     bench->upload_ring.stats.stalls - stalls);
+        if (scenario == RENDER_SCENARIO_TILEMAP) {
+            SDL_snprintf(name, sizeof(name), "%s/%u/chunks", scenario_names[scenario], count);
+            bench_report(SUITE, name, "chunks=%u draws=%u culled=%u chunk_uploads_per_frame=%.2f",
+                         tilemap.chunks_x * tilemap.chunks_y, tilemap.stats.draws, tilemap.stats.culled,
+                         (double) (tilemap.stats.chunk_uploads - chunk_uploads) / frames);
+        }
+        if (scenario == RENDER_SCENARIO_PARTICLES) {
+            ok = check_particles(bench, &particles, count, WARMUP_FRAMES + frames, frames);
+        }
+    }
+
+    SDL_ReleaseGPUBuffer(bench->device, quads);
+    if (particles.device != NULL) {
+        SDL_WaitForGPUIdle(bench->device);
+        particles_destroy(&particles);
+    }
+    if (tilemap.chunks != NULL) {
+        tilemap_destroy(&tilemap);
+    }
+    SDL_free(sprites);
+    SDL_free(frame_ns);
+    return ok;
+}
+
+static bool parse_scenario(const char *name, render_scenario_t *scenario) {
+    for (int i = 0; i < RENDER_SCENARIO_COUNT; i++) {
+        if (SDL_strcmp(name, scenario_names[i]) == 0) {
+            *scenario = (render_scenario_t) i;
+            return true;
+        }
+    }
+    return SDL_SetError("unknown scenario %s", name);
+}
+
+// render path on the gpu into an offscreen target, no window. runs from the build directory (it loads the
+// compiled shaders) and on a cpu driver too, e.g. VK_DRIVER_FILES=<lvp_icd.json> for lavapipe.
+// args: [sprites|quads|uploads|tilemap|particles] [count] [frames], count is the map width and height for tilemap.
+// particles also reads the live count back and checks it against what was emitted
+int bench_render(int argc, char **argv) {
+    render_bench_t bench;
+    bool ok = render_bench_init(&bench);
+    if (ok) {
+        bench_report(SUITE, "device", "driver=%s target=%ux%u", SDL_GetGPUDeviceDriver(bench.device), TARGET_WIDTH,
+                     TARGET_HEIGHT);
+    }
+    if (ok && argc > 1) {
+        render_scenario_t scenario;
+        uint32_t count = argc > 2 ? (uint32_t) SDL_atoi(argv[2]) : 1000;
+        uint32_t frames = argc > 3 ? (uint32_t) SDL_atoi(argv[3]) : DEFAULT_FRAMES;
+        ok = parse_scenario(argv[1], &scenario) && run_scenario(&bench, scenario, count, SDL_max(frames, 1));
+    } else if (ok) {
+        ok = run_scenario(&bench, RENDER_SCENARIO_SPRITES, 1000, DEFAULT_FRAMES) &&
+             run_scenario(&bench, RENDER_SCENARIO_SPRITES, 10000, DEFAULT_FRAMES) &&
+             run_scenario(&bench, RENDER_SCENARIO_SPRITES, 100000, DEFAULT_FRAMES) &&
+             run_scenario(&bench, RENDER_SCENARIO_QUADS, 100, DEFAULT_FRAMES) &&
+             run_scenario(&bench, RENDER_SCENARIO_QUADS, 1000, DEFAULT_FRAMES) &&
+             run_scenario(&bench, RENDER_SCENARIO_QUADS, 10000, DEFAULT_FRAMES) &&
+             run_scenario(&bench, RENDER_SCENARIO_UPLOADS, 16, DEFAULT_FRAMES) &&
+             run_scenario(&bench, RENDER_SCENARIO_UPLOADS, 256, DEFAULT_FRAMES) &&
+             run_scenario(&bench, RENDER_SCENARIO_TILEMAP, 64, DEFAULT_FRAMES) &&
+             run_scenario(&bench, RENDER_SCENARIO_TILEMAP, 1024, DEFAULT_FRAMES) &&
+             run_scenario(&bench, RENDER_SCENARIO_PARTICLES, 10000, DEFAULT_FRAMES) &&
+             run_scenario(&bench, RENDER_SCENARIO_PARTICLES, 100000, DEFAULT_FRAMES) &&
+             run_scenario(&bench, RENDER_SCENARIO_PARTICLES, 1000000, DEFAULT_FRAMES);
+    }
+    if (!ok) {
+        SDL_Log("%s: %s", SUITE, SDL_GetError());
+    }
+    render_bench_destroy(&bench);
+    return ok ? 0 : 1;
+}
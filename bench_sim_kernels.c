@@ -0,0 +1,187 @@
+#include "bench.h"
+#include "entity.h"
+#include "flow_field.h"
+#include "sim_kernels.h"
+
+#define SUITE "sim_kernels"
+#define MIN_BENCH_SECONDS 0.25
+#define MAP_SIZE 32
+#define ENEMY_SPEED 0.3f
+#define BOUND 1.5f
+// kernel calls between two resets of the entities, so they don't drift off the map while being timed
+#define REPEATS 8
+
+typedef enum {
+    KERNEL_INTEGRATE,
+    KERNEL_STEER,
+    KERNEL_EXPIRE,
+    KERNEL_COUNT,
+} kernel_t;
+
+static const char *kernel_names[KERNEL_COUNT] = {
+        [KERNEL_INTEGRATE] = "integrate",
+        [KERNEL_STEER] = "steer",
+        [KERNEL_EXPIRE] = "expire",
+};
+
+static float random_float(uint32_t *seed, float min, float max) {
+    return min + (float) (bench_rand(seed) >> 8) * ((max - min) / 16777216.0f);
+}
+
+// a late wave: mostly enemies spread over the map and a little past it, some towers, projectiles in flight and a
+// few of everything already dead
+static void populate(entity_store_t *store, uint32_t count, uint32_t *seed) {
+    for (uint32_t i = 0; i < count; i++) {
+        uint32_t roll = bench_rand(seed) % 16;
+        entity_kind_t kind = roll < 12 ? ENTITY_KIND_ENEMY : roll < 13 ? ENTITY_KIND_TOWER : ENTITY_KIND_PROJECTILE;
+        entity_spawn(store, kind, random_float(seed, -1.6f, 1.6f), random_float(seed, -1.6f, 1.6f));
+        uint32_t e = store->count - 1;
+        store->vel_x[e] = random_float(seed, -2.0f, 2.0f);
+        store->vel_y[e] = random_float(seed, -2.0f, 2.0f);
+        store->health[e] = bench_rand(seed) % 8 == 0 ? 0.0f : random_float(seed, -10.0f, 100.0f);
+        store->path_progress[e] = random_float(seed, 0.0f, 4.0f);
+    }
+}
+
+static void copy_entities(entity_store_t *dst, const entity_store_t *src) {
+    size_t bytes = src->count * sizeof(float);
+    dst->count = src->count;
+    SDL_memcpy(dst->kind, src->kind, src->count);
+    SDL_memcpy(dst->pos_x, src->pos_x, bytes);
+    SDL_memcpy(dst->pos_y, src->pos_y, bytes);
+    SDL_memcpy(dst->prev_x, src->prev_x, bytes);
+    SDL_memcpy(dst->prev_y, src->prev_y, bytes);
+    SDL_memcpy(dst->vel_x, src->vel_x, bytes);
+    SDL_memcpy(dst->vel_y, src->vel_y, bytes);
+    SDL_memcpy(dst->health, src->health, bytes);
+    SDL_memcpy(dst->path_progress, src->path_progress, bytes);
+}
+
+static bool same_entities(const entity_store_t *a, const entity_store_t *b) {
+    size_t bytes = a->count * sizeof(float);
+    return SDL_memcmp(a->pos_x, b->pos_x, bytes) == 0 && SDL_memcmp(a->pos_y, b->pos_y, bytes) == 0 &&
+           SDL_memcmp(a->prev_x, b->prev_x, bytes) == 0 && SDL_memcmp(a->prev_y, b->prev_y, bytes) == 0 &&
+           SDL_memcmp(a->vel_x, b->vel_x, bytes) == 0 && SDL_memcmp(a->vel_y, b->vel_y, bytes) == 0 &&
+           SDL_memcmp(a->path_progress, b->path_progress, bytes) == 0;
+}
+
+static void run_kernel(kernel_t kernel, entity_store_t *store, const flow_field_t *field, uint8_t *expired) {
+    switch (kernel) {
+        case KERNEL_INTEGRATE:
+            sim_kernels_integrate(store, 0, store->count, 1.0f / 60.0f);
+            break;
+        case KERNEL_STEER:
+            sim_kernels_steer(store, field, 0, store->count, ENEMY_SPEED, 1.0f / 60.0f);
+            break;
+        default:
+            sim_kernels_expire(store, field, 0, store->count, BOUND, expired);
+            break;
+    }
+}
+
+// entities per second of `kernel` on every kernel set the cpu has, each checked bit for bit against the scalar one.
+// false with the error set if one of them differs
+static bool bench_kernel(kernel_t kernel, const entity_store_t *source, const flow_field_t *field,
+                         entity_store_t *reference, entity_store_t *work, uint8_t *reference_expired,
+                         uint8_t *expired) {
+    uint32_t count = source->count;
+    copy_entities(reference, source);
+    SDL_memset(reference_expired, 0xAA, count);
+    sim_kernels_set_isa(SIM_KERNELS_ISA_SCALAR);
+    run_kernel(kernel, reference, field, reference_expired);
+
+    bool ok = true;
+    double scalar_rate = 0.0;
+    for (int isa = 0; isa < SIM_KERNELS_ISA_COUNT; isa++) {
+        if (!sim_kernels_set_isa((sim_kernels_isa_t) isa)) {
+            continue;
+        }
+        copy_entities(work, source);
+        SDL_memset(expired, 0xAA, count);
+        run_kernel(kernel, work, field, expired);
+        bool exact = same_entities(work, reference) && SDL_memcmp(expired, reference_expired, count) == 0;
+        if (!exact) {
+            ok = SDL_SetError("%s/%s does not match scalar output", kernel_names[kernel],
+                              sim_kernels_isa_name((sim_kernels_isa_t) isa));
+        }
+
+        uint64_t kernel_ns = 0;
+        size_t calls = 0;
+        uint64_t start = bench_now_ns();
+        do {
+            copy_entities(work, source);
+            uint64_t t0 = bench_now_ns();
+            for (int i = 0; i < REPEATS; i++) {
+                run_kernel(kernel, work, field, expired);
+            }
+            kernel_ns += bench_now_ns() - t0;
+            calls += REPEATS;
+        } while (bench_elapsed_s(start) < MIN_BENCH_SECONDS);
+
+        double rate = (double) count * calls / ((double) kernel_ns / 1e9);
+        if (isa == SIM_KERNELS_ISA_SCALAR) {
+            scalar_rate = rate;
+        }
+        char name[64];
+        SDL_snprintf(name, sizeof(name), "%s/%s/%u", kernel_names[kernel],
+                     sim_kernels_isa_name((sim_kernels_isa_t) isa), count);
+        bench_report(SUITE, name, "mentities_per_s=%.1f ns_per_entity=%.3f speedup=%.2f ok=%d", rate / 1e6,
+                     1e9 / rate, rate / scalar_rate, exact);
+    }
+    return ok;
+}
+
+static int bench_count(uint32_t count) {
+    flow_field_t field = {0};
+    entity_store_t source = {0};
+    entity_store_t reference = {0};
+    entity_store_t work = {0};
+    uint8_t *expired = SDL_malloc(count);
+    uint8_t *reference_expired = SDL_malloc(count);
+    bool ok = expired != NULL && reference_expired != NULL &&
+              flow_field_init(&field, MAP_SIZE, MAP_SIZE, MAP_SIZE - 1, MAP_SIZE / 2) &&
+              entity_store_init(&source, count) && entity_store_init(&reference, count) &&
+              entity_store_init(&work, count);
+    if (ok) {
+        uint32_t seed = 1234;
+        // a few towers so some tiles have no direction
+        for (int i = 0; i < MAP_SIZE * 4; i++) {
+            flow_field_place_tower(&field, bench_rand(&seed) % MAP_SIZE, bench_rand(&seed) % MAP_SIZE);
+        }
+        populate(&source, count, &seed);
+        for (int kernel = 0; kernel < KERNEL_COUNT; kernel++) {
+            ok &= bench_kernel((kernel_t) kernel, &source, &field, &reference, &work, reference_expired, expired);
+        }
+    }
+    if (!ok) {
+        SDL_Log("%s: %s", SUITE, SDL_GetError());
+    }
+
+    SDL_free(reference_expired);
+    SDL_free(expired);
+    entity_store_destroy(&work);
+    entity_store_destroy(&reference);
+    entity_store_destroy(&source);
+    flow_field_destroy(&field);
+    return ok ? 0 : 1;
+}
+
+// args: [entities]
+int bench_sim_kernels(int argc, char **argv) {
+    sim_kernels_init();
+    sim_kernels_isa_t best = sim_kernels_get_isa();
+
+    int result = 0;
+    if (argc > 1) {
+        result = bench_count((uint32_t) SDL_atoi(argv[1]));
+    } else {
+        // not multiples of 8, so the scalar tails of the wide kernels are checked too
+        static const uint32_t counts[] = {1021, 16381, 262139};
+        for (size_t i = 0; i < SDL_arraysize(counts); i++) {
+            result |= bench_count(counts[i]);
+        }
+    }
+
+    sim_kernels_set_isa(best);
+    return result;
+}
@@ -0,0 +1,250 @@
+#include "bench.h"
+#include "spatial_hash.h"
+
+#define SUITE "spatial_hash"
+#define MIN_BENCH_SECONDS 0.25
+#define QUERIES 1024
+#define TOWER_RANGE 0.15f
+#define PROJECTILE_STEP 0.05f
+#define HIT_RADIUS 0.02f
+#define NEAREST 4
+
+typedef struct {
+    uint32_t n;
+    float *x;
+    float *y;
+    float *progress;
+    float qx[QUERIES];
+    float qy[QUERIES];
+    float qx1[QUERIES];
+    float qy1[QUERIES];
+} scene_t;
+
+static float random_unit(uint32_t *seed) {
+    return (float) (bench_rand(seed) >> 8) * (2.0f / 16777216.0f) - 1.0f;
+}
+
+static uint32_t brute_radius(const scene_t *scene, float x, float y, float radius) {
+    uint32_t found = 0;
+    for (uint32_t i = 0; i < scene->n; i++) {
+        float dx = scene->x[i] - x;
+        float dy = scene->y[i] - y;
+        found += dx * dx + dy * dy <= radius * radius;
+    }
+    return found;
+}
+
+static uint32_t brute_first_along_path(const scene_t *scene, float x, float y, float radius) {
+    uint32_t best = SPATIAL_HASH_NONE;
+    for (uint32_t i = 0; i < scene->n; i++) {
+        float dx = scene->x[i] - x;
+        float dy = scene->y[i] - y;
+        if (dx * dx + dy * dy <= radius * radius &&
+            (best == SPATIAL_HASH_NONE || scene->progress[i] > scene->progress[best])) {
+            best = i;
+        }
+    }
+    return best;
+}
+
+// distance of the n-th closest within radius, or -1 if there are fewer
+static float brute_nth_nearest(const scene_t *scene, float x, float y, float radius, uint32_t n) {
+    float best[NEAREST];
+    uint32_t found = 0;
+    for (uint32_t i = 0; i < scene->n; i++) {
+        float dx = scene->x[i] - x;
+        float dy = scene->y[i] - y;
+        float d2 = dx * dx + dy * dy;
+        if (d2 > radius * radius || (found == n && d2 >= best[n - 1])) {
+            continue;
+        }
+        uint32_t pos = found < n ? found++ : n - 1;
+        while (pos > 0 && best[pos - 1] > d2) {
+            best[pos] = best[pos - 1];
+            pos--;
+        }
+        best[pos] = d2;
+    }
+    return found == n ? best[n - 1] : -1.0f;
+}
+
+static uint32_t brute_segment(const scene_t *scene, float x0, float y0, float x1, float y1, float radius) {
+    uint32_t best = SPATIAL_HASH_NONE;
+    float best_t = 2.0f;
+    float dx = x1 - x0;
+    float dy = y1 - y0;
+    float a = dx * dx + dy * dy;
+    for (uint32_t i = 0; i < scene->n; i++) {
+        float fx = x0 - scene->x[i];
+        float fy = y0 - scene->y[i];
+        float c = fx * fx + fy * fy - radius * radius;
+        float b = fx * dx + fy * dy;
+        float t;
+        if (c <= 0.0f) {
+            t = 0.0f;
+        } else if (b >= 0.0f || b * b - a * c < 0.0f) {
+            continue;
+        } else {
+            t = (-b - SDL_sqrtf(b * b - a * c)) / a;
+            if (t > 1.0f) {
+                continue;
+            }
+        }
+        if (t < best_t) {
+            best = i;
+            best_t = t;
+        }
+    }
+    return best;
+}
+
+static void report(const char *name, uint32_t n, double grid_s, size_t grid_runs, double brute_s, size_t brute_runs,
+                   bool ok) {
+    char full[64];
+    SDL_snprintf(full, sizeof(full), "%s/%u", name, n);
+    double grid_qps = (double) QUERIES * grid_runs / grid_s;
+    double brute_qps = (double) QUERIES * brute_runs / brute_s;
+    bench_report(SUITE, full, "grid_mqps=%.3f brute_mqps=%.4f speedup=%.1f ok=%d", grid_qps / 1e6, brute_qps / 1e6,
+                 grid_qps / brute_qps, ok);
+}
+
+// times `_body` run over every query until MIN_BENCH_SECONDS passed, `_runs` and `_seconds` receive the result
+#define TIME_QUERIES(_runs, _seconds, _body)                 \
+    do {                                                     \
+        uint64_t _start = bench_now_ns();                    \
+        _runs = 0;                                           \
+        do {                                                 \
+            for (uint32_t q = 0; q < QUERIES; q++) {         \
+                _body;                                       \
+            }                                                \
+            _runs++;                                         \
+        } while (bench_elapsed_s(_start) < MIN_BENCH_SECONDS); \
+        _seconds = bench_elapsed_s(_start);                  \
+    } while (false)
+
+static int bench_enemies(uint32_t n) {
+    scene_t *scene = SDL_calloc(1, sizeof(scene_t));
+    scene->n = n;
+    scene->x = SDL_malloc(n * sizeof(float));
+    scene->y = SDL_malloc(n * sizeof(float));
+    scene->progress = SDL_malloc(n * sizeof(float));
+    uint32_t seed = 1234;
+    for (uint32_t i = 0; i < n; i++) {
+        scene->x[i] = random_unit(&seed);
+        scene->y[i] = random_unit(&seed);
+        scene->progress[i] = random_unit(&seed);
+    }
+    for (uint32_t q = 0; q < QUERIES; q++) {
+        scene->qx[q] = random_unit(&seed);
+        scene->qy[q] = random_unit(&seed);
+        float angle = random_unit(&seed) * SDL_PI_F;
+        scene->qx1[q] = scene->qx[q] + SDL_cosf(angle) * PROJECTILE_STEP;
+        scene->qy1[q] = scene->qy[q] + SDL_sinf(angle) * PROJECTILE_STEP;
+    }
+
+    spatial_hash_t hash;
+    spatial_hash_init(&hash, -1.0f, -1.0f, 1.0f, 1.0f, TOWER_RANGE, n);
+
+    size_t builds = 0;
+    uint64_t start = bench_now_ns();
+    do {
+        spatial_hash_build(&hash, scene->x, scene->y, NULL, 0, n);
+        builds++;
+    } while (bench_elapsed_s(start) < MIN_BENCH_SECONDS);
+    char name[64];
+    SDL_snprintf(name, sizeof(name), "build/%u", n);
+    bench_report(SUITE, name, "cells=%ux%u us_per_build=%.1f ns_per_item=%.2f", hash.cols, hash.rows,
+                 bench_elapsed_s(start) * 1e6 / builds, bench_elapsed_s(start) * 1e9 / ((double) builds * n));
+
+    int result = 0;
+    bool ok = true;
+    volatile uint32_t sink = 0;
+    size_t grid_runs;
+    size_t brute_runs;
+    double grid_s;
+    double brute_s;
+    uint32_t out[NEAREST];
+
+    // radius: what every tower does to find candidates
+    for (uint32_t q = 0; q < QUERIES; q++) {
+        ok &= spatial_hash_query_radius(&hash, scene->qx[q], scene->qy[q], TOWER_RANGE, out, 0) ==
+              brute_radius(scene, scene->qx[q], scene->qy[q], TOWER_RANGE);
+    }
+    TIME_QUERIES(grid_runs, grid_s,
+                 sink += spatial_hash_query_radius(&hash, scene->qx[q], scene->qy[q], TOWER_RANGE, out, 0));
+    TIME_QUERIES(brute_runs, brute_s, sink += brute_radius(scene, scene->qx[q], scene->qy[q], TOWER_RANGE));
+    report("radius", n, grid_s, grid_runs, brute_s, brute_runs, ok);
+    result |= !ok;
+
+    // first along path: the default tower targeting
+    ok = true;
+    for (uint32_t q = 0; q < QUERIES; q++) {
+        ok &= spatial_hash_first_along_path(&hash, scene->qx[q], scene->qy[q], TOWER_RANGE, scene->progress) ==
+              brute_first_along_path(scene, scene->qx[q], scene->qy[q], TOWER_RANGE);
+    }
+    TIME_QUERIES(grid_runs, grid_s,
+                 sink += spatial_hash_first_along_path(&hash, scene->qx[q], scene->qy[q], TOWER_RANGE,
+                                                       scene->progress));
+    TIME_QUERIES(brute_runs, brute_s, sink += brute_first_along_path(scene, scene->qx[q], scene->qy[q], TOWER_RANGE));
+    report("first_along_path", n, grid_s, grid_runs, brute_s, brute_runs, ok);
+    result |= !ok;
+
+    // nearest n: splash and chain targeting
+    ok = true;
+    for (uint32_t q = 0; q < QUERIES; q++) {
+        uint32_t found = spatial_hash_nearest(&hash, scene->qx[q], scene->qy[q], TOWER_RANGE, NEAREST, out);
+        float nth = brute_nth_nearest(scene, scene->qx[q], scene->qy[q], TOWER_RANGE, NEAREST);
+        if (found == NEAREST) {
+            float dx = scene->x[out[NEAREST - 1]] - scene->qx[q];
+            float dy = scene->y[out[NEAREST - 1]] - scene->qy[q];
+            ok &= dx * dx + dy * dy == nth;
+        } else {
+            ok &= nth < 0.0f;
+        }
+    }
+    TIME_QUERIES(grid_runs, grid_s,
+                 sink += spatial_hash_nearest(&hash, scene->qx[q], scene->qy[q], TOWER_RANGE, NEAREST, out));
+    TIME_QUERIES(brute_runs, brute_s,
+                 sink += (uint32_t) brute_nth_nearest(scene, scene->qx[q], scene->qy[q], TOWER_RANGE, NEAREST));
+    report("nearest4", n, grid_s, grid_runs, brute_s, brute_runs, ok);
+    result |= !ok;
+
+    // segment cast: one projectile step
+    ok = true;
+    float t;
+    for (uint32_t q = 0; q < QUERIES; q++) {
+        ok &= spatial_hash_segment_cast(&hash, scene->qx[q], scene->qy[q], scene->qx1[q], scene->qy1[q], HIT_RADIUS,
+                                        &t) ==
+              brute_segment(scene, scene->qx[q], scene->qy[q], scene->qx1[q], scene->qy1[q], HIT_RADIUS);
+    }
+    TIME_QUERIES(grid_runs, grid_s,
+                 sink += spatial_hash_segment_cast(&hash, scene->qx[q], scene->qy[q], scene->qx1[q], scene->qy1[q],
+                                                   HIT_RADIUS, &t));
+    TIME_QUERIES(brute_runs, brute_s,
+                 sink += brute_segment(scene, scene->qx[q], scene->qy[q], scene->qx1[q], scene->qy1[q], HIT_RADIUS));
+    report("segment_cast", n, grid_s, grid_runs, brute_s, brute_runs, ok);
+    result |= !ok;
+
+    if (result) {
+        SDL_Log("%s: grid and brute force disagree with %u enemies", SUITE, n);
+    }
+    spatial_hash_destroy(&hash);
+    SDL_free(scene->progress);
+    SDL_free(scene->y);
+    SDL_free(scene->x);
+    SDL_free(scene);
+    return result;
+}
+
+// args: [enemies]
+int bench_spatial_hash(int argc, char **argv) {
+    if (argc > 1) {
+        return bench_enemies((uint32_t) SDL_atoi(argv[1]));
+    }
+    static const uint32_t counts[] = {1000, 10000, 50000};
+    int result = 0;
+    for (size_t i = 0; i < SDL_arraysize(counts); i++) {
+        result |= bench_enemies(counts[i]);
+    }
+    return result;
+}
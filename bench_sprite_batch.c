@@ -0,0 +1,69 @@
+#include "bench.h"
+#include "sprite_batch.h"
+
+#define SUITE "sprite_batch"
+#define MIN_BENCH_SECONDS 0.25
+
+// cpu side of a frame: submit N sprites spread over `textures` bindings and `layers` layers, then sort and pack
+static void bench_frame_build(uint32_t sprites, uint32_t textures, uint32_t layers) {
+    sprite_batch_t batch;
+    sprite_batch_init(&batch, NULL, NULL, sprites);
+    sprite_instance *out = SDL_malloc(sprites * sizeof(sprite_instance));
+
+    uint32_t seed = 1234;
+    uint32_t *texture_ids = SDL_malloc(sprites * sizeof(uint32_t));
+    uint16_t *sprite_layers = SDL_malloc(sprites * sizeof(uint16_t));
+    for (uint32_t i = 0; i < sprites; i++) {
+        texture_ids[i] = bench_rand(&seed) % textures;
+        sprite_layers[i] = (uint16_t) (bench_rand(&seed) % layers);
+    }
+
+    size_t frames = 0;
+    uint64_t start = bench_now_ns();
+    do {
+        sprite_batch_begin(&batch);
+        for (uint32_t i = 0; i < sprites; i++) {
+            sprite_t sprite = {
+                    .xy_pos = {(float) i, (float) i},
+                    .scale = {1.0f, 1.0f},
+                    .uv_rect = {0.0f, 0.0f, 1.0f, 1.0f},
+                    .color = {1.0f, 1.0f, 1.0f, 1.0f},
+            };
+            // fake handles, the cpu side never dereferences them
+            SDL_GPUTexture *texture = (SDL_GPUTexture *) (uintptr_t) (0x1000 + texture_ids[i] * 16);
+            sprite_batch_submit(&batch, texture, NULL, sprite_layers[i], &sprite);
+        }
+        sprite_batch_pack(&batch, out);
+        frames++;
+    } while (bench_elapsed_s(start) < MIN_BENCH_SECONDS);
+    double seconds = bench_elapsed_s(start);
+
+    char name[64];
+    SDL_snprintf(name, sizeof(name), "build/%u", sprites);
+    double total = (double) sprites * frames;
+    bench_report(SUITE, name, "textures=%u layers=%u draws=%u msprites_per_s=%.2f ns_per_sprite=%.2f us_per_frame=%.1f",
+                 textures, layers, batch.num_runs, total / seconds / 1e6, seconds * 1e9 / total,
+                 seconds * 1e6 / frames);
+
+    SDL_free(sprite_layers);
+    SDL_free(texture_ids);
+    SDL_free(out);
+    sprite_batch_destroy(&batch);
+}
+
+// args: [sprites] [textures] [layers]
+int bench_sprite_batch(int argc, char **argv) {
+    if (argc > 1) {
+        uint32_t sprites = (uint32_t) SDL_atoi(argv[1]);
+        uint32_t textures = argc > 2 ? (uint32_t) SDL_atoi(argv[2]) : 8;
+        uint32_t layers = argc > 3 ? (uint32_t) SDL_atoi(argv[3]) : 4;
+        bench_frame_build(sprites, textures, layers);
+        return 0;
+    }
+    static const uint32_t counts[] = {1000, 10000, 50000, 100000};
+    for (size_t i = 0; i < SDL_arraysize(counts); i++) {
+        bench_frame_build(counts[i], 1, 1);
+        bench_frame_build(counts[i], 8, 4);
+    }
+    return 0;
+}
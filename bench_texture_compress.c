@@ -0,0 +1,162 @@
+#include "bench.h"
+#include "texture_compress.h"
+
+#define SUITE "texture_compress"
+#define TEXTURE_SIZE 512
+#define BENCH_RUNS 3
+
+typedef struct {
+    const char *name;
+    uint32_t levels;
+    size_t level_offset[16];
+    size_t rgba8_bytes;
+    uint8_t *texels;
+} mip_chain_t;
+
+// ground like texture: a few overlapping waves plus grain, opaque
+static void fill_terrain(uint8_t *rgba, uint32_t *seed) {
+    for (uint32_t y = 0; y < TEXTURE_SIZE; y++) {
+        for (uint32_t x = 0; x < TEXTURE_SIZE; x++) {
+            float wave = SDL_sinf((float) x * 0.05f) * SDL_cosf((float) y * 0.07f) +
+                         0.5f * SDL_sinf((float) (x + y) * 0.13f);
+            int grain = (int) (bench_rand(seed) % 17) - 8;
+            uint8_t *texel = rgba + ((size_t) y * TEXTURE_SIZE + x) * 4;
+            texel[0] = (uint8_t) SDL_clamp(90 + (int) (wave * 30.0f) + grain, 0, 255);
+            texel[1] = (uint8_t) SDL_clamp(140 + (int) (wave * 45.0f) + grain, 0, 255);
+            texel[2] = (uint8_t) SDL_clamp(60 + (int) (wave * 20.0f) + grain, 0, 255);
+            texel[3] = 255;
+        }
+    }
+}
+
+// sprite like texture: a shaded disc with a soft edge on a transparent background
+static void fill_sprite(uint8_t *rgba, uint32_t *seed) {
+    (void) seed;
+    float center = TEXTURE_SIZE * 0.5f;
+    for (uint32_t y = 0; y < TEXTURE_SIZE; y++) {
+        for (uint32_t x = 0; x < TEXTURE_SIZE; x++) {
+            float dx = ((float) x - center) / center;
+            float dy = ((float) y - center) / center;
+            float d = SDL_sqrtf(dx * dx + dy * dy);
+            uint8_t *texel = rgba + ((size_t) y * TEXTURE_SIZE + x) * 4;
+            texel[0] = (uint8_t) SDL_clamp(200.0f - d * 120.0f, 0.0f, 255.0f);
+            texel[1] = (uint8_t) SDL_clamp(60.0f + dx * 50.0f, 0.0f, 255.0f);
+            texel[2] = (uint8_t) SDL_clamp(40.0f + dy * 60.0f, 0.0f, 255.0f);
+            texel[3] = (uint8_t) SDL_clamp((0.9f - d) * 2550.0f, 0.0f, 255.0f);
+        }
+    }
+}
+
+static bool build_chain(mip_chain_t *chain, void (*fill)(uint8_t *, uint32_t *), uint32_t *seed) {
+    chain->levels = texture_mip_count(TEXTURE_SIZE, TEXTURE_SIZE);
+    chain->rgba8_bytes = 0;
+    for (uint32_t level = 0; level < chain->levels; level++) {
+        chain->level_offset[level] = chain->rgba8_bytes;
+        uint32_t size = SDL_max(TEXTURE_SIZE >> level, 1);
+        chain->rgba8_bytes += texture_encoded_size(TEXTURE_ENCODING_RGBA8, size, size);
+    }
+    chain->texels = SDL_malloc(chain->rgba8_bytes);
+    if (chain->texels == NULL) {
+        return false;
+    }
+    fill(chain->texels, seed);
+
+    double best = 1e30;
+    for (int run = 0; run < BENCH_RUNS; run++) {
+        uint64_t start = bench_now_ns();
+        for (uint32_t level = 1; level < chain->levels; level++) {
+            uint32_t size = TEXTURE_SIZE >> (level - 1);
+            texture_downsample(chain->texels + chain->level_offset[level - 1], size, size,
+                               chain->texels + chain->level_offset[level]);
+        }
+        best = SDL_min(best, bench_elapsed_s(start));
+    }
+    bench_report(SUITE, "mips", "texture=%s levels=%u ms=%.3f mib_per_s=%.0f", chain->name, chain->levels,
+                 best * 1e3, (double) chain->rgba8_bytes / best / (1024.0 * 1024.0));
+    return true;
+}
+
+static double psnr(double squared_error, size_t samples) {
+    if (squared_error == 0.0) {
+        return 99.0;
+    }
+    return 10.0 * SDL_log10(255.0 * 255.0 * (double) samples / squared_error);
+}
+
+// encodes the whole chain, decodes level 0 back and compares it to the source
+static void bench_encoding(const mip_chain_t *chain, texture_encoding_t encoding, uint8_t *encoded,
+                           uint8_t *decoded) {
+    size_t encoded_bytes = 0;
+    double best = 1e30;
+    for (int run = 0; run < BENCH_RUNS; run++) {
+        uint64_t start = bench_now_ns();
+        encoded_bytes = 0;
+        for (uint32_t level = 0; level < chain->levels; level++) {
+            uint32_t size = SDL_max(TEXTURE_SIZE >> level, 1);
+            texture_encode(encoding, chain->texels + chain->level_offset[level], size, size, encoded + encoded_bytes);
+            encoded_bytes += texture_encoded_size(encoding, size, size);
+        }
+        best = SDL_min(best, bench_elapsed_s(start));
+    }
+
+    texture_decode(encoding, encoded, TEXTURE_SIZE, TEXTURE_SIZE, decoded);
+    double rgb_error = 0.0;
+    double alpha_error = 0.0;
+    for (size_t i = 0; i < (size_t) TEXTURE_SIZE * TEXTURE_SIZE; i++) {
+        for (int c = 0; c < 4; c++) {
+            double d = (double) chain->texels[i * 4 + c] - decoded[i * 4 + c];
+            if (c < 3) {
+                rgb_error += d * d;
+            } else {
+                alpha_error += d * d;
+            }
+        }
+    }
+    size_t texels = (size_t) TEXTURE_SIZE * TEXTURE_SIZE;
+    bench_report(SUITE, texture_encoding_name(encoding),
+                 "texture=%s mib_per_s=%.1f psnr_rgb_db=%.2f psnr_alpha_db=%.2f bytes=%zu rgba8_bytes=%zu "
+                 "saving=%.1fx", chain->name, (double) chain->rgba8_bytes / best / (1024.0 * 1024.0), psnr(rgb_error, texels * 3),
+                 psnr(alpha_error, texels), encoded_bytes, chain->rgba8_bytes,
+                 (double) chain->rgba8_bytes / (double) encoded_bytes);
+}
+
+// mip generation and bc1/bc3/bc7 encode speed of a full chain, quality of the top level and the bytes an upload
+// saves against rgba8
+int bench_texture_compress(int argc, char **argv) {
+    (void) argc;
+    (void) argv;
+    uint32_t seed = 7;
+    mip_chain_t chains[2] = {
+            {.name = "terrain"},
+            {.name = "sprite"},
+    };
+    void (*fills[2])(uint8_t *, uint32_t *) = {fill_terrain, fill_sprite};
+    size_t scratch_size = (size_t) TEXTURE_SIZE * TEXTURE_SIZE * 8;
+    uint8_t *encoded = SDL_malloc(scratch_size);
+    uint8_t *decoded = SDL_malloc(scratch_size);
+    int result = 0;
+    if (encoded == NULL || decoded == NULL) {
+        result = 1;
+        goto cleanup;
+    }
+    for (int i = 0; i < 2; i++) {
+        if (!build_chain(&chains[i], fills[i], &seed)) {
+            result = 1;
+            goto cleanup;
+        }
+        for (int encoding = TEXTURE_ENCODING_BC1; encoding < TEXTURE_ENCODING_COUNT; encoding++) {
+            bench_encoding(&chains[i], (texture_encoding_t) encoding, encoded, decoded);
+        }
+    }
+
+    cleanup:
+    if (result) {
+        SDL_Log("%s: %s", SUITE, SDL_GetError());
+    }
+    for (int i = 0; i < 2; i++) {
+        SDL_free(chains[i].texels);
+    }
+    SDL_free(encoded);
+    SDL_free(decoded);
+    return result;
+}
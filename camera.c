@@ -0,0 +1,53 @@
+#include "camera.h"
+
+void camera_init(camera_t *camera, float center_x, float center_y, float half_height) {
+    camera->center[0] = center_x;
+    camera->center[1] = center_y;
+    camera->half_height = half_height;
+    camera->aspect = 1.0f;
+}
+
+void camera_set_viewport(camera_t *camera, uint32_t width, uint32_t height) {
+    camera->aspect = height > 0 ? (float) width / (float) height : 1.0f;
+}
+
+void camera_view_rect(const camera_t *camera, float view[4]) {
+    float half_width = camera->half_height * camera->aspect;
+    view[0] = camera->center[0] - half_width;
+    view[1] = camera->center[1] - camera->half_height;
+    view[2] = camera->center[0] + half_width;
+    view[3] = camera->center[1] + camera->half_height;
+}
+
+void camera_uniform_data(const camera_t *camera, camera_uniform *uniform) {
+    uniform->scale[0] = 1.0f / (camera->half_height * camera->aspect);
+    uniform->scale[1] = 1.0f / camera->half_height;
+    uniform->offset[0] = -camera->center[0] * uniform->scale[0];
+    uniform->offset[1] = -camera->center[1] * uniform->scale[1];
+}
+
+void camera_screen_to_world(const camera_t *camera, float screen_x, float screen_y, float width, float height,
+                            float *world_x, float *world_y) {
+    float ndc_x = screen_x / width * 2.0f - 1.0f;
+    float ndc_y = 1.0f - screen_y / height * 2.0f;
+    *world_x = camera->center[0] + ndc_x * camera->half_height * camera->aspect;
+    *world_y = camera->center[1] + ndc_y * camera->half_height;
+}
+
+void camera_pan_pixels(camera_t *camera, float dx, float dy, float height) {
+    float world_per_pixel = 2.0f * camera->half_height / height;
+    camera->center[0] -= dx * world_per_pixel;
+    camera->center[1] += dy * world_per_pixel;
+}
+
+void camera_zoom_at(camera_t *camera, float factor, float screen_x, float screen_y, float width, float height) {
+    float before_x;
+    float before_y;
+    camera_screen_to_world(camera, screen_x, screen_y, width, height, &before_x, &before_y);
+    camera->half_height = SDL_clamp(camera->half_height * factor, CAMERA_MIN_HALF_HEIGHT, CAMERA_MAX_HALF_HEIGHT);
+    float after_x;
+    float after_y;
+    camera_screen_to_world(camera, screen_x, screen_y, width, height, &after_x, &after_y);
+    camera->center[0] += before_x - after_x;
+    camera->center[1] += before_y - after_y;
+}
@@ -0,0 +1,35 @@
+#ifndef KINGDOM_DEFENSE_CAMERA_H
+#define KINGDOM_DEFENSE_CAMERA_H
+
+#include <SDL3/SDL.h>
+
+#include "shader_inputs.h"
+
+#define CAMERA_MIN_HALF_HEIGHT 0.1f
+#define CAMERA_MAX_HALF_HEIGHT 8.0f
+
+// 2d view onto the world, y up. zooming changes how much of the world fits between the top and bottom edge
+typedef struct {
+    float center[2];
+    // world units from the center to the top and bottom edge of the screen
+    float half_height;
+    // screen width over height
+    float aspect;
+} camera_t;
+
+void camera_init(camera_t *camera, float center_x, float center_y, float half_height);
+void camera_set_viewport(camera_t *camera, uint32_t width, uint32_t height);
+
+// the visible world rectangle: min_x, min_y, max_x, max_y
+void camera_view_rect(const camera_t *camera, float view[4]);
+void camera_uniform_data(const camera_t *camera, camera_uniform *uniform);
+
+// screen position in pixels (y down) of a `width` x `height` screen to world position
+void camera_screen_to_world(const camera_t *camera, float screen_x, float screen_y, float width, float height,
+                            float *world_x, float *world_y);
+// moves by a screen space delta in pixels, the world follows the cursor
+void camera_pan_pixels(camera_t *camera, float dx, float dy, float height);
+// `factor` < 1 zooms in. the world position under the screen position stays put
+void camera_zoom_at(camera_t *camera, float factor, float screen_x, float screen_y, float width, float height);
+
+#endif //KINGDOM_DEFENSE_CAMERA_H
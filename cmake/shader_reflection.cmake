@@ -0,0 +1,42 @@
+# Turns the JSON reflection written by `shadercross -d JSON` into shader_reflection.gen.h, one
+# SHADER_REFLECTION(name, samplers, storage_textures, storage_buffers, uniform_buffers) line per shader. compute
+# shaders (*.comp.hlsl) get a COMPUTE_SHADER_REFLECTION(name, samplers, readonly_storage_textures,
+# readonly_storage_buffers, readwrite_storage_textures, readwrite_storage_buffers, uniform_buffers, threadcount_x,
+# threadcount_y, threadcount_z) line instead.
+#
+# usage: cmake -DINPUTS=<a.json|b.json|...> -DOUTPUT=<header> -P shader_reflection.cmake
+
+string(REPLACE "|" ";" INPUTS "${INPUTS}")
+
+set(content "// generated by cmake/shader_reflection.cmake, do not edit\n")
+foreach (INPUT ${INPUTS})
+    file(READ ${INPUT} json)
+    get_filename_component(name ${INPUT} NAME)
+    string(REGEX REPLACE "\\.json$" ".spirv" name ${name})
+
+    if (name MATCHES "\\.comp\\.hlsl\\.spirv$")
+        set(macro COMPUTE_SHADER_REFLECTION)
+        set(keys samplers readonly_storage_textures readonly_storage_buffers readwrite_storage_textures
+                 readwrite_storage_buffers uniform_buffers threadcount_x threadcount_y threadcount_z)
+    else ()
+        set(macro SHADER_REFLECTION)
+        set(keys samplers storage_textures storage_buffers uniform_buffers)
+    endif ()
+
+    set(counts "")
+    foreach (KEY ${keys})
+        # a key shadercross renamed or a truncated file would turn into counts the pipeline can't be created with
+        string(JSON value ERROR_VARIABLE error GET "${json}" ${KEY})
+        if (error)
+            message(FATAL_ERROR "${INPUT}: ${error}")
+        endif ()
+        list(APPEND counts ${value})
+    endforeach ()
+    string(REPLACE ";" ", " counts "${counts}")
+    string(APPEND content "${macro}(\"${name}\", ${counts})\n")
+endforeach ()
+
+# only touch the header when something changed, everything including it would rebuild otherwise
+file(WRITE ${OUTPUT}.tmp "${content}")
+file(COPY_FILE ${OUTPUT}.tmp ${OUTPUT} ONLY_IF_DIFFERENT)
+file(REMOVE ${OUTPUT}.tmp)
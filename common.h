@@ -0,0 +1,23 @@
+#ifndef KINGDOM_DEFENSE_COMMON_H
+#define KINGDOM_DEFENSE_COMMON_H
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#define ARRAY_SIZE(_array) (sizeof(_array) / sizeof(_array[0]))
+
+#define SDL_PRINT_ERROR_AND_EXIT(_err)                \
+    do {                                              \
+        fprintf(stderr, _err ": %s", SDL_GetError()); \
+        exit(-1);                                     \
+    } while (false)
+
+#define CHECK_RET(_bool, _ERR, ...) \
+    do {                    \
+        if (!(_bool)) {\
+            fprintf(stderr, "failed: "_ERR" at %s:%d", ##__VA_ARGS__, __FILE__, __LINE__); \
+            exit(1);\
+        }\
+    } while (false)
+
+#endif //KINGDOM_DEFENSE_COMMON_H
@@ -0,0 +1,159 @@
+#include "entity.h"
+#include "sim_kernels.h"
+
+// component arrays are cache line aligned so the update loops vectorize without peeling
+#define COMPONENT_ALIGNMENT 64
+
+static uint32_t handle_slot(entity_t entity) {
+    return entity & ENTITY_INDEX_MASK;
+}
+
+static uint32_t handle_generation(entity_t entity) {
+    return entity >> ENTITY_INDEX_BITS;
+}
+
+static void *alloc_component(uint32_t capacity, size_t size) {
+    void *mem = SDL_aligned_alloc(COMPONENT_ALIGNMENT, capacity * size);
+    if (mem) {
+        SDL_memset(mem, 0, capacity * size);
+    }
+    return mem;
+}
+
+bool entity_store_init(entity_store_t *store, uint32_t capacity) {
+    SDL_zerop(store);
+    if (capacity == 0 || capacity > ENTITY_MAX_CAPACITY) {
+        return SDL_SetError("entity capacity must be in [1, %u]", ENTITY_MAX_CAPACITY);
+    }
+    sim_kernels_init();
+    store->capacity = capacity;
+    store->handle = alloc_component(capacity, sizeof(entity_t));
+    store->kind = alloc_component(capacity, sizeof(uint8_t));
+    store->pos_x = alloc_component(capacity, sizeof(float));
+    store->pos_y = alloc_component(capacity, sizeof(float));
+    store->prev_x = alloc_component(capacity, sizeof(float));
+    store->prev_y = alloc_component(capacity, sizeof(float));
+    store->vel_x = alloc_component(capacity, sizeof(float));
+    store->vel_y = alloc_component(capacity, sizeof(float));
+    store->health = alloc_component(capacity, sizeof(float));
+    store->path_progress = alloc_component(capacity, sizeof(float));
+    store->target = alloc_component(capacity, sizeof(entity_t));
+    store->dense_index = alloc_component(capacity, sizeof(uint32_t));
+    store->generation = alloc_component(capacity, sizeof(uint16_t));
+    store->free_slots = alloc_component(capacity, sizeof(uint32_t));
+    if (!store->handle || !store->kind || !store->pos_x || !store->pos_y || !store->prev_x || !store->prev_y ||
+        !store->vel_x || !store->vel_y || !store->health || !store->path_progress || !store->target ||
+        !store->dense_index || !store->generation || !store->free_slots) {
+        entity_store_destroy(store);
+        return SDL_OutOfMemory();
+    }
+    entity_store_clear(store);
+    return true;
+}
+
+void entity_store_destroy(entity_store_t *store) {
+    SDL_aligned_free(store->handle);
+    SDL_aligned_free(store->kind);
+    SDL_aligned_free(store->pos_x);
+    SDL_aligned_free(store->pos_y);
+    SDL_aligned_free(store->prev_x);
+    SDL_aligned_free(store->prev_y);
+    SDL_aligned_free(store->vel_x);
+    SDL_aligned_free(store->vel_y);
+    SDL_aligned_free(store->health);
+    SDL_aligned_free(store->path_progress);
+    SDL_aligned_free(store->target);
+    SDL_aligned_free(store->dense_index);
+    SDL_aligned_free(store->generation);
+    SDL_aligned_free(store->free_slots);
+    SDL_zerop(store);
+}
+
+void entity_store_clear(entity_store_t *store) {
+    store->count = 0;
+    store->free_head = 0;
+    store->free_count = store->capacity;
+    for (uint32_t i = 0; i < store->capacity; i++) {
+        store->free_slots[i] = i;
+        store->dense_index[i] = ENTITY_INVALID_INDEX;
+        // handles from before the clear must not resolve again
+        store->generation[i] = (uint16_t) ((store->generation[i] + 1) & ENTITY_GENERATION_MASK);
+        if (store->generation[i] == 0) {
+            store->generation[i] = 1;
+        }
+    }
+}
+
+entity_t entity_spawn(entity_store_t *store, entity_kind_t kind, float x, float y) {
+    if (store->free_count == 0) {
+        return ENTITY_NULL;
+    }
+    uint32_t slot = store->free_slots[store->free_head];
+    store->free_head = (store->free_head + 1) % store->capacity;
+    store->free_count--;
+
+    uint32_t i = store->count++;
+    store->high_water = SDL_max(store->high_water, store->count);
+    entity_t entity = (entity_t) store->generation[slot] << ENTITY_INDEX_BITS | slot;
+    store->dense_index[slot] = i;
+    store->handle[i] = entity;
+    store->kind[i] = (uint8_t) kind;
+    store->pos_x[i] = x;
+    store->pos_y[i] = y;
+    store->prev_x[i] = x;
+    store->prev_y[i] = y;
+    store->vel_x[i] = 0.0f;
+    store->vel_y[i] = 0.0f;
+    store->health[i] = 0.0f;
+    store->path_progress[i] = 0.0f;
+    store->target[i] = ENTITY_NULL;
+    return entity;
+}
+
+uint32_t entity_index(const entity_store_t *store, entity_t entity) {
+    uint32_t slot = handle_slot(entity);
+    if (slot >= store->capacity || store->generation[slot] != handle_generation(entity)) {
+        return ENTITY_INVALID_INDEX;
+    }
+    return store->dense_index[slot];
+}
+
+bool entity_despawn(entity_store_t *store, entity_t entity) {
+    uint32_t i = entity_index(store, entity);
+    if (i == ENTITY_INVALID_INDEX) {
+        return false;
+    }
+    uint32_t slot = handle_slot(entity);
+
+    // swap remove, the last entity fills the hole so [0, count) stays dense
+    uint32_t last = --store->count;
+    if (i != last) {
+        store->handle[i] = store->handle[last];
+        store->kind[i] = store->kind[last];
+        store->pos_x[i] = store->pos_x[last];
+        store->pos_y[i] = store->pos_y[last];
+        store->prev_x[i] = store->prev_x[last];
+        store->prev_y[i] = store->prev_y[last];
+        store->vel_x[i] = store->vel_x[last];
+        store->vel_y[i] = store->vel_y[last];
+        store->health[i] = store->health[last];
+        store->path_progress[i] = store->path_progress[last];
+        store->target[i] = store->target[last];
+        store->dense_index[handle_slot(store->handle[i])] = i;
+    }
+
+    store->dense_index[slot] = ENTITY_INVALID_INDEX;
+    uint16_t generation = (uint16_t) ((store->generation[slot] + 1) & ENTITY_GENERATION_MASK);
+    store->generation[slot] = generation ? generation : 1;
+    store->free_slots[(store->free_head + store->free_count) % store->capacity] = slot;
+    store->free_count++;
+    return true;
+}
+
+void entity_store_integrate(entity_store_t *store, float dt) {
+    entity_store_integrate_range(store, 0, store->count, dt);
+}
+
+void entity_store_integrate_range(entity_store_t *store, uint32_t begin, uint32_t end, float dt) {
+    sim_kernels_integrate(store, begin, end, dt);
+}
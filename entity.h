@@ -0,0 +1,77 @@
+#ifndef KINGDOM_DEFENSE_ENTITY_H
+#define KINGDOM_DEFENSE_ENTITY_H
+
+#include <SDL3/SDL.h>
+
+// handles are (generation << ENTITY_INDEX_BITS | slot). a slot's generation is bumped every time its entity is
+// despawned, so stale handles stop resolving instead of silently pointing at whatever reused the slot
+#define ENTITY_INDEX_BITS 20
+#define ENTITY_INDEX_MASK ((1u << ENTITY_INDEX_BITS) - 1)
+#define ENTITY_GENERATION_MASK ((1u << (32 - ENTITY_INDEX_BITS)) - 1)
+#define ENTITY_MAX_CAPACITY (1u << ENTITY_INDEX_BITS)
+// generation 0 is never handed out, so a zeroed handle is always dead
+#define ENTITY_NULL 0u
+#define ENTITY_INVALID_INDEX UINT32_MAX
+
+typedef uint32_t entity_t;
+
+typedef enum {
+    ENTITY_KIND_ENEMY,
+    ENTITY_KIND_TOWER,
+    ENTITY_KIND_PROJECTILE,
+    ENTITY_KIND_COUNT,
+} entity_kind_t;
+
+// structure of arrays, entry i of every component array belongs to the same entity. live entities are always
+// packed into [0, count), despawning moves the last entity into the hole
+typedef struct {
+    uint32_t count;
+    uint32_t capacity;
+    // most entities alive at once since init, what the capacity has to cover
+    uint32_t high_water;
+
+    // dense, indexed 0..count-1
+    entity_t *handle;
+    uint8_t *kind;
+    float *pos_x;
+    float *pos_y;
+    // position before the last entity_store_integrate, for render interpolation
+    float *prev_x;
+    float *prev_y;
+    float *vel_x;
+    float *vel_y;
+    float *health;
+    float *path_progress;
+    entity_t *target;
+
+    // sparse, indexed by slot
+    uint32_t *dense_index;
+    uint16_t *generation;
+    // fifo of free slots, so a slot is reused as late as possible and generations wrap slowly
+    uint32_t *free_slots;
+    uint32_t free_head;
+    uint32_t free_count;
+} entity_store_t;
+
+// everything is allocated up front, spawning and despawning never allocate
+bool entity_store_init(entity_store_t *store, uint32_t capacity);
+void entity_store_destroy(entity_store_t *store);
+void entity_store_clear(entity_store_t *store);
+
+// returns ENTITY_NULL when the store is full. components other than kind and position start zeroed
+entity_t entity_spawn(entity_store_t *store, entity_kind_t kind, float x, float y);
+// returns false if the handle was already dead
+bool entity_despawn(entity_store_t *store, entity_t entity);
+// dense index of a live entity, ENTITY_INVALID_INDEX for dead or stale handles. only valid until the next despawn
+uint32_t entity_index(const entity_store_t *store, entity_t entity);
+
+static inline bool entity_alive(const entity_store_t *store, entity_t entity) {
+    return entity_index(store, entity) != ENTITY_INVALID_INDEX;
+}
+
+// prev = pos, pos += vel * dt over every live entity
+void entity_store_integrate(entity_store_t *store, float dt);
+// the same over dense indices [begin, end), disjoint ranges can run on different threads
+void entity_store_integrate_range(entity_store_t *store, uint32_t begin, uint32_t end, float dt);
+
+#endif //KINGDOM_DEFENSE_ENTITY_H
@@ -0,0 +1,342 @@
+#include "flow_field.h"
+
+// orthogonal directions first, so ties prefer them over diagonals
+static const int8_t direction_dx[8] = {1, 0, -1, 0, 1, -1, -1, 1};
+static const int8_t direction_dy[8] = {0, 1, 0, -1, 1, 1, -1, -1};
+#define DIAGONAL 0.70710678f
+const float flow_field_direction_x[8] = {1.0f, 0.0f, -1.0f, 0.0f, DIAGONAL, -DIAGONAL, -DIAGONAL, DIAGONAL};
+const float flow_field_direction_y[8] = {0.0f, 1.0f, 0.0f, -1.0f, DIAGONAL, DIAGONAL, -DIAGONAL, -DIAGONAL};
+
+bool flow_field_init(flow_field_t *field, uint32_t width, uint32_t height, uint32_t goal_x, uint32_t goal_y) {
+    SDL_zerop(field);
+    // a 4-connected shortest path can not get longer than the grid has cells, which keeps costs in 16 bits
+    if (width == 0 || height == 0 || width * height > FLOW_FIELD_UNREACHABLE + 1u) {
+        return SDL_SetError("flow field size %ux%u out of range", width, height);
+    }
+    if (goal_x >= width || goal_y >= height) {
+        return SDL_SetError("flow field goal outside of the grid");
+    }
+    field->width = width;
+    field->height = height;
+    field->stride = width + 2;
+    field->cells = field->stride * (height + 2);
+    for (int d = 0; d < 8; d++) {
+        field->neighbour_offset[d] = direction_dx[d] + direction_dy[d] * (int32_t) field->stride;
+    }
+    field->goal = flow_field_cell(field, goal_x, goal_y);
+
+    uint32_t cells = field->cells;
+    field->blocked = SDL_calloc(cells, sizeof(uint8_t));
+    field->cost = SDL_calloc(cells, sizeof(uint16_t));
+    field->direction = SDL_calloc(cells, sizeof(uint8_t));
+    field->queue = SDL_calloc(cells, sizeof(flow_node_t));
+    field->seeds = SDL_calloc(cells, sizeof(flow_node_t));
+    // every invalidated cell queues at most its 4 neighbours, plus the ones around the blocked cell
+    field->worklist = SDL_calloc(cells * 4 + 4, sizeof(uint32_t));
+    field->affected = SDL_calloc(cells, sizeof(uint32_t));
+    field->touched = SDL_calloc(cells, sizeof(uint32_t));
+    field->stamp = SDL_calloc(cells, sizeof(uint32_t));
+    if (!field->blocked || !field->cost || !field->direction || !field->queue || !field->seeds || !field->worklist ||
+        !field->affected || !field->touched || !field->stamp) {
+        flow_field_destroy(field);
+        return false;
+    }
+
+    // the border is a wall nothing can remove
+    SDL_memset(field->blocked, 1, cells);
+    for (uint32_t y = 0; y < height; y++) {
+        SDL_memset(&field->blocked[flow_field_cell(field, 0, y)], 0, width);
+    }
+    SDL_memset(field->direction, FLOW_FIELD_NO_DIRECTION, cells);
+    flow_field_rebuild(field);
+    return true;
+}
+
+void flow_field_destroy(flow_field_t *field) {
+    SDL_free(field->blocked);
+    SDL_free(field->cost);
+    SDL_free(field->direction);
+    SDL_free(field->queue);
+    SDL_free(field->seeds);
+    SDL_free(field->worklist);
+    SDL_free(field->affected);
+    SDL_free(field->touched);
+    SDL_free(field->stamp);
+    SDL_zerop(field);
+}
+
+bool flow_field_add_spawn(flow_field_t *field, uint32_t x, uint32_t y) {
+    if (x >= field->width || y >= field->height) {
+        return SDL_SetError("spawn outside of the grid");
+    }
+    if (field->num_spawns == FLOW_FIELD_MAX_SPAWNS) {
+        return SDL_SetError("too many spawns");
+    }
+    field->spawns[field->num_spawns++] = flow_field_cell(field, x, y);
+    return true;
+}
+
+// blocked cells always cost FLOW_FIELD_UNREACHABLE, so they never win the minimum and need no separate check
+static inline void update_direction(flow_field_t *field, uint32_t cell) {
+    const uint16_t *cost = field->cost;
+    const uint8_t *blocked = field->blocked;
+    const int32_t *offset = field->neighbour_offset;
+    uint32_t best = cost[cell];
+    uint32_t best_direction = FLOW_FIELD_NO_DIRECTION;
+    if (best == FLOW_FIELD_UNREACHABLE || cell == field->goal) {
+        field->direction[cell] = FLOW_FIELD_NO_DIRECTION;
+        return;
+    }
+    for (uint32_t d = 0; d < 4; d++) {
+        uint32_t c = cost[cell + offset[d]];
+        best_direction = c < best ? d : best_direction;
+        best = c < best ? c : best;
+    }
+    // no cutting corners past a blocked cell, diagonal d is made of orthogonals d - 4 and (d - 3) % 4
+    for (uint32_t d = 4; d < 8; d++) {
+        uint32_t c = cost[cell + offset[d]];
+        c = blocked[cell + offset[d - 4]] | blocked[cell + offset[(d - 3) % 4]] ? FLOW_FIELD_UNREACHABLE : c;
+        best_direction = c < best ? d : best_direction;
+        best = c < best ? c : best;
+    }
+    field->direction[cell] = (uint8_t) best_direction;
+}
+
+static void touch(flow_field_t *field, uint32_t cell) {
+    if (field->stamp[cell] != field->epoch) {
+        field->stamp[cell] = field->epoch;
+        field->touched[field->num_touched++] = cell;
+    }
+}
+
+static void next_epoch(flow_field_t *field) {
+    if (++field->epoch == 0) {
+        SDL_memset(field->stamp, 0, field->cells * sizeof(uint32_t));
+        field->epoch = 1;
+    }
+}
+
+// directions depend on the costs and blocked state of all 8 neighbours, so they are refreshed around every cell
+// that changed
+static void refresh_directions(flow_field_t *field) {
+    next_epoch(field);
+    for (uint32_t i = 0; i < field->num_touched; i++) {
+        uint32_t cell = field->touched[i];
+        for (int d = -1; d < 8; d++) {
+            uint32_t neighbour = d < 0 ? cell : cell + field->neighbour_offset[d];
+            if (field->stamp[neighbour] != field->epoch) {
+                field->stamp[neighbour] = field->epoch;
+                update_direction(field, neighbour);
+            }
+        }
+    }
+}
+
+// relaxes outwards from the queued cells. unit edge costs keep the fifo sorted, `seeds` are extra start nodes
+// already sorted by cost that get merged in as the fifo catches up with them
+static void propagate(flow_field_t *field, uint32_t head, uint32_t tail, uint32_t num_seeds) {
+    flow_node_t *queue = field->queue;
+    uint16_t *cost = field->cost;
+    const uint8_t *blocked = field->blocked;
+    const int32_t *offset = field->neighbour_offset;
+    uint32_t next_seed = 0;
+    while (head < tail || next_seed < num_seeds) {
+        flow_node_t node;
+        if (next_seed < num_seeds && (head == tail || field->seeds[next_seed].cost <= queue[head].cost)) {
+            node = field->seeds[next_seed++];
+        } else {
+            node = queue[head++];
+        }
+        if (cost[node.cell] != node.cost) {
+            // lowered again after this node was queued
+            continue;
+        }
+        for (int d = 0; d < 4; d++) {
+            uint32_t neighbour = node.cell + offset[d];
+            if (!blocked[neighbour] && node.cost + 1 < cost[neighbour]) {
+                cost[neighbour] = (uint16_t) (node.cost + 1);
+                queue[tail++] = (flow_node_t) {node.cost + 1, neighbour};
+                touch(field, neighbour);
+            }
+        }
+    }
+}
+
+void flow_field_rebuild(flow_field_t *field) {
+    SDL_memset(field->cost, 0xFF, field->cells * sizeof(uint16_t));
+    field->num_touched = 0;
+    next_epoch(field);
+    uint32_t tail = 0;
+    if (!field->blocked[field->goal]) {
+        field->cost[field->goal] = 0;
+        field->queue[tail++] = (flow_node_t) {0, field->goal};
+    }
+    propagate(field, 0, tail, 0);
+    for (uint32_t y = 0; y < field->height; y++) {
+        uint32_t row = flow_field_cell(field, 0, y);
+        for (uint32_t x = 0; x < field->width; x++) {
+            update_direction(field, row + x);
+        }
+    }
+    field->stats.last_cells = field->width * field->height;
+    field->stats.rebuilds++;
+}
+
+static int compare_nodes(const void *a, const void *b) {
+    const flow_node_t *na = a;
+    const flow_node_t *nb = b;
+    return (na->cost > nb->cost) - (na->cost < nb->cost);
+}
+
+// costs can only grow. first every cell that loses its last neighbour one step closer to the goal is invalidated,
+// recursively, then the invalidated region is refilled from its still valid border
+static void block_cell(flow_field_t *field, uint32_t cell) {
+    uint16_t *cost = field->cost;
+    const int32_t *offset = field->neighbour_offset;
+    uint32_t old_cost = cost[cell];
+    field->blocked[cell] = 1;
+    cost[cell] = FLOW_FIELD_UNREACHABLE;
+    touch(field, cell);
+    if (old_cost == FLOW_FIELD_UNREACHABLE) {
+        return;
+    }
+
+    uint32_t num_work = 0;
+    for (int d = 0; d < 4; d++) {
+        if (cost[cell + offset[d]] == old_cost + 1) {
+            field->worklist[num_work++] = cell + offset[d];
+        }
+    }
+
+    uint32_t num_affected = 0;
+    while (num_work > 0) {
+        uint32_t u = field->worklist[--num_work];
+        uint32_t u_cost = cost[u];
+        if (u_cost == FLOW_FIELD_UNREACHABLE || u == field->goal) {
+            continue;
+        }
+        bool supported = false;
+        for (int d = 0; d < 4 && !supported; d++) {
+            supported = cost[u + offset[d]] + 1u == u_cost;
+        }
+        if (supported) {
+            continue;
+        }
+        cost[u] = FLOW_FIELD_UNREACHABLE;
+        field->affected[num_affected++] = u;
+        touch(field, u);
+        for (int d = 0; d < 4; d++) {
+            if (cost[u + offset[d]] == u_cost + 1) {
+                field->worklist[num_work++] = u + offset[d];
+            }
+        }
+    }
+
+    uint32_t num_seeds = 0;
+    for (uint32_t a = 0; a < num_affected; a++) {
+        uint32_t u = field->affected[a];
+        uint32_t best = FLOW_FIELD_UNREACHABLE;
+        for (int d = 0; d < 4; d++) {
+            // blocked cells are always unreachable, no need to check them separately
+            best = SDL_min(best, cost[u + offset[d]] + 1u);
+        }
+        if (best < FLOW_FIELD_UNREACHABLE) {
+            cost[u] = (uint16_t) best;
+            field->seeds[num_seeds++] = (flow_node_t) {best, u};
+        }
+    }
+    SDL_qsort(field->seeds, num_seeds, sizeof(flow_node_t), compare_nodes);
+    propagate(field, 0, 0, num_seeds);
+}
+
+// costs can only shrink, a plain wave out of the freed cell finds every cell that improves
+static void unblock_cell(flow_field_t *field, uint32_t cell) {
+    field->blocked[cell] = 0;
+    touch(field, cell);
+    uint32_t best = cell == field->goal ? 0 : FLOW_FIELD_UNREACHABLE;
+    for (int d = 0; d < 4; d++) {
+        best = SDL_min(best, field->cost[cell + field->neighbour_offset[d]] + 1u);
+    }
+    if (best >= FLOW_FIELD_UNREACHABLE) {
+        field->cost[cell] = FLOW_FIELD_UNREACHABLE;
+        return;
+    }
+    field->cost[cell] = (uint16_t) best;
+    field->queue[0] = (flow_node_t) {best, cell};
+    propagate(field, 0, 1, 0);
+}
+
+void flow_field_set_blocked(flow_field_t *field, uint32_t x, uint32_t y, bool blocked) {
+    if (x >= field->width || y >= field->height) {
+        return;
+    }
+    uint32_t cell = flow_field_cell(field, x, y);
+    if ((field->blocked[cell] != 0) == blocked) {
+        return;
+    }
+    field->num_touched = 0;
+    next_epoch(field);
+    if (blocked) {
+        block_cell(field, cell);
+    } else {
+        unblock_cell(field, cell);
+    }
+    refresh_directions(field);
+    field->stats.last_cells = field->num_touched;
+    field->stats.updates++;
+}
+
+static uint64_t reachable_spawns(const flow_field_t *field) {
+    uint64_t mask = 0;
+    for (uint32_t i = 0; i < field->num_spawns; i++) {
+        if (field->cost[field->spawns[i]] != FLOW_FIELD_UNREACHABLE) {
+            mask |= 1ull << i;
+        }
+    }
+    return mask;
+}
+
+bool flow_field_place_tower(flow_field_t *field, uint32_t x, uint32_t y) {
+    if (x >= field->width || y >= field->height) {
+        return SDL_SetError("tower outside of the grid");
+    }
+    uint32_t cell = flow_field_cell(field, x, y);
+    if (field->blocked[cell] || cell == field->goal) {
+        return SDL_SetError("cell is not free");
+    }
+    for (uint32_t i = 0; i < field->num_spawns; i++) {
+        if (field->spawns[i] == cell) {
+            return SDL_SetError("cell is a spawn");
+        }
+    }
+
+    // try it and undo if a spawn got cut off, both directions are incremental so this stays local
+    uint64_t before = reachable_spawns(field);
+    flow_field_set_blocked(field, x, y, true);
+    if ((reachable_spawns(field) & before) != before) {
+        flow_field_set_blocked(field, x, y, false);
+        return SDL_SetError("tower would block the path");
+    }
+    return true;
+}
+
+bool flow_field_remove_tower(flow_field_t *field, uint32_t x, uint32_t y) {
+    if (x >= field->width || y >= field->height || !field->blocked[flow_field_cell(field, x, y)]) {
+        return SDL_SetError("no tower at %u,%u", x, y);
+    }
+    flow_field_set_blocked(field, x, y, false);
+    return true;
+}
+
+bool flow_field_sample(const flow_field_t *field, uint32_t x, uint32_t y, float *dx, float *dy) {
+    if (x >= field->width || y >= field->height) {
+        return false;
+    }
+    uint8_t direction = field->direction[flow_field_cell(field, x, y)];
+    if (direction == FLOW_FIELD_NO_DIRECTION) {
+        return false;
+    }
+    *dx = flow_field_direction_x[direction];
+    *dy = flow_field_direction_y[direction];
+    return true;
+}
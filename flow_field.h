@@ -0,0 +1,83 @@
+#ifndef KINGDOM_DEFENSE_FLOW_FIELD_H
+#define KINGDOM_DEFENSE_FLOW_FIELD_H
+
+#include <SDL3/SDL.h>
+
+#define FLOW_FIELD_UNREACHABLE UINT16_MAX
+#define FLOW_FIELD_NO_DIRECTION 0xFF
+#define FLOW_FIELD_MAX_SPAWNS 64
+
+// unit vectors of the 8 neighbour directions, indexed by the values of flow_field_t.direction
+extern const float flow_field_direction_x[8];
+extern const float flow_field_direction_y[8];
+
+// (cost, cell) pair of the repair queues
+typedef struct {
+    uint32_t cost;
+    uint32_t cell;
+} flow_node_t;
+
+typedef struct {
+    uint64_t rebuilds;
+    uint64_t updates;
+    // cells whose cost changed in the last rebuild or update
+    uint32_t last_cells;
+} flow_field_stats_t;
+
+// shortest path costs towards one goal cell for the whole grid (the integration field) and, derived from it, the
+// direction every cell should move in. enemies only ever sample `direction`, so thousands of them cost the same
+// as one. the arrays carry a one cell blocked border so neighbour lookups need no bounds checks, index them with
+// flow_field_cell
+typedef struct {
+    uint32_t width;
+    uint32_t height;
+    // row pitch of the padded arrays, width + 2
+    uint32_t stride;
+    uint32_t cells;
+    int32_t neighbour_offset[8];
+    uint32_t goal;
+    uint8_t *blocked;
+    // 4-connected step count to the goal, FLOW_FIELD_UNREACHABLE for blocked or walled in cells
+    uint16_t *cost;
+    // index into the 8 neighbour directions, FLOW_FIELD_NO_DIRECTION at the goal and where there is no path
+    uint8_t *direction;
+
+    // cells that must stay connected to the goal when towers are placed
+    uint32_t spawns[FLOW_FIELD_MAX_SPAWNS];
+    uint32_t num_spawns;
+
+    // scratch for incremental updates, sized for the whole grid so updates never allocate
+    flow_node_t *queue;
+    flow_node_t *seeds;
+    uint32_t *worklist;
+    uint32_t *affected;
+    uint32_t *touched;
+    uint32_t num_touched;
+    uint32_t *stamp;
+    uint32_t epoch;
+
+    flow_field_stats_t stats;
+} flow_field_t;
+
+static inline uint32_t flow_field_cell(const flow_field_t *field, uint32_t x, uint32_t y) {
+    return (y + 1) * field->stride + x + 1;
+}
+
+bool flow_field_init(flow_field_t *field, uint32_t width, uint32_t height, uint32_t goal_x, uint32_t goal_y);
+void flow_field_destroy(flow_field_t *field);
+bool flow_field_add_spawn(flow_field_t *field, uint32_t x, uint32_t y);
+
+// recomputes everything from the goal, O(cells)
+void flow_field_rebuild(flow_field_t *field);
+// blocks or unblocks one cell and only repairs the cells whose cost depends on it
+void flow_field_set_blocked(flow_field_t *field, uint32_t x, uint32_t y, bool blocked);
+
+// blocks the cell unless that would cut a reachable spawn off from the goal, in which case the field is left
+// unchanged and false is returned
+bool flow_field_place_tower(flow_field_t *field, uint32_t x, uint32_t y);
+bool flow_field_remove_tower(flow_field_t *field, uint32_t x, uint32_t y);
+
+// unit direction to move in from cell (x, y), false at the goal, off the grid or where there is no path
+bool flow_field_sample(const flow_field_t *field, uint32_t x, uint32_t y, float *dx, float *dy);
+
+#endif //KINGDOM_DEFENSE_FLOW_FIELD_H
@@ -0,0 +1,63 @@
+#include "frame_pacer.h"
+
+void frame_pacer_init(frame_pacer_t *pacer, uint32_t fps_cap) {
+    SDL_zerop(pacer);
+    frame_pacer_set_cap(pacer, fps_cap);
+    // the first frame always renders
+    pacer->pending_frames = FRAME_PACER_SETTLE_FRAMES;
+}
+
+void frame_pacer_set_cap(frame_pacer_t *pacer, uint32_t fps_cap) {
+    pacer->min_frame_ns = fps_cap > 0 ? SDL_NS_PER_SECOND / fps_cap : 0;
+}
+
+void frame_pacer_request(frame_pacer_t *pacer) {
+    pacer->pending_frames = FRAME_PACER_SETTLE_FRAMES;
+}
+
+void frame_pacer_wait(frame_pacer_t *pacer, bool on_demand, uint64_t deadline_ns) {
+    uint64_t now_ns = SDL_GetTicksNS();
+    if (on_demand && pacer->pending_frames == 0) {
+        // blocked in the os until there is input, no polling
+        Sint32 timeout_ms = -1;
+        if (deadline_ns != 0) {
+            uint64_t remaining_ns = deadline_ns > now_ns ? deadline_ns - now_ns : 0;
+            timeout_ms = (Sint32) SDL_min((remaining_ns + SDL_NS_PER_MS - 1) / SDL_NS_PER_MS, SDL_MAX_SINT32);
+        }
+        SDL_WaitEventTimeout(NULL, timeout_ms);
+        pacer->stats.waits++;
+        pacer->stats.last_wait_ns = SDL_GetTicksNS() - now_ns;
+        pacer->slot_ns = SDL_GetTicksNS();
+        return;
+    }
+
+    uint64_t next_ns = pacer->slot_ns + pacer->min_frame_ns;
+    if (pacer->min_frame_ns == 0 || next_ns <= now_ns) {
+        // behind by a whole slot or more: start over from now instead of rendering the missed frames back to back
+        pacer->slot_ns = now_ns;
+        pacer->stats.last_wait_ns = 0;
+        return;
+    }
+    // sleeps most of it and spins the last bit, a plain SDL_Delay overshoots by up to a scheduler tick
+    SDL_DelayPrecise(next_ns - now_ns);
+    pacer->slot_ns = next_ns;
+    pacer->stats.waits++;
+    pacer->stats.last_wait_ns = next_ns - now_ns;
+}
+
+bool frame_pacer_should_render(frame_pacer_t *pacer, bool on_demand) {
+    if (on_demand && pacer->pending_frames == 0) {
+        pacer->stats.skipped_frames++;
+        return false;
+    }
+    if (pacer->pending_frames > 0) {
+        pacer->pending_frames--;
+    }
+    pacer->stats.rendered_frames++;
+    return true;
+}
+
+void frame_pacer_skip(frame_pacer_t *pacer) {
+    pacer->pending_frames = 0;
+    pacer->stats.skipped_frames++;
+}
@@ -0,0 +1,46 @@
+#ifndef KINGDOM_DEFENSE_FRAME_PACER_H
+#define KINGDOM_DEFENSE_FRAME_PACER_H
+
+#include <SDL3/SDL.h>
+
+// frames rendered after every request in on demand mode, imgui needs a couple to settle after input
+#define FRAME_PACER_SETTLE_FRAMES 3
+
+typedef struct {
+    uint64_t rendered_frames;
+    // loop iterations that found nothing to draw
+    uint64_t skipped_frames;
+    // times frame_pacer_wait gave the cpu away, and for how long the last time
+    uint64_t waits;
+    uint64_t last_wait_ns;
+} frame_pacer_stats_t;
+
+// decides when the main loop runs and whether it renders. the running game renders every iteration, no faster
+// than the cap. on demand (paused, minimized) the loop blocks in the event queue and only renders after
+// something asked for a frame: input, a sim step or a deadline the caller passes in
+typedef struct {
+    // 0 without a cap
+    uint64_t min_frame_ns;
+    // start of the frame slot frame_pacer_wait last released
+    uint64_t slot_ns;
+    uint32_t pending_frames;
+
+    frame_pacer_stats_t stats;
+} frame_pacer_t;
+
+// `fps_cap` 0 renders as fast as the swapchain allows
+void frame_pacer_init(frame_pacer_t *pacer, uint32_t fps_cap);
+void frame_pacer_set_cap(frame_pacer_t *pacer, uint32_t fps_cap);
+
+// something on screen changed, the next FRAME_PACER_SETTLE_FRAMES on demand iterations render
+void frame_pacer_request(frame_pacer_t *pacer);
+// blocks until the next iteration is due. continuous: sleeps out the rest of the cap's frame slot. on demand
+// with no frame pending: until an event arrives or `deadline_ns` (SDL_GetTicksNS time, 0 for none) passes
+void frame_pacer_wait(frame_pacer_t *pacer, bool on_demand, uint64_t deadline_ns);
+// whether this iteration renders, counts it either way
+bool frame_pacer_should_render(frame_pacer_t *pacer, bool on_demand);
+// this iteration doesn't render whatever was requested, e.g. minimized. drops the pending frames so the next
+// frame_pacer_wait blocks again
+void frame_pacer_skip(frame_pacer_t *pacer);
+
+#endif //KINGDOM_DEFENSE_FRAME_PACER_H
@@ -0,0 +1,86 @@
+#include "frame_ring.h"
+
+static void frame_completed(frame_ring_t *ring, frame_context_t *frame) {
+    if (frame->submit_ns != 0) {
+        ring->last_gpu_ns = SDL_GetTicksNS() - frame->submit_ns;
+        frame->submit_ns = 0;
+    }
+}
+
+static void wait_frame(frame_ring_t *ring, frame_context_t *frame) {
+    if (frame->fence == NULL) {
+        return;
+    }
+    SDL_WaitForGPUFences(ring->device, true, &frame->fence, 1);
+    frame_completed(ring, frame);
+    SDL_ReleaseGPUFence(ring->device, frame->fence);
+    frame->fence = NULL;
+}
+
+static void wait_all(frame_ring_t *ring) {
+    for (uint32_t i = 0; i < FRAME_RING_MAX_FRAMES; i++) {
+        wait_frame(ring, &ring->frames[i]);
+    }
+}
+
+static bool apply_frames_in_flight(frame_ring_t *ring, uint32_t frames_in_flight) {
+    if (frames_in_flight == ring->frames_in_flight) {
+        return true;
+    }
+    // contexts are about to be reassigned, nothing can be in flight while that happens
+    wait_all(ring);
+    ring->frames_in_flight = frames_in_flight;
+    ring->current = 0;
+    // keep the swapchain from queueing more frames than we do
+    return SDL_SetGPUAllowedFramesInFlight(ring->device, frames_in_flight);
+}
+
+bool frame_ring_init(frame_ring_t *ring, SDL_GPUDevice *device, SDL_GPUGraphicsPipeline *sprite_pipeline,
+                     uint32_t frames_in_flight) {
+    SDL_zerop(ring);
+    ring->device = device;
+    for (uint32_t i = 0; i < FRAME_RING_MAX_FRAMES; i++) {
+        if (!sprite_batch_init(&ring->frames[i].sprite_batch, device, sprite_pipeline, 1024)) {
+            return false;
+        }
+    }
+    ring->requested_frames_in_flight = SDL_clamp(frames_in_flight, 1, FRAME_RING_MAX_FRAMES);
+    return apply_frames_in_flight(ring, ring->requested_frames_in_flight);
+}
+
+void frame_ring_destroy(frame_ring_t *ring) {
+    wait_all(ring);
+    for (uint32_t i = 0; i < FRAME_RING_MAX_FRAMES; i++) {
+        sprite_batch_destroy(&ring->frames[i].sprite_batch);
+    }
+    SDL_zerop(ring);
+}
+
+void frame_ring_set_frames_in_flight(frame_ring_t *ring, uint32_t frames_in_flight) {
+    // applied by the next frame_ring_begin, the current frame keeps the context it already has
+    ring->requested_frames_in_flight = SDL_clamp(frames_in_flight, 1, FRAME_RING_MAX_FRAMES);
+}
+
+frame_context_t *frame_ring_begin(frame_ring_t *ring) {
+    apply_frames_in_flight(ring, ring->requested_frames_in_flight);
+    // oldest first so last_gpu_ns ends up with the newest frame that finished
+    for (uint32_t i = 0; i < ring->frames_in_flight; i++) {
+        frame_context_t *other = &ring->frames[(ring->current + i) % ring->frames_in_flight];
+        if (other->fence != NULL && other->submit_ns != 0 && SDL_QueryGPUFence(ring->device, other->fence)) {
+            frame_completed(ring, other);
+        }
+    }
+    frame_context_t *frame = &ring->frames[ring->current];
+    uint64_t start = SDL_GetTicksNS();
+    wait_frame(ring, frame);
+    ring->last_wait_ns = SDL_GetTicksNS() - start;
+    frame->frame_index = ring->frame_index;
+    return frame;
+}
+
+void frame_ring_end(frame_ring_t *ring, SDL_GPUFence *fence) {
+    ring->frames[ring->current].fence = fence;
+    ring->frames[ring->current].submit_ns = fence != NULL ? SDL_GetTicksNS() : 0;
+    ring->current = (ring->current + 1) % ring->frames_in_flight;
+    ring->frame_index++;
+}
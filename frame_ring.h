@@ -0,0 +1,47 @@
+#ifndef KINGDOM_DEFENSE_FRAME_RING_H
+#define KINGDOM_DEFENSE_FRAME_RING_H
+
+#include <SDL3/SDL.h>
+
+#include "sprite_batch.h"
+
+#define FRAME_RING_MAX_FRAMES 3
+#define FRAME_RING_DEFAULT_FRAMES 2
+
+// everything a frame writes while the gpu may still be reading an older frame
+typedef struct {
+    SDL_GPUFence *fence;
+    uint64_t frame_index;
+    // when the frame was submitted, 0 once its fence has been seen signaled
+    uint64_t submit_ns;
+    sprite_batch_t sprite_batch;
+} frame_context_t;
+
+typedef struct {
+    SDL_GPUDevice *device;
+    frame_context_t frames[FRAME_RING_MAX_FRAMES];
+    uint32_t frames_in_flight;
+    uint32_t requested_frames_in_flight;
+    uint32_t current;
+    uint64_t frame_index;
+    // time the cpu spent blocked on the fence in the last frame_ring_begin
+    uint64_t last_wait_ns;
+    // submit to fence signaled of the most recently completed frame. sdl_gpu has no timestamp queries, so this is
+    // the closest to gpu frame time we get, fences are polled once per frame_ring_begin
+    uint64_t last_gpu_ns;
+} frame_ring_t;
+
+bool frame_ring_init(frame_ring_t *ring, SDL_GPUDevice *device, SDL_GPUGraphicsPipeline *sprite_pipeline,
+                     uint32_t frames_in_flight);
+void frame_ring_destroy(frame_ring_t *ring);
+
+// 1 is the lowest latency (cpu and gpu never overlap), FRAME_RING_MAX_FRAMES the highest throughput.
+// takes effect on the next frame_ring_begin
+void frame_ring_set_frames_in_flight(frame_ring_t *ring, uint32_t frames_in_flight);
+
+// returns the next context, only blocks if the gpu has not finished the frame that last used it
+frame_context_t *frame_ring_begin(frame_ring_t *ring);
+// hands the fence of the submitted frame to the current context, NULL if the frame was not submitted
+void frame_ring_end(frame_ring_t *ring, SDL_GPUFence *fence);
+
+#endif //KINGDOM_DEFENSE_FRAME_RING_H
@@ -0,0 +1,312 @@
+#include "game_state.h"
+#include "sim_kernels.h"
+
+static float wrap_angle(float angle) {
+    if (angle >= 2.0f * SDL_PI_F) {
+        angle -= 2.0f * SDL_PI_F;
+    } else if (angle < 0.0f) {
+        angle += 2.0f * SDL_PI_F;
+    }
+    return angle;
+}
+
+static uint32_t world_to_tile(float p) {
+    // negative values wrap to huge ones and fall off the grid like everything else out of range
+    return (uint32_t) (int32_t) SDL_floorf((p + 1.0f) * 0.5f * GAME_STATE_MAP_SIZE);
+}
+
+static float tile_to_world(uint32_t tile) {
+    return ((float) tile + 0.5f) * (2.0f / GAME_STATE_MAP_SIZE) - 1.0f;
+}
+
+static uint32_t next_random(game_state_t *state) {
+    uint32_t x = state->rng;
+    x ^= x << 13;
+    x ^= x >> 17;
+    x ^= x << 5;
+    state->rng = x;
+    return x;
+}
+
+bool game_state_init(game_state_t *state, uint32_t seed, job_system_t *jobs) {
+    SDL_zerop(state);
+    state->jobs = jobs;
+    // xorshift never leaves 0
+    state->rng = seed ? seed : 0x9e3779b9u;
+    state->query_result = SDL_malloc(GAME_STATE_MAX_ENTITIES * sizeof(uint32_t));
+    state->query_t = SDL_malloc(GAME_STATE_MAX_ENTITIES * sizeof(float));
+    state->expired = SDL_malloc(GAME_STATE_MAX_ENTITIES * sizeof(uint8_t));
+    // cells about the tower range, the margin keeps enemies that overshoot the map edge out of the border cells
+    if (state->query_result == NULL || state->query_t == NULL || state->expired == NULL ||
+        !entity_store_init(&state->entities, GAME_STATE_MAX_ENTITIES) ||
+        !flow_field_init(&state->flow_field, GAME_STATE_MAP_SIZE, GAME_STATE_MAP_SIZE, GAME_STATE_MAP_SIZE - 1,
+                         GAME_STATE_MAP_SIZE / 2) ||
+        !spatial_hash_init(&state->enemy_grid, -1.5f, -1.5f, 1.5f, 1.5f, 0.125f, GAME_STATE_MAX_ENTITIES)) {
+        game_state_destroy(state);
+        return false;
+    }
+    for (uint32_t y = 0; y < GAME_STATE_MAP_SIZE; y += 4) {
+        flow_field_add_spawn(&state->flow_field, 0, y);
+    }
+    for (int i = 0; i < GAME_STATE_RING_SPRITES; i++) {
+        state->orbit[i] = (float) i * (2.0f * SDL_PI_F / GAME_STATE_RING_SPRITES);
+        state->spin[i] = wrap_angle((float) i);
+    }
+    SDL_memcpy(state->prev_orbit, state->orbit, sizeof(state->orbit));
+    SDL_memcpy(state->prev_spin, state->spin, sizeof(state->spin));
+    return true;
+}
+
+// safe on a partially initialized state, every part tolerates being destroyed zeroed
+void game_state_destroy(game_state_t *state) {
+    spatial_hash_destroy(&state->enemy_grid);
+    flow_field_destroy(&state->flow_field);
+    entity_store_destroy(&state->entities);
+    SDL_free(state->query_t);
+    SDL_free(state->expired);
+    SDL_free(state->query_result);
+    SDL_zerop(state);
+}
+
+bool game_state_place_tower(game_state_t *state, float x, float y) {
+    uint32_t tile_x = world_to_tile(x);
+    uint32_t tile_y = world_to_tile(y);
+    if (!flow_field_place_tower(&state->flow_field, tile_x, tile_y)) {
+        return false;
+    }
+    entity_t tower = entity_spawn(&state->entities, ENTITY_KIND_TOWER, tile_to_world(tile_x), tile_to_world(tile_y));
+    uint32_t i = entity_index(&state->entities, tower);
+    if (i == ENTITY_INVALID_INDEX) {
+        flow_field_remove_tower(&state->flow_field, tile_x, tile_y);
+        return SDL_SetError("too many entities");
+    }
+    state->entities.health[i] = 100.0f;
+    return true;
+}
+
+bool game_state_queue_input(game_state_t *state, const game_input_t *input) {
+    if (state->num_inputs == GAME_STATE_MAX_INPUTS) {
+        return SDL_SetError("input queue full");
+    }
+    state->inputs[state->num_inputs++] = *input;
+    return true;
+}
+
+static void apply_inputs(game_state_t *state) {
+    for (uint32_t i = 0; i < state->num_inputs; i++) {
+        const game_input_t *input = &state->inputs[i];
+        if (input->kind == GAME_INPUT_PLACE_TOWER && game_state_place_tower(state, input->x, input->y)) {
+            state->towers_placed++;
+        } else {
+            state->rejected_inputs++;
+        }
+    }
+    state->num_inputs = 0;
+}
+
+// placeholder wave until there are real waves: enemies enter at a random spawn on the left edge and follow the
+// flow field to the goal
+static void spawn_enemies(game_state_t *state) {
+    if (state->tick % GAME_STATE_SPAWN_INTERVAL != 0) {
+        return;
+    }
+    flow_field_t *flow_field = &state->flow_field;
+    uint32_t spawn = next_random(state) % flow_field->num_spawns;
+    float y = tile_to_world(flow_field->spawns[spawn] / flow_field->stride - 1);
+    entity_t enemy = entity_spawn(&state->entities, ENTITY_KIND_ENEMY, tile_to_world(0), y);
+    uint32_t i = entity_index(&state->entities, enemy);
+    if (i != ENTITY_INVALID_INDEX) {
+        state->entities.health[i] = 100.0f;
+    }
+}
+
+typedef struct {
+    game_state_t *state;
+    float dt;
+} step_job_t;
+
+// movement: steering and integration only touch the entity itself, so ranges run in parallel. one flow field
+// lookup per enemy, no matter how many there are. off the grid or on a freshly blocked tile there is no direction
+// and the enemy keeps walking until it is back on an open one
+static void move_job(void *data, uint32_t begin, uint32_t end) {
+    step_job_t *step = data;
+    game_state_t *state = step->state;
+    sim_kernels_steer(&state->entities, &state->flow_field, begin, end, GAME_STATE_ENEMY_SPEED, step->dt);
+    entity_store_integrate_range(&state->entities, begin, end, step->dt);
+}
+
+static bool tower_fires(const game_state_t *state, uint32_t i) {
+    // towers are staggered by handle so they don't all fire on the same tick
+    return (state->tick + state->entities.handle[i]) % GAME_STATE_TOWER_COOLDOWN == 0;
+}
+
+// targeting and hit tests: read only grid queries, every entity writes its own query_result slot
+static void query_job(void *data, uint32_t begin, uint32_t end) {
+    game_state_t *state = data;
+    entity_store_t *entities = &state->entities;
+    for (uint32_t i = begin; i < end; i++) {
+        uint32_t result = SPATIAL_HASH_NONE;
+        if (entities->kind[i] == ENTITY_KIND_PROJECTILE) {
+            // projectiles sweep the segment they moved along this step, so fast ones can't tunnel through
+            result = spatial_hash_segment_cast(&state->enemy_grid, entities->prev_x[i], entities->prev_y[i],
+                                               entities->pos_x[i], entities->pos_y[i], GAME_STATE_HIT_RADIUS,
+                                               &state->query_t[i]);
+        } else if (entities->kind[i] == ENTITY_KIND_TOWER && tower_fires(state, i)) {
+            // aim at the enemy in range that is furthest along its path, the one closest to leaking
+            result = spatial_hash_first_along_path(&state->enemy_grid, entities->pos_x[i], entities->pos_y[i],
+                                                   GAME_STATE_TOWER_RANGE, entities->path_progress);
+        }
+        state->query_result[i] = result;
+    }
+}
+
+static void add_effect(game_state_t *state, float x, float y, game_effect_kind_t kind) {
+    if (state->num_effects < GAME_STATE_MAX_EFFECTS) {
+        state->effects[state->num_effects++] = (game_effect_t) {x, y, kind};
+    }
+}
+
+static void apply_hits(game_state_t *state) {
+    entity_store_t *entities = &state->entities;
+    for (uint32_t i = 0; i < entities->count; i++) {
+        uint32_t enemy = state->query_result[i];
+        // an enemy already killed this step can't stop a second projectile, it simply flies through
+        if (entities->kind[i] != ENTITY_KIND_PROJECTILE || enemy == SPATIAL_HASH_NONE ||
+            entities->health[enemy] <= 0.0f) {
+            continue;
+        }
+        float t = state->query_t[i];
+        entities->health[enemy] -= GAME_STATE_PROJECTILE_DAMAGE;
+        entities->health[i] = 0.0f;
+        entities->pos_x[i] = entities->prev_x[i] + (entities->pos_x[i] - entities->prev_x[i]) * t;
+        entities->pos_y[i] = entities->prev_y[i] + (entities->pos_y[i] - entities->prev_y[i]) * t;
+        add_effect(state, entities->pos_x[i], entities->pos_y[i], GAME_EFFECT_HIT);
+        if (entities->health[enemy] <= 0.0f) {
+            add_effect(state, entities->pos_x[enemy], entities->pos_y[enemy], GAME_EFFECT_KILL);
+        }
+    }
+}
+
+static void fire_towers(game_state_t *state) {
+    entity_store_t *entities = &state->entities;
+    // projectiles spawned here are appended, only walk the entities that existed before
+    uint32_t count = entities->count;
+    for (uint32_t i = 0; i < count; i++) {
+        uint32_t enemy = state->query_result[i];
+        // the target was picked before apply_hits, it may have died since
+        if (entities->kind[i] != ENTITY_KIND_TOWER || enemy == SPATIAL_HASH_NONE ||
+            entities->health[enemy] <= 0.0f) {
+            continue;
+        }
+        float dx = entities->pos_x[enemy] - entities->pos_x[i];
+        float dy = entities->pos_y[enemy] - entities->pos_y[i];
+        float length = SDL_sqrtf(dx * dx + dy * dy);
+        if (length == 0.0f) {
+            continue;
+        }
+        entity_t projectile = entity_spawn(entities, ENTITY_KIND_PROJECTILE, entities->pos_x[i], entities->pos_y[i]);
+        uint32_t p = entity_index(entities, projectile);
+        if (p == ENTITY_INVALID_INDEX) {
+            return;
+        }
+        entities->vel_x[p] = dx / length * GAME_STATE_PROJECTILE_SPEED;
+        entities->vel_y[p] = dy / length * GAME_STATE_PROJECTILE_SPEED;
+        entities->health[p] = 1.0f;
+        entities->target[p] = entities->handle[enemy];
+    }
+}
+
+// runs last, despawning swaps the last entity into the current index and invalidates every grid query result
+static void despawn_dead(game_state_t *state) {
+    entity_store_t *entities = &state->entities;
+    // dead, off the map by a margin or, for enemies, arrived on the goal tile
+    sim_kernels_expire(entities, &state->flow_field, 0, entities->count, 1.5f, state->expired);
+    // walk backwards so the entity swapped in was already visited, the flags of the ones in front are still valid
+    for (uint32_t i = entities->count; i-- > 0;) {
+        if (state->expired[i]) {
+            entity_despawn(entities, entities->handle[i]);
+        }
+    }
+}
+
+// spawning, applying damage and despawning change the entity arrays and run on the calling thread, movement and
+// the grid queries fan out over the job system and join before the next phase
+void sim_step(game_state_t *state, float dt) {
+    SDL_memcpy(state->prev_orbit, state->orbit, sizeof(state->orbit));
+    SDL_memcpy(state->prev_spin, state->spin, sizeof(state->spin));
+
+    for (int i = 0; i < GAME_STATE_RING_SPRITES; i++) {
+        state->orbit[i] = wrap_angle(state->orbit[i] + 0.5f * dt);
+        state->spin[i] = wrap_angle(state->spin[i] + 2.0f * dt);
+    }
+
+    entity_store_t *entities = &state->entities;
+    apply_inputs(state);
+    spawn_enemies(state);
+    step_job_t step = {state, dt};
+    job_system_parallel_for(state->jobs, entities->count, GAME_STATE_JOB_GRAIN, move_job, &step);
+    // grid results are dense indices, so from here on nothing may despawn until despawn_dead
+    spatial_hash_build(&state->enemy_grid, entities->pos_x, entities->pos_y, entities->kind, ENTITY_KIND_ENEMY,
+                       entities->count);
+    job_system_parallel_for(state->jobs, entities->count, GAME_STATE_JOB_GRAIN, query_job, state);
+    apply_hits(state);
+    fire_towers(state);
+    despawn_dead(state);
+    state->tick++;
+}
+
+static uint64_t hash_bytes(uint64_t hash, const void *data, size_t size) {
+    const uint8_t *bytes = data;
+    for (size_t i = 0; i < size; i++) {
+        hash ^= bytes[i];
+        hash *= 0x100000001b3ull;
+    }
+    return hash;
+}
+
+uint64_t game_state_checksum(const game_state_t *state) {
+    // fnv-1a over the current values. prev_, the flow field's costs and directions and the grid are derived from
+    // them
+    const entity_store_t *entities = &state->entities;
+    uint64_t hash = 0xcbf29ce484222325ull;
+    hash = hash_bytes(hash, &state->tick, sizeof(state->tick));
+    hash = hash_bytes(hash, &state->rng, sizeof(state->rng));
+    hash = hash_bytes(hash, state->orbit, sizeof(state->orbit));
+    hash = hash_bytes(hash, state->spin, sizeof(state->spin));
+    hash = hash_bytes(hash, &entities->count, sizeof(entities->count));
+    hash = hash_bytes(hash, entities->handle, entities->count * sizeof(entity_t));
+    hash = hash_bytes(hash, entities->kind, entities->count * sizeof(uint8_t));
+    hash = hash_bytes(hash, entities->pos_x, entities->count * sizeof(float));
+    hash = hash_bytes(hash, entities->pos_y, entities->count * sizeof(float));
+    hash = hash_bytes(hash, entities->vel_x, entities->count * sizeof(float));
+    hash = hash_bytes(hash, entities->vel_y, entities->count * sizeof(float));
+    hash = hash_bytes(hash, entities->health, entities->count * sizeof(float));
+    hash = hash_bytes(hash, entities->path_progress, entities->count * sizeof(float));
+    hash = hash_bytes(hash, entities->target, entities->count * sizeof(entity_t));
+    hash = hash_bytes(hash, state->flow_field.blocked, state->flow_field.cells * sizeof(uint8_t));
+    return hash;
+}
+
+void sim_clock_init(sim_clock_t *clock) {
+    SDL_zerop(clock);
+    clock->step_ns = SDL_NS_PER_SECOND / SIM_TICK_RATE;
+}
+
+uint32_t sim_clock_advance(sim_clock_t *clock, uint64_t elapsed_ns) {
+    clock->accumulator_ns += elapsed_ns;
+    uint64_t steps = clock->accumulator_ns / clock->step_ns;
+    clock->accumulator_ns -= steps * clock->step_ns;
+    if (steps > SIM_MAX_STEPS_PER_FRAME) {
+        clock->dropped_steps += steps - SIM_MAX_STEPS_PER_FRAME;
+        steps = SIM_MAX_STEPS_PER_FRAME;
+    }
+    return (uint32_t) steps;
+}
+
+float sim_clock_alpha(const sim_clock_t *clock) {
+    return (float) clock->accumulator_ns / (float) clock->step_ns;
+}
+
+uint64_t sim_clock_until_step_ns(const sim_clock_t *clock) {
+    return clock->step_ns - clock->accumulator_ns;
+}
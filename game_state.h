@@ -0,0 +1,135 @@
+#ifndef KINGDOM_DEFENSE_GAME_STATE_H
+#define KINGDOM_DEFENSE_GAME_STATE_H
+
+#include <SDL3/SDL.h>
+
+#include "entity.h"
+#include "flow_field.h"
+#include "job_system.h"
+#include "spatial_hash.h"
+
+#define SIM_TICK_RATE 60
+#define SIM_DT (1.0f / (float) SIM_TICK_RATE)
+// after a long stall the simulation drops time instead of trying to catch up all at once
+#define SIM_MAX_STEPS_PER_FRAME 8
+
+#define GAME_STATE_RING_SPRITES 64
+#define GAME_STATE_MAX_ENTITIES (64 * 1024)
+// one enemy every GAME_STATE_SPAWN_INTERVAL ticks
+#define GAME_STATE_SPAWN_INTERVAL 6
+#define GAME_STATE_ENEMY_SPEED 0.3f
+// the map is a GAME_STATE_MAP_SIZE^2 tile grid covering [-1, 1] in both axes
+#define GAME_STATE_MAP_SIZE 32
+#define GAME_STATE_TOWER_RANGE 0.35f
+// a tower fires once every GAME_STATE_TOWER_COOLDOWN ticks while an enemy is in range
+#define GAME_STATE_TOWER_COOLDOWN 20
+#define GAME_STATE_PROJECTILE_SPEED 2.0f
+#define GAME_STATE_PROJECTILE_DAMAGE 25.0f
+// distance from an enemy's center a projectile hits at
+#define GAME_STATE_HIT_RADIUS 0.03f
+// entities per job when a phase is spread over the job system
+#define GAME_STATE_JOB_GRAIN 1024
+// hits and kills kept for the renderer until it takes them, the rest are dropped
+#define GAME_STATE_MAX_EFFECTS 256
+// player inputs waiting for the next step
+#define GAME_STATE_MAX_INPUTS 64
+
+typedef enum {
+    // a tower on the tile under (x, y)
+    GAME_INPUT_PLACE_TOWER,
+    GAME_INPUT_COUNT,
+} game_input_kind_t;
+
+// a player action. the next sim_step applies every queued input in order before anything else, so a replay is the
+// seed plus the inputs and the step they were queued before
+typedef struct {
+    game_input_kind_t kind;
+    float x;
+    float y;
+} game_input_t;
+
+typedef enum {
+    GAME_EFFECT_HIT,
+    GAME_EFFECT_KILL,
+    GAME_EFFECT_COUNT,
+} game_effect_kind_t;
+
+// something the renderer may want to show, where it happened
+typedef struct {
+    float x;
+    float y;
+    game_effect_kind_t kind;
+} game_effect_t;
+
+// everything the simulation owns. it never reads the clock, the window or the gpu, so the same seed and the same
+// number of sim_step calls always give the same state, on any number of threads
+typedef struct {
+    uint64_t tick;
+    // xorshift32 state, the only source of randomness the simulation may use
+    uint32_t rng;
+
+    entity_store_t entities;
+    // enemies walk the flow field towards the goal tile on the right edge, towers block tiles
+    flow_field_t flow_field;
+    // enemy positions, rebuilt after every move so towers and projectiles don't have to scan every enemy
+    spatial_hash_t enemy_grid;
+    // per entity result of the parallel query phase: the enemy a projectile hit (and where along its step) or
+    // the enemy a tower aims at. applied afterwards on one thread in index order, so results never depend on
+    // the number of threads
+    uint32_t *query_result;
+    float *query_t;
+    // per entity despawn flags of the current step
+    uint8_t *expired;
+
+    // queued by game_state_queue_input, consumed by the next sim_step
+    game_input_t inputs[GAME_STATE_MAX_INPUTS];
+    uint32_t num_inputs;
+    // inputs sim_step applied and the ones it had to turn down, e.g. a tower that would wall in the spawns
+    uint64_t towers_placed;
+    uint64_t rejected_inputs;
+
+    // appended by sim_step, cleared by whoever shows them. write only for the simulation and not part of the
+    // checksum
+    game_effect_t effects[GAME_STATE_MAX_EFFECTS];
+    uint32_t num_effects;
+
+    // not owned, the parallel phases of sim_step run on it
+    job_system_t *jobs;
+
+    // placeholder scene until there are real entities: a ring of spinning sprites. the prev_ values are the
+    // state before the last step, the renderer interpolates between them
+    float orbit[GAME_STATE_RING_SPRITES];
+    float prev_orbit[GAME_STATE_RING_SPRITES];
+    float spin[GAME_STATE_RING_SPRITES];
+    float prev_spin[GAME_STATE_RING_SPRITES];
+} game_state_t;
+
+// accumulates real time and hands it out in fixed SIM_DT steps
+typedef struct {
+    uint64_t step_ns;
+    uint64_t accumulator_ns;
+    // steps dropped because more than SIM_MAX_STEPS_PER_FRAME were due
+    uint64_t dropped_steps;
+} sim_clock_t;
+
+bool game_state_init(game_state_t *state, uint32_t seed, job_system_t *jobs);
+void game_state_destroy(game_state_t *state);
+void sim_step(game_state_t *state, float dt);
+// places a tower on the tile under world position (x, y) right away, fails if the tile is taken or the tower would
+// cut the spawns off from the goal. for setting up a state before it runs, the player goes through
+// game_state_queue_input
+bool game_state_place_tower(game_state_t *state, float x, float y);
+// queues `input` for the next sim_step, fails if GAME_STATE_MAX_INPUTS are already waiting
+bool game_state_queue_input(game_state_t *state, const game_input_t *input);
+// cheap fingerprint of every simulated value, equal between two runs iff they stayed in lockstep
+uint64_t game_state_checksum(const game_state_t *state);
+
+void sim_clock_init(sim_clock_t *clock);
+// adds `elapsed_ns` of real time and returns how many steps to run now
+uint32_t sim_clock_advance(sim_clock_t *clock, uint64_t elapsed_ns);
+// how far the clock is between the last step and the next one, [0, 1)
+float sim_clock_alpha(const sim_clock_t *clock);
+// real time left until the next step is due
+uint64_t sim_clock_until_step_ns(const sim_clock_t *clock);
+
+#endif //KINGDOM_DEFENSE_GAME_STATE_H
@@ -0,0 +1,285 @@
+#include "gpu_resources.h"
+
+#define GPU_RESOURCES_MIN_CAPACITY 256
+// a released slot, probing goes on past it
+#define TOMBSTONE ((const void *) 1)
+
+typedef struct {
+    const void *handle;
+    const char *callsite;
+    uint64_t bytes;
+    gpu_resource_kind_t kind;
+} gpu_resource_t;
+
+static const char *kind_names[GPU_RESOURCE_COUNT] = {
+        [GPU_RESOURCE_BUFFER] = "buffer",
+        [GPU_RESOURCE_TRANSFER_BUFFER] = "transfer buffer",
+        [GPU_RESOURCE_TEXTURE] = "texture",
+        [GPU_RESOURCE_SAMPLER] = "sampler",
+        [GPU_RESOURCE_SHADER] = "shader",
+        [GPU_RESOURCE_GRAPHICS_PIPELINE] = "graphics pipeline",
+        [GPU_RESOURCE_COMPUTE_PIPELINE] = "compute pipeline",
+};
+
+// open addressing keyed by the handle, a power of two of slots kept at most half full counting tombstones. the
+// mutex is created by whichever thread gets there first and goes away with the table in gpu_resources_shutdown
+static SDL_InitState init_state;
+static SDL_Mutex *mutex;
+static gpu_resource_t *slots;
+static uint32_t capacity;
+static uint32_t used_slots;
+static gpu_resource_stats_t stats;
+
+static void lock(void) {
+    if (SDL_ShouldInit(&init_state)) {
+        mutex = SDL_CreateMutex();
+        SDL_SetInitialized(&init_state, mutex != NULL);
+    }
+    SDL_LockMutex(mutex);
+}
+
+static void unlock(void) {
+    SDL_UnlockMutex(mutex);
+}
+
+static uint32_t hash_handle(const void *handle) {
+    uint64_t h = (uint64_t) (uintptr_t) handle * 0x9E3779B97F4A7C15ull;
+    return (uint32_t) (h >> 32);
+}
+
+static bool grow(void) {
+    uint32_t new_capacity = capacity == 0 ? GPU_RESOURCES_MIN_CAPACITY : capacity;
+    // only grow when live objects fill the table, otherwise rehashing drops the tombstones
+    uint32_t live = 0;
+    for (int kind = 0; kind < GPU_RESOURCE_COUNT; kind++) {
+        live += stats.live[kind];
+    }
+    while ((live + 1) * 4 > new_capacity) {
+        new_capacity *= 2;
+    }
+    gpu_resource_t *new_slots = SDL_calloc(new_capacity, sizeof(gpu_resource_t));
+    if (new_slots == NULL) {
+        return false;
+    }
+    for (uint32_t i = 0; i < capacity; i++) {
+        if (slots[i].handle == NULL || slots[i].handle == TOMBSTONE) {
+            continue;
+        }
+        uint32_t slot = hash_handle(slots[i].handle) & (new_capacity - 1);
+        while (new_slots[slot].handle != NULL) {
+            slot = (slot + 1) & (new_capacity - 1);
+        }
+        new_slots[slot] = slots[i];
+    }
+    SDL_free(slots);
+    slots = new_slots;
+    capacity = new_capacity;
+    used_slots = live;
+    return true;
+}
+
+static void track(gpu_resource_kind_t kind, const void *handle, uint64_t bytes, const char *callsite) {
+    if (handle == NULL) {
+        return;
+    }
+    lock();
+    // the object itself was created, only its bookkeeping is lost if the table can't grow
+    if ((used_slots + 1) * 2 > capacity && !grow()) {
+        unlock();
+        SDL_Log("gpu resources: can't track %s from %s", kind_names[kind], callsite);
+        return;
+    }
+    uint32_t slot = hash_handle(handle) & (capacity - 1);
+    while (slots[slot].handle != NULL && slots[slot].handle != TOMBSTONE) {
+        slot = (slot + 1) & (capacity - 1);
+    }
+    used_slots += slots[slot].handle == NULL;
+    slots[slot] = (gpu_resource_t) {handle, callsite, bytes, kind};
+    stats.live[kind]++;
+    stats.bytes[kind] += bytes;
+    stats.total_bytes += bytes;
+    stats.peak_bytes = SDL_max(stats.peak_bytes, stats.total_bytes);
+    stats.created++;
+    unlock();
+}
+
+static void untrack(gpu_resource_kind_t kind, const void *handle) {
+    if (handle == NULL) {
+        return;
+    }
+    lock();
+    uint32_t slot = hash_handle(handle) & (capacity - 1);
+    while (capacity > 0 && slots[slot].handle != NULL && slots[slot].handle != handle) {
+        slot = (slot + 1) & (capacity - 1);
+    }
+    if (capacity == 0 || slots[slot].handle == NULL) {
+        unlock();
+        SDL_Log("gpu resources: releasing a %s that wasn't created through the registry", kind_names[kind]);
+        return;
+    }
+    if (slots[slot].kind != kind) {
+        SDL_Log("gpu resources: %s from %s released as a %s", kind_names[slots[slot].kind], slots[slot].callsite,
+                kind_names[kind]);
+    }
+    gpu_resource_t *resource = &slots[slot];
+    stats.live[resource->kind]--;
+    stats.bytes[resource->kind] -= resource->bytes;
+    stats.total_bytes -= resource->bytes;
+    stats.released++;
+    resource->handle = TOMBSTONE;
+    unlock();
+}
+
+// every mip level of every layer and sample
+static uint64_t texture_bytes(const SDL_GPUTextureCreateInfo *info) {
+    bool is_3d = info->type == SDL_GPU_TEXTURETYPE_3D;
+    uint64_t bytes = 0;
+    for (uint32_t level = 0; level < SDL_max(info->num_levels, 1); level++) {
+        bytes += SDL_CalculateGPUTextureFormatSize(
+                info->format, SDL_max(info->width >> level, 1), SDL_max(info->height >> level, 1),
+                is_3d ? SDL_max(info->layer_count_or_depth >> level, 1) : SDL_max(info->layer_count_or_depth, 1));
+    }
+    return bytes << info->sample_count;
+}
+
+SDL_GPUBuffer *gpu_create_buffer(SDL_GPUDevice *device, const SDL_GPUBufferCreateInfo *info, const char *callsite) {
+    SDL_GPUBuffer *buffer = SDL_CreateGPUBuffer(device, info);
+    track(GPU_RESOURCE_BUFFER, buffer, info->size, callsite);
+    return buffer;
+}
+
+SDL_GPUTransferBuffer *gpu_create_transfer_buffer(SDL_GPUDevice *device, const SDL_GPUTransferBufferCreateInfo *info,
+                                                  const char *callsite) {
+    SDL_GPUTransferBuffer *transfer_buffer = SDL_CreateGPUTransferBuffer(device, info);
+    track(GPU_RESOURCE_TRANSFER_BUFFER, transfer_buffer, info->size, callsite);
+    return transfer_buffer;
+}
+
+SDL_GPUTexture *gpu_create_texture(SDL_GPUDevice *device, const SDL_GPUTextureCreateInfo *info, const char *callsite) {
+    SDL_GPUTexture *texture = SDL_CreateGPUTexture(device, info);
+    track(GPU_RESOURCE_TEXTURE, texture, texture_bytes(info), callsite);
+    return texture;
+}
+
+SDL_GPUSampler *gpu_create_sampler(SDL_GPUDevice *device, const SDL_GPUSamplerCreateInfo *info, const char *callsite) {
+    SDL_GPUSampler *sampler = SDL_CreateGPUSampler(device, info);
+    track(GPU_RESOURCE_SAMPLER, sampler, 0, callsite);
+    return sampler;
+}
+
+SDL_GPUShader *gpu_create_shader(SDL_GPUDevice *device, const SDL_GPUShaderCreateInfo *info, const char *callsite) {
+    SDL_GPUShader *shader = SDL_CreateGPUShader(device, info);
+    track(GPU_RESOURCE_SHADER, shader, 0, callsite);
+    return shader;
+}
+
+SDL_GPUGraphicsPipeline *gpu_create_graphics_pipeline(SDL_GPUDevice *device,
+                                                      const SDL_GPUGraphicsPipelineCreateInfo *info,
+                                                      const char *callsite) {
+    SDL_GPUGraphicsPipeline *pipeline = SDL_CreateGPUGraphicsPipeline(device, info);
+    track(GPU_RESOURCE_GRAPHICS_PIPELINE, pipeline, 0, callsite);
+    return pipeline;
+}
+
+SDL_GPUComputePipeline *gpu_create_compute_pipeline(SDL_GPUDevice *device,
+                                                    const SDL_GPUComputePipelineCreateInfo *info,
+                                                    const char *callsite) {
+    SDL_GPUComputePipeline *pipeline = SDL_CreateGPUComputePipeline(device, info);
+    track(GPU_RESOURCE_COMPUTE_PIPELINE, pipeline, 0, callsite);
+    return pipeline;
+}
+
+void gpu_release_buffer(SDL_GPUDevice *device, SDL_GPUBuffer *buffer) {
+    if (buffer != NULL) {
+        untrack(GPU_RESOURCE_BUFFER, buffer);
+        SDL_ReleaseGPUBuffer(device, buffer);
+    }
+}
+
+void gpu_release_transfer_buffer(SDL_GPUDevice *device, SDL_GPUTransferBuffer *transfer_buffer) {
+    if (transfer_buffer != NULL) {
+        untrack(GPU_RESOURCE_TRANSFER_BUFFER, transfer_buffer);
+        SDL_ReleaseGPUTransferBuffer(device, transfer_buffer);
+    }
+}
+
+void gpu_release_texture(SDL_GPUDevice *device, SDL_GPUTexture *texture) {
+    if (texture != NULL) {
+        untrack(GPU_RESOURCE_TEXTURE, texture);
+        SDL_ReleaseGPUTexture(device, texture);
+    }
+}
+
+void gpu_release_sampler(SDL_GPUDevice *device, SDL_GPUSampler *sampler) {
+    if (sampler != NULL) {
+        untrack(GPU_RESOURCE_SAMPLER, sampler);
+        SDL_ReleaseGPUSampler(device, sampler);
+    }
+}
+
+void gpu_release_shader(SDL_GPUDevice *device, SDL_GPUShader *shader) {
+    if (shader != NULL) {
+        untrack(GPU_RESOURCE_SHADER, shader);
+        SDL_ReleaseGPUShader(device, shader);
+    }
+}
+
+void gpu_release_graphics_pipeline(SDL_GPUDevice *device, SDL_GPUGraphicsPipeline *pipeline) {
+    if (pipeline != NULL) {
+        untrack(GPU_RESOURCE_GRAPHICS_PIPELINE, pipeline);
+        SDL_ReleaseGPUGraphicsPipeline(device, pipeline);
+    }
+}
+
+void gpu_release_compute_pipeline(SDL_GPUDevice *device, SDL_GPUComputePipeline *pipeline) {
+    if (pipeline != NULL) {
+        untrack(GPU_RESOURCE_COMPUTE_PIPELINE, pipeline);
+        SDL_ReleaseGPUComputePipeline(device, pipeline);
+    }
+}
+
+const char *gpu_resource_kind_name(gpu_resource_kind_t kind) {
+    return kind_names[kind];
+}
+
+void gpu_resources_stats(gpu_resource_stats_t *out) {
+    lock();
+    *out = stats;
+    unlock();
+}
+
+uint32_t gpu_resources_report_leaks(void) {
+    lock();
+    uint32_t leaks = 0;
+    uint64_t leaked_bytes = 0;
+    for (uint32_t i = 0; i < capacity; i++) {
+        const gpu_resource_t *resource = &slots[i];
+        if (resource->handle == NULL || resource->handle == TOMBSTONE) {
+            continue;
+        }
+        SDL_Log("gpu resources: leaked %s of %" SDL_PRIu64 " bytes from %s", kind_names[resource->kind],
+                resource->bytes, resource->callsite);
+        leaks++;
+        leaked_bytes += resource->bytes;
+    }
+    if (leaks > 0) {
+        SDL_Log("gpu resources: %u objects with %" SDL_PRIu64 " bytes still alive, peak was %.1f MiB", leaks,
+                leaked_bytes, (double) stats.peak_bytes / (1024.0 * 1024.0));
+    }
+    unlock();
+    return leaks;
+}
+
+void gpu_resources_shutdown(void) {
+    if (!SDL_ShouldQuit(&init_state)) {
+        return;
+    }
+    SDL_free(slots);
+    slots = NULL;
+    capacity = 0;
+    used_slots = 0;
+    SDL_zero(stats);
+    SDL_DestroyMutex(mutex);
+    mutex = NULL;
+    SDL_SetInitialized(&init_state, false);
+}
@@ -0,0 +1,66 @@
+#ifndef KINGDOM_DEFENSE_GPU_RESOURCES_H
+#define KINGDOM_DEFENSE_GPU_RESOURCES_H
+
+#include <SDL3/SDL.h>
+
+#define GPU_RESOURCES_STRINGIFY_(_x) #_x
+#define GPU_RESOURCES_STRINGIFY(_x) GPU_RESOURCES_STRINGIFY_(_x)
+// file:line of the create call, a string literal so the registry only keeps the pointer
+#define GPU_CALLSITE __FILE__ ":" GPU_RESOURCES_STRINGIFY(__LINE__)
+
+typedef enum {
+    GPU_RESOURCE_BUFFER,
+    GPU_RESOURCE_TRANSFER_BUFFER,
+    GPU_RESOURCE_TEXTURE,
+    GPU_RESOURCE_SAMPLER,
+    GPU_RESOURCE_SHADER,
+    GPU_RESOURCE_GRAPHICS_PIPELINE,
+    GPU_RESOURCE_COMPUTE_PIPELINE,
+    GPU_RESOURCE_COUNT,
+} gpu_resource_kind_t;
+
+typedef struct {
+    uint32_t live[GPU_RESOURCE_COUNT];
+    // what was asked for, the driver's alignment and padding come on top. samplers, shaders and pipelines
+    // count as 0
+    uint64_t bytes[GPU_RESOURCE_COUNT];
+    uint64_t total_bytes;
+    // the most that was ever alive at once
+    uint64_t peak_bytes;
+    uint64_t created;
+    uint64_t released;
+} gpu_resource_stats_t;
+
+// every gpu object the game creates goes through these, the registry knows what is alive, how large it is and
+// where it came from. one registry for the process, safe to use from any thread. the release functions ignore
+// NULL like SDL does. objects created elsewhere (the imgui backend, the bench) aren't seen
+SDL_GPUBuffer *gpu_create_buffer(SDL_GPUDevice *device, const SDL_GPUBufferCreateInfo *info, const char *callsite);
+SDL_GPUTransferBuffer *gpu_create_transfer_buffer(SDL_GPUDevice *device, const SDL_GPUTransferBufferCreateInfo *info,
+                                                  const char *callsite);
+SDL_GPUTexture *gpu_create_texture(SDL_GPUDevice *device, const SDL_GPUTextureCreateInfo *info, const char *callsite);
+SDL_GPUSampler *gpu_create_sampler(SDL_GPUDevice *device, const SDL_GPUSamplerCreateInfo *info, const char *callsite);
+SDL_GPUShader *gpu_create_shader(SDL_GPUDevice *device, const SDL_GPUShaderCreateInfo *info, const char *callsite);
+SDL_GPUGraphicsPipeline *gpu_create_graphics_pipeline(SDL_GPUDevice *device,
+                                                      const SDL_GPUGraphicsPipelineCreateInfo *info,
+                                                      const char *callsite);
+SDL_GPUComputePipeline *gpu_create_compute_pipeline(SDL_GPUDevice *device,
+                                                    const SDL_GPUComputePipelineCreateInfo *info,
+                                                    const char *callsite);
+
+void gpu_release_buffer(SDL_GPUDevice *device, SDL_GPUBuffer *buffer);
+void gpu_release_transfer_buffer(SDL_GPUDevice *device, SDL_GPUTransferBuffer *transfer_buffer);
+void gpu_release_texture(SDL_GPUDevice *device, SDL_GPUTexture *texture);
+void gpu_release_sampler(SDL_GPUDevice *device, SDL_GPUSampler *sampler);
+void gpu_release_shader(SDL_GPUDevice *device, SDL_GPUShader *shader);
+void gpu_release_graphics_pipeline(SDL_GPUDevice *device, SDL_GPUGraphicsPipeline *pipeline);
+void gpu_release_compute_pipeline(SDL_GPUDevice *device, SDL_GPUComputePipeline *pipeline);
+
+const char *gpu_resource_kind_name(gpu_resource_kind_t kind);
+void gpu_resources_stats(gpu_resource_stats_t *stats);
+// logs every object still alive with its size and callsite and returns how many there are. call it after
+// everything was released and before the device is destroyed
+uint32_t gpu_resources_report_leaks(void);
+// frees the registry itself, the last call into it. objects created afterwards start a new one
+void gpu_resources_shutdown(void);
+
+#endif //KINGDOM_DEFENSE_GPU_RESOURCES_H
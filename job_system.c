@@ -0,0 +1,254 @@
+#include "job_system.h"
+
+// empty polls before an idle worker goes to sleep, long enough to bridge the gap between two phases of a tick
+#define IDLE_SPINS 2048
+
+static uint32_t next_random(job_thread_t *thread) {
+    uint32_t x = thread->rng;
+    x ^= x << 13;
+    x ^= x >> 17;
+    x ^= x << 5;
+    thread->rng = x;
+    return x;
+}
+
+// owner only
+static bool queue_push(job_queue_t *queue, const job_t *job) {
+    uint32_t bottom = (uint32_t) SDL_GetAtomicInt(&queue->bottom);
+    uint32_t top = (uint32_t) SDL_GetAtomicInt(&queue->top);
+    if (bottom - top >= JOB_QUEUE_CAPACITY) {
+        return false;
+    }
+    queue->jobs[bottom % JOB_QUEUE_CAPACITY] = *job;
+    // publishes the job, sdl atomics are full barriers
+    SDL_SetAtomicInt(&queue->bottom, (int) (bottom + 1));
+    return true;
+}
+
+// owner only
+static bool queue_pop(job_queue_t *queue, job_t *job) {
+    uint32_t bottom = (uint32_t) SDL_GetAtomicInt(&queue->bottom) - 1;
+    // claim the bottom job first, thieves that read top after this see the smaller queue
+    SDL_SetAtomicInt(&queue->bottom, (int) bottom);
+    uint32_t top = (uint32_t) SDL_GetAtomicInt(&queue->top);
+    int32_t remaining = (int32_t) (bottom - top);
+    if (remaining < 0) {
+        SDL_SetAtomicInt(&queue->bottom, (int) (bottom + 1));
+        return false;
+    }
+    *job = queue->jobs[bottom % JOB_QUEUE_CAPACITY];
+    if (remaining > 0) {
+        return true;
+    }
+    // the last job, a thief may be taking it right now. whoever moves top gets it
+    bool won = SDL_CompareAndSwapAtomicInt(&queue->top, (int) top, (int) (top + 1));
+    SDL_SetAtomicInt(&queue->bottom, (int) (bottom + 1));
+    return won;
+}
+
+static bool queue_steal(job_queue_t *queue, job_t *job) {
+    uint32_t top = (uint32_t) SDL_GetAtomicInt(&queue->top);
+    uint32_t bottom = (uint32_t) SDL_GetAtomicInt(&queue->bottom);
+    if ((int32_t) (bottom - top) <= 0) {
+        return false;
+    }
+    // the slot can only be reused once top moved past it, in which case the copy is thrown away below
+    *job = queue->jobs[top % JOB_QUEUE_CAPACITY];
+    return SDL_CompareAndSwapAtomicInt(&queue->top, (int) top, (int) (top + 1));
+}
+
+// NULL on threads that neither created the system nor belong to it
+static job_thread_t *current_thread(job_system_t *system) {
+    uintptr_t index = (uintptr_t) SDL_GetTLS(&system->thread_index);
+    return index ? &system->threads[index - 1] : NULL;
+}
+
+static void run_job(job_thread_t *thread, const job_t *job) {
+    job->fn(job->data, job->begin, job->end);
+    if (thread) {
+        thread->stats.executed++;
+    }
+    // last, the waiter may return and free `data` as soon as this hits zero
+    if (job->counter) {
+        SDL_AddAtomicInt(&job->counter->pending, -1);
+    }
+}
+
+// own queue first, then one pass over the others starting at a random victim
+static bool find_work(job_system_t *system, job_thread_t *thread, job_t *job) {
+    if (thread && queue_pop(&thread->queue, job)) {
+        return true;
+    }
+    uint32_t n = system->num_threads;
+    uint32_t start = thread ? next_random(thread) % n : 0;
+    for (uint32_t i = 0; i < n; i++) {
+        job_thread_t *victim = &system->threads[(start + i) % n];
+        if (victim != thread && queue_steal(&victim->queue, job)) {
+            if (thread) {
+                thread->stats.stolen++;
+            }
+            return true;
+        }
+    }
+    return false;
+}
+
+static int worker_main(void *data) {
+    job_thread_t *thread = data;
+    job_system_t *system = thread->system;
+    SDL_SetTLS(&system->thread_index, (void *) (uintptr_t) (thread->index + 1), NULL);
+
+    uint32_t idle = 0;
+    job_t job;
+    while (!SDL_GetAtomicInt(&system->quit)) {
+        if (find_work(system, thread, &job)) {
+            run_job(thread, &job);
+            idle = 0;
+            continue;
+        }
+        if (++idle < IDLE_SPINS) {
+            SDL_CPUPauseInstruction();
+            continue;
+        }
+        // announce the nap before the last look, a push that lands after the look sees `sleeping` and signals
+        SDL_AddAtomicInt(&system->sleeping, 1);
+        if (find_work(system, thread, &job)) {
+            SDL_AddAtomicInt(&system->sleeping, -1);
+            run_job(thread, &job);
+            idle = 0;
+            continue;
+        }
+        thread->stats.sleeps++;
+        SDL_WaitSemaphore(system->wake);
+        SDL_AddAtomicInt(&system->sleeping, -1);
+        idle = 0;
+    }
+    return 0;
+}
+
+uint32_t job_system_default_workers(void) {
+    int cores = SDL_GetNumLogicalCPUCores();
+    return (uint32_t) SDL_clamp(cores - 1, 0, JOB_SYSTEM_MAX_THREADS - 1);
+}
+
+bool job_system_init(job_system_t *system, uint32_t num_workers) {
+    SDL_zerop(system);
+    system->num_threads = SDL_min(num_workers, JOB_SYSTEM_MAX_THREADS - 1) + 1;
+    system->threads = SDL_aligned_alloc(JOB_CACHE_LINE, system->num_threads * sizeof(job_thread_t));
+    if (system->threads == NULL) {
+        return false;
+    }
+    SDL_memset(system->threads, 0, system->num_threads * sizeof(job_thread_t));
+    system->wake = SDL_CreateSemaphore(0);
+    if (system->wake == NULL) {
+        job_system_destroy(system);
+        return false;
+    }
+
+    for (uint32_t i = 0; i < system->num_threads; i++) {
+        job_thread_t *thread = &system->threads[i];
+        thread->system = system;
+        thread->index = i;
+        thread->rng = 0x9e3779b9u * (i + 1);
+    }
+    // the creating thread is thread 0, it runs jobs while it waits
+    if (!SDL_SetTLS(&system->thread_index, (void *) (uintptr_t) 1, NULL)) {
+        job_system_destroy(system);
+        return false;
+    }
+    for (uint32_t i = 1; i < system->num_threads; i++) {
+        system->threads[i].thread = SDL_CreateThread(worker_main, "job worker", &system->threads[i]);
+        if (system->threads[i].thread == NULL) {
+            job_system_destroy(system);
+            return false;
+        }
+    }
+    return true;
+}
+
+void job_system_destroy(job_system_t *system) {
+    SDL_SetAtomicInt(&system->quit, 1);
+    if (system->threads) {
+        for (uint32_t i = 1; i < system->num_threads; i++) {
+            SDL_SignalSemaphore(system->wake);
+        }
+        for (uint32_t i = 1; i < system->num_threads; i++) {
+            SDL_WaitThread(system->threads[i].thread, NULL);
+        }
+    }
+    SDL_SetTLS(&system->thread_index, NULL, NULL);
+    SDL_DestroySemaphore(system->wake);
+    SDL_aligned_free(system->threads);
+    SDL_zerop(system);
+}
+
+void job_system_push(job_system_t *system, job_fn_t fn, void *data, uint32_t begin, uint32_t end,
+                     job_counter_t *counter) {
+    job_t job = {
+            .fn = fn,
+            .data = data,
+            .begin = begin,
+            .end = end,
+            .counter = counter,
+    };
+    if (counter) {
+        SDL_AddAtomicInt(&counter->pending, 1);
+    }
+    job_thread_t *thread = current_thread(system);
+    // without workers or room in the queue the job runs right here, which is what a worker would do anyway
+    if (thread == NULL || system->num_threads == 1 || !queue_push(&thread->queue, &job)) {
+        run_job(thread, &job);
+        return;
+    }
+    if (SDL_GetAtomicInt(&system->sleeping) > 0) {
+        SDL_SignalSemaphore(system->wake);
+    }
+}
+
+void job_system_dispatch(job_system_t *system, uint32_t count, uint32_t grain, job_fn_t fn, void *data,
+                         job_counter_t *counter) {
+    grain = SDL_max(grain, 1);
+    for (uint32_t begin = 0; begin < count; begin += SDL_min(grain, count - begin)) {
+        job_system_push(system, fn, data, begin, begin + SDL_min(grain, count - begin), counter);
+    }
+}
+
+void job_system_wait(job_system_t *system, job_counter_t *counter) {
+    job_thread_t *thread = current_thread(system);
+    uint32_t idle = 0;
+    job_t job;
+    while (SDL_GetAtomicInt(&counter->pending) > 0) {
+        if (find_work(system, thread, &job)) {
+            run_job(thread, &job);
+            idle = 0;
+        } else if (++idle < IDLE_SPINS) {
+            SDL_CPUPauseInstruction();
+        } else {
+            // the jobs left are running elsewhere. with more threads than free cores spinning would keep them
+            // from finishing, give the core away
+            SDL_DelayNS(0);
+        }
+    }
+}
+
+void job_system_parallel_for(job_system_t *system, uint32_t count, uint32_t grain, job_fn_t fn, void *data) {
+    if (count <= grain || system->num_threads == 1) {
+        if (count > 0) {
+            fn(data, 0, count);
+        }
+        return;
+    }
+    job_counter_t counter;
+    SDL_SetAtomicInt(&counter.pending, 0);
+    job_system_dispatch(system, count, grain, fn, data, &counter);
+    job_system_wait(system, &counter);
+}
+
+void job_system_stats(job_system_t *system, job_thread_stats_t *total) {
+    SDL_zerop(total);
+    for (uint32_t i = 0; i < system->num_threads; i++) {
+        total->executed += system->threads[i].stats.executed;
+        total->stolen += system->threads[i].stats.stolen;
+        total->sleeps += system->threads[i].stats.sleeps;
+    }
+}
@@ -0,0 +1,87 @@
+#ifndef KINGDOM_DEFENSE_JOB_SYSTEM_H
+#define KINGDOM_DEFENSE_JOB_SYSTEM_H
+
+#include <SDL3/SDL.h>
+
+#define JOB_SYSTEM_MAX_THREADS 64
+// jobs one thread can have queued, pushing more runs them right away on the pushing thread
+#define JOB_QUEUE_CAPACITY 1024
+#define JOB_CACHE_LINE 64
+
+// `begin` and `end` are the range of a parallel for, single jobs get whatever they were pushed with
+typedef void (*job_fn_t)(void *data, uint32_t begin, uint32_t end);
+
+// jobs of a group that did not finish yet. a job may wait on another group's counter, that is how dependencies
+// are expressed: the waiting thread keeps running other jobs in the meantime, so it never deadlocks the pool
+typedef struct {
+    SDL_AtomicInt pending;
+} job_counter_t;
+
+typedef struct {
+    job_fn_t fn;
+    void *data;
+    uint32_t begin;
+    uint32_t end;
+    job_counter_t *counter;
+} job_t;
+
+// chase-lev deque. the owning thread pushes and pops at the bottom (newest first, still hot in its cache), the
+// other threads steal from the top. positions only ever grow and wrap around, the distance is what counts
+typedef struct {
+    _Alignas(JOB_CACHE_LINE) SDL_AtomicInt top;
+    _Alignas(JOB_CACHE_LINE) SDL_AtomicInt bottom;
+    _Alignas(JOB_CACHE_LINE) job_t jobs[JOB_QUEUE_CAPACITY];
+} job_queue_t;
+
+// written only by the owning thread without synchronization, totals are approximate while workers are running
+typedef struct {
+    uint64_t executed;
+    uint64_t stolen;
+    uint64_t sleeps;
+} job_thread_stats_t;
+
+typedef struct job_system job_system_t;
+
+typedef struct {
+    job_queue_t queue;
+    job_system_t *system;
+    SDL_Thread *thread;
+    uint32_t index;
+    // xorshift32, picks the steal victims
+    uint32_t rng;
+    job_thread_stats_t stats;
+} job_thread_t;
+
+// a fixed pool of worker threads plus the thread that created it, which takes part as thread 0 whenever it
+// waits on a counter. every thread owns a deque and steals from the others once its own runs dry, idle workers
+// sleep on a semaphore
+struct job_system {
+    job_thread_t *threads;
+    uint32_t num_threads;
+    SDL_TLSID thread_index;
+    SDL_Semaphore *wake;
+    SDL_AtomicInt sleeping;
+    SDL_AtomicInt quit;
+};
+
+// `num_workers` threads are started next to the calling one, 0 runs every job on the calling thread
+bool job_system_init(job_system_t *system, uint32_t num_workers);
+// waits for the workers to exit, queued jobs are dropped
+void job_system_destroy(job_system_t *system);
+// one worker per logical core besides the calling thread
+uint32_t job_system_default_workers(void);
+
+// queues fn(data, begin, end) and adds it to `counter`, which may be NULL for fire and forget
+void job_system_push(job_system_t *system, job_fn_t fn, void *data, uint32_t begin, uint32_t end,
+                     job_counter_t *counter);
+// splits [0, count) into jobs of at most `grain` items, returns without waiting for them
+void job_system_dispatch(job_system_t *system, uint32_t count, uint32_t grain, job_fn_t fn, void *data,
+                         job_counter_t *counter);
+// runs queued jobs on the calling thread until `counter` drops to zero
+void job_system_wait(job_system_t *system, job_counter_t *counter);
+// dispatch and wait, the calling thread does its share of the ranges
+void job_system_parallel_for(job_system_t *system, uint32_t count, uint32_t grain, job_fn_t fn, void *data);
+
+void job_system_stats(job_system_t *system, job_thread_stats_t *total);
+
+#endif //KINGDOM_DEFENSE_JOB_SYSTEM_H
@@ -1,478 +1,322 @@
 #include <stdio.h>
 #include <stdlib.h>
-#include <assert.h>
 
 #include <SDL3/SDL.h>
 
 #include <cimgui.h>
 #include <cimgui_impl.h>
 
-#include <spirv_cross_c.h>
-
+#include "asset_pack.h"
+#include "asset_stream.h"
+#include "camera.h"
+#include "common.h"
+#include "frame_pacer.h"
+#include "frame_ring.h"
+#include "game_state.h"
+#include "gpu_resources.h"
+#include "job_system.h"
+#include "memory.h"
+#include "particles.h"
+#include "profiler.h"
+#include "quadtree.h"
+#include "render_pipelines.h"
 #include "shader_inputs.h"
-
-#define ARRAY_SIZE(_array) (sizeof(_array) / sizeof(_array[0]))
-
-#define SDL_PRINT_ERROR_AND_EXIT(_err)                \
-    do {                                              \
-        fprintf(stderr, _err ": %s", SDL_GetError()); \
-        exit(-1);                                     \
-    } while (false)
-
-#define CHECK_RET(_bool, _ERR, ...) \
-    do {                    \
-        if (!(_bool)) {\
-            fprintf(stderr, "failed: "_ERR" at %s:%d", ##__VA_ARGS__, __FILE__, __LINE__); \
-            exit(1);\
-        }\
-    } while (false)
-
-typedef struct {
-    SDL_GPUShaderCreateInfo info;
-    SDL_GPUShader *shader;
-} shader_t;
-
-static void error_callback(void *userdata, const char *error) {
-    (void) userdata;
-    fprintf(stderr, "Error: %s\n", error);
-    exit(1);
+#include "sprite_atlas.h"
+#include "sprite_batch.h"
+#include "tilemap.h"
+#include "upload_ring.h"
+
+// per frame scratch: hud lists and anything else that only lives until the next frame
+#define FRAME_ARENA_SIZE (1024 * 1024)
+// smallest nodes one tile wide, loose enough to hold a tower or an enemy
+#define ENTITY_TREE_DEPTH 5
+// how often a paused window renders to move streaming textures along and pick up the ones that came in
+#define ASSET_POLL_NS (100 * SDL_NS_PER_MS)
+
+// imgui allocates through SDL so its allocations are counted with everything else
+static void *imgui_alloc(size_t size, void *user_data) {
+    (void) user_data;
+    return SDL_malloc(size);
 }
 
-static void
-dump_resource_list(spvc_compiler compiler, spvc_resources resources, spvc_resource_type type, const char *tag) {
-    const spvc_reflected_resource *list = NULL;
-    size_t count = 0;
-    size_t i;
-    CHECK_RET(spvc_resources_get_resource_list_for_type(resources, type, &list, &count) == SPVC_SUCCESS,
-              "Failed to get resource list for type: %d", type);
-    printf("%s\n", tag);
-    for (i = 0; i < count; i++) {
-        printf("ID: %u, BaseTypeID: %u, TypeID: %u, Name: %s\n", list[i].id, list[i].base_type_id, list[i].type_id,
-               list[i].name);
-        printf("  Set: %u, Binding: %u\n",
-               spvc_compiler_get_decoration(compiler, list[i].id, SpvDecorationDescriptorSet),
-               spvc_compiler_get_decoration(compiler, list[i].id, SpvDecorationBinding));
-    }
+static void imgui_free(void *mem, void *user_data) {
+    (void) user_data;
+    SDL_free(mem);
 }
 
-static void dump_resources(spvc_compiler compiler, spvc_resources resources) {
-    dump_resource_list(compiler, resources, SPVC_RESOURCE_TYPE_UNIFORM_BUFFER, "UBO");
-    dump_resource_list(compiler, resources, SPVC_RESOURCE_TYPE_STORAGE_BUFFER, "SSBO");
-    dump_resource_list(compiler, resources, SPVC_RESOURCE_TYPE_PUSH_CONSTANT, "Push");
-    dump_resource_list(compiler, resources, SPVC_RESOURCE_TYPE_SEPARATE_SAMPLERS, "Samplers");
-    dump_resource_list(compiler, resources, SPVC_RESOURCE_TYPE_SEPARATE_IMAGE, "Image");
-    dump_resource_list(compiler, resources, SPVC_RESOURCE_TYPE_SAMPLED_IMAGE, "Combined image samplers");
-    dump_resource_list(compiler, resources, SPVC_RESOURCE_TYPE_STAGE_INPUT, "Stage input");
-    dump_resource_list(compiler, resources, SPVC_RESOURCE_TYPE_STAGE_OUTPUT, "Stage output");
-    dump_resource_list(compiler, resources, SPVC_RESOURCE_TYPE_STORAGE_IMAGE, "Storage image");
-    dump_resource_list(compiler, resources, SPVC_RESOURCE_TYPE_SUBPASS_INPUT, "Subpass input");
-}
+void imgui_init(SDL_GPUDevice *device, SDL_Window *window, float main_scale) {
+    igSetAllocatorFunctions(imgui_alloc, imgui_free, NULL);
+    igCreateContext(NULL);
+    ImGuiIO *io = igGetIO_Nil();
+    io->ConfigFlags |= ImGuiConfigFlags_DockingEnable;
+    io->ConfigFlags |= ImGuiConfigFlags_NavEnableKeyboard;
 
-typedef struct {
-    float x;
-    float y;
-    float color[4];
-} vertex_pos_color_t;
-
-shader_t *load_shader(SDL_GPUDevice *device, const char *path, SDL_GPUShaderStage stage, spvc_context context) {
-    size_t size = 0;
-    void *file = SDL_LoadFile(path, &size);
-    if (size == 0) {
-        SDL_free(file);
-        return NULL;
-    }
-
-    spvc_parsed_ir ir;
-    spvc_compiler compiler;
-    spvc_compiler_options options;
-    spvc_resources resources;
-    CHECK_RET(spvc_context_parse_spirv(context, file, size / sizeof(SpvId), &ir) == SPVC_SUCCESS,
-              "Failed to parse spirv ir");
-    CHECK_RET(
-            spvc_context_create_compiler(context, SPVC_BACKEND_NONE, ir, SPVC_CAPTURE_MODE_TAKE_OWNERSHIP, &compiler) ==
-            SPVC_SUCCESS, "Failed to create SPVC_BACKEND_NONE compiler");
-    CHECK_RET(spvc_compiler_create_compiler_options(compiler, &options) == SPVC_SUCCESS,
-              "Failed to create compiler options");
-    CHECK_RET(spvc_compiler_install_compiler_options(compiler, options) == SPVC_SUCCESS,
-              "Failed to install compiler options");
-    CHECK_RET(spvc_compiler_create_shader_resources(compiler, &resources) == SPVC_SUCCESS,
-              "Failed to create shader resources");
-
-    size_t num_uniform_buffers;
-    const spvc_reflected_resource *list = NULL;
-    CHECK_RET(spvc_resources_get_resource_list_for_type(resources, SPVC_RESOURCE_TYPE_UNIFORM_BUFFER, &list,
-                                                        &num_uniform_buffers) == SPVC_SUCCESS,
-              "Failed to get resource list for type: %d", SPVC_RESOURCE_TYPE_UNIFORM_BUFFER);
-    size_t num_storage_buffers;
-    CHECK_RET(spvc_resources_get_resource_list_for_type(resources, SPVC_RESOURCE_TYPE_STORAGE_BUFFER, &list,
-                                                        &num_storage_buffers) == SPVC_SUCCESS,
-              "Failed to get resource list for type: %d", SPVC_RESOURCE_TYPE_STORAGE_BUFFER);
-    size_t num_samplers;
-    CHECK_RET(spvc_resources_get_resource_list_for_type(resources, SPVC_RESOURCE_TYPE_SEPARATE_SAMPLERS, &list,
-                                                        &num_samplers) == SPVC_SUCCESS,
-              "Failed to get resource list for type: %d", SPVC_RESOURCE_TYPE_SEPARATE_SAMPLERS);
-    size_t num_storage_textures;
-    CHECK_RET(spvc_resources_get_resource_list_for_type(resources, SPVC_RESOURCE_TYPE_STORAGE_IMAGE, &list,
-                                                        &num_storage_textures) == SPVC_SUCCESS,
-              "Failed to get resource list for type: %d", SPVC_RESOURCE_TYPE_STORAGE_IMAGE);
-
-    SDL_PropertiesID props = SDL_CreateProperties();
-    SDL_SetStringProperty(props, SDL_PROP_GPU_SHADER_CREATE_NAME_STRING, path);
-    SDL_GPUShaderCreateInfo info = {
-            .code = file,
-            .code_size = size,
-            .entrypoint = "main",
-            .format = SDL_GPU_SHADERFORMAT_SPIRV,
-            .stage = stage,
-            .props = props,
-            .num_samplers = num_samplers,
-            .num_storage_buffers = num_storage_buffers,
-            .num_uniform_buffers = num_uniform_buffers,
-            .num_storage_textures = num_storage_textures,
+    igStyleColorsDark(NULL);
+
+    ImGuiStyle *style = igGetStyle();
+    ImGuiStyle_ScaleAllSizes(style, main_scale);
+    style->FontScaleDpi = main_scale;
+
+    ImGui_ImplSDL3_InitForSDLGPU(window);
+    ImGui_ImplSDLGPU3_InitInfo imgui_init_info = {
+            .Device = device,
+            .MSAASamples = 4,
+            .ColorTargetFormat = SDL_GetGPUSwapchainTextureFormat(device, window),
     };
-    SDL_GPUShader *shader = SDL_CreateGPUShader(device, &info);
-    SDL_free(file);
-    if (shader == NULL) {
-        return NULL;
-    }
-    shader_t *ret = SDL_malloc(sizeof(shader_t));
-    ret->shader = shader;
-    ret->info = info;
-    return ret;
+    ImGui_ImplSDLGPU3_Init(&imgui_init_info);
 }
 
-void free_shader(SDL_GPUDevice *device, shader_t *shader) {
-    assert(device && "device is null");
-    assert(shader && "shader is null");
-    SDL_ReleaseGPUShader(device, shader->shader);
-    SDL_free(shader);
+static float lerp(float a, float b, float t) {
+    return a + (b - a) * t;
 }
 
-typedef void (*convert_format_fun_t)(void *input, size_t input_size, void *out, size_t *out_size);
-
-typedef struct {
-    SDL_PixelFormat surface;
-    SDL_GPUTextureFormat gpu;
-    convert_format_fun_t convert;
-    SDL_GPUTextureFormat convert_format;
-    uint8_t bits_per_pixel;
-} sdl_surface_format_to_gpu_format;
-
-void convert_bgr24_to_rgba8(void *input, size_t input_size, void *out, size_t *out_size) {
-    uint8_t *input_as_bytes = (uint8_t *) input;
-    uint8_t *out_as_bytes = (uint8_t *) out;
-    size_t pixels = input_size;
-    for (size_t i = 0; i < pixels; i++) {
-        size_t input_px = i * 3;
-        size_t out_px = i * 4;
-
-        uint8_t b = input_as_bytes[input_px + 0];
-        uint8_t g = input_as_bytes[input_px + 1];
-        uint8_t r = input_as_bytes[input_px + 2];
-
-        out_as_bytes[out_px + 0] = r;
-        out_as_bytes[out_px + 1] = g;
-        out_as_bytes[out_px + 2] = b;
-        out_as_bytes[out_px + 3] = UINT8_MAX;
+// shortest way around, the sim wraps angles into [0, 2pi)
+static float lerp_angle(float a, float b, float t) {
+    float delta = b - a;
+    if (delta > SDL_PI_F) {
+        delta -= 2.0f * SDL_PI_F;
+    } else if (delta < -SDL_PI_F) {
+        delta += 2.0f * SDL_PI_F;
+    }
+    return a + delta * t;
+}
 
-        *out_size += 4;
+// blocked tiles, spawns and the goal. again after steps that placed towers, tiles that didn't change cost nothing
+static void mark_flow_field_tiles(tilemap_t *tilemap, const flow_field_t *flow_field) {
+    for (uint32_t y = 0; y < flow_field->height; y++) {
+        for (uint32_t x = 0; x < flow_field->width; x++) {
+            if (flow_field->blocked[flow_field_cell(flow_field, x, y)]) {
+                tilemap_set(tilemap, x, y, TILE_KIND_BLOCKED);
+            }
+        }
     }
+    for (uint32_t i = 0; i < flow_field->num_spawns; i++) {
+        uint32_t cell = flow_field->spawns[i];
+        tilemap_set(tilemap, cell % flow_field->stride - 1, cell / flow_field->stride - 1, TILE_KIND_SPAWN);
+    }
+    uint32_t goal = flow_field->goal;
+    tilemap_set(tilemap, goal % flow_field->stride - 1, goal / flow_field->stride - 1, TILE_KIND_GOAL);
 }
 
-sdl_surface_format_to_gpu_format pixel_to_gpu[] = {
-        {SDL_PIXELFORMAT_BGR24, SDL_GPU_TEXTUREFORMAT_INVALID, convert_bgr24_to_rgba8,
-         SDL_GPU_TEXTUREFORMAT_R8G8B8A8_UNORM, 32},
+static const float kind_scale[ENTITY_KIND_COUNT] = {
+        [ENTITY_KIND_ENEMY] = 0.05f,
+        [ENTITY_KIND_TOWER] = 2.0f / GAME_STATE_MAP_SIZE,
+        [ENTITY_KIND_PROJECTILE] = 0.02f,
+};
+// all grass until there is art for them
+static const sprite_id_t kind_sprite[ENTITY_KIND_COUNT] = {
+        [ENTITY_KIND_ENEMY] = SPRITE_ID_GRASS,
+        [ENTITY_KIND_TOWER] = SPRITE_ID_GRASS,
+        [ENTITY_KIND_PROJECTILE] = SPRITE_ID_GRASS,
+};
+static const float kind_color[ENTITY_KIND_COUNT][4] = {
+        [ENTITY_KIND_ENEMY] = {1.0f, 0.4f, 0.4f, 1.0f},
+        [ENTITY_KIND_TOWER] = {0.4f, 0.4f, 1.0f, 1.0f},
+        [ENTITY_KIND_PROJECTILE] = {1.0f, 1.0f, 0.4f, 1.0f},
 };
 
-#define PIXEL_TO_GPU_SIZE (sizeof(pixel_to_gpu) / sizeof(sdl_surface_format_to_gpu_format))
-
-sdl_surface_format_to_gpu_format *gpu_format_for_surface(SDL_PixelFormat pixel_format) {
-    for (size_t i = 0; i < PIXEL_TO_GPU_SIZE; i++) {
-        if (pixel_to_gpu[i].surface == pixel_format) {
-            return &pixel_to_gpu[i];
-        }
+// bounds around where each entity may be drawn between the last two steps, keyed by dense index. positions only
+// move in sim_step, so frames between steps reuse the tree
+static void build_entity_tree(quadtree_t *tree, const entity_store_t *entities) {
+    quadtree_begin(tree);
+    for (uint32_t i = 0; i < entities->count; i++) {
+        float half = kind_scale[entities->kind[i]] * 0.5f;
+        quadtree_insert(tree, i, SDL_min(entities->prev_x[i], entities->pos_x[i]) - half,
+                        SDL_min(entities->prev_y[i], entities->pos_y[i]) - half,
+                        SDL_max(entities->prev_x[i], entities->pos_x[i]) + half,
+                        SDL_max(entities->prev_y[i], entities->pos_y[i]) + half);
     }
-    return NULL;
+    quadtree_end(tree);
 }
 
-SDL_GPUTexture *upload_texture_to_gpu(SDL_GPUDevice *device, const char *asset_name) {
-    char buffer[1024] = {0};
-    snprintf(buffer, sizeof(buffer), "assets/%s", asset_name);
-    SDL_Surface *surface = SDL_LoadBMP(buffer);
-    if (surface == NULL) {
-        SDL_PRINT_ERROR_AND_EXIT("failed to load texture");
-    }
-
-    sdl_surface_format_to_gpu_format *converter = gpu_format_for_surface(surface->format);
-    CHECK_RET(converter != NULL, "Cant load texture with with SDL_PixelFormat: %d", surface->format);
-
-    uint32_t w = surface->w;
-    uint32_t h = surface->h;
-    bool free_pixels = false;
-    uint8_t *pixels = NULL;
-    SDL_GPUTextureFormat format;
-    if (converter->gpu == SDL_GPU_TEXTUREFORMAT_INVALID) {
-        pixels = SDL_malloc(1024 * 1024 * 1024);
-        if (pixels == NULL) {
-            SDL_DestroySurface(surface);
-            return NULL;
+// `pages` holds the texture of every atlas page, sprites on one page share a binding
+static void submit_game_state(sprite_batch_t *sprite_batch, const game_state_t *state, float alpha,
+                              const float view[4], const uint32_t *visible, uint32_t num_visible,
+                              SDL_GPUTexture *const *pages, SDL_GPUSampler *sampler) {
+    // the ring as a whole, its sprites aren't worth a tree
+    static const float ring_extent = 0.75f + 0.08f;
+    if (view[0] <= ring_extent && view[2] >= -ring_extent && view[1] <= ring_extent && view[3] >= -ring_extent) {
+        const atlas_sprite_t *art = sprite_atlas_sprite(SPRITE_ID_GRASS);
+        for (int i = 0; i < GAME_STATE_RING_SPRITES; i++) {
+            float orbit = lerp_angle(state->prev_orbit[i], state->orbit[i], alpha);
+            sprite_t sprite = {
+                    .xy_pos = {SDL_cosf(orbit) * 0.75f, SDL_sinf(orbit) * 0.75f},
+                    .scale = {0.08f, 0.08f},
+                    .uv_rect = {art->uv_rect[0], art->uv_rect[1], art->uv_rect[2], art->uv_rect[3]},
+                    .color = {1.0f, 1.0f, 1.0f, 1.0f},
+                    .rotation = lerp_angle(state->prev_spin[i], state->spin[i], alpha),
+            };
+            sprite_batch_submit(sprite_batch, pages[art->page], sampler, 0, &sprite);
         }
-        size_t out_size = 0;
-        converter->convert(surface->pixels, w * h, pixels, &out_size);
-        format = converter->convert_format;
-        free_pixels = true;
-    } else {
-        pixels = surface->pixels;
-        format = converter->gpu;
-    }
-
-    SDL_GPUTextureCreateInfo texture_info = {
-            .width = surface->w,
-            .height = surface->h,
-            .format = format,
-            .layer_count_or_depth = 1,
-            .num_levels = 1,
-            .usage = SDL_GPU_TEXTUREUSAGE_SAMPLER,
-    };
-    SDL_GPUTexture *texture = SDL_CreateGPUTexture(device, &texture_info);
-    if (texture == NULL) {
-        goto error;
     }
 
-    size_t size_bytes = w * h * (converter->bits_per_pixel / 8);
-    SDL_GPUTransferBufferCreateInfo texture_transfer_buffer_info = {
-            .size = size_bytes,
-    };
-    SDL_GPUTransferBuffer *texture_transfer_buffer = SDL_CreateGPUTransferBuffer(device, &texture_transfer_buffer_info);
-    if (texture_transfer_buffer == NULL) {
-        goto error;
+    // straight off the component arrays, one instance per visible entity
+    const entity_store_t *entities = &state->entities;
+    for (uint32_t v = 0; v < num_visible; v++) {
+        uint32_t i = visible[v];
+        uint8_t kind = entities->kind[i];
+        const atlas_sprite_t *art = sprite_atlas_sprite(kind_sprite[kind]);
+        sprite_t sprite = {
+                .xy_pos = {lerp(entities->prev_x[i], entities->pos_x[i], alpha),
+                           lerp(entities->prev_y[i], entities->pos_y[i], alpha)},
+                .scale = {kind_scale[kind], kind_scale[kind]},
+                .uv_rect = {art->uv_rect[0], art->uv_rect[1], art->uv_rect[2], art->uv_rect[3]},
+                .color = {kind_color[kind][0], kind_color[kind][1], kind_color[kind][2], kind_color[kind][3]},
+        };
+        sprite_batch_submit(sprite_batch, pages[art->page], sampler, 1, &sprite);
     }
+}
 
-    void *mem = SDL_MapGPUTransferBuffer(device, texture_transfer_buffer, false);
-    memcpy(mem, pixels, size_bytes);
-    SDL_UnmapGPUTransferBuffer(device, texture_transfer_buffer);
+// what hits and kills look like, indexed by game_effect_kind_t. positions come from the effect
+static const particle_burst_t effect_bursts[GAME_EFFECT_COUNT] = {
+        [GAME_EFFECT_HIT] = {.count = 24, .speed = 0.3f, .lifetime = 0.25f, .size = 0.01f,
+                             .color = {1.0f, 0.85f, 0.4f, 1.0f}},
+        [GAME_EFFECT_KILL] = {.count = 160, .speed = 0.6f, .lifetime = 0.6f, .size = 0.016f,
+                              .color = {1.0f, 0.45f, 0.15f, 1.0f}},
+};
 
-    SDL_GPUCommandBuffer *command_buffer = SDL_AcquireGPUCommandBuffer(device);
-    if (command_buffer == NULL) {
-        goto error;
+// everything that was hit or killed since the last rendered frame bursts into particles
+static void emit_effects(particles_t *particles, game_state_t *state) {
+    for (uint32_t i = 0; i < state->num_effects; i++) {
+        const game_effect_t *effect = &state->effects[i];
+        particle_burst_t burst = effect_bursts[effect->kind];
+        burst.x = effect->x;
+        burst.y = effect->y;
+        particles_emit(particles, &burst);
     }
+    state->num_effects = 0;
+}
 
-    SDL_GPUCopyPass *copy_pass = SDL_BeginGPUCopyPass(command_buffer);
-
-    SDL_UploadToGPUTexture(copy_pass,
-                           &(SDL_GPUTextureTransferInfo) {
-                                   .transfer_buffer = texture_transfer_buffer,
-                                   .pixels_per_row = w,
-                                   .rows_per_layer = h,
-                           }, &(SDL_GPUTextureRegion) {
-                    .texture = texture,
-                    .w = w,
-                    .h = h,
-            }, false);
-
-    SDL_EndGPUCopyPass(copy_pass);
-    SDL_SubmitGPUCommandBuffer(command_buffer);
-
-    SDL_ReleaseGPUTransferBuffer(device, texture_transfer_buffer);
-    SDL_DestroySurface(surface);
-    if (free_pixels) {
-        SDL_free(pixels);
+// frame time graph, the zones of the last frame and what it drew and uploaded
+static void draw_profiler_hud(const profiler_t *profiler, const frame_ring_t *frame_ring, arena_t *frame_arena,
+                              float main_scale) {
+    profiler_frame_stats_t frame_stats;
+    profiler_frame_stats(profiler, &frame_stats);
+    float *frame_ms = ARENA_NEW(frame_arena, float, PROFILER_HISTORY_FRAMES);
+    uint32_t num_frame_ms = frame_ms != NULL ? profiler_frame_times(profiler, frame_ms, PROFILER_HISTORY_FRAMES) : 0;
+    char overlay[64];
+    SDL_snprintf(overlay, sizeof(overlay), "p50 %.2f  p99 %.2f  max %.2f ms",
+                 (double) frame_stats.p50_ns / SDL_NS_PER_MS, (double) frame_stats.p99_ns / SDL_NS_PER_MS,
+                 (double) frame_stats.max_ns / SDL_NS_PER_MS);
+    igPlotLines_FloatPtr("##frame_ms", frame_ms, (int) num_frame_ms, 0, overlay, 0.0f,
+                         (float) ((double) frame_stats.max_ns / SDL_NS_PER_MS) * 1.1f,
+                         (ImVec2) {300.0f * main_scale, 60.0f * main_scale}, sizeof(float));
+    igText("gpu: %.2f ms submit to fence", (double) frame_ring->last_gpu_ns / SDL_NS_PER_MS);
+
+    const profiler_frame_t *last = profiler_last_frame(profiler);
+    if (last == NULL) {
+        return;
     }
-    return texture;
-
-    error:
-    if (free_pixels) {
-        SDL_free(pixels);
+    for (uint32_t i = 0; i < last->num_zones; i++) {
+        const profiler_zone_t *zone = &last->zones[i];
+        igText("%*s%-18s %7.3f ms", (int) zone->depth * 2, "", zone->name,
+               (double) (zone->end_ns - zone->begin_ns) / SDL_NS_PER_MS);
     }
-    if (texture) {
-        SDL_ReleaseGPUTexture(device, texture);
+    igText("draws: %" SDL_PRIu64 ", binds: %" SDL_PRIu64 ", uploaded: %.1f KiB",
+           last->counters[PROFILER_COUNTER_DRAW_CALLS], last->counters[PROFILER_COUNTER_BINDS],
+           (double) last->counters[PROFILER_COUNTER_UPLOAD_BYTES] / 1024.0);
+    igText("heap allocations: %" SDL_PRIu64 ", frame arena: %zu KiB (high water %zu of %zu KiB)",
+           last->counters[PROFILER_COUNTER_HEAP_ALLOCATIONS], frame_arena->used / 1024,
+           frame_arena->high_water / 1024, frame_arena->size / 1024);
+    if (profiler->dropped_zones > 0) {
+        igText("dropped zones: %" SDL_PRIu64, profiler->dropped_zones);
     }
-    SDL_DestroySurface(surface);
-    return NULL;
 }
 
-void imgui_init(SDL_GPUDevice *device, SDL_Window *window, float main_scale) {
-    igCreateContext(NULL);
-    ImGuiIO *io = igGetIO_Nil();
-    io->ConfigFlags |= ImGuiConfigFlags_DockingEnable;
-    io->ConfigFlags |= ImGuiConfigFlags_NavEnableKeyboard;
-
-    igStyleColorsDark(NULL);
-
-    ImGuiStyle *style = igGetStyle();
-    ImGuiStyle_ScaleAllSizes(style, main_scale);
-    style->FontScaleDpi = main_scale;
-
-    ImGui_ImplSDL3_InitForSDLGPU(window);
-    ImGui_ImplSDLGPU3_InitInfo imgui_init_info = {
-            .Device = device,
-            .MSAASamples = 4,
-            .ColorTargetFormat = SDL_GetGPUSwapchainTextureFormat(device, window),
-    };
-    ImGui_ImplSDLGPU3_Init(&imgui_init_info);
+// what the registry counts as alive on the gpu, per kind and in total
+static void draw_gpu_resources_hud(const gpu_resource_stats_t *stats) {
+    const double mib = 1024.0 * 1024.0;
+    igText("gpu memory: %.1f MiB (peak %.1f MiB), %" SDL_PRIu64 " created, %" SDL_PRIu64 " released",
+           (double) stats->total_bytes / mib, (double) stats->peak_bytes / mib, stats->created, stats->released);
+    for (int kind = 0; kind < GPU_RESOURCE_COUNT; kind++) {
+        if (stats->live[kind] > 0) {
+            igText("  %-18s %4u %8.2f MiB", gpu_resource_kind_name(kind), stats->live[kind],
+                   (double) stats->bytes[kind] / mib);
+        }
+    }
 }
 
-SDL_GPUGraphicsPipeline *
-load_simple_triangle_pipeline(SDL_GPUDevice *device, SDL_GPUTextureFormat color_target_format, spvc_context context) {
-    shader_t *simple_vert = load_shader(device, "simple.vert.hlsl.spirv", SDL_GPU_SHADERSTAGE_VERTEX, context);
-    if (simple_vert == NULL) {
-        SDL_PRINT_ERROR_AND_EXIT("failed to load simple_vert shader");
+// no window, no gpu: steps the simulation as fast as the cpu allows and reports the tick rate
+static int run_headless(uint64_t ticks, uint32_t seed, uint32_t workers) {
+    if (!SDL_Init(0)) {
+        SDL_PRINT_ERROR_AND_EXIT("SDL_Init");
     }
 
-    shader_t *simple_frag = load_shader(device, "simple.frag.hlsl.spirv", SDL_GPU_SHADERSTAGE_FRAGMENT, context);
-    if (simple_frag == NULL) {
-        SDL_PRINT_ERROR_AND_EXIT("failed to load simple_frag shader");
+    job_system_t jobs;
+    if (!job_system_init(&jobs, workers)) {
+        SDL_PRINT_ERROR_AND_EXIT("failed to start the job system");
     }
 
-    SDL_GPUColorTargetDescription color_target_description = {
-            .format = color_target_format,
-    };
-    SDL_GPUVertexBufferDescription vertex_buffer_description = {
-            .slot = 0,
-            .input_rate = SDL_GPU_VERTEXINPUTRATE_VERTEX,
-            .instance_step_rate = 0,
-            .pitch = sizeof(vertex_pos_color_t),
-    };
-    SDL_GPUVertexAttribute vertex_attributes[] = {
-            {
-                    .buffer_slot = 0,
-                    .format = SDL_GPU_VERTEXELEMENTFORMAT_FLOAT2,
-                    .location = 0,
-                    .offset = 0,
-            },
-            {
-                    .buffer_slot = 0,
-                    .format = SDL_GPU_VERTEXELEMENTFORMAT_FLOAT4,
-                    .location = 1,
-                    .offset = offsetof(vertex_pos_color_t, color),
-            },
-    };
-    SDL_GPUGraphicsPipelineCreateInfo pipeline_create_info = {
-            .vertex_shader = simple_vert->shader,
-            .fragment_shader = simple_frag->shader,
-            .primitive_type = SDL_GPU_PRIMITIVETYPE_TRIANGLELIST,
-            .target_info = {
-                    .num_color_targets = 1,
-                    .color_target_descriptions = &color_target_description,
-            },
-            .rasterizer_state = {
-                    .fill_mode = SDL_GPU_FILLMODE_FILL,
-            },
-            .vertex_input_state = (SDL_GPUVertexInputState) {
-                    .num_vertex_buffers = 1,
-                    .vertex_buffer_descriptions = &vertex_buffer_description,
-                    .num_vertex_attributes = ARRAY_SIZE(vertex_attributes),
-                    .vertex_attributes = vertex_attributes,
-            },
-    };
-    SDL_GPUGraphicsPipeline *pipeline = SDL_CreateGPUGraphicsPipeline(device, &pipeline_create_info);
-    free_shader(device, simple_frag);
-    free_shader(device, simple_vert);
-    return pipeline;
-}
-
-SDL_GPUGraphicsPipeline *
-load_quad_pipeline(SDL_GPUDevice *device, SDL_GPUTextureFormat color_target_format, spvc_context context) {
-    shader_t *quad_vertex_shader = load_shader(device, "quad.vert.hlsl.spirv", SDL_GPU_SHADERSTAGE_VERTEX, context);
-    if (quad_vertex_shader == NULL) {
-        SDL_PRINT_ERROR_AND_EXIT("failed to load quad vertex shader");
+    game_state_t *state = SDL_malloc(sizeof(game_state_t));
+    if (state == NULL) {
+        SDL_PRINT_ERROR_AND_EXIT("failed to allocate game state");
     }
-
-    shader_t *quad_frag_shader = load_shader(device, "quad.frag.hlsl.spirv", SDL_GPU_SHADERSTAGE_FRAGMENT, context);
-    if (quad_frag_shader == NULL) {
-        SDL_PRINT_ERROR_AND_EXIT("failed to load quad frag shader");
+    if (!game_state_init(state, seed, &jobs)) {
+        SDL_PRINT_ERROR_AND_EXIT("failed to create game state");
     }
 
-    SDL_GPUColorTargetDescription color_target_description = {
-            .format = color_target_format,
-    };
-    SDL_GPUVertexBufferDescription vertex_buffer_description = {
-            .slot = 0,
-            .input_rate = SDL_GPU_VERTEXINPUTRATE_VERTEX,
-            .instance_step_rate = 0,
-            .pitch = sizeof(quad_vert),
-    };
-    SDL_GPUVertexAttribute vertex_attributes[] = {
-            { // xy_pos
-                    .buffer_slot = 0,
-                    .format = SDL_GPU_VERTEXELEMENTFORMAT_FLOAT2,
-                    .location = 0,
-                    .offset = offsetof(quad_vert, xy_pos),
-            },
-            { // uv
-                    .buffer_slot = 0,
-                    .format = SDL_GPU_VERTEXELEMENTFORMAT_FLOAT2,
-                    .location = 1,
-                    .offset = offsetof(quad_vert, uv),
-            },
-            { // color
-                    .buffer_slot = 0,
-                    .format = SDL_GPU_VERTEXELEMENTFORMAT_FLOAT4,
-                    .location = 2,
-                    .offset = offsetof(quad_vert, color),
-            },
-    };
-    SDL_GPUGraphicsPipelineCreateInfo pipeline_create_info = {
-            .vertex_shader = quad_vertex_shader->shader,
-            .fragment_shader = quad_frag_shader->shader,
-            .primitive_type = SDL_GPU_PRIMITIVETYPE_TRIANGLELIST,
-            .target_info = {
-                    .num_color_targets = 1,
-                    .color_target_descriptions = &color_target_description,
-            },
-            .rasterizer_state = {
-                    .fill_mode = SDL_GPU_FILLMODE_FILL,
-            },
-            .vertex_input_state = (SDL_GPUVertexInputState) {
-                    .num_vertex_buffers = 1,
-                    .vertex_buffer_descriptions = &vertex_buffer_description,
-                    .num_vertex_attributes = ARRAY_SIZE(vertex_attributes),
-                    .vertex_attributes = vertex_attributes,
-            },
-    };
-    SDL_GPUGraphicsPipeline* pipeline = SDL_CreateGPUGraphicsPipeline(device, &pipeline_create_info);
-    free_shader(device, quad_frag_shader);
-    free_shader(device, quad_vertex_shader);
-    return pipeline;
+    uint64_t start = SDL_GetTicksNS();
+    uint32_t heap_allocations = memory_heap_allocations();
+    for (uint64_t i = 0; i < ticks; i++) {
+        sim_step(state, SIM_DT);
+    }
+    heap_allocations = memory_heap_allocations() - heap_allocations;
+    double seconds = (double) (SDL_GetTicksNS() - start) / SDL_NS_PER_SECOND;
+
+    SDL_Log("headless: %" SDL_PRIu64 " ticks (%.1f s simulated) in %.3f s, %.0f ticks/s on %u threads, checksum %016"
+            SDL_PRIx64, state->tick, (double) state->tick / SIM_TICK_RATE, seconds,
+            seconds > 0.0 ? (double) state->tick / seconds : 0.0, jobs.num_threads, game_state_checksum(state));
+    // everything the simulation needs is allocated by game_state_init, stepping must not touch the heap
+    SDL_Log("headless: %u heap allocations while stepping", heap_allocations);
+    game_state_destroy(state);
+    SDL_free(state);
+    job_system_destroy(&jobs);
+    SDL_Quit();
+    return 0;
 }
 
-void upload_data_to_gpu(SDL_GPUDevice *device, SDL_GPUBuffer *buffer, const void* data, size_t size) {
-    // TODO: make uploads batched
-    SDL_GPUTransferBufferCreateInfo transfer_buffer_info = {
-            .usage = SDL_GPU_TRANSFERBUFFERUSAGE_UPLOAD,
-            .size = size,
-    };
-    SDL_GPUTransferBuffer *transfer_buffer = SDL_CreateGPUTransferBuffer(device, &transfer_buffer_info);
-    void *mem = SDL_MapGPUTransferBuffer(device, transfer_buffer, false);
-    memcpy(mem, data, size);
-    SDL_UnmapGPUTransferBuffer(device, transfer_buffer);
-
-    SDL_GPUCommandBuffer *command_buffer = SDL_AcquireGPUCommandBuffer(device);
-
-    SDL_GPUCopyPass *copy_pass = SDL_BeginGPUCopyPass(command_buffer);
-    SDL_GPUTransferBufferLocation source = {
-        .transfer_buffer = transfer_buffer,
-    };
-    SDL_GPUBufferRegion destination = {
-        .buffer = buffer,
-        .size = size,
-    };
-    SDL_UploadToGPUBuffer(copy_pass, &source, &destination, false);
-    SDL_EndGPUCopyPass(copy_pass);
+int main(int argc, char **argv) {
+    if (!memory_track_heap()) {
+        SDL_PRINT_ERROR_AND_EXIT("failed to hook the allocator");
+    }
+    uint32_t frames_in_flight = FRAME_RING_DEFAULT_FRAMES;
+    bool headless = false;
+    // ten simulated minutes
+    uint64_t headless_ticks = 10 * 60 * SIM_TICK_RATE;
+    uint32_t seed = 1;
+    uint32_t workers = job_system_default_workers();
+    bool use_asset_pack = true;
+    // 0: as fast as the swapchain's present mode lets frames through
+    uint32_t fps_cap = 0;
+    for (int i = 1; i < argc; i++) {
+        if (SDL_strcmp(argv[i], "--frames-in-flight") == 0 && i + 1 < argc) {
+            frames_in_flight = (uint32_t) SDL_atoi(argv[++i]);
+        } else if (SDL_strcmp(argv[i], "--headless") == 0) {
+            headless = true;
+        } else if (SDL_strcmp(argv[i], "--ticks") == 0 && i + 1 < argc) {
+            headless_ticks = SDL_strtoull(argv[++i], NULL, 10);
+        } else if (SDL_strcmp(argv[i], "--seed") == 0 && i + 1 < argc) {
+            seed = (uint32_t) SDL_strtoul(argv[++i], NULL, 10);
+        } else if (SDL_strcmp(argv[i], "--fps-cap") == 0 && i + 1 < argc) {
+            fps_cap = (uint32_t) SDL_strtoul(argv[++i], NULL, 10);
+        } else if (SDL_strcmp(argv[i], "--no-pack") == 0) {
+            use_asset_pack = false;
+        } else if (SDL_strcmp(argv[i], "--threads") == 0 && i + 1 < argc) {
+            // total threads, the main one included
+            int threads = SDL_atoi(argv[++i]);
+            workers = threads > 1 ? (uint32_t) threads - 1 : 0;
+        }
+    }
 
-    SDL_SubmitGPUCommandBuffer(command_buffer);
-    SDL_ReleaseGPUTransferBuffer(device, transfer_buffer);
-}
+    if (headless) {
+        return run_headless(headless_ticks, seed, workers);
+    }
 
-int main(void) {
+    uint64_t startup_begin = SDL_GetTicksNS();
     if (!SDL_Init(SDL_INIT_VIDEO)) {
         SDL_PRINT_ERROR_AND_EXIT("SDL_Init");
     }
 
-    spvc_context spvc_context;
-    CHECK_RET(spvc_context_create(&spvc_context) == SPVC_SUCCESS, "Failed to create spvc_context");
-    spvc_context_set_error_callback(spvc_context, error_callback, NULL);
-
     float main_scale = SDL_GetDisplayContentScale(SDL_GetPrimaryDisplay());
     SDL_WindowFlags window_flags = SDL_WINDOW_RESIZABLE | SDL_WINDOW_HIGH_PIXEL_DENSITY;
     SDL_Window *window = SDL_CreateWindow("Kingdom Defense", (int) (800 * main_scale), (int) (600 * main_scale),
@@ -492,53 +336,98 @@ int main(void) {
 
     SDL_GPUTextureFormat swapchain_texture_format = SDL_GetGPUSwapchainTextureFormat(device, window);
 
-    SDL_GPUTexture *grass = upload_texture_to_gpu(device, "grass.bmp");
-    SDL_GPUSamplerCreateInfo grass_sampler_info = {
+    // shader modules and pipelines are the bulk of startup on a cold driver cache, the worker starts on the sprite
+    // pipeline while the rest of startup runs. nothing else is built until something draws with it
+    render_pipelines_t render_pipelines;
+    if (!render_pipelines_init(&render_pipelines, device, swapchain_texture_format)) {
+        SDL_PRINT_ERROR_AND_EXIT("failed to start the pipeline builder");
+    }
+    render_pipelines_request(&render_pipelines, RENDER_PIPELINE_SPRITE);
+    render_pipelines_request(&render_pipelines, RENDER_PIPELINE_PARTICLE);
+
+    arena_t frame_arena;
+    if (!arena_init(&frame_arena, FRAME_ARENA_SIZE)) {
+        SDL_PRINT_ERROR_AND_EXIT("failed to create frame arena");
+    }
+
+    // the frame arena holds each compute shader file until its pipeline exists
+    particles_t particles;
+    if (!particles_init(&particles, device, &frame_arena, PARTICLES_DEFAULT_CAPACITY)) {
+        SDL_PRINT_ERROR_AND_EXIT("failed to create particles");
+    }
+
+    upload_ring_t upload_ring;
+    if (!upload_ring_init(&upload_ring, device, UPLOAD_RING_DEFAULT_SIZE)) {
+        SDL_PRINT_ERROR_AND_EXIT("failed to create upload ring");
+    }
+
+    // the pack is built next to the executable by the asset_pack target, without it textures fall back to bmp
+    asset_pack_t asset_pack;
+    bool have_pack = use_asset_pack && asset_pack_open(&asset_pack, ASSET_PACK_DEFAULT_PATH);
+    if (use_asset_pack && !have_pack) {
+        SDL_Log("no asset pack, loading bmp files: %s", SDL_GetError());
+    }
+    // textures load in the background, the first frames draw with the placeholder
+    asset_stream_t *asset_stream = SDL_malloc(sizeof(asset_stream_t));
+    if (asset_stream == NULL ||
+        !asset_stream_init(asset_stream, device, &upload_ring, have_pack ? &asset_pack : NULL)) {
+        SDL_PRINT_ERROR_AND_EXIT("failed to start the asset stream");
+    }
+    // every sprite lives on one of a few atlas pages, a frame binds each page once at most
+    uint32_t atlas_assets[SPRITE_ATLAS_NUM_PAGES];
+    for (uint32_t page = 0; page < SPRITE_ATLAS_NUM_PAGES; page++) {
+        atlas_assets[page] = asset_stream_request(asset_stream, sprite_atlas_page_name(page));
+    }
+    // trilinear over the mip chain from the pack, textures loaded from bmp only have their first level. deeper
+    // levels would blend neighbouring sprites
+    SDL_GPUSamplerCreateInfo atlas_sampler_info = {
+            .min_filter = SDL_GPU_FILTER_LINEAR,
+            .mag_filter = SDL_GPU_FILTER_LINEAR,
+            .mipmap_mode = SDL_GPU_SAMPLERMIPMAPMODE_LINEAR,
+            .max_lod = (float) ATLAS_MAX_LOD,
             .compare_op = SDL_GPU_COMPAREOP_ALWAYS,
     };
-    SDL_GPUSampler *grass_sampler = SDL_CreateGPUSampler(device, &grass_sampler_info);
-    if (!grass_sampler) {
-        SDL_PRINT_ERROR_AND_EXIT("failed to load grass_sampler");
+    SDL_GPUSampler *atlas_sampler = gpu_create_sampler(device, &atlas_sampler_info, GPU_CALLSITE);
+    if (!atlas_sampler) {
+        SDL_PRINT_ERROR_AND_EXIT("failed to load atlas_sampler");
     }
 
     imgui_init(device, window, main_scale);
 
-    SDL_GPUGraphicsPipeline *simple_triangle_pipeline = load_simple_triangle_pipeline(device, swapchain_texture_format, spvc_context);
-    if (!simple_triangle_pipeline) {
-        SDL_PRINT_ERROR_AND_EXIT("failed to load simple_triangle_pipeline");
+    // the first frame can't draw without it
+    uint64_t pipelines_begin = SDL_GetTicksNS();
+    SDL_GPUGraphicsPipeline *sprite_pipeline = render_pipelines_wait(&render_pipelines, RENDER_PIPELINE_SPRITE);
+    if (!sprite_pipeline) {
+        SDL_PRINT_ERROR_AND_EXIT("failed to load sprite pipeline");
     }
+    uint64_t pipelines_wait_ns = SDL_GetTicksNS() - pipelines_begin;
 
-    SDL_GPUGraphicsPipeline *quad_pipeline = load_quad_pipeline(device, swapchain_texture_format, spvc_context);
-    if (!quad_pipeline) {
-        SDL_PRINT_ERROR_AND_EXIT("failed to load quad pipeline");
+    frame_ring_t frame_ring;
+    if (!frame_ring_init(&frame_ring, device, sprite_pipeline, frames_in_flight)) {
+        SDL_PRINT_ERROR_AND_EXIT("failed to create frame ring");
     }
 
-    SDL_GPUBufferCreateInfo buffer_info = {
-            .usage = SDL_GPU_BUFFERUSAGE_VERTEX,
-            .size = sizeof(vertex_pos_color_t) * 3,
-    };
-    SDL_GPUBuffer *triangle_vertex = SDL_CreateGPUBuffer(device, &buffer_info);
-
-    vertex_pos_color_t rainbow_triangle_vertices[3] = {
-            {-1.0f, -1.0f, 1.0f, 0.0f, 0.0f, 1.0f},
-            {1.0f, -1.0f, 0.0f, 1.0f, 0.0f, 1.0f},
-            {0.0f, 1.0f, 0.0f, 0.0f, 1.0f, 1.0f},
-    };
-    upload_data_to_gpu(device, triangle_vertex, rainbow_triangle_vertices, sizeof(rainbow_triangle_vertices));
+    profiler_t profiler;
+    if (!profiler_init(&profiler)) {
+        SDL_PRINT_ERROR_AND_EXIT("failed to create profiler");
+    }
 
     quad_vert quad_vertices[] = {
             // top
-            { .xy_pos = {-0.5f, 0.5f}, .uv = {0.0f, 0.0f}, .color = {1.0f, 0.0f, 0.0f, 1.0f}},
-            { .xy_pos = {0.5f, 0.5f}, .uv = {1.0f, 0.0f}, .color = {0.0f, 0.0f, 1.0f, 1.0f}},
-            { .xy_pos = {-0.5f, -0.5f}, .uv = {0.0f, 1.0f}, .color = {0.0f, 0.0f, 1.0f, 1.0f}},
-            { .xy_pos = {0.5f, -0.5f}, .uv = {1.0f, 1.0f}, .color = {0.0f, 1.0f, 0.0f, 1.0f}},
+            { .xy_pos = {SNORM16(-0.5f), SNORM16(0.5f)}, .uv = {0, 0}, .color = {255, 0, 0, 255}},
+            { .xy_pos = {SNORM16(0.5f), SNORM16(0.5f)}, .uv = {UINT16_MAX, 0}, .color = {0, 0, 255, 255}},
+            { .xy_pos = {SNORM16(-0.5f), SNORM16(-0.5f)}, .uv = {0, UINT16_MAX}, .color = {0, 0, 255, 255}},
+            { .xy_pos = {SNORM16(0.5f), SNORM16(-0.5f)}, .uv = {UINT16_MAX, UINT16_MAX}, .color = {0, 255, 0, 255}},
     };
     SDL_GPUBufferCreateInfo quad_buffer_info = {
             .usage = SDL_GPU_BUFFERUSAGE_VERTEX,
             .size = sizeof(quad_vertices),
     };
-    SDL_GPUBuffer *quad_buffer = SDL_CreateGPUBuffer(device, &quad_buffer_info);
-    upload_data_to_gpu(device, quad_buffer, quad_vertices, sizeof(quad_vertices));
+    SDL_GPUBuffer *quad_buffer = gpu_create_buffer(device, &quad_buffer_info, GPU_CALLSITE);
+    if (!quad_buffer) {
+        SDL_PRINT_ERROR_AND_EXIT("failed to create quad_buffer");
+    }
+    upload_ring_upload_buffer(&upload_ring, quad_buffer, 0, quad_vertices, sizeof(quad_vertices));
 
     uint16_t quad_index[] = {
             0, 3, 1,
@@ -548,26 +437,187 @@ int main(void) {
             .usage = SDL_GPU_BUFFERUSAGE_INDEX,
             .size = sizeof(quad_index),
     };
-    SDL_GPUBuffer *quad_index_buffer = SDL_CreateGPUBuffer(device, &quad_index_buffer_info);
-    upload_data_to_gpu(device, quad_index_buffer, quad_index, sizeof(quad_index));
+    SDL_GPUBuffer *quad_index_buffer = gpu_create_buffer(device, &quad_index_buffer_info, GPU_CALLSITE);
+    if (!quad_index_buffer) {
+        SDL_PRINT_ERROR_AND_EXIT("failed to create quad_index_buffer");
+    }
+    upload_ring_upload_buffer(&upload_ring, quad_index_buffer, 0, quad_index, sizeof(quad_index));
+
+    // every startup upload goes out in a single copy pass
+    if (!upload_ring_submit(&upload_ring)) {
+        SDL_PRINT_ERROR_AND_EXIT("failed to submit uploads");
+    }
+
+    game_state_t *game_state = SDL_malloc(sizeof(game_state_t));
+    if (game_state == NULL) {
+        SDL_PRINT_ERROR_AND_EXIT("failed to allocate game state");
+    }
+    job_system_t jobs;
+    if (!job_system_init(&jobs, workers)) {
+        SDL_PRINT_ERROR_AND_EXIT("failed to start the job system");
+    }
+    if (!game_state_init(game_state, seed, &jobs)) {
+        SDL_PRINT_ERROR_AND_EXIT("failed to create game state");
+    }
+    // the ground, uploaded with the first frame's uploads
+    tilemap_t tilemap;
+    if (!tilemap_init(&tilemap, device, GAME_STATE_MAP_SIZE, GAME_STATE_MAP_SIZE, -1.0f, -1.0f,
+                      2.0f / GAME_STATE_MAP_SIZE, sprite_atlas_sprite(SPRITE_ID_GRASS)->uv_rect)) {
+        SDL_PRINT_ERROR_AND_EXIT("failed to create tilemap");
+    }
+    mark_flow_field_tiles(&tilemap, &game_state->flow_field);
+    // the whole map in view to begin with, wheel zooms and the right mouse button drags
+    camera_t camera;
+    camera_init(&camera, 0.0f, 0.0f, 1.0f);
+    quadtree_t entity_tree;
+    if (!quadtree_init(&entity_tree, -1.0f, -1.0f, 2.0f, ENTITY_TREE_DEPTH, GAME_STATE_MAX_ENTITIES)) {
+        SDL_PRINT_ERROR_AND_EXIT("failed to create entity tree");
+    }
+    uint64_t entity_tree_tick = UINT64_MAX;
+    sim_clock_t sim_clock;
+    sim_clock_init(&sim_clock);
+    uint64_t last_frame_ns = SDL_GetTicksNS();
+    // particles advance by real time between rendered frames
+    uint64_t last_particles_ns = last_frame_ns;
+    uint64_t last_upload_bytes = upload_ring.stats.bytes;
+    frame_pacer_t frame_pacer;
+    frame_pacer_init(&frame_pacer, fps_cap);
+    // textures only move through the stream in rendered frames, see the asset poll below
+    uint32_t last_assets_done = 0;
+    uint64_t asset_poll_ns = 0;
+    int fps_cap_setting = (int) fps_cap;
+    // refreshed after every submit, the overlay shows the previous frame's
+    gpu_resource_stats_t gpu_stats;
+    gpu_resources_stats(&gpu_stats);
 
     bool quit = false;
+    bool first_frame = true;
+    bool save_trace = false;
+    bool paused = false;
 
     while (!quit) {
+        // nothing moves while paused or minimized, so the loop sleeps until input or the next thing that is due
+        bool minimized = (SDL_GetWindowFlags(window) & SDL_WINDOW_MINIMIZED) != 0;
+        bool on_demand = paused || minimized;
+        asset_stream_stats_t asset_stats;
+        asset_stream_stats(asset_stream, &asset_stats);
+        uint32_t assets_done = asset_stats.resident + asset_stats.failed;
+        bool assets_loading = assets_done < asset_stats.requested;
+        uint64_t deadline_ns = 0;
+        if (!paused) {
+            // a minimized game still steps the simulation
+            deadline_ns = SDL_GetTicksNS() + sim_clock_until_step_ns(&sim_clock);
+        } else if (assets_loading && !minimized) {
+            deadline_ns = asset_poll_ns;
+        }
+        frame_pacer_wait(&frame_pacer, on_demand, deadline_ns);
+
+        profiler_frame_begin(&profiler);
+        arena_reset(&frame_arena);
+        uint32_t frame_heap_allocations = memory_heap_allocations();
+
+        uint32_t zone = profiler_begin(&profiler, "events");
         SDL_Event e;
         while (SDL_PollEvent(&e)) {
             ImGui_ImplSDL3_ProcessEvent(&e);
+            frame_pacer_request(&frame_pacer);
 
             if (e.type == SDL_EVENT_QUIT) {
                 quit = true;
             }
+            if (e.type == SDL_EVENT_KEY_DOWN && e.key.key == SDLK_F9 && !e.key.repeat) {
+                save_trace = true;
+            }
+            if (e.type == SDL_EVENT_KEY_DOWN && e.key.key == SDLK_P && !e.key.repeat &&
+                !igGetIO_Nil()->WantCaptureKeyboard) {
+                paused = !paused;
+            }
+            // event positions are in window coordinates
+            int window_w = 1;
+            int window_h = 1;
+            SDL_GetWindowSize(window, &window_w, &window_h);
+            bool mouse_free = !igGetIO_Nil()->WantCaptureMouse;
+            if (e.type == SDL_EVENT_MOUSE_WHEEL && mouse_free) {
+                camera_zoom_at(&camera, SDL_powf(0.9f, e.wheel.y), e.wheel.mouse_x, e.wheel.mouse_y,
+                               (float) window_w, (float) window_h);
+            }
+            if (e.type == SDL_EVENT_MOUSE_MOTION && (e.motion.state & SDL_BUTTON_RMASK) && mouse_free) {
+                camera_pan_pixels(&camera, e.motion.xrel, e.motion.yrel, (float) window_h);
+            }
+            if (e.type == SDL_EVENT_MOUSE_BUTTON_DOWN && e.button.button == SDL_BUTTON_LEFT && mouse_free) {
+                float x;
+                float y;
+                camera_screen_to_world(&camera, e.button.x, e.button.y, (float) window_w, (float) window_h, &x, &y);
+                // the simulation places it on its next step, like a replay would
+                game_input_t input = {.kind = GAME_INPUT_PLACE_TOWER, .x = x, .y = y};
+                if (!game_state_queue_input(game_state, &input)) {
+                    SDL_Log("can't place tower: %s", SDL_GetError());
+                }
+            }
             // process events
         }
+        profiler_end(&profiler, zone);
+
+        // the simulation keeps its fixed rate no matter how fast frames come, even while minimized. time spent
+        // paused is dropped
+        zone = profiler_begin(&profiler, "sim");
+        uint64_t now_ns = SDL_GetTicksNS();
+        uint32_t steps = paused ? 0 : sim_clock_advance(&sim_clock, now_ns - last_frame_ns);
+        last_frame_ns = now_ns;
+        uint64_t towers_placed = game_state->towers_placed;
+        uint64_t rejected_inputs = game_state->rejected_inputs;
+        for (uint32_t i = 0; i < steps; i++) {
+            sim_step(game_state, SIM_DT);
+        }
+        if (game_state->towers_placed != towers_placed) {
+            mark_flow_field_tiles(&tilemap, &game_state->flow_field);
+        }
+        if (game_state->rejected_inputs != rejected_inputs) {
+            SDL_Log("can't place tower: the tile is taken or it would wall in the spawns");
+        }
+        profiler_end(&profiler, zone);
+        // a texture that streamed in shows up on the next frame. one frame every ASSET_POLL_NS while textures are
+        // on their way keeps the stream going when nothing else renders
+        bool asset_poll_due = assets_loading && now_ns >= asset_poll_ns;
+        if (steps > 0 || assets_done != last_assets_done || asset_poll_due) {
+            frame_pacer_request(&frame_pacer);
+            last_assets_done = assets_done;
+        }
 
-        if (SDL_GetWindowFlags(window) & SDL_WINDOW_MINIMIZED) {
+        // nothing to see while minimized, the loop sleeps until the next sim step
+        if (minimized) {
+            frame_pacer_skip(&frame_pacer);
+        }
+        if (minimized || !frame_pacer_should_render(&frame_pacer, on_demand)) {
+            profiler_count(&profiler, PROFILER_COUNTER_HEAP_ALLOCATIONS,
+                           memory_heap_allocations() - frame_heap_allocations);
+            profiler_frame_end(&profiler);
             continue;
         }
 
+        // anything staged since the last frame goes out in one copy pass ahead of the frame's commands
+        asset_poll_ns = now_ns + ASSET_POLL_NS;
+        zone = profiler_begin(&profiler, "uploads");
+        upload_ring_retire(&upload_ring);
+        asset_stream_update(asset_stream);
+        SDL_GPUTexture *atlas_textures[SPRITE_ATLAS_NUM_PAGES];
+        for (uint32_t page = 0; page < SPRITE_ATLAS_NUM_PAGES; page++) {
+            atlas_textures[page] = asset_stream_texture(asset_stream, atlas_assets[page]);
+        }
+        if (!tilemap_upload(&tilemap, &upload_ring) || !upload_ring_submit(&upload_ring)) {
+            SDL_PRINT_ERROR_AND_EXIT("failed to submit uploads");
+        }
+        profiler_count(&profiler, PROFILER_COUNTER_UPLOAD_BYTES, upload_ring.stats.bytes - last_upload_bytes);
+        last_upload_bytes = upload_ring.stats.bytes;
+        profiler_end(&profiler, zone);
+
+        // only blocks when the gpu is still busy with the frame that last used this context
+        zone = profiler_begin(&profiler, "fence wait");
+        frame_context_t *frame = frame_ring_begin(&frame_ring);
+        sprite_batch_t *sprite_batch = &frame->sprite_batch;
+        profiler_end(&profiler, zone);
+
+        zone = profiler_begin(&profiler, "acquire swapchain");
         SDL_GPUCommandBuffer *command_buffer = SDL_AcquireGPUCommandBuffer(device);
 
         SDL_GPUTexture *window_texture;
@@ -576,6 +626,42 @@ int main(void) {
         if (!SDL_WaitAndAcquireGPUSwapchainTexture(command_buffer, window, &window_texture, &width, &height)) {
             SDL_PRINT_ERROR_AND_EXIT("Failed to acquire GPU Swapchain texture");
         }
+        profiler_end(&profiler, zone);
+
+        uint32_t record_zone = profiler_begin(&profiler, "record");
+        // rendered somewhere between the last two sim steps so motion stays smooth at any frame rate
+        camera_set_viewport(&camera, width, height);
+        float view[4];
+        camera_view_rect(&camera, view);
+        // off screen entities are neither interpolated nor turned into sprites
+        zone = profiler_begin(&profiler, "cull");
+        if (game_state->tick != entity_tree_tick) {
+            build_entity_tree(&entity_tree, &game_state->entities);
+            entity_tree_tick = game_state->tick;
+        }
+        uint32_t *visible = ARENA_NEW(&frame_arena, uint32_t, game_state->entities.count);
+        uint32_t num_visible = visible != NULL ? quadtree_query(&entity_tree, view, visible) : 0;
+        profiler_count(&profiler, PROFILER_COUNTER_VISIBLE_OBJECTS, num_visible);
+        profiler_count(&profiler, PROFILER_COUNTER_CULLED_OBJECTS, game_state->entities.count - num_visible);
+        profiler_end(&profiler, zone);
+
+        zone = profiler_begin(&profiler, "sprites");
+        sprite_batch_begin(sprite_batch);
+        submit_game_state(sprite_batch, game_state, sim_clock_alpha(&sim_clock), view, visible, num_visible,
+                          atlas_textures, atlas_sampler);
+        if (!sprite_batch_upload(sprite_batch, command_buffer)) {
+            SDL_PRINT_ERROR_AND_EXIT("failed to upload sprites");
+        }
+        profiler_count(&profiler, PROFILER_COUNTER_UPLOAD_BYTES, sprite_batch->count * sizeof(sprite_instance));
+        profiler_end(&profiler, zone);
+
+        // compute passes can't run inside the render pass, the draw further down reads what they leave behind
+        zone = profiler_begin(&profiler, "particles");
+        emit_effects(&particles, game_state);
+        float particles_dt = paused ? 0.0f : SDL_min((float) (now_ns - last_particles_ns) / SDL_NS_PER_SECOND, 0.1f);
+        last_particles_ns = now_ns;
+        particles_update(&particles, command_buffer, particles_dt);
+        profiler_end(&profiler, zone);
 
         SDL_GPUColorTargetInfo target_info = {
                 .texture = window_texture,
@@ -584,85 +670,165 @@ int main(void) {
                 .load_op = SDL_GPU_LOADOP_CLEAR,
                 .store_op = SDL_GPU_STOREOP_STORE,
         };
+        zone = profiler_begin(&profiler, "scene pass");
+        camera_uniform camera_data;
+        camera_uniform_data(&camera, &camera_data);
+        SDL_PushGPUVertexUniformData(command_buffer, CAMERA_UNIFORM_SLOT, &camera_data, sizeof(camera_data));
         SDL_GPURenderPass *render_pass = SDL_BeginGPURenderPass(command_buffer, &target_info, 1, NULL);
 
-        SDL_BindGPUGraphicsPipeline(render_pass, simple_triangle_pipeline);
-        SDL_BindGPUVertexBuffers(render_pass, 0, &(SDL_GPUBufferBinding) {
-                .buffer = triangle_vertex,
-        }, 1);
-        SDL_DrawGPUPrimitives(render_pass, 3, 1, 0, 0);
-
-        SDL_BindGPUGraphicsPipeline(render_pass, quad_pipeline);
-        SDL_BindGPUVertexBuffers(render_pass, 0, &(SDL_GPUBufferBinding) { .buffer = quad_buffer }, 1);
-        SDL_BindGPUIndexBuffer(render_pass, &(SDL_GPUBufferBinding) { .buffer = quad_index_buffer}, SDL_GPU_INDEXELEMENTSIZE_16BIT);
-        SDL_BindGPUFragmentSamplers(render_pass, 0, &(SDL_GPUTextureSamplerBinding){ .texture = grass, .sampler = grass_sampler }, 1);
-        SDL_DrawGPUIndexedPrimitives(render_pass, 6, 1, 0, 0, 0);
+        tilemap_draw(&tilemap, render_pass, sprite_pipeline, quad_buffer, quad_index_buffer,
+                     atlas_textures[sprite_atlas_sprite(SPRITE_ID_GRASS)->page], atlas_sampler, view);
+        profiler_count(&profiler, PROFILER_COUNTER_BINDS, tilemap.stats.binds);
+        profiler_count(&profiler, PROFILER_COUNTER_DRAW_CALLS, tilemap.stats.draws);
+
+        sprite_batch_flush(sprite_batch, render_pass, quad_buffer, quad_index_buffer);
+        profiler_count(&profiler, PROFILER_COUNTER_BINDS, sprite_batch->stats.binds);
+        profiler_count(&profiler, PROFILER_COUNTER_DRAW_CALLS, sprite_batch->stats.draws);
+
+        // on top of the sprites, skipped until the worker built the pipeline
+        SDL_GPUGraphicsPipeline *particle_pipeline = render_pipelines_get(&render_pipelines, RENDER_PIPELINE_PARTICLE);
+        if (particle_pipeline) {
+            particles_draw(&particles, render_pass, particle_pipeline);
+            profiler_count(&profiler, PROFILER_COUNTER_BINDS, 1);
+            profiler_count(&profiler, PROFILER_COUNTER_DRAW_CALLS, 1);
+        }
 
         SDL_EndGPURenderPass(render_pass);
-
-        SDL_BlitGPUTexture(command_buffer, &(SDL_GPUBlitInfo){
-            .source = (SDL_GPUBlitRegion) {
-                    .texture = grass,
-                    .w = 32,
-                    .h = 32,
-            },
-            .destination = (SDL_GPUBlitRegion) {
-                    .texture = window_texture,
-                    .x = 100,
-                    .y = 100,
-                    .w = 32,
-                    .h = 32,
-            },
-            .load_op = SDL_GPU_LOADOP_LOAD,
-        });
+        profiler_end(&profiler, zone);
 
         // draw imgui
+        zone = profiler_begin(&profiler, "imgui");
         ImGui_ImplSDLGPU3_NewFrame();
         ImGui_ImplSDL3_NewFrame();
         igNewFrame();
 
         {
-            bool open = true;
-            if (open) {
-                igShowDemoWindow(&open);
-            }
-        }
-
-        {
-            bool open = true;
-            if (igBegin("Some imGui window", &open, 0)) {
-                igText("something here");
+            igSetNextWindowPos((ImVec2) {10.0f, 10.0f}, ImGuiCond_FirstUseEver, (ImVec2) {0.0f, 0.0f});
+            igSetNextWindowBgAlpha(0.8f);
+            if (igBegin("Performance", NULL, 0)) {
+                draw_profiler_hud(&profiler, &frame_ring, &frame_arena, main_scale);
+                if (igButton("save trace (F9)", (ImVec2) {0.0f, 0.0f})) {
+                    save_trace = true;
+                }
+                igSeparator();
+                int latency = (int) frame_ring.frames_in_flight;
+                if (igSliderInt("frames in flight", &latency, 1, FRAME_RING_MAX_FRAMES, "%d", 0)) {
+                    frame_ring_set_frames_in_flight(&frame_ring, (uint32_t) latency);
+                }
+                igText("fence wait: %.3f ms", (double) frame_ring.last_wait_ns / SDL_NS_PER_MS);
+                if (igSliderInt("fps cap", &fps_cap_setting, 0, 480, fps_cap_setting > 0 ? "%d" : "off", 0)) {
+                    frame_pacer_set_cap(&frame_pacer, (uint32_t) fps_cap_setting);
+                }
+                igCheckbox("paused (P)", &paused);
+                igText("pacing: %s, %" SDL_PRIu64 " rendered, %" SDL_PRIu64 " skipped, last wait %.2f ms",
+                       on_demand ? "on demand" : "continuous", frame_pacer.stats.rendered_frames,
+                       frame_pacer.stats.skipped_frames, (double) frame_pacer.stats.last_wait_ns / SDL_NS_PER_MS);
+                igText("sim tick: %" SDL_PRIu64 " (%" SDL_PRIu64 " dropped)", game_state->tick,
+                       sim_clock.dropped_steps);
+                igText("entities: %u (high water %u of %u)", game_state->entities.count,
+                       game_state->entities.high_water, game_state->entities.capacity);
+                igText("sim threads: %u", jobs.num_threads);
+                igText("particles: %" SDL_PRIu64 " bursts (%" SDL_PRIu64 " dropped), %" SDL_PRIu64
+                       " emitted, capacity %u", particles.stats.bursts, particles.stats.dropped_bursts,
+                       particles.stats.emitted, particles.capacity);
+                igText("culling: %u visible, %u culled, %u tree nodes visited", entity_tree.stats.visible,
+                       entity_tree.stats.culled, entity_tree.stats.nodes_visited);
+                igText("ground: %u draws, %u chunks culled, %" SDL_PRIu64 " chunk uploads", tilemap.stats.draws,
+                       tilemap.stats.culled, tilemap.stats.chunk_uploads);
+                asset_stream_stats(asset_stream, &asset_stats);
+                igText("assets: %u/%u resident, %u failed", asset_stats.resident, asset_stats.requested,
+                       asset_stats.failed);
+                igText("asset queues: %u loading (max %u), %u staging, %u uploading", asset_stats.request_depth,
+                       asset_stats.max_request_depth, asset_stats.staging_depth, asset_stats.upload_depth);
+                igText("asset latency: last %.2f ms, max %.2f ms", (double) asset_stats.last_latency_ns / SDL_NS_PER_MS,
+                       (double) asset_stats.max_latency_ns / SDL_NS_PER_MS);
+                draw_gpu_resources_hud(&gpu_stats);
             }
             igEnd();
         }
 
         igRender();
         ImDrawData *draw_data = igGetDrawData();
+        profiler_end(&profiler, zone);
 
+        zone = profiler_begin(&profiler, "imgui pass");
         target_info.load_op = SDL_GPU_LOADOP_LOAD;
         ImGui_ImplSDLGPU3_PrepareDrawData(draw_data, command_buffer);
         SDL_GPURenderPass *imgui_render_pass = SDL_BeginGPURenderPass(command_buffer, &target_info, 1, NULL);
         ImGui_ImplSDLGPU3_RenderDrawData(draw_data, command_buffer, imgui_render_pass, NULL);
         SDL_EndGPURenderPass(imgui_render_pass);
+        profiler_end(&profiler, zone);
+        profiler_end(&profiler, record_zone);
 
+        zone = profiler_begin(&profiler, "submit");
         SDL_GPUFence *fence = SDL_SubmitGPUCommandBufferAndAcquireFence(command_buffer);
-        if (!SDL_WaitForGPUFences(device, true, &fence, 1)) {
-            SDL_PRINT_ERROR_AND_EXIT("Wait for Gpu Fences failed");
+        if (fence == NULL) {
+            SDL_PRINT_ERROR_AND_EXIT("Submit command buffer failed");
+        }
+        frame_ring_end(&frame_ring, fence);
+        profiler_end(&profiler, zone);
+        profiler_count(&profiler, PROFILER_COUNTER_HEAP_ALLOCATIONS, memory_heap_allocations() - frame_heap_allocations);
+        gpu_resources_stats(&gpu_stats);
+        profiler_count(&profiler, PROFILER_COUNTER_GPU_BYTES, gpu_stats.total_bytes);
+        profiler_frame_end(&profiler);
+
+        if (save_trace) {
+            // the whole history, so a hitch is still in the file when the key is hit right after it
+            save_trace = false;
+            char trace_path[64];
+            SDL_snprintf(trace_path, sizeof(trace_path), "kingdom_defense_trace_%" SDL_PRIu64 ".json",
+                         profiler.num_frames);
+            if (profiler_export_chrome_trace(&profiler, trace_path)) {
+                SDL_Log("wrote %s", trace_path);
+            } else {
+                SDL_Log("failed to save trace: %s", SDL_GetError());
+            }
+        }
+
+        if (first_frame) {
+            // compare runs with a cleared driver shader cache (cold) against a second launch (warm)
+            first_frame = false;
+            render_pipelines_stats_t pipeline_stats;
+            render_pipelines_get_stats(&render_pipelines, &pipeline_stats);
+            SDL_Log("startup: waited %.2f ms for pipelines (%u of %u built, shaders %.2f ms, pipelines %.2f ms, %u "
+                    "shaders and %u pipelines shared), first frame %.2f ms (%u of %u textures resident)",
+                    (double) pipelines_wait_ns / SDL_NS_PER_MS, pipeline_stats.ready, RENDER_PIPELINE_COUNT,
+                    (double) pipeline_stats.shader_ns / SDL_NS_PER_MS,
+                    (double) pipeline_stats.pipeline_ns / SDL_NS_PER_MS, pipeline_stats.shaders_shared,
+                    pipeline_stats.pipelines_shared, (double) (SDL_GetTicksNS() - startup_begin) / SDL_NS_PER_MS,
+                    asset_stream->stats.resident, asset_stream->stats.requested);
         }
-        SDL_ReleaseGPUFence(device, fence);
     }
 
     SDL_WaitForGPUIdle(device);
+    frame_ring_destroy(&frame_ring);
+    particles_destroy(&particles);
+    tilemap_destroy(&tilemap);
+    quadtree_destroy(&entity_tree);
+    profiler_destroy(&profiler);
+    arena_destroy(&frame_arena);
+    render_pipelines_destroy(&render_pipelines);
+    game_state_destroy(game_state);
+    SDL_free(game_state);
+    job_system_destroy(&jobs);
+    asset_stream_destroy(asset_stream);
+    SDL_free(asset_stream);
+    if (have_pack) {
+        asset_pack_close(&asset_pack);
+    }
+    upload_ring_destroy(&upload_ring);
+    gpu_release_buffer(device, quad_buffer);
+    gpu_release_buffer(device, quad_index_buffer);
+    gpu_release_sampler(device, atlas_sampler);
+    gpu_resources_report_leaks();
+    gpu_resources_shutdown();
     ImGui_ImplSDL3_Shutdown();
     ImGui_ImplSDLGPU3_Shutdown();
     igDestroyContext(NULL);
 
-    SDL_ReleaseGPUGraphicsPipeline(device, simple_triangle_pipeline);
-
     SDL_ReleaseWindowFromGPUDevice(device, window);
     SDL_DestroyGPUDevice(device);
     SDL_DestroyWindow(window);
     SDL_Quit();
-    spvc_context_destroy(spvc_context);
     return 0;
 }
@@ -0,0 +1,67 @@
+#include "memory.h"
+
+bool arena_init(arena_t *arena, size_t size) {
+    SDL_zerop(arena);
+    arena->base = SDL_aligned_alloc(ARENA_DEFAULT_ALIGNMENT, size);
+    if (arena->base == NULL) {
+        return false;
+    }
+    arena->size = size;
+    return true;
+}
+
+void arena_destroy(arena_t *arena) {
+    SDL_aligned_free(arena->base);
+    SDL_zerop(arena);
+}
+
+void *arena_alloc(arena_t *arena, size_t size, size_t alignment) {
+    size_t offset = (arena->used + alignment - 1) & ~(alignment - 1);
+    if (offset > arena->size || size > arena->size - offset) {
+        arena->failed++;
+        SDL_SetError("arena full, %zu bytes asked for with %zu of %zu in use", size, arena->used, arena->size);
+        return NULL;
+    }
+    arena->used = offset + size;
+    arena->high_water = SDL_max(arena->high_water, arena->used);
+    return arena->base + offset;
+}
+
+void arena_reset(arena_t *arena) {
+    arena->used = 0;
+}
+
+static SDL_malloc_func original_malloc;
+static SDL_calloc_func original_calloc;
+static SDL_realloc_func original_realloc;
+static SDL_free_func original_free;
+static SDL_AtomicInt heap_allocations;
+
+static void *SDLCALL counting_malloc(size_t size) {
+    SDL_AddAtomicInt(&heap_allocations, 1);
+    return original_malloc(size);
+}
+
+static void *SDLCALL counting_calloc(size_t count, size_t size) {
+    SDL_AddAtomicInt(&heap_allocations, 1);
+    return original_calloc(count, size);
+}
+
+// shrinking or resizing in place still counts, the caller can't know it was free
+static void *SDLCALL counting_realloc(void *mem, size_t size) {
+    SDL_AddAtomicInt(&heap_allocations, 1);
+    return original_realloc(mem, size);
+}
+
+static void SDLCALL counting_free(void *mem) {
+    original_free(mem);
+}
+
+bool memory_track_heap(void) {
+    SDL_GetOriginalMemoryFunctions(&original_malloc, &original_calloc, &original_realloc, &original_free);
+    return SDL_SetMemoryFunctions(counting_malloc, counting_calloc, counting_realloc, counting_free);
+}
+
+uint32_t memory_heap_allocations(void) {
+    return (uint32_t) SDL_GetAtomicInt(&heap_allocations);
+}
@@ -0,0 +1,49 @@
+#ifndef KINGDOM_DEFENSE_MEMORY_H
+#define KINGDOM_DEFENSE_MEMORY_H
+
+#include <SDL3/SDL.h>
+
+#define ARENA_DEFAULT_ALIGNMENT 16
+
+// one block reserved up front and handed out linearly. it never grows, a full arena fails the allocation, so code
+// living on an arena can't hit the heap behind our back. nothing is freed one by one: a frame arena is reset
+// once per frame, a scratch arena is rewound by arena_scope_end
+typedef struct {
+    uint8_t *base;
+    size_t size;
+    size_t used;
+    // the most that was ever in use at once, size the arena from this
+    size_t high_water;
+    uint64_t failed;
+} arena_t;
+
+// position of an arena to rewind to, everything allocated after arena_scope_begin is released together
+typedef struct {
+    arena_t *arena;
+    size_t used;
+} arena_scope_t;
+
+bool arena_init(arena_t *arena, size_t size);
+void arena_destroy(arena_t *arena);
+// `alignment` is a power of two. NULL with an error set when the arena is full
+void *arena_alloc(arena_t *arena, size_t size, size_t alignment);
+void arena_reset(arena_t *arena);
+
+static inline arena_scope_t arena_scope_begin(arena_t *arena) {
+    return (arena_scope_t) {arena, arena->used};
+}
+
+static inline void arena_scope_end(arena_scope_t scope) {
+    scope.arena->used = scope.used;
+}
+
+#define ARENA_NEW(_arena, _type, _count) \
+    ((_type *) arena_alloc((_arena), sizeof(_type) * (_count), SDL_max(_Alignof(_type), ARENA_DEFAULT_ALIGNMENT)))
+
+// routes SDL_malloc and friends through counting wrappers, every thread's heap allocations show up in
+// memory_heap_allocations. has to run before anything is allocated through SDL, so first thing in main
+bool memory_track_heap(void);
+// allocations so far, wraps around. compare two readings to count the allocations in between
+uint32_t memory_heap_allocations(void);
+
+#endif //KINGDOM_DEFENSE_MEMORY_H
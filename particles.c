@@ -0,0 +1,268 @@
+#include "particles.h"
+#include "gpu_resources.h"
+#include "render_pipelines.h"
+#include "shader_reflection.h"
+
+// PARTICLE_ARGS_SIZE uints of arguments for no particles: 6 vertices, 0 instances, 0 groups, then the zero counter
+static const uint32_t reset_data[PARTICLE_ARGS_SIZE + 1] = {
+        6, 0, 0, 0, 0, 1, 1, 0,
+        0,
+};
+
+#define ARGS_BYTES (PARTICLE_ARGS_SIZE * sizeof(uint32_t))
+
+// what particles_update binds to each pass besides the uniform in PARTICLE_UNIFORM_SLOT
+typedef struct {
+    const char *path;
+    uint32_t readonly_storage_buffers;
+    uint32_t readwrite_storage_buffers;
+} particle_pass_t;
+
+static const particle_pass_t emit_pass = {"particle_emit.comp.hlsl.spirv", 0, 3};
+static const particle_pass_t simulate_pass = {"particle_simulate.comp.hlsl.spirv", 1, 1};
+static const particle_pass_t compact_pass = {"particle_compact.comp.hlsl.spirv", 1, 3};
+
+// the reflection of the compiled shader against the bindings, so a shader that declares something else fails here
+// and not as a validation error or a device loss on the first update
+static SDL_GPUComputePipeline *load_pass(SDL_GPUDevice *device, arena_t *scratch, const particle_pass_t *pass) {
+    const compute_shader_reflection_t *reflection = compute_shader_reflection_find(pass->path);
+    if (reflection != NULL &&
+        (reflection->num_samplers != 0 || reflection->num_readonly_storage_textures != 0 ||
+         reflection->num_readwrite_storage_textures != 0 ||
+         reflection->num_readonly_storage_buffers != pass->readonly_storage_buffers ||
+         reflection->num_readwrite_storage_buffers != pass->readwrite_storage_buffers ||
+         reflection->num_uniform_buffers != 1 || reflection->threadcount_x != PARTICLE_GROUP_SIZE ||
+         reflection->threadcount_y != 1 || reflection->threadcount_z != 1)) {
+        SDL_SetError("%s doesn't declare the resources particles_update binds", pass->path);
+        return NULL;
+    }
+    return load_compute_pipeline(device, scratch, pass->path);
+}
+
+// empty arguments and counter for particle buffer `index`. not cycled, the counter of the other buffer has to stay
+static void record_reset(particles_t *particles, SDL_GPUCopyPass *copy_pass, uint32_t index) {
+    SDL_GPUTransferBufferLocation args_source = {.transfer_buffer = particles->reset, .offset = 0};
+    SDL_GPUBufferRegion args = {.buffer = particles->args[index], .offset = 0, .size = ARGS_BYTES};
+    SDL_UploadToGPUBuffer(copy_pass, &args_source, &args, false);
+    SDL_GPUTransferBufferLocation counter_source = {.transfer_buffer = particles->reset, .offset = ARGS_BYTES};
+    SDL_GPUBufferRegion counter = {
+            .buffer = particles->counters,
+            .offset = index * (uint32_t) sizeof(uint32_t),
+            .size = sizeof(uint32_t),
+    };
+    SDL_UploadToGPUBuffer(copy_pass, &counter_source, &counter, false);
+}
+
+bool particles_init(particles_t *particles, SDL_GPUDevice *device, arena_t *scratch, uint32_t capacity) {
+    SDL_zerop(particles);
+    if (capacity == 0 || capacity > PARTICLES_MAX_CAPACITY) {
+        return SDL_SetError("particle capacity %u out of range", capacity);
+    }
+    particles->device = device;
+    particles->capacity = capacity;
+    // particles_draw binds the current particle buffer and the camera uniform to the vertex shader
+    const shader_reflection_t *vertex = shader_reflection_find("particle.vert.hlsl.spirv");
+    if (vertex != NULL && (vertex->num_samplers != 0 || vertex->num_storage_textures != 0 ||
+                           vertex->num_storage_buffers != 1 || vertex->num_uniform_buffers != 1)) {
+        return SDL_SetError("particle.vert.hlsl.spirv doesn't declare the resources particles_draw binds");
+    }
+    particles->emit = load_pass(device, scratch, &emit_pass);
+    particles->simulate = load_pass(device, scratch, &simulate_pass);
+    particles->compact = load_pass(device, scratch, &compact_pass);
+    if (particles->emit == NULL || particles->simulate == NULL || particles->compact == NULL) {
+        particles_destroy(particles);
+        return false;
+    }
+
+    SDL_GPUBufferCreateInfo particle_info = {
+            .usage = SDL_GPU_BUFFERUSAGE_COMPUTE_STORAGE_READ | SDL_GPU_BUFFERUSAGE_COMPUTE_STORAGE_WRITE |
+                     SDL_GPU_BUFFERUSAGE_GRAPHICS_STORAGE_READ,
+            .size = capacity * (uint32_t) sizeof(particle),
+    };
+    SDL_GPUBufferCreateInfo args_info = {
+            .usage = SDL_GPU_BUFFERUSAGE_INDIRECT | SDL_GPU_BUFFERUSAGE_COMPUTE_STORAGE_WRITE,
+            .size = ARGS_BYTES,
+    };
+    SDL_GPUBufferCreateInfo counters_info = {
+            .usage = SDL_GPU_BUFFERUSAGE_COMPUTE_STORAGE_READ | SDL_GPU_BUFFERUSAGE_COMPUTE_STORAGE_WRITE,
+            .size = 2 * sizeof(uint32_t),
+    };
+    SDL_GPUTransferBufferCreateInfo reset_info = {
+            .usage = SDL_GPU_TRANSFERBUFFERUSAGE_UPLOAD,
+            .size = sizeof(reset_data),
+    };
+    SDL_GPUTransferBufferCreateInfo readback_info = {
+            .usage = SDL_GPU_TRANSFERBUFFERUSAGE_DOWNLOAD,
+            .size = sizeof(uint32_t),
+    };
+    bool ok = true;
+    for (int i = 0; i < 2; i++) {
+        particles->particles[i] = gpu_create_buffer(device, &particle_info, GPU_CALLSITE);
+        particles->args[i] = gpu_create_buffer(device, &args_info, GPU_CALLSITE);
+        ok &= particles->particles[i] != NULL && particles->args[i] != NULL;
+    }
+    particles->counters = gpu_create_buffer(device, &counters_info, GPU_CALLSITE);
+    particles->reset = gpu_create_transfer_buffer(device, &reset_info, GPU_CALLSITE);
+    particles->readback = gpu_create_transfer_buffer(device, &readback_info, GPU_CALLSITE);
+    void *mapped = ok && particles->counters && particles->reset && particles->readback
+                           ? SDL_MapGPUTransferBuffer(device, particles->reset, false)
+                           : NULL;
+    if (mapped == NULL) {
+        particles_destroy(particles);
+        return false;
+    }
+    SDL_memcpy(mapped, reset_data, sizeof(reset_data));
+    SDL_UnmapGPUTransferBuffer(device, particles->reset);
+
+    // both buffers start out empty, later command buffers run after this one
+    SDL_GPUCommandBuffer *command_buffer = SDL_AcquireGPUCommandBuffer(device);
+    if (command_buffer == NULL) {
+        particles_destroy(particles);
+        return false;
+    }
+    SDL_GPUCopyPass *copy_pass = SDL_BeginGPUCopyPass(command_buffer);
+    record_reset(particles, copy_pass, 0);
+    record_reset(particles, copy_pass, 1);
+    SDL_EndGPUCopyPass(copy_pass);
+    if (!SDL_SubmitGPUCommandBuffer(command_buffer)) {
+        particles_destroy(particles);
+        return false;
+    }
+    return true;
+}
+
+void particles_destroy(particles_t *particles) {
+    SDL_GPUDevice *device = particles->device;
+    gpu_release_transfer_buffer(device, particles->readback);
+    gpu_release_transfer_buffer(device, particles->reset);
+    gpu_release_buffer(device, particles->counters);
+    for (int i = 0; i < 2; i++) {
+        gpu_release_buffer(device, particles->args[i]);
+        gpu_release_buffer(device, particles->particles[i]);
+    }
+    gpu_release_compute_pipeline(device, particles->compact);
+    gpu_release_compute_pipeline(device, particles->simulate);
+    gpu_release_compute_pipeline(device, particles->emit);
+    SDL_zerop(particles);
+}
+
+bool particles_emit(particles_t *particles, const particle_burst_t *burst) {
+    particle_emit_uniform *pending = &particles->pending;
+    if (burst->count == 0) {
+        return true;
+    }
+    if (pending->num_emitters == PARTICLE_MAX_EMITTERS) {
+        particles->stats.dropped_bursts++;
+        return false;
+    }
+    // the emit pass runs a thread per waiting particle, more than the buffer holds would only be thrown away and
+    // could ask for more groups than a dispatch allows
+    uint32_t count = SDL_min(burst->count, particles->capacity - pending->num_particles);
+    if (count == 0) {
+        particles->stats.dropped_bursts++;
+        return false;
+    }
+    pending->emitters[pending->num_emitters++] = (particle_emitter) {
+            .pos = {burst->x, burst->y},
+            .speed = burst->speed,
+            .lifetime = burst->lifetime,
+            .color = {burst->color[0], burst->color[1], burst->color[2], burst->color[3]},
+            .size = burst->size,
+            .first = pending->num_particles,
+            .count = count,
+    };
+    pending->num_particles += count;
+    particles->stats.emitted += count;
+    particles->stats.bursts++;
+    return true;
+}
+
+void particles_update(particles_t *particles, SDL_GPUCommandBuffer *command_buffer, float dt) {
+    uint32_t source = particles->current;
+    uint32_t destination = source ^ 1;
+
+    // the compaction target starts out empty
+    SDL_GPUCopyPass *copy_pass = SDL_BeginGPUCopyPass(command_buffer);
+    record_reset(particles, copy_pass, destination);
+    SDL_EndGPUCopyPass(copy_pass);
+
+    particle_emit_uniform *pending = &particles->pending;
+    if (pending->num_emitters > 0) {
+        pending->seed = particles->seed++;
+        pending->source = source;
+        pending->capacity = particles->capacity;
+        SDL_PushGPUComputeUniformData(command_buffer, PARTICLE_UNIFORM_SLOT, pending, sizeof(*pending));
+        SDL_GPUStorageBufferReadWriteBinding emit_bindings[] = {
+                {.buffer = particles->particles[source]},
+                {.buffer = particles->counters},
+                {.buffer = particles->args[source]},
+        };
+        SDL_GPUComputePass *pass = SDL_BeginGPUComputePass(command_buffer, NULL, 0, emit_bindings,
+                                                           SDL_arraysize(emit_bindings));
+        SDL_BindGPUComputePipeline(pass, particles->emit);
+        SDL_DispatchGPUCompute(pass, (pending->num_particles + PARTICLE_GROUP_SIZE - 1) / PARTICLE_GROUP_SIZE, 1, 1);
+        SDL_EndGPUComputePass(pass);
+        pending->num_emitters = 0;
+        pending->num_particles = 0;
+    }
+
+    // both passes run a thread per particle of the source buffer, the group count comes from its arguments
+    particle_step_uniform step = {
+            .dt = dt,
+            .damping = SDL_expf(-PARTICLES_DRAG * dt),
+            .source = source,
+            .capacity = particles->capacity,
+    };
+    SDL_PushGPUComputeUniformData(command_buffer, PARTICLE_UNIFORM_SLOT, &step, sizeof(step));
+    SDL_GPUStorageBufferReadWriteBinding simulate_bindings[] = {
+            {.buffer = particles->particles[source]},
+    };
+    SDL_GPUComputePass *pass = SDL_BeginGPUComputePass(command_buffer, NULL, 0, simulate_bindings,
+                                                       SDL_arraysize(simulate_bindings));
+    SDL_BindGPUComputePipeline(pass, particles->simulate);
+    SDL_BindGPUComputeStorageBuffers(pass, 0, &particles->counters, 1);
+    SDL_DispatchGPUComputeIndirect(pass, particles->args[source], PARTICLE_ARGS_GROUPS * sizeof(uint32_t));
+    SDL_EndGPUComputePass(pass);
+
+    SDL_GPUStorageBufferReadWriteBinding compact_bindings[] = {
+            {.buffer = particles->particles[destination]},
+            {.buffer = particles->counters},
+            {.buffer = particles->args[destination]},
+    };
+    pass = SDL_BeginGPUComputePass(command_buffer, NULL, 0, compact_bindings, SDL_arraysize(compact_bindings));
+    SDL_BindGPUComputePipeline(pass, particles->compact);
+    SDL_BindGPUComputeStorageBuffers(pass, 0, &particles->particles[source], 1);
+    SDL_DispatchGPUComputeIndirect(pass, particles->args[source], PARTICLE_ARGS_GROUPS * sizeof(uint32_t));
+    SDL_EndGPUComputePass(pass);
+
+    particles->current = destination;
+    particles->stats.updates++;
+}
+
+void particles_draw(particles_t *particles, SDL_GPURenderPass *render_pass, SDL_GPUGraphicsPipeline *pipeline) {
+    SDL_BindGPUGraphicsPipeline(render_pass, pipeline);
+    SDL_BindGPUVertexStorageBuffers(render_pass, 0, &particles->particles[particles->current], 1);
+    SDL_DrawGPUPrimitivesIndirect(render_pass, particles->args[particles->current], 0, 1);
+}
+
+void particles_request_count(particles_t *particles, SDL_GPUCommandBuffer *command_buffer) {
+    SDL_GPUCopyPass *copy_pass = SDL_BeginGPUCopyPass(command_buffer);
+    SDL_GPUBufferRegion counter = {
+            .buffer = particles->counters,
+            .offset = particles->current * (uint32_t) sizeof(uint32_t),
+            .size = sizeof(uint32_t),
+    };
+    SDL_GPUTransferBufferLocation destination = {.transfer_buffer = particles->readback, .offset = 0};
+    SDL_DownloadFromGPUBuffer(copy_pass, &counter, &destination);
+    SDL_EndGPUCopyPass(copy_pass);
+}
+
+bool particles_read_count(particles_t *particles, uint32_t *count) {
+    uint32_t *mapped = SDL_MapGPUTransferBuffer(particles->device, particles->readback, false);
+    if (mapped == NULL) {
+        return false;
+    }
+    *count = *mapped;
+    SDL_UnmapGPUTransferBuffer(particles->device, particles->readback);
+    return true;
+}
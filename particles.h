@@ -0,0 +1,87 @@
+#ifndef KINGDOM_DEFENSE_PARTICLES_H
+#define KINGDOM_DEFENSE_PARTICLES_H
+
+#include <SDL3/SDL.h>
+
+#include "memory.h"
+#include "shader_inputs.h"
+
+#define PARTICLES_DEFAULT_CAPACITY (256 * 1024)
+// one thread per particle in a single row of groups, and vulkan only promises 65535 groups along x
+#define PARTICLES_MAX_CAPACITY (65535 * PARTICLE_GROUP_SIZE)
+// per second, what is left of the velocity after one second is exp(-PARTICLES_DRAG)
+#define PARTICLES_DRAG 3.0f
+
+// what particles_emit takes, see particle_emitter
+typedef struct {
+    float x;
+    float y;
+    uint32_t count;
+    // the fastest particle of the burst, the others are down to a quarter of it
+    float speed;
+    // seconds, the same for the whole burst
+    float lifetime;
+    float size;
+    float color[4];
+} particle_burst_t;
+
+typedef struct {
+    uint64_t updates;
+    // particles asked for, a full buffer drops some of them on the gpu
+    uint64_t emitted;
+    uint64_t bursts;
+    // bursts that didn't fit into the PARTICLE_MAX_EMITTERS or the capacity of one update
+    uint64_t dropped_bursts;
+} particles_stats_t;
+
+// hit effects and explosions, simulated and drawn entirely on the gpu. two storage buffers take turns: the emit
+// pass appends new particles to the current one, the simulate pass moves them, the compact pass copies the
+// living into the other one and counts them into its argument buffer, which the draw and the next update's
+// passes read indirectly. the cpu records the same handful of commands whatever the number of particles and never
+// waits on the gpu
+typedef struct {
+    SDL_GPUDevice *device;
+    SDL_GPUComputePipeline *emit;
+    SDL_GPUComputePipeline *simulate;
+    SDL_GPUComputePipeline *compact;
+    uint32_t capacity;
+
+    SDL_GPUBuffer *particles[2];
+    // PARTICLE_ARGS_SIZE uints per particle buffer, see shader_inputs.h
+    SDL_GPUBuffer *args[2];
+    // one append counter per particle buffer, the exact count of the compacted one
+    SDL_GPUBuffer *counters;
+    // empty arguments followed by a zero counter, uploaded over the compaction target every update
+    SDL_GPUTransferBuffer *reset;
+    SDL_GPUTransferBuffer *readback;
+    // the buffer that is drawn and emitted into
+    uint32_t current;
+
+    // bursts of the next update
+    particle_emit_uniform pending;
+    uint32_t seed;
+    particles_stats_t stats;
+} particles_t;
+
+// builds the compute pipelines from the shaders next to the executable, `scratch` holds each file while its
+// pipeline is created. `capacity` particles at most are alive, counting the ones an update emits before the
+// expired ones of that update are gone. bursts that don't fit are cut short
+bool particles_init(particles_t *particles, SDL_GPUDevice *device, arena_t *scratch, uint32_t capacity);
+// the gpu must be done with every command buffer the particles were recorded into
+void particles_destroy(particles_t *particles);
+
+// queued for the next particles_update, cut short to what is left of the capacity. false if PARTICLE_MAX_EMITTERS
+// bursts are already waiting or the waiting ones fill the whole buffer
+bool particles_emit(particles_t *particles, const particle_burst_t *burst);
+// records the emit, simulate and compact passes, outside of any pass. `dt` 0 freezes the particles
+void particles_update(particles_t *particles, SDL_GPUCommandBuffer *command_buffer, float dt);
+// one indirect draw of every particle inside a render pass, with the RENDER_PIPELINE_PARTICLE pipeline and the
+// camera uniform pushed
+void particles_draw(particles_t *particles, SDL_GPURenderPass *render_pass, SDL_GPUGraphicsPipeline *pipeline);
+
+// records a copy of the particle count after the last update, outside of any pass. particles_read_count gives it
+// once the command buffer finished
+void particles_request_count(particles_t *particles, SDL_GPUCommandBuffer *command_buffer);
+bool particles_read_count(particles_t *particles, uint32_t *count);
+
+#endif //KINGDOM_DEFENSE_PARTICLES_H
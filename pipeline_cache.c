@@ -0,0 +1,133 @@
+#include "pipeline_cache.h"
+#include "gpu_resources.h"
+
+#define HASH_FIELD(_hash, _field) (_hash) = pipeline_cache_hash(&(_field), sizeof(_field), (_hash))
+
+uint64_t pipeline_cache_hash(const void *data, size_t size, uint64_t seed) {
+    const uint8_t *bytes = data;
+    uint64_t hash = seed;
+    for (size_t i = 0; i < size; i++) {
+        hash ^= bytes[i];
+        hash *= 0x100000001b3ull;
+    }
+    return hash;
+}
+
+void pipeline_cache_init(pipeline_cache_t *cache, SDL_GPUDevice *device) {
+    SDL_zerop(cache);
+    cache->device = device;
+}
+
+void pipeline_cache_destroy(pipeline_cache_t *cache) {
+    for (uint32_t i = 0; i < cache->count; i++) {
+        gpu_release_graphics_pipeline(cache->device, cache->entries[i].pipeline);
+    }
+    SDL_free(cache->entries);
+    SDL_zerop(cache);
+}
+
+// field by field so struct padding and pointers never end up in the key
+static uint64_t hash_state(const SDL_GPUGraphicsPipelineCreateInfo *info, uint64_t vertex_hash,
+                           uint64_t fragment_hash) {
+    uint64_t hash = PIPELINE_CACHE_HASH_SEED;
+    HASH_FIELD(hash, vertex_hash);
+    HASH_FIELD(hash, fragment_hash);
+    HASH_FIELD(hash, info->primitive_type);
+
+    const SDL_GPUVertexInputState *input = &info->vertex_input_state;
+    HASH_FIELD(hash, input->num_vertex_buffers);
+    for (uint32_t i = 0; i < input->num_vertex_buffers; i++) {
+        const SDL_GPUVertexBufferDescription *buffer = &input->vertex_buffer_descriptions[i];
+        HASH_FIELD(hash, buffer->slot);
+        HASH_FIELD(hash, buffer->pitch);
+        HASH_FIELD(hash, buffer->input_rate);
+        HASH_FIELD(hash, buffer->instance_step_rate);
+    }
+    HASH_FIELD(hash, input->num_vertex_attributes);
+    for (uint32_t i = 0; i < input->num_vertex_attributes; i++) {
+        const SDL_GPUVertexAttribute *attribute = &input->vertex_attributes[i];
+        HASH_FIELD(hash, attribute->location);
+        HASH_FIELD(hash, attribute->buffer_slot);
+        HASH_FIELD(hash, attribute->format);
+        HASH_FIELD(hash, attribute->offset);
+    }
+
+    const SDL_GPURasterizerState *rasterizer = &info->rasterizer_state;
+    HASH_FIELD(hash, rasterizer->fill_mode);
+    HASH_FIELD(hash, rasterizer->cull_mode);
+    HASH_FIELD(hash, rasterizer->front_face);
+    HASH_FIELD(hash, rasterizer->depth_bias_constant_factor);
+    HASH_FIELD(hash, rasterizer->depth_bias_clamp);
+    HASH_FIELD(hash, rasterizer->depth_bias_slope_factor);
+    HASH_FIELD(hash, rasterizer->enable_depth_bias);
+    HASH_FIELD(hash, rasterizer->enable_depth_clip);
+
+    const SDL_GPUMultisampleState *multisample = &info->multisample_state;
+    HASH_FIELD(hash, multisample->sample_count);
+    HASH_FIELD(hash, multisample->sample_mask);
+    HASH_FIELD(hash, multisample->enable_mask);
+
+    const SDL_GPUDepthStencilState *depth = &info->depth_stencil_state;
+    HASH_FIELD(hash, depth->compare_op);
+    HASH_FIELD(hash, depth->back_stencil_state);
+    HASH_FIELD(hash, depth->front_stencil_state);
+    HASH_FIELD(hash, depth->compare_mask);
+    HASH_FIELD(hash, depth->write_mask);
+    HASH_FIELD(hash, depth->enable_depth_test);
+    HASH_FIELD(hash, depth->enable_depth_write);
+    HASH_FIELD(hash, depth->enable_stencil_test);
+
+    const SDL_GPUGraphicsPipelineTargetInfo *target = &info->target_info;
+    HASH_FIELD(hash, target->num_color_targets);
+    for (uint32_t i = 0; i < target->num_color_targets; i++) {
+        const SDL_GPUColorTargetDescription *color = &target->color_target_descriptions[i];
+        const SDL_GPUColorTargetBlendState *blend = &color->blend_state;
+        HASH_FIELD(hash, color->format);
+        HASH_FIELD(hash, blend->src_color_blendfactor);
+        HASH_FIELD(hash, blend->dst_color_blendfactor);
+        HASH_FIELD(hash, blend->color_blend_op);
+        HASH_FIELD(hash, blend->src_alpha_blendfactor);
+        HASH_FIELD(hash, blend->dst_alpha_blendfactor);
+        HASH_FIELD(hash, blend->alpha_blend_op);
+        HASH_FIELD(hash, blend->color_write_mask);
+        HASH_FIELD(hash, blend->enable_blend);
+        HASH_FIELD(hash, blend->enable_color_write_mask);
+    }
+    HASH_FIELD(hash, target->depth_stencil_format);
+    HASH_FIELD(hash, target->has_depth_stencil_target);
+    return hash;
+}
+
+SDL_GPUGraphicsPipeline *pipeline_cache_get(pipeline_cache_t *cache, const SDL_GPUGraphicsPipelineCreateInfo *info,
+                                            uint64_t vertex_hash, uint64_t fragment_hash) {
+    uint64_t key = hash_state(info, vertex_hash, fragment_hash);
+    for (uint32_t i = 0; i < cache->count; i++) {
+        if (cache->entries[i].key == key) {
+            cache->stats.hits++;
+            return cache->entries[i].pipeline;
+        }
+    }
+
+    if (cache->count == cache->capacity) {
+        uint32_t capacity = cache->capacity ? cache->capacity * 2 : 16;
+        pipeline_cache_entry_t *entries = SDL_realloc(cache->entries, capacity * sizeof(pipeline_cache_entry_t));
+        if (entries == NULL) {
+            return NULL;
+        }
+        cache->entries = entries;
+        cache->capacity = capacity;
+    }
+
+    uint64_t start = SDL_GetTicksNS();
+    SDL_GPUGraphicsPipeline *pipeline = gpu_create_graphics_pipeline(cache->device, info, GPU_CALLSITE);
+    cache->stats.create_ns += SDL_GetTicksNS() - start;
+    cache->stats.misses++;
+    if (pipeline == NULL) {
+        return NULL;
+    }
+    cache->entries[cache->count++] = (pipeline_cache_entry_t) {
+            .key = key,
+            .pipeline = pipeline,
+    };
+    return pipeline;
+}
@@ -0,0 +1,41 @@
+#ifndef KINGDOM_DEFENSE_PIPELINE_CACHE_H
+#define KINGDOM_DEFENSE_PIPELINE_CACHE_H
+
+#include <SDL3/SDL.h>
+
+#define PIPELINE_CACHE_HASH_SEED 0xcbf29ce484222325ull
+
+typedef struct {
+    uint64_t key;
+    SDL_GPUGraphicsPipeline *pipeline;
+} pipeline_cache_entry_t;
+
+typedef struct {
+    uint32_t hits;
+    uint32_t misses;
+    // time spent inside SDL_CreateGPUGraphicsPipeline
+    uint64_t create_ns;
+} pipeline_cache_stats_t;
+
+// graphics pipelines keyed by the hash of their shaders plus every piece of fixed function state, asking twice
+// for the same pipeline returns the first one. the cache owns the pipelines it hands out
+typedef struct {
+    SDL_GPUDevice *device;
+    pipeline_cache_entry_t *entries;
+    uint32_t count;
+    uint32_t capacity;
+    pipeline_cache_stats_t stats;
+} pipeline_cache_t;
+
+// 64 bit fnv-1a, chain calls by passing the previous result as `seed`
+uint64_t pipeline_cache_hash(const void *data, size_t size, uint64_t seed);
+
+void pipeline_cache_init(pipeline_cache_t *cache, SDL_GPUDevice *device);
+// releases every pipeline the cache created
+void pipeline_cache_destroy(pipeline_cache_t *cache);
+
+// `vertex_hash` and `fragment_hash` identify the shader code, the shader handles in `info` are not part of the key
+SDL_GPUGraphicsPipeline *pipeline_cache_get(pipeline_cache_t *cache, const SDL_GPUGraphicsPipelineCreateInfo *info,
+                                            uint64_t vertex_hash, uint64_t fragment_hash);
+
+#endif //KINGDOM_DEFENSE_PIPELINE_CACHE_H
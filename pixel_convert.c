@@ -0,0 +1,381 @@
+#include "pixel_convert.h"
+
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || defined(_M_IX86)
+#define PIXEL_CONVERT_X86 1
+#include <immintrin.h>
+#if defined(__GNUC__) || defined(__clang__)
+#define TARGET_ISA(_isa) __attribute__((target(_isa)))
+#else
+#define TARGET_ISA(_isa)
+#endif
+#endif
+
+// swizzle entry that writes 0xFF instead of reading from the source pixel
+#define OPAQUE 0xFF
+
+typedef void (*swizzle_fun_t)(const uint8_t *input, uint8_t *out, size_t pixels, const uint8_t swizzle[4]);
+
+static void swizzle_scalar(const uint8_t *input, uint8_t *out, size_t pixels, const uint8_t swizzle[4],
+                           size_t src_bytes) {
+    for (size_t i = 0; i < pixels; i++) {
+        const uint8_t *px = input + i * src_bytes;
+        uint8_t *out_px = out + i * 4;
+        out_px[0] = px[swizzle[0]];
+        out_px[1] = px[swizzle[1]];
+        out_px[2] = px[swizzle[2]];
+        out_px[3] = swizzle[3] == OPAQUE ? UINT8_MAX : px[swizzle[3]];
+    }
+}
+
+static void swizzle24_scalar(const uint8_t *input, uint8_t *out, size_t pixels, const uint8_t swizzle[4]) {
+    swizzle_scalar(input, out, pixels, swizzle, 3);
+}
+
+static void swizzle32_scalar(const uint8_t *input, uint8_t *out, size_t pixels, const uint8_t swizzle[4]) {
+    swizzle_scalar(input, out, pixels, swizzle, 4);
+}
+
+#ifdef PIXEL_CONVERT_X86
+
+// pshufb mask for 4 pixels, bytes with the high bit set are zeroed and filled by the alpha mask
+TARGET_ISA("ssse3")
+static inline __m128i make_shuffle_mask(const uint8_t swizzle[4], int src_bytes) {
+    uint8_t mask[16];
+    for (int px = 0; px < 4; px++) {
+        for (int c = 0; c < 4; c++) {
+            mask[px * 4 + c] = swizzle[c] == OPAQUE ? 0x80 : (uint8_t) (px * src_bytes + swizzle[c]);
+        }
+    }
+    return _mm_loadu_si128((const __m128i *) mask);
+}
+
+TARGET_ISA("ssse3")
+static inline __m128i make_alpha_mask(const uint8_t swizzle[4]) {
+    return swizzle[3] == OPAQUE ? _mm_set1_epi32((int) 0xFF000000u) : _mm_setzero_si128();
+}
+
+TARGET_ISA("ssse3")
+static void swizzle24_ssse3(const uint8_t *input, uint8_t *out, size_t pixels, const uint8_t swizzle[4]) {
+    __m128i shuffle = make_shuffle_mask(swizzle, 3);
+    __m128i alpha = make_alpha_mask(swizzle);
+    size_t i = 0;
+    // every load reads 16 bytes but only consumes 12, keep the over-read inside the row
+    for (; i + 6 <= pixels; i += 4) {
+        __m128i px = _mm_loadu_si128((const __m128i *) (input + i * 3));
+        px = _mm_or_si128(_mm_shuffle_epi8(px, shuffle), alpha);
+        _mm_storeu_si128((__m128i *) (out + i * 4), px);
+    }
+    swizzle_scalar(input + i * 3, out + i * 4, pixels - i, swizzle, 3);
+}
+
+TARGET_ISA("ssse3")
+static void swizzle32_ssse3(const uint8_t *input, uint8_t *out, size_t pixels, const uint8_t swizzle[4]) {
+    __m128i shuffle = make_shuffle_mask(swizzle, 4);
+    __m128i alpha = make_alpha_mask(swizzle);
+    size_t i = 0;
+    for (; i + 4 <= pixels; i += 4) {
+        __m128i px = _mm_loadu_si128((const __m128i *) (input + i * 4));
+        px = _mm_or_si128(_mm_shuffle_epi8(px, shuffle), alpha);
+        _mm_storeu_si128((__m128i *) (out + i * 4), px);
+    }
+    swizzle_scalar(input + i * 4, out + i * 4, pixels - i, swizzle, 4);
+}
+
+TARGET_ISA("avx2")
+static void swizzle24_avx2(const uint8_t *input, uint8_t *out, size_t pixels, const uint8_t swizzle[4]) {
+    // vpshufb only shuffles inside 128 bit lanes, so each lane gets its own 4 pixel load
+    __m256i shuffle = _mm256_broadcastsi128_si256(make_shuffle_mask(swizzle, 3));
+    __m256i alpha = _mm256_broadcastsi128_si256(make_alpha_mask(swizzle));
+    size_t i = 0;
+    for (; i + 10 <= pixels; i += 8) {
+        const uint8_t *src = input + i * 3;
+        __m256i px = _mm256_castsi128_si256(_mm_loadu_si128((const __m128i *) src));
+        px = _mm256_inserti128_si256(px, _mm_loadu_si128((const __m128i *) (src + 12)), 1);
+        px = _mm256_or_si256(_mm256_shuffle_epi8(px, shuffle), alpha);
+        _mm256_storeu_si256((__m256i *) (out + i * 4), px);
+    }
+    swizzle_scalar(input + i * 3, out + i * 4, pixels - i, swizzle, 3);
+}
+
+TARGET_ISA("avx2")
+static void swizzle32_avx2(const uint8_t *input, uint8_t *out, size_t pixels, const uint8_t swizzle[4]) {
+    __m256i shuffle = _mm256_broadcastsi128_si256(make_shuffle_mask(swizzle, 4));
+    __m256i alpha = _mm256_broadcastsi128_si256(make_alpha_mask(swizzle));
+    size_t i = 0;
+    for (; i + 8 <= pixels; i += 8) {
+        __m256i px = _mm256_loadu_si256((const __m256i *) (input + i * 4));
+        px = _mm256_or_si256(_mm256_shuffle_epi8(px, shuffle), alpha);
+        _mm256_storeu_si256((__m256i *) (out + i * 4), px);
+    }
+    swizzle_scalar(input + i * 4, out + i * 4, pixels - i, swizzle, 4);
+}
+
+#endif
+
+static pixel_convert_isa_t active_isa = PIXEL_CONVERT_ISA_SCALAR;
+static swizzle_fun_t swizzle24_impl = swizzle24_scalar;
+static swizzle_fun_t swizzle32_impl = swizzle32_scalar;
+static SDL_InitState init_state;
+
+#define DEFINE_SWIZZLE_KERNEL(_name, _bytes, _r, _g, _b, _a)                          \
+    static void _name(const uint8_t *input, uint8_t *out, size_t pixels, const void *ctx) { \
+        (void) ctx;                                                                   \
+        static const uint8_t swizzle[4] = {_r, _g, _b, _a};                           \
+        swizzle##_bytes##_impl(input, out, pixels, swizzle);                          \
+    }
+
+// source byte order -> R8G8B8A8
+DEFINE_SWIZZLE_KERNEL(convert_bgr24_to_rgba8, 24, 2, 1, 0, OPAQUE)
+DEFINE_SWIZZLE_KERNEL(convert_rgb24_to_rgba8, 24, 0, 1, 2, OPAQUE)
+DEFINE_SWIZZLE_KERNEL(convert_rgba32_to_rgba8, 32, 0, 1, 2, 3)
+DEFINE_SWIZZLE_KERNEL(convert_bgra32_to_rgba8, 32, 2, 1, 0, 3)
+DEFINE_SWIZZLE_KERNEL(convert_argb32_to_rgba8, 32, 1, 2, 3, 0)
+DEFINE_SWIZZLE_KERNEL(convert_abgr32_to_rgba8, 32, 3, 2, 1, 0)
+DEFINE_SWIZZLE_KERNEL(convert_rgbx32_to_rgba8, 32, 0, 1, 2, OPAQUE)
+DEFINE_SWIZZLE_KERNEL(convert_bgrx32_to_rgba8, 32, 2, 1, 0, OPAQUE)
+DEFINE_SWIZZLE_KERNEL(convert_xrgb32_to_rgba8, 32, 1, 2, 3, OPAQUE)
+DEFINE_SWIZZLE_KERNEL(convert_xbgr32_to_rgba8, 32, 3, 2, 1, OPAQUE)
+
+static void convert_index8_to_rgba8(const uint8_t *input, uint8_t *out, size_t pixels, const void *ctx) {
+    const uint8_t (*lut)[4] = ctx;
+    for (size_t i = 0; i < pixels; i++) {
+        SDL_memcpy(out + i * 4, lut[input[i]], 4);
+    }
+}
+
+static uint16_t load_u16(const uint8_t *input, size_t i) {
+    uint16_t v;
+    SDL_memcpy(&v, input + i * 2, sizeof(v));
+    return v;
+}
+
+static void convert_rgb565_to_rgba8(const uint8_t *input, uint8_t *out, size_t pixels, const void *ctx) {
+    (void) ctx;
+    for (size_t i = 0; i < pixels; i++) {
+        uint16_t v = load_u16(input, i);
+        uint8_t r = (v >> 11) & 0x1F;
+        uint8_t g = (v >> 5) & 0x3F;
+        uint8_t b = v & 0x1F;
+        out[i * 4 + 0] = (uint8_t) ((r << 3) | (r >> 2));
+        out[i * 4 + 1] = (uint8_t) ((g << 2) | (g >> 4));
+        out[i * 4 + 2] = (uint8_t) ((b << 3) | (b >> 2));
+        out[i * 4 + 3] = UINT8_MAX;
+    }
+}
+
+static void convert_argb1555_to_rgba8(const uint8_t *input, uint8_t *out, size_t pixels, const void *ctx) {
+    (void) ctx;
+    for (size_t i = 0; i < pixels; i++) {
+        uint16_t v = load_u16(input, i);
+        uint8_t r = (v >> 10) & 0x1F;
+        uint8_t g = (v >> 5) & 0x1F;
+        uint8_t b = v & 0x1F;
+        out[i * 4 + 0] = (uint8_t) ((r << 3) | (r >> 2));
+        out[i * 4 + 1] = (uint8_t) ((g << 3) | (g >> 2));
+        out[i * 4 + 2] = (uint8_t) ((b << 3) | (b >> 2));
+        out[i * 4 + 3] = (v & 0x8000) ? UINT8_MAX : 0;
+    }
+}
+
+static void convert_argb4444_to_rgba8(const uint8_t *input, uint8_t *out, size_t pixels, const void *ctx) {
+    (void) ctx;
+    for (size_t i = 0; i < pixels; i++) {
+        uint16_t v = load_u16(input, i);
+        out[i * 4 + 0] = (uint8_t) (((v >> 8) & 0xF) * 17);
+        out[i * 4 + 1] = (uint8_t) (((v >> 4) & 0xF) * 17);
+        out[i * 4 + 2] = (uint8_t) ((v & 0xF) * 17);
+        out[i * 4 + 3] = (uint8_t) (((v >> 12) & 0xF) * 17);
+    }
+}
+
+// byte order formats (RGB24, RGBA32, ...) are endian independent, the 16 bit ones are packed in native endian
+static const sdl_surface_format_to_gpu_format pixel_to_gpu[] = {
+        {SDL_PIXELFORMAT_BGR24, SDL_GPU_TEXTUREFORMAT_INVALID, convert_bgr24_to_rgba8,
+         SDL_GPU_TEXTUREFORMAT_R8G8B8A8_UNORM},
+        {SDL_PIXELFORMAT_RGB24, SDL_GPU_TEXTUREFORMAT_INVALID, convert_rgb24_to_rgba8,
+         SDL_GPU_TEXTUREFORMAT_R8G8B8A8_UNORM},
+        {SDL_PIXELFORMAT_RGBA32, SDL_GPU_TEXTUREFORMAT_R8G8B8A8_UNORM, convert_rgba32_to_rgba8,
+         SDL_GPU_TEXTUREFORMAT_R8G8B8A8_UNORM},
+        {SDL_PIXELFORMAT_BGRA32, SDL_GPU_TEXTUREFORMAT_B8G8R8A8_UNORM, convert_bgra32_to_rgba8,
+         SDL_GPU_TEXTUREFORMAT_R8G8B8A8_UNORM},
+        {SDL_PIXELFORMAT_ARGB32, SDL_GPU_TEXTUREFORMAT_INVALID, convert_argb32_to_rgba8,
+         SDL_GPU_TEXTUREFORMAT_R8G8B8A8_UNORM},
+        {SDL_PIXELFORMAT_ABGR32, SDL_GPU_TEXTUREFORMAT_INVALID, convert_abgr32_to_rgba8,
+         SDL_GPU_TEXTUREFORMAT_R8G8B8A8_UNORM},
+        {SDL_PIXELFORMAT_RGBX32, SDL_GPU_TEXTUREFORMAT_INVALID, convert_rgbx32_to_rgba8,
+         SDL_GPU_TEXTUREFORMAT_R8G8B8A8_UNORM},
+        {SDL_PIXELFORMAT_BGRX32, SDL_GPU_TEXTUREFORMAT_INVALID, convert_bgrx32_to_rgba8,
+         SDL_GPU_TEXTUREFORMAT_R8G8B8A8_UNORM},
+        {SDL_PIXELFORMAT_XRGB32, SDL_GPU_TEXTUREFORMAT_INVALID, convert_xrgb32_to_rgba8,
+         SDL_GPU_TEXTUREFORMAT_R8G8B8A8_UNORM},
+        {SDL_PIXELFORMAT_XBGR32, SDL_GPU_TEXTUREFORMAT_INVALID, convert_xbgr32_to_rgba8,
+         SDL_GPU_TEXTUREFORMAT_R8G8B8A8_UNORM},
+        {SDL_PIXELFORMAT_INDEX8, SDL_GPU_TEXTUREFORMAT_INVALID, convert_index8_to_rgba8,
+         SDL_GPU_TEXTUREFORMAT_R8G8B8A8_UNORM},
+        {SDL_PIXELFORMAT_RGB565, SDL_GPU_TEXTUREFORMAT_B5G6R5_UNORM, convert_rgb565_to_rgba8,
+         SDL_GPU_TEXTUREFORMAT_R8G8B8A8_UNORM},
+        {SDL_PIXELFORMAT_ARGB1555, SDL_GPU_TEXTUREFORMAT_B5G5R5A1_UNORM, convert_argb1555_to_rgba8,
+         SDL_GPU_TEXTUREFORMAT_R8G8B8A8_UNORM},
+        {SDL_PIXELFORMAT_ARGB4444, SDL_GPU_TEXTUREFORMAT_B4G4R4A4_UNORM, convert_argb4444_to_rgba8,
+         SDL_GPU_TEXTUREFORMAT_R8G8B8A8_UNORM},
+};
+
+const sdl_surface_format_to_gpu_format *gpu_format_for_surface(SDL_PixelFormat pixel_format) {
+    for (size_t i = 0; i < SDL_arraysize(pixel_to_gpu); i++) {
+        if (pixel_to_gpu[i].surface == pixel_format) {
+            return &pixel_to_gpu[i];
+        }
+    }
+    return NULL;
+}
+
+static bool isa_supported(pixel_convert_isa_t isa) {
+    switch (isa) {
+        case PIXEL_CONVERT_ISA_SCALAR:
+            return true;
+#ifdef PIXEL_CONVERT_X86
+        case PIXEL_CONVERT_ISA_SSSE3:
+            // SDL has no SSSE3 query, every SSE4.1 cpu has it
+            return SDL_HasSSE41();
+        case PIXEL_CONVERT_ISA_AVX2:
+            return SDL_HasAVX2();
+#endif
+        default:
+            return false;
+    }
+}
+
+bool pixel_convert_set_isa(pixel_convert_isa_t isa) {
+    if (!isa_supported(isa)) {
+        return false;
+    }
+    switch (isa) {
+#ifdef PIXEL_CONVERT_X86
+        case PIXEL_CONVERT_ISA_SSSE3:
+            swizzle24_impl = swizzle24_ssse3;
+            swizzle32_impl = swizzle32_ssse3;
+            break;
+        case PIXEL_CONVERT_ISA_AVX2:
+            swizzle24_impl = swizzle24_avx2;
+            swizzle32_impl = swizzle32_avx2;
+            break;
+#endif
+        default:
+            swizzle24_impl = swizzle24_scalar;
+            swizzle32_impl = swizzle32_scalar;
+            break;
+    }
+    active_isa = isa;
+    return true;
+}
+
+pixel_convert_isa_t pixel_convert_get_isa(void) {
+    return active_isa;
+}
+
+const char *pixel_convert_isa_name(pixel_convert_isa_t isa) {
+    switch (isa) {
+        case PIXEL_CONVERT_ISA_SCALAR:
+            return "scalar";
+        case PIXEL_CONVERT_ISA_SSSE3:
+            return "ssse3";
+        case PIXEL_CONVERT_ISA_AVX2:
+            return "avx2";
+        default:
+            return "unknown";
+    }
+}
+
+void pixel_convert_init(void) {
+    if (!SDL_ShouldInit(&init_state)) {
+        return;
+    }
+    for (int isa = PIXEL_CONVERT_ISA_COUNT - 1; isa >= 0; isa--) {
+        if (pixel_convert_set_isa((pixel_convert_isa_t) isa)) {
+            break;
+        }
+    }
+    SDL_SetInitialized(&init_state, true);
+}
+
+bool pixel_convert_surface(SDL_GPUDevice *device, SDL_Surface *surface, converted_pixels_t *out) {
+    pixel_convert_init();
+
+    uint32_t w = surface->w;
+    uint32_t h = surface->h;
+    const sdl_surface_format_to_gpu_format *converter = gpu_format_for_surface(surface->format);
+    if (converter == NULL) {
+        // uncommon formats go through SDL once and then take the RGBA32 path
+        SDL_Surface *rgba = SDL_ConvertSurface(surface, SDL_PIXELFORMAT_RGBA32);
+        if (rgba == NULL) {
+            return false;
+        }
+        bool ok = pixel_convert_surface(NULL, rgba, out);
+        SDL_DestroySurface(rgba);
+        return ok;
+    }
+
+    if (device != NULL && converter->gpu != SDL_GPU_TEXTUREFORMAT_INVALID &&
+        SDL_GPUTextureSupportsFormat(device, converter->gpu, SDL_GPU_TEXTURETYPE_2D, SDL_GPU_TEXTUREUSAGE_SAMPLER)) {
+        uint32_t texel_size = SDL_GPUTextureFormatTexelBlockSize(converter->gpu);
+        if (surface->pitch % texel_size == 0) {
+            *out = (converted_pixels_t) {
+                    .format = converter->gpu,
+                    .width = w,
+                    .height = h,
+                    .pixels_per_row = surface->pitch / texel_size,
+                    .size_bytes = (size_t) surface->pitch * h,
+                    .pixels = surface->pixels,
+                    .owned = false,
+            };
+            return true;
+        }
+    }
+
+    uint8_t lut[256][4];
+    const void *ctx = NULL;
+    if (SDL_ISPIXELFORMAT_INDEXED(surface->format)) {
+        SDL_Palette *palette = SDL_GetSurfacePalette(surface);
+        if (palette == NULL) {
+            return SDL_SetError("indexed surface without palette");
+        }
+        SDL_memset(lut, 0, sizeof(lut));
+        for (int i = 0; i < palette->ncolors && i < 256; i++) {
+            lut[i][0] = palette->colors[i].r;
+            lut[i][1] = palette->colors[i].g;
+            lut[i][2] = palette->colors[i].b;
+            lut[i][3] = palette->colors[i].a;
+        }
+        ctx = lut;
+    }
+
+    uint32_t texel_size = SDL_GPUTextureFormatTexelBlockSize(converter->convert_format);
+    size_t row_bytes = (size_t) w * texel_size;
+    uint8_t *pixels = SDL_malloc(row_bytes * h);
+    if (pixels == NULL) {
+        return false;
+    }
+    const uint8_t *src = surface->pixels;
+    for (uint32_t y = 0; y < h; y++) {
+        converter->convert(src + (size_t) y * surface->pitch, pixels + y * row_bytes, w, ctx);
+    }
+
+    *out = (converted_pixels_t) {
+            .format = converter->convert_format,
+            .width = w,
+            .height = h,
+            .pixels_per_row = w,
+            .size_bytes = row_bytes * h,
+            .pixels = pixels,
+            .owned = true,
+    };
+    return true;
+}
+
+void pixel_convert_free(converted_pixels_t *converted) {
+    if (converted->owned) {
+        SDL_free(converted->pixels);
+    }
+    converted->pixels = NULL;
+    converted->owned = false;
+}
@@ -0,0 +1,50 @@
+#ifndef KINGDOM_DEFENSE_PIXEL_CONVERT_H
+#define KINGDOM_DEFENSE_PIXEL_CONVERT_H
+
+#include <SDL3/SDL.h>
+
+// converts `pixels` pixels of one row from `input` into `out`. `ctx` is kernel specific (palette lut for indexed).
+typedef void (*convert_format_fun_t)(const uint8_t *input, uint8_t *out, size_t pixels, const void *ctx);
+
+typedef enum {
+    PIXEL_CONVERT_ISA_SCALAR,
+    PIXEL_CONVERT_ISA_SSSE3,
+    PIXEL_CONVERT_ISA_AVX2,
+    PIXEL_CONVERT_ISA_COUNT,
+} pixel_convert_isa_t;
+
+typedef struct {
+    SDL_PixelFormat surface;
+    // format the surface can be uploaded as without conversion, INVALID if there is none
+    SDL_GPUTextureFormat gpu;
+    // used when `gpu` is INVALID or not supported by the device
+    convert_format_fun_t convert;
+    SDL_GPUTextureFormat convert_format;
+} sdl_surface_format_to_gpu_format;
+
+typedef struct {
+    SDL_GPUTextureFormat format;
+    uint32_t width;
+    uint32_t height;
+    uint32_t pixels_per_row;
+    size_t size_bytes;
+    uint8_t *pixels;
+    // pixels either point into the source surface or into a scratch buffer owned by us
+    bool owned;
+} converted_pixels_t;
+
+const sdl_surface_format_to_gpu_format *gpu_format_for_surface(SDL_PixelFormat pixel_format);
+
+// picks the best kernels for the running cpu, called lazily by the functions below
+void pixel_convert_init(void);
+
+// force a kernel set, returns false if the cpu does not support it
+bool pixel_convert_set_isa(pixel_convert_isa_t isa);
+pixel_convert_isa_t pixel_convert_get_isa(void);
+const char *pixel_convert_isa_name(pixel_convert_isa_t isa);
+
+// device may be NULL, in that case every format goes through its conversion kernel
+bool pixel_convert_surface(SDL_GPUDevice *device, SDL_Surface *surface, converted_pixels_t *out);
+void pixel_convert_free(converted_pixels_t *converted);
+
+#endif //KINGDOM_DEFENSE_PIXEL_CONVERT_H
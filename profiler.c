@@ -0,0 +1,192 @@
+#include "profiler.h"
+
+static const char *counter_names[PROFILER_COUNTER_COUNT] = {
+        [PROFILER_COUNTER_DRAW_CALLS] = "draw_calls",
+        [PROFILER_COUNTER_BINDS] = "binds",
+        [PROFILER_COUNTER_UPLOAD_BYTES] = "upload_bytes",
+        [PROFILER_COUNTER_HEAP_ALLOCATIONS] = "heap_allocations",
+        [PROFILER_COUNTER_VISIBLE_OBJECTS] = "visible_objects",
+        [PROFILER_COUNTER_CULLED_OBJECTS] = "culled_objects",
+        [PROFILER_COUNTER_GPU_BYTES] = "gpu_bytes",
+};
+
+static profiler_frame_t *current_frame(profiler_t *profiler) {
+    return &profiler->frames[(profiler->num_frames - 1) % PROFILER_HISTORY_FRAMES];
+}
+
+// finished frames in the history, the one being recorded doesn't count
+static uint32_t finished_frames(const profiler_t *profiler) {
+    uint64_t finished = profiler->recording ? profiler->num_frames - 1 : profiler->num_frames;
+    return (uint32_t) SDL_min(finished, PROFILER_HISTORY_FRAMES);
+}
+
+// i-th finished frame, oldest first
+static const profiler_frame_t *finished_frame(const profiler_t *profiler, uint32_t i) {
+    uint64_t last = profiler->recording ? profiler->num_frames - 1 : profiler->num_frames;
+    uint64_t index = last - finished_frames(profiler) + i;
+    return &profiler->frames[index % PROFILER_HISTORY_FRAMES];
+}
+
+bool profiler_init(profiler_t *profiler) {
+    SDL_zerop(profiler);
+    profiler->frames = SDL_calloc(PROFILER_HISTORY_FRAMES, sizeof(profiler_frame_t));
+    return profiler->frames != NULL;
+}
+
+void profiler_destroy(profiler_t *profiler) {
+    SDL_free(profiler->frames);
+    SDL_zerop(profiler);
+}
+
+void profiler_frame_begin(profiler_t *profiler) {
+    if (profiler->recording) {
+        profiler_frame_end(profiler);
+    }
+    profiler->num_frames++;
+    profiler->recording = true;
+    profiler->depth = 0;
+    profiler_frame_t *frame = current_frame(profiler);
+    SDL_zerop(frame);
+    frame->index = profiler->num_frames - 1;
+    frame->begin_ns = SDL_GetTicksNS();
+}
+
+void profiler_frame_end(profiler_t *profiler) {
+    if (!profiler->recording) {
+        return;
+    }
+    profiler_frame_t *frame = current_frame(profiler);
+    frame->end_ns = SDL_GetTicksNS();
+    while (profiler->depth > 0) {
+        frame->zones[profiler->stack[--profiler->depth]].end_ns = frame->end_ns;
+    }
+    profiler->recording = false;
+}
+
+uint32_t profiler_begin(profiler_t *profiler, const char *name) {
+    if (!profiler->recording) {
+        return PROFILER_INVALID_ZONE;
+    }
+    profiler_frame_t *frame = current_frame(profiler);
+    if (frame->num_zones == PROFILER_MAX_ZONES || profiler->depth == PROFILER_MAX_DEPTH) {
+        profiler->dropped_zones++;
+        return PROFILER_INVALID_ZONE;
+    }
+    uint32_t zone = frame->num_zones++;
+    frame->zones[zone] = (profiler_zone_t) {
+            .name = name,
+            .begin_ns = SDL_GetTicksNS(),
+            .depth = profiler->depth,
+    };
+    profiler->stack[profiler->depth++] = zone;
+    return zone;
+}
+
+void profiler_end(profiler_t *profiler, uint32_t zone) {
+    if (zone == PROFILER_INVALID_ZONE || !profiler->recording) {
+        return;
+    }
+    profiler_frame_t *frame = current_frame(profiler);
+    uint64_t now = SDL_GetTicksNS();
+    // a zone ended out of order also closes the zones opened inside it
+    while (profiler->depth > 0) {
+        uint32_t top = profiler->stack[--profiler->depth];
+        frame->zones[top].end_ns = now;
+        if (top == zone) {
+            break;
+        }
+    }
+}
+
+const profiler_frame_t *profiler_last_frame(const profiler_t *profiler) {
+    uint32_t frames = finished_frames(profiler);
+    return frames > 0 ? finished_frame(profiler, frames - 1) : NULL;
+}
+
+static int compare_durations(const void *a, const void *b) {
+    uint64_t x = *(const uint64_t *) a;
+    uint64_t y = *(const uint64_t *) b;
+    return (x > y) - (x < y);
+}
+
+void profiler_frame_stats(const profiler_t *profiler, profiler_frame_stats_t *out) {
+    SDL_zerop(out);
+    uint64_t durations[PROFILER_HISTORY_FRAMES];
+    uint32_t frames = finished_frames(profiler);
+    for (uint32_t i = 0; i < frames; i++) {
+        const profiler_frame_t *frame = finished_frame(profiler, i);
+        durations[i] = frame->end_ns - frame->begin_ns;
+    }
+    if (frames == 0) {
+        return;
+    }
+    SDL_qsort(durations, frames, sizeof(uint64_t), compare_durations);
+    // nearest rank
+    out->frames = frames;
+    out->p50_ns = durations[(frames - 1) / 2];
+    out->p99_ns = durations[(frames * 99 + 99) / 100 - 1];
+    out->max_ns = durations[frames - 1];
+}
+
+uint32_t profiler_frame_times(const profiler_t *profiler, float *ms, uint32_t max) {
+    uint32_t frames = finished_frames(profiler);
+    uint32_t first = frames > max ? frames - max : 0;
+    for (uint32_t i = first; i < frames; i++) {
+        const profiler_frame_t *frame = finished_frame(profiler, i);
+        ms[i - first] = (float) ((double) (frame->end_ns - frame->begin_ns) / SDL_NS_PER_MS);
+    }
+    return frames - first;
+}
+
+// chrome trace timestamps are in microseconds
+static double trace_us(uint64_t ns) {
+    return (double) ns / SDL_NS_PER_US;
+}
+
+// every event follows the thread name metadata, so each one starts with a comma
+static bool write_zone(SDL_IOStream *out, const char *name, uint64_t begin_ns, uint64_t end_ns) {
+    return SDL_IOprintf(out, ",\n{\"name\":\"%s\",\"cat\":\"cpu\",\"ph\":\"X\",\"ts\":%.3f,\"dur\":%.3f,\"pid\":1,"
+                             "\"tid\":1}", name, trace_us(begin_ns), trace_us(end_ns - begin_ns)) > 0;
+}
+
+static bool write_frame(SDL_IOStream *out, const profiler_frame_t *frame) {
+    if (!write_zone(out, "frame", frame->begin_ns, frame->end_ns)) {
+        return false;
+    }
+    for (uint32_t i = 0; i < frame->num_zones; i++) {
+        const profiler_zone_t *zone = &frame->zones[i];
+        if (!write_zone(out, zone->name, zone->begin_ns, zone->end_ns)) {
+            return false;
+        }
+    }
+    if (SDL_IOprintf(out, ",\n{\"name\":\"counters\",\"ph\":\"C\",\"ts\":%.3f,\"pid\":1,\"tid\":1,\"args\":{",
+                     trace_us(frame->begin_ns)) == 0) {
+        return false;
+    }
+    for (int counter = 0; counter < PROFILER_COUNTER_COUNT; counter++) {
+        if (SDL_IOprintf(out, "%s\"%s\":%" SDL_PRIu64, counter == 0 ? "" : ",", counter_names[counter],
+                         frame->counters[counter]) == 0) {
+            return false;
+        }
+    }
+    return SDL_IOprintf(out, "}}") > 0;
+}
+
+bool profiler_export_chrome_trace(const profiler_t *profiler, const char *path) {
+    SDL_IOStream *out = SDL_IOFromFile(path, "wb");
+    if (out == NULL) {
+        return false;
+    }
+    bool ok = SDL_IOprintf(out, "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[") > 0 &&
+              SDL_IOprintf(out, "\n{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":1,"
+                                "\"args\":{\"name\":\"render\"}}") > 0;
+    uint32_t frames = finished_frames(profiler);
+    for (uint32_t i = 0; ok && i < frames; i++) {
+        ok = write_frame(out, finished_frame(profiler, i));
+    }
+    ok = ok && SDL_IOprintf(out, "\n]}\n") > 0;
+    if (!SDL_CloseIO(out)) {
+        ok = false;
+    }
+    return ok || SDL_SetError("failed to write %s", path);
+}
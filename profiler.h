@@ -0,0 +1,89 @@
+#ifndef KINGDOM_DEFENSE_PROFILER_H
+#define KINGDOM_DEFENSE_PROFILER_H
+
+#include <SDL3/SDL.h>
+
+#define PROFILER_MAX_ZONES 64
+#define PROFILER_MAX_DEPTH 8
+// about five seconds at 60 fps, enough to still have a hitch in memory when somebody hits the export key
+#define PROFILER_HISTORY_FRAMES 300
+#define PROFILER_INVALID_ZONE UINT32_MAX
+
+typedef enum {
+    PROFILER_COUNTER_DRAW_CALLS,
+    PROFILER_COUNTER_BINDS,
+    PROFILER_COUNTER_UPLOAD_BYTES,
+    // on every thread, see memory_track_heap
+    PROFILER_COUNTER_HEAP_ALLOCATIONS,
+    // entities that made it past view culling and the ones that didn't
+    PROFILER_COUNTER_VISIBLE_OBJECTS,
+    PROFILER_COUNTER_CULLED_OBJECTS,
+    // everything gpu_resources knows to be alive at the end of the frame, a soak run's trace shows it growing
+    PROFILER_COUNTER_GPU_BYTES,
+    PROFILER_COUNTER_COUNT,
+} profiler_counter_t;
+
+typedef struct {
+    // string literal, only the pointer is kept
+    const char *name;
+    uint64_t begin_ns;
+    uint64_t end_ns;
+    uint32_t depth;
+} profiler_zone_t;
+
+typedef struct {
+    uint64_t index;
+    uint64_t begin_ns;
+    uint64_t end_ns;
+    profiler_zone_t zones[PROFILER_MAX_ZONES];
+    uint32_t num_zones;
+    uint64_t counters[PROFILER_COUNTER_COUNT];
+} profiler_frame_t;
+
+typedef struct {
+    uint32_t frames;
+    uint64_t p50_ns;
+    uint64_t p99_ns;
+    uint64_t max_ns;
+} profiler_frame_stats_t;
+
+// cpu timing zones and per frame counters of the render thread, kept for the last PROFILER_HISTORY_FRAMES frames
+typedef struct {
+    profiler_frame_t *frames;
+    // frames begun so far, the one being recorded is frames[(num_frames - 1) % PROFILER_HISTORY_FRAMES]
+    uint64_t num_frames;
+    bool recording;
+    uint32_t stack[PROFILER_MAX_DEPTH];
+    uint32_t depth;
+    // zones that didn't fit in their frame or nested too deep
+    uint64_t dropped_zones;
+} profiler_t;
+
+bool profiler_init(profiler_t *profiler);
+void profiler_destroy(profiler_t *profiler);
+
+void profiler_frame_begin(profiler_t *profiler);
+// closes zones left open
+void profiler_frame_end(profiler_t *profiler);
+
+// zones nest, every profiler_begin is matched by a profiler_end before the frame ends
+uint32_t profiler_begin(profiler_t *profiler, const char *name);
+void profiler_end(profiler_t *profiler, uint32_t zone);
+
+static inline void profiler_count(profiler_t *profiler, profiler_counter_t counter, uint64_t value) {
+    if (profiler->recording) {
+        profiler->frames[(profiler->num_frames - 1) % PROFILER_HISTORY_FRAMES].counters[counter] += value;
+    }
+}
+
+// the last finished frame, NULL before the first one ends
+const profiler_frame_t *profiler_last_frame(const profiler_t *profiler);
+// frame time percentiles over the finished frames in the history
+void profiler_frame_stats(const profiler_t *profiler, profiler_frame_stats_t *out);
+// frame times in milliseconds, oldest first. returns how many were written
+uint32_t profiler_frame_times(const profiler_t *profiler, float *ms, uint32_t max);
+
+// writes every finished frame in the history as chrome trace events, open it in chrome://tracing or perfetto
+bool profiler_export_chrome_trace(const profiler_t *profiler, const char *path);
+
+#endif //KINGDOM_DEFENSE_PROFILER_H
@@ -0,0 +1,190 @@
+#include "quadtree.h"
+
+// nodes of the levels above `level`, level l is a 2^l x 2^l grid
+static uint32_t level_offset(uint32_t level) {
+    return ((1u << (2 * level)) - 1) / 3;
+}
+
+static uint32_t node_index(uint32_t level, uint32_t x, uint32_t y) {
+    return level_offset(level) + y * (1u << level) + x;
+}
+
+bool quadtree_init(quadtree_t *tree, float min_x, float min_y, float size, uint32_t depth, uint32_t capacity) {
+    SDL_zerop(tree);
+    if (size <= 0.0f || depth > QUADTREE_MAX_DEPTH) {
+        return SDL_SetError("invalid quadtree size or depth");
+    }
+    tree->min_x = min_x;
+    tree->min_y = min_y;
+    tree->size = size;
+    tree->inv_size = 1.0f / size;
+    tree->depth = depth;
+    for (uint32_t level = 0; level <= depth; level++) {
+        tree->half_cell[level] = size / (float) (1u << level) * 0.5f;
+    }
+    tree->num_nodes = level_offset(depth + 1);
+    tree->capacity = capacity;
+    tree->node_start = SDL_calloc(tree->num_nodes + 1, sizeof(uint32_t));
+    tree->subtree_items = SDL_calloc(tree->num_nodes, sizeof(uint32_t));
+    tree->order = SDL_malloc(capacity * sizeof(uint32_t));
+    tree->item_node = SDL_malloc(capacity * sizeof(uint32_t));
+    tree->item_id = SDL_malloc(capacity * sizeof(uint32_t));
+    tree->item_bounds = SDL_malloc(capacity * sizeof(float[4]));
+    if (tree->node_start == NULL || tree->subtree_items == NULL || tree->order == NULL || tree->item_node == NULL ||
+        tree->item_id == NULL || tree->item_bounds == NULL) {
+        quadtree_destroy(tree);
+        return false;
+    }
+    return true;
+}
+
+void quadtree_destroy(quadtree_t *tree) {
+    SDL_free(tree->node_start);
+    SDL_free(tree->subtree_items);
+    SDL_free(tree->order);
+    SDL_free(tree->item_node);
+    SDL_free(tree->item_id);
+    SDL_free(tree->item_bounds);
+    SDL_zerop(tree);
+}
+
+void quadtree_begin(quadtree_t *tree) {
+    tree->count = 0;
+}
+
+bool quadtree_insert(quadtree_t *tree, uint32_t id, float min_x, float min_y, float max_x, float max_y) {
+    if (tree->count == tree->capacity) {
+        return SDL_SetError("quadtree full");
+    }
+    uint32_t i = tree->count++;
+    tree->item_id[i] = id;
+    tree->item_bounds[i][0] = min_x;
+    tree->item_bounds[i][1] = min_y;
+    tree->item_bounds[i][2] = max_x;
+    tree->item_bounds[i][3] = max_y;
+
+    // a node holds items up to half its cell in every direction from a center inside the cell
+    float fx = ((min_x + max_x) * 0.5f - tree->min_x) * tree->inv_size;
+    float fy = ((min_y + max_y) * 0.5f - tree->min_y) * tree->inv_size;
+    float extent = SDL_max(max_x - min_x, max_y - min_y) * 0.5f;
+    if (!(fx >= 0.0f && fx < 1.0f && fy >= 0.0f && fy < 1.0f) || extent > tree->half_cell[0]) {
+        tree->item_node[i] = 0;
+        return true;
+    }
+    // most items are small, so start at the bottom
+    uint32_t level = tree->depth;
+    while (extent > tree->half_cell[level]) {
+        level--;
+    }
+    uint32_t cells = 1u << level;
+    uint32_t x = SDL_min((uint32_t) (fx * (float) cells), cells - 1);
+    uint32_t y = SDL_min((uint32_t) (fy * (float) cells), cells - 1);
+    tree->item_node[i] = node_index(level, x, y);
+    return true;
+}
+
+void quadtree_end(quadtree_t *tree) {
+    SDL_memset(tree->node_start, 0, (tree->num_nodes + 1) * sizeof(uint32_t));
+    for (uint32_t i = 0; i < tree->count; i++) {
+        tree->node_start[tree->item_node[i] + 1]++;
+    }
+    for (uint32_t n = 0; n < tree->num_nodes; n++) {
+        tree->node_start[n + 1] += tree->node_start[n];
+    }
+    // subtree_items is the write cursor of every node until the scatter is done
+    SDL_memcpy(tree->subtree_items, tree->node_start, tree->num_nodes * sizeof(uint32_t));
+    for (uint32_t i = 0; i < tree->count; i++) {
+        tree->order[tree->subtree_items[tree->item_node[i]]++] = i;
+    }
+
+    // bottom up, children first
+    for (int32_t level = (int32_t) tree->depth; level >= 0; level--) {
+        uint32_t cells = 1u << level;
+        for (uint32_t y = 0; y < cells; y++) {
+            for (uint32_t x = 0; x < cells; x++) {
+                uint32_t n = node_index((uint32_t) level, x, y);
+                uint32_t total = tree->node_start[n + 1] - tree->node_start[n];
+                if ((uint32_t) level < tree->depth) {
+                    total += tree->subtree_items[node_index(level + 1, x * 2, y * 2)] +
+                             tree->subtree_items[node_index(level + 1, x * 2 + 1, y * 2)] +
+                             tree->subtree_items[node_index(level + 1, x * 2, y * 2 + 1)] +
+                             tree->subtree_items[node_index(level + 1, x * 2 + 1, y * 2 + 1)];
+                }
+                tree->subtree_items[n] = total;
+            }
+        }
+    }
+}
+
+static bool overlaps(const float a[4], const float b[4]) {
+    return a[0] <= b[2] && a[2] >= b[0] && a[1] <= b[3] && a[3] >= b[1];
+}
+
+static bool contains(const float outer[4], const float inner[4]) {
+    return inner[0] >= outer[0] && inner[2] <= outer[2] && inner[1] >= outer[1] && inner[3] <= outer[3];
+}
+
+static uint32_t take_subtree(quadtree_t *tree, uint32_t level, uint32_t x, uint32_t y, uint32_t *out) {
+    uint32_t n = node_index(level, x, y);
+    if (tree->subtree_items[n] == 0) {
+        return 0;
+    }
+    tree->stats.nodes_visited++;
+    uint32_t num_out = 0;
+    for (uint32_t i = tree->node_start[n]; i < tree->node_start[n + 1]; i++) {
+        out[num_out++] = tree->item_id[tree->order[i]];
+    }
+    if (level < tree->depth) {
+        for (uint32_t child = 0; child < 4; child++) {
+            num_out += take_subtree(tree, level + 1, x * 2 + (child & 1), y * 2 + (child >> 1), out + num_out);
+        }
+    }
+    return num_out;
+}
+
+static uint32_t query_node(quadtree_t *tree, const float view[4], uint32_t level, uint32_t x, uint32_t y,
+                           uint32_t *out) {
+    uint32_t n = node_index(level, x, y);
+    if (tree->subtree_items[n] == 0) {
+        return 0;
+    }
+    // the root also holds the items that fit nowhere, only its children can be judged by their bounds
+    if (level > 0) {
+        float cell = tree->size / (float) (1u << level);
+        float loose[4] = {
+                tree->min_x + ((float) x - 0.5f) * cell,
+                tree->min_y + ((float) y - 0.5f) * cell,
+                tree->min_x + ((float) x + 1.5f) * cell,
+                tree->min_y + ((float) y + 1.5f) * cell,
+        };
+        if (!overlaps(loose, view)) {
+            return 0;
+        }
+        if (contains(view, loose)) {
+            return take_subtree(tree, level, x, y, out);
+        }
+    }
+    tree->stats.nodes_visited++;
+    uint32_t num_out = 0;
+    for (uint32_t i = tree->node_start[n]; i < tree->node_start[n + 1]; i++) {
+        uint32_t item = tree->order[i];
+        if (overlaps(tree->item_bounds[item], view)) {
+            out[num_out++] = tree->item_id[item];
+        }
+    }
+    if (level < tree->depth) {
+        for (uint32_t child = 0; child < 4; child++) {
+            num_out += query_node(tree, view, level + 1, x * 2 + (child & 1), y * 2 + (child >> 1), out + num_out);
+        }
+    }
+    return num_out;
+}
+
+uint32_t quadtree_query(quadtree_t *tree, const float view[4], uint32_t *out) {
+    tree->stats.nodes_visited = 0;
+    uint32_t visible = query_node(tree, view, 0, 0, 0, out);
+    tree->stats.items = tree->count;
+    tree->stats.visible = visible;
+    tree->stats.culled = tree->count - visible;
+    return visible;
+}
@@ -0,0 +1,60 @@
+#ifndef KINGDOM_DEFENSE_QUADTREE_H
+#define KINGDOM_DEFENSE_QUADTREE_H
+
+#include <SDL3/SDL.h>
+
+#define QUADTREE_MAX_DEPTH 10
+
+typedef struct {
+    uint32_t items;
+    uint32_t visible;
+    uint32_t culled;
+    uint32_t nodes_visited;
+} quadtree_stats_t;
+
+// loose quadtree over a square, every level a dense grid of nodes so there are no pointers to chase. a node's
+// loose bounds are its cell grown by half a cell on every side, an item goes to the deepest level it fits in
+// by size and to the node its center falls in there. items that fit nowhere, too large or centered off the
+// square, stay in the root and are tested one by one.
+// rebuilt from scratch like spatial_hash: quadtree_begin, one quadtree_insert per item, quadtree_end. moving
+// and static items are handled alike, a rebuild is a counting sort and never allocates
+typedef struct {
+    float min_x;
+    float min_y;
+    float size;
+    float inv_size;
+    uint32_t depth;
+    // half the cell size of every level, the largest extent an item in it may have
+    float half_cell[QUADTREE_MAX_DEPTH + 1];
+    uint32_t num_nodes;
+
+    // items of node n are order[node_start[n]] .. order[node_start[n + 1] - 1], subtree_items also counts the
+    // ones below n
+    uint32_t *node_start;
+    uint32_t *subtree_items;
+    uint32_t *order;
+    // insertion order: node, caller side id and min_x, min_y, max_x, max_y of every item. only the 4 byte order
+    // is sorted, the bounds stay where they were written
+    uint32_t *item_node;
+    uint32_t *item_id;
+    float (*item_bounds)[4];
+    uint32_t count;
+    uint32_t capacity;
+
+    quadtree_stats_t stats;
+} quadtree_t;
+
+// `depth` levels below the root, the smallest nodes are size / 2^depth wide
+bool quadtree_init(quadtree_t *tree, float min_x, float min_y, float size, uint32_t depth, uint32_t capacity);
+void quadtree_destroy(quadtree_t *tree);
+
+void quadtree_begin(quadtree_t *tree);
+// false once `capacity` items were inserted
+bool quadtree_insert(quadtree_t *tree, uint32_t id, float min_x, float min_y, float max_x, float max_y);
+void quadtree_end(quadtree_t *tree);
+
+// ids of the items overlapping `view` (min_x, min_y, max_x, max_y) into `out`, which has room for every item.
+// returns how many. whole subtrees are skipped or taken without looking at their items where the view allows
+uint32_t quadtree_query(quadtree_t *tree, const float view[4], uint32_t *out);
+
+#endif //KINGDOM_DEFENSE_QUADTREE_H
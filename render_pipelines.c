@@ -0,0 +1,529 @@
+#include <assert.h>
+
+#include "common.h"
+#include "gpu_resources.h"
+#include "render_pipelines.h"
+#include "shader_inputs.h"
+#include "shader_reflection.h"
+
+static int worker_main(void *data);
+
+// the file goes to the scratch arena, the shader owns a copy of the code once it is created
+static void *load_file(arena_t *scratch, const char *path, size_t *size) {
+    SDL_IOStream *file = SDL_IOFromFile(path, "rb");
+    if (file == NULL) {
+        return NULL;
+    }
+    Sint64 length = SDL_GetIOSize(file);
+    void *data = length > 0 ? arena_alloc(scratch, (size_t) length, ARENA_DEFAULT_ALIGNMENT) : NULL;
+    bool ok = data != NULL && SDL_ReadIO(file, data, (size_t) length) == (size_t) length;
+    SDL_CloseIO(file);
+    *size = ok ? (size_t) length : 0;
+    return ok ? data : NULL;
+}
+
+shader_t *load_shader(SDL_GPUDevice *device, arena_t *scratch, const char *path, SDL_GPUShaderStage stage) {
+    // resource counts are baked in at build time, see cmake/shader_reflection.cmake
+    const shader_reflection_t *reflection = shader_reflection_find(path);
+    if (reflection == NULL) {
+        SDL_SetError("no reflection data for %s", path);
+        return NULL;
+    }
+    shader_t *ret = ARENA_NEW(scratch, shader_t, 1);
+    if (ret == NULL) {
+        return NULL;
+    }
+
+    arena_scope_t file_scope = arena_scope_begin(scratch);
+    size_t size = 0;
+    void *file = load_file(scratch, path, &size);
+    if (file == NULL) {
+        arena_scope_end(file_scope);
+        return NULL;
+    }
+
+    SDL_PropertiesID props = SDL_CreateProperties();
+    SDL_SetStringProperty(props, SDL_PROP_GPU_SHADER_CREATE_NAME_STRING, path);
+    SDL_GPUShaderCreateInfo info = {
+            .code = file,
+            .code_size = size,
+            .entrypoint = "main",
+            .format = SDL_GPU_SHADERFORMAT_SPIRV,
+            .stage = stage,
+            .props = props,
+            .num_samplers = reflection->num_samplers,
+            .num_storage_buffers = reflection->num_storage_buffers,
+            .num_uniform_buffers = reflection->num_uniform_buffers,
+            .num_storage_textures = reflection->num_storage_textures,
+    };
+    SDL_GPUShader *shader = gpu_create_shader(device, &info, GPU_CALLSITE);
+    uint64_t hash = pipeline_cache_hash(file, size, PIPELINE_CACHE_HASH_SEED);
+    arena_scope_end(file_scope);
+    SDL_DestroyProperties(props);
+    if (shader == NULL) {
+        return NULL;
+    }
+    ret->shader = shader;
+    ret->info = info;
+    ret->info.code = NULL;
+    ret->info.props = 0;
+    ret->hash = hash;
+    return ret;
+}
+
+void free_shader(SDL_GPUDevice *device, shader_t *shader) {
+    assert(device && "device is null");
+    assert(shader && "shader is null");
+    gpu_release_shader(device, shader->shader);
+}
+
+SDL_GPUComputePipeline *load_compute_pipeline(SDL_GPUDevice *device, arena_t *scratch, const char *path) {
+    const compute_shader_reflection_t *reflection = compute_shader_reflection_find(path);
+    if (reflection == NULL) {
+        SDL_SetError("no reflection data for %s", path);
+        return NULL;
+    }
+    arena_scope_t file_scope = arena_scope_begin(scratch);
+    size_t size = 0;
+    void *file = load_file(scratch, path, &size);
+    if (file == NULL) {
+        arena_scope_end(file_scope);
+        return NULL;
+    }
+
+    SDL_PropertiesID props = SDL_CreateProperties();
+    SDL_SetStringProperty(props, SDL_PROP_GPU_COMPUTEPIPELINE_CREATE_NAME_STRING, path);
+    SDL_GPUComputePipelineCreateInfo info = {
+            .code = file,
+            .code_size = size,
+            .entrypoint = "main",
+            .format = SDL_GPU_SHADERFORMAT_SPIRV,
+            .num_samplers = reflection->num_samplers,
+            .num_readonly_storage_textures = reflection->num_readonly_storage_textures,
+            .num_readonly_storage_buffers = reflection->num_readonly_storage_buffers,
+            .num_readwrite_storage_textures = reflection->num_readwrite_storage_textures,
+            .num_readwrite_storage_buffers = reflection->num_readwrite_storage_buffers,
+            .num_uniform_buffers = reflection->num_uniform_buffers,
+            .threadcount_x = reflection->threadcount_x,
+            .threadcount_y = reflection->threadcount_y,
+            .threadcount_z = reflection->threadcount_z,
+            .props = props,
+    };
+    SDL_GPUComputePipeline *pipeline = gpu_create_compute_pipeline(device, &info, GPU_CALLSITE);
+    arena_scope_end(file_scope);
+    SDL_DestroyProperties(props);
+    return pipeline;
+}
+
+typedef struct {
+    const SDL_GPUVertexBufferDescription *buffers;
+    uint32_t num_buffers;
+    const SDL_GPUVertexAttribute *attributes;
+    uint32_t num_attributes;
+} vertex_layout_info_t;
+
+static const SDL_GPUVertexBufferDescription simple_buffers[] = {
+        {
+                .slot = 0,
+                .input_rate = SDL_GPU_VERTEXINPUTRATE_VERTEX,
+                .pitch = sizeof(simple_vert),
+        },
+};
+static const SDL_GPUVertexAttribute simple_attributes[] = {
+        { // xy_pos
+                .buffer_slot = 0,
+                .format = SIMPLE_VERT_FORMAT_XY_POS,
+                .location = SIMPLE_VERT_LOCATION_XY_POS,
+                .offset = offsetof(simple_vert, xy_pos),
+        },
+        { // color
+                .buffer_slot = 0,
+                .format = SIMPLE_VERT_FORMAT_COLOR,
+                .location = SIMPLE_VERT_LOCATION_COLOR,
+                .offset = offsetof(simple_vert, color),
+        },
+};
+
+static const SDL_GPUVertexBufferDescription quad_buffers[] = {
+        {
+                .slot = 0,
+                .input_rate = SDL_GPU_VERTEXINPUTRATE_VERTEX,
+                .pitch = sizeof(quad_vert),
+        },
+};
+static const SDL_GPUVertexAttribute quad_attributes[] = {
+        { // xy_pos
+                .buffer_slot = 0,
+                .format = QUAD_VERT_FORMAT_XY_POS,
+                .location = QUAD_VERT_LOCATION_XY_POS,
+                .offset = offsetof(quad_vert, xy_pos),
+        },
+        { // uv
+                .buffer_slot = 0,
+                .format = QUAD_VERT_FORMAT_UV,
+                .location = QUAD_VERT_LOCATION_UV,
+                .offset = offsetof(quad_vert, uv),
+        },
+        { // color
+                .buffer_slot = 0,
+                .format = QUAD_VERT_FORMAT_COLOR,
+                .location = QUAD_VERT_LOCATION_COLOR,
+                .offset = offsetof(quad_vert, color),
+        },
+};
+
+static const SDL_GPUVertexBufferDescription sprite_buffers[] = {
+        {
+                .slot = 0,
+                .input_rate = SDL_GPU_VERTEXINPUTRATE_VERTEX,
+                .pitch = sizeof(quad_vert),
+        },
+        {
+                .slot = 1,
+                .input_rate = SDL_GPU_VERTEXINPUTRATE_INSTANCE,
+                .pitch = sizeof(sprite_instance),
+        },
+};
+static const SDL_GPUVertexAttribute sprite_attributes[] = {
+        { // xy_pos
+                .buffer_slot = 0,
+                .format = QUAD_VERT_FORMAT_XY_POS,
+                .location = QUAD_VERT_LOCATION_XY_POS,
+                .offset = offsetof(quad_vert, xy_pos),
+        },
+        { // uv
+                .buffer_slot = 0,
+                .format = QUAD_VERT_FORMAT_UV,
+                .location = QUAD_VERT_LOCATION_UV,
+                .offset = offsetof(quad_vert, uv),
+        },
+        { // instance_pos
+                .buffer_slot = 1,
+                .format = SPRITE_INSTANCE_FORMAT_XY_POS,
+                .location = SPRITE_INSTANCE_LOCATION_XY_POS,
+                .offset = offsetof(sprite_instance, xy_pos),
+        },
+        { // instance_scale
+                .buffer_slot = 1,
+                .format = SPRITE_INSTANCE_FORMAT_SCALE,
+                .location = SPRITE_INSTANCE_LOCATION_SCALE,
+                .offset = offsetof(sprite_instance, scale),
+        },
+        { // instance_uv_rect
+                .buffer_slot = 1,
+                .format = SPRITE_INSTANCE_FORMAT_UV_RECT,
+                .location = SPRITE_INSTANCE_LOCATION_UV_RECT,
+                .offset = offsetof(sprite_instance, uv_rect),
+        },
+        { // instance_color
+                .buffer_slot = 1,
+                .format = SPRITE_INSTANCE_FORMAT_COLOR,
+                .location = SPRITE_INSTANCE_LOCATION_COLOR,
+                .offset = offsetof(sprite_instance, color),
+        },
+        { // instance_rotation
+                .buffer_slot = 1,
+                .format = SPRITE_INSTANCE_FORMAT_ROTATION,
+                .location = SPRITE_INSTANCE_LOCATION_ROTATION,
+                .offset = offsetof(sprite_instance, rotation),
+        },
+};
+
+static const vertex_layout_info_t vertex_layouts[VERTEX_LAYOUT_COUNT] = {
+        [VERTEX_LAYOUT_SIMPLE] = {simple_buffers, ARRAY_SIZE(simple_buffers), simple_attributes,
+                                  ARRAY_SIZE(simple_attributes)},
+        [VERTEX_LAYOUT_QUAD] = {quad_buffers, ARRAY_SIZE(quad_buffers), quad_attributes, ARRAY_SIZE(quad_attributes)},
+        [VERTEX_LAYOUT_SPRITE] = {sprite_buffers, ARRAY_SIZE(sprite_buffers), sprite_attributes,
+                                  ARRAY_SIZE(sprite_attributes)},
+        [VERTEX_LAYOUT_NONE] = {NULL, 0, NULL, 0},
+};
+
+static const SDL_GPUColorTargetBlendState blend_states[BLEND_MODE_COUNT] = {
+        [BLEND_MODE_OPAQUE] = {0},
+        [BLEND_MODE_ALPHA] = {
+                .src_color_blendfactor = SDL_GPU_BLENDFACTOR_SRC_ALPHA,
+                .dst_color_blendfactor = SDL_GPU_BLENDFACTOR_ONE_MINUS_SRC_ALPHA,
+                .color_blend_op = SDL_GPU_BLENDOP_ADD,
+                .src_alpha_blendfactor = SDL_GPU_BLENDFACTOR_ONE,
+                .dst_alpha_blendfactor = SDL_GPU_BLENDFACTOR_ONE_MINUS_SRC_ALPHA,
+                .alpha_blend_op = SDL_GPU_BLENDOP_ADD,
+                .enable_blend = true,
+        },
+        [BLEND_MODE_ADDITIVE] = {
+                .src_color_blendfactor = SDL_GPU_BLENDFACTOR_SRC_ALPHA,
+                .dst_color_blendfactor = SDL_GPU_BLENDFACTOR_ONE,
+                .color_blend_op = SDL_GPU_BLENDOP_ADD,
+                .src_alpha_blendfactor = SDL_GPU_BLENDFACTOR_ZERO,
+                .dst_alpha_blendfactor = SDL_GPU_BLENDFACTOR_ONE,
+                .alpha_blend_op = SDL_GPU_BLENDOP_ADD,
+                .enable_blend = true,
+        },
+};
+
+// a new material is a line here, nothing is built until something asks for it
+static const render_pipeline_desc_t pipeline_descs[RENDER_PIPELINE_COUNT] = {
+        [RENDER_PIPELINE_SIMPLE_TRIANGLE] = {
+                .name = "simple_triangle",
+                .vertex_shader = "simple.vert.hlsl.spirv",
+                .fragment_shader = "simple.frag.hlsl.spirv",
+                .vertex_layout = VERTEX_LAYOUT_SIMPLE,
+                .blend = BLEND_MODE_OPAQUE,
+                .primitive_type = SDL_GPU_PRIMITIVETYPE_TRIANGLELIST,
+        },
+        [RENDER_PIPELINE_QUAD] = {
+                .name = "quad",
+                .vertex_shader = "quad.vert.hlsl.spirv",
+                .fragment_shader = "quad.frag.hlsl.spirv",
+                .vertex_layout = VERTEX_LAYOUT_QUAD,
+                .blend = BLEND_MODE_OPAQUE,
+                .primitive_type = SDL_GPU_PRIMITIVETYPE_TRIANGLELIST,
+        },
+        [RENDER_PIPELINE_SPRITE] = {
+                .name = "sprite",
+                .vertex_shader = "sprite.vert.hlsl.spirv",
+                .fragment_shader = "quad.frag.hlsl.spirv",
+                .vertex_layout = VERTEX_LAYOUT_SPRITE,
+                .blend = BLEND_MODE_OPAQUE,
+                .primitive_type = SDL_GPU_PRIMITIVETYPE_TRIANGLELIST,
+        },
+        // drawn indirectly, see particles_draw
+        [RENDER_PIPELINE_PARTICLE] = {
+                .name = "particle",
+                .vertex_shader = "particle.vert.hlsl.spirv",
+                .fragment_shader = "simple.frag.hlsl.spirv",
+                .vertex_layout = VERTEX_LAYOUT_NONE,
+                .blend = BLEND_MODE_ADDITIVE,
+                .primitive_type = SDL_GPU_PRIMITIVETYPE_TRIANGLELIST,
+        },
+};
+
+const render_pipeline_desc_t *render_pipeline_desc(render_pipeline_id_t id) {
+    return &pipeline_descs[id];
+}
+
+uint64_t render_pipeline_desc_hash(const render_pipeline_desc_t *desc) {
+    uint64_t hash = PIPELINE_CACHE_HASH_SEED;
+    hash = pipeline_cache_hash(desc->vertex_shader, SDL_strlen(desc->vertex_shader) + 1, hash);
+    hash = pipeline_cache_hash(desc->fragment_shader, SDL_strlen(desc->fragment_shader) + 1, hash);
+    hash = pipeline_cache_hash(&desc->vertex_layout, sizeof(desc->vertex_layout), hash);
+    hash = pipeline_cache_hash(&desc->blend, sizeof(desc->blend), hash);
+    hash = pipeline_cache_hash(&desc->primitive_type, sizeof(desc->primitive_type), hash);
+    return pipeline_cache_hash(&desc->color_format, sizeof(desc->color_format), hash);
+}
+
+bool render_pipelines_init(render_pipelines_t *pipelines, SDL_GPUDevice *device, SDL_GPUTextureFormat color_format) {
+    SDL_zerop(pipelines);
+    pipelines->device = device;
+    pipeline_cache_init(&pipelines->cache, device);
+    for (uint32_t id = 0; id < RENDER_PIPELINE_COUNT; id++) {
+        render_pipeline_desc_t *desc = &pipelines->descs[id];
+        *desc = pipeline_descs[id];
+        if (desc->color_format == SDL_GPU_TEXTUREFORMAT_INVALID) {
+            desc->color_format = color_format;
+        }
+        pipelines->keys[id] = render_pipeline_desc_hash(desc);
+        pipelines->canonical[id] = (render_pipeline_id_t) id;
+        for (uint32_t other = 0; other < id; other++) {
+            if (pipelines->keys[other] == pipelines->keys[id]) {
+                pipelines->canonical[id] = (render_pipeline_id_t) other;
+                break;
+            }
+        }
+    }
+    pipelines->mutex = SDL_CreateMutex();
+    pipelines->wake = SDL_CreateCondition();
+    pipelines->done = SDL_CreateCondition();
+    if (!arena_init(&pipelines->scratch, RENDER_PIPELINES_SCRATCH_SIZE) || pipelines->mutex == NULL ||
+        pipelines->wake == NULL || pipelines->done == NULL) {
+        render_pipelines_destroy(pipelines);
+        return false;
+    }
+    pipelines->thread = SDL_CreateThread(worker_main, "pipeline builder", pipelines);
+    if (pipelines->thread == NULL) {
+        render_pipelines_destroy(pipelines);
+        return false;
+    }
+    return true;
+}
+
+void render_pipelines_destroy(render_pipelines_t *pipelines) {
+    if (pipelines->thread) {
+        SDL_LockMutex(pipelines->mutex);
+        pipelines->quit = true;
+        SDL_SignalCondition(pipelines->wake);
+        SDL_UnlockMutex(pipelines->mutex);
+        SDL_WaitThread(pipelines->thread, NULL);
+    }
+    for (uint32_t i = 0; i < pipelines->num_shaders; i++) {
+        free_shader(pipelines->device, &pipelines->shaders[i].shader);
+    }
+    pipeline_cache_destroy(&pipelines->cache);
+    arena_destroy(&pipelines->scratch);
+    SDL_DestroyCondition(pipelines->done);
+    SDL_DestroyCondition(pipelines->wake);
+    SDL_DestroyMutex(pipelines->mutex);
+    SDL_zerop(pipelines);
+}
+
+// worker side: the module loaded for `path` before, or a new one
+static shader_t *find_shader(render_pipelines_t *pipelines, const char *path, SDL_GPUShaderStage stage,
+                             render_pipelines_stats_t *stats) {
+    for (uint32_t i = 0; i < pipelines->num_shaders; i++) {
+        render_pipelines_shader_t *loaded = &pipelines->shaders[i];
+        if (SDL_strcmp(loaded->path, path) == 0 && loaded->shader.info.stage == stage) {
+            stats->shaders_shared++;
+            return &loaded->shader;
+        }
+    }
+    if (pipelines->num_shaders == ARRAY_SIZE(pipelines->shaders)) {
+        SDL_SetError("too many shaders");
+        return NULL;
+    }
+    uint64_t start = SDL_GetTicksNS();
+    arena_scope_t scope = arena_scope_begin(&pipelines->scratch);
+    shader_t *shader = load_shader(pipelines->device, &pipelines->scratch, path, stage);
+    render_pipelines_shader_t *loaded = &pipelines->shaders[pipelines->num_shaders];
+    if (shader != NULL) {
+        *loaded = (render_pipelines_shader_t) {path, *shader};
+        pipelines->num_shaders++;
+        stats->shaders_loaded++;
+    }
+    arena_scope_end(scope);
+    stats->shader_ns += SDL_GetTicksNS() - start;
+    return shader != NULL ? &loaded->shader : NULL;
+}
+
+static SDL_GPUGraphicsPipeline *build_pipeline(render_pipelines_t *pipelines, render_pipeline_id_t id,
+                                               render_pipelines_stats_t *stats) {
+    const render_pipeline_desc_t *desc = &pipelines->descs[id];
+    shader_t *vertex_shader = find_shader(pipelines, desc->vertex_shader, SDL_GPU_SHADERSTAGE_VERTEX, stats);
+    shader_t *fragment_shader = find_shader(pipelines, desc->fragment_shader, SDL_GPU_SHADERSTAGE_FRAGMENT, stats);
+    if (vertex_shader == NULL || fragment_shader == NULL) {
+        return NULL;
+    }
+
+    const vertex_layout_info_t *layout = &vertex_layouts[desc->vertex_layout];
+    SDL_GPUColorTargetDescription color_target_description = {
+            .format = desc->color_format,
+            .blend_state = blend_states[desc->blend],
+    };
+    SDL_GPUGraphicsPipelineCreateInfo pipeline_create_info = {
+            .vertex_shader = vertex_shader->shader,
+            .fragment_shader = fragment_shader->shader,
+            .primitive_type = desc->primitive_type,
+            .target_info = {
+                    .num_color_targets = 1,
+                    .color_target_descriptions = &color_target_description,
+            },
+            .rasterizer_state = {
+                    .fill_mode = SDL_GPU_FILLMODE_FILL,
+            },
+            .vertex_input_state = (SDL_GPUVertexInputState) {
+                    .num_vertex_buffers = layout->num_buffers,
+                    .vertex_buffer_descriptions = layout->buffers,
+                    .num_vertex_attributes = layout->num_attributes,
+                    .vertex_attributes = layout->attributes,
+            },
+    };
+    uint32_t hits = pipelines->cache.stats.hits;
+    uint64_t start = SDL_GetTicksNS();
+    SDL_GPUGraphicsPipeline *pipeline = pipeline_cache_get(&pipelines->cache, &pipeline_create_info,
+                                                           vertex_shader->hash, fragment_shader->hash);
+    stats->pipeline_ns += SDL_GetTicksNS() - start;
+    stats->pipelines_shared += pipelines->cache.stats.hits - hits;
+    return pipeline;
+}
+
+static int worker_main(void *data) {
+    render_pipelines_t *pipelines = data;
+    SDL_LockMutex(pipelines->mutex);
+    while (!pipelines->quit) {
+        if (pipelines->queue_count == 0) {
+            SDL_WaitCondition(pipelines->wake, pipelines->mutex);
+            continue;
+        }
+        render_pipeline_id_t id = pipelines->queue[pipelines->queue_head];
+        pipelines->queue_head = (pipelines->queue_head + 1) % RENDER_PIPELINE_COUNT;
+        pipelines->queue_count--;
+        render_pipelines_stats_t stats = pipelines->stats;
+        SDL_UnlockMutex(pipelines->mutex);
+
+        // the shader table, the cache and the scratch arena are only touched on this thread, the lock only
+        // guards the queue and the stats
+        SDL_GPUGraphicsPipeline *pipeline = build_pipeline(pipelines, id, &stats);
+        if (pipeline == NULL) {
+            SDL_Log("failed to build the %s pipeline: %s", pipelines->descs[id].name, SDL_GetError());
+        }
+
+        SDL_LockMutex(pipelines->mutex);
+        pipelines->stats.shaders_loaded = stats.shaders_loaded;
+        pipelines->stats.shaders_shared = stats.shaders_shared;
+        pipelines->stats.pipelines_shared = stats.pipelines_shared;
+        pipelines->stats.shader_ns = stats.shader_ns;
+        pipelines->stats.pipeline_ns = stats.pipeline_ns;
+        pipelines->stats.ready += pipeline != NULL;
+        pipelines->stats.failed += pipeline == NULL;
+        SDL_SetAtomicPointer(&pipelines->pipelines[id], pipeline);
+        SDL_SetAtomicInt(&pipelines->states[id],
+                         pipeline != NULL ? RENDER_PIPELINE_STATE_READY : RENDER_PIPELINE_STATE_FAILED);
+        SDL_BroadcastCondition(pipelines->done);
+    }
+    SDL_UnlockMutex(pipelines->mutex);
+    return 0;
+}
+
+void render_pipelines_request(render_pipelines_t *pipelines, render_pipeline_id_t id) {
+    id = pipelines->canonical[id];
+    if (SDL_GetAtomicInt(&pipelines->states[id]) != RENDER_PIPELINE_STATE_IDLE) {
+        return;
+    }
+    SDL_LockMutex(pipelines->mutex);
+    // every id is queued once at most, the queue can't overflow
+    if (SDL_GetAtomicInt(&pipelines->states[id]) == RENDER_PIPELINE_STATE_IDLE) {
+        SDL_SetAtomicInt(&pipelines->states[id], RENDER_PIPELINE_STATE_QUEUED);
+        pipelines->queue[(pipelines->queue_head + pipelines->queue_count) % RENDER_PIPELINE_COUNT] = id;
+        pipelines->queue_count++;
+        pipelines->stats.requested++;
+        SDL_SignalCondition(pipelines->wake);
+    }
+    SDL_UnlockMutex(pipelines->mutex);
+}
+
+SDL_GPUGraphicsPipeline *render_pipelines_get(render_pipelines_t *pipelines, render_pipeline_id_t id) {
+    id = pipelines->canonical[id];
+    if (SDL_GetAtomicInt(&pipelines->states[id]) == RENDER_PIPELINE_STATE_READY) {
+        return SDL_GetAtomicPointer(&pipelines->pipelines[id]);
+    }
+    render_pipelines_request(pipelines, id);
+    return NULL;
+}
+
+SDL_GPUGraphicsPipeline *render_pipelines_wait(render_pipelines_t *pipelines, render_pipeline_id_t id) {
+    id = pipelines->canonical[id];
+    render_pipelines_request(pipelines, id);
+    SDL_LockMutex(pipelines->mutex);
+    while (SDL_GetAtomicInt(&pipelines->states[id]) == RENDER_PIPELINE_STATE_QUEUED) {
+        SDL_WaitCondition(pipelines->done, pipelines->mutex);
+    }
+    SDL_UnlockMutex(pipelines->mutex);
+    SDL_GPUGraphicsPipeline *pipeline = SDL_GetAtomicPointer(&pipelines->pipelines[id]);
+    if (pipeline == NULL) {
+        SDL_SetError("failed to build the %s pipeline", pipelines->descs[id].name);
+    }
+    return pipeline;
+}
+
+bool render_pipelines_pending(render_pipelines_t *pipelines) {
+    for (uint32_t id = 0; id < RENDER_PIPELINE_COUNT; id++) {
+        if (SDL_GetAtomicInt(&pipelines->states[id]) == RENDER_PIPELINE_STATE_QUEUED) {
+            return true;
+        }
+    }
+    return false;
+}
+
+void render_pipelines_get_stats(render_pipelines_t *pipelines, render_pipelines_stats_t *stats) {
+    SDL_LockMutex(pipelines->mutex);
+    *stats = pipelines->stats;
+    SDL_UnlockMutex(pipelines->mutex);
+}
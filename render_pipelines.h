@@ -0,0 +1,145 @@
+#ifndef KINGDOM_DEFENSE_RENDER_PIPELINES_H
+#define KINGDOM_DEFENSE_RENDER_PIPELINES_H
+
+#include <SDL3/SDL.h>
+
+#include "memory.h"
+#include "pipeline_cache.h"
+
+#define RENDER_PIPELINES_SCRATCH_SIZE (1024 * 1024)
+
+typedef struct {
+    SDL_GPUShaderCreateInfo info;
+    SDL_GPUShader *shader;
+    // hash of the spirv code, part of the pipeline cache key
+    uint64_t hash;
+} shader_t;
+
+// compiled shaders are looked up next to the executable, the working directory has to be the build directory.
+// the shader_t and the file are allocated from `scratch`, free_shader only releases the gpu shader
+shader_t *load_shader(SDL_GPUDevice *device, arena_t *scratch, const char *path, SDL_GPUShaderStage stage);
+void free_shader(SDL_GPUDevice *device, shader_t *shader);
+// the same for a compute shader, which is a whole pipeline in SDL. built right away on the calling thread, there
+// is no state to share between them. release it with gpu_release_compute_pipeline
+SDL_GPUComputePipeline *load_compute_pipeline(SDL_GPUDevice *device, arena_t *scratch, const char *path);
+
+typedef enum {
+    // one simple_vert per vertex
+    VERTEX_LAYOUT_SIMPLE,
+    // one quad_vert per vertex
+    VERTEX_LAYOUT_QUAD,
+    // slot 0 is the unit quad, slot 1 one sprite_instance per instance
+    VERTEX_LAYOUT_SPRITE,
+    // no vertex buffers, the shader reads storage buffers by SV_VertexID and SV_InstanceID
+    VERTEX_LAYOUT_NONE,
+    VERTEX_LAYOUT_COUNT,
+} vertex_layout_t;
+
+typedef enum {
+    BLEND_MODE_OPAQUE,
+    // straight alpha
+    BLEND_MODE_ALPHA,
+    // adds color times alpha, order independent
+    BLEND_MODE_ADDITIVE,
+    BLEND_MODE_COUNT,
+} blend_mode_t;
+
+typedef enum {
+    RENDER_PIPELINE_SIMPLE_TRIANGLE,
+    RENDER_PIPELINE_QUAD,
+    RENDER_PIPELINE_SPRITE,
+    RENDER_PIPELINE_PARTICLE,
+    RENDER_PIPELINE_COUNT,
+} render_pipeline_id_t;
+
+// everything a pipeline is built from, see the table in render_pipelines.c. a color format of
+// SDL_GPU_TEXTUREFORMAT_INVALID stands for the one render_pipelines_init was given
+typedef struct {
+    const char *name;
+    const char *vertex_shader;
+    const char *fragment_shader;
+    vertex_layout_t vertex_layout;
+    blend_mode_t blend;
+    SDL_GPUPrimitiveType primitive_type;
+    SDL_GPUTextureFormat color_format;
+} render_pipeline_desc_t;
+
+typedef enum {
+    RENDER_PIPELINE_STATE_IDLE,
+    RENDER_PIPELINE_STATE_QUEUED,
+    RENDER_PIPELINE_STATE_READY,
+    RENDER_PIPELINE_STATE_FAILED,
+} render_pipeline_state_t;
+
+typedef struct {
+    uint32_t requested;
+    uint32_t ready;
+    uint32_t failed;
+    uint32_t shaders_loaded;
+    // shader modules and pipelines that were already there for another description
+    uint32_t shaders_shared;
+    uint32_t pipelines_shared;
+    // worker time spent loading shaders and inside pipeline creation
+    uint64_t shader_ns;
+    uint64_t pipeline_ns;
+} render_pipelines_stats_t;
+
+// a shader module the worker loaded, kept for every later pipeline that names the same file
+typedef struct {
+    const char *path;
+    shader_t shader;
+} render_pipelines_shader_t;
+
+// the pipelines of the description table, built on first use by a worker thread. shader modules are loaded once
+// per file and identical pipeline state is created once through the pipeline cache, so descriptions that hash
+// the same get the same pipeline handle and batches can sort and group by it
+typedef struct {
+    SDL_GPUDevice *device;
+    // the table with the color format filled in, and a hash of every description
+    render_pipeline_desc_t descs[RENDER_PIPELINE_COUNT];
+    uint64_t keys[RENDER_PIPELINE_COUNT];
+    // the first description with the same key, everything about `id` happens on canonical[id]
+    render_pipeline_id_t canonical[RENDER_PIPELINE_COUNT];
+    // written by the worker and read without the lock: the state is published after the pipeline
+    void *pipelines[RENDER_PIPELINE_COUNT];
+    SDL_AtomicInt states[RENDER_PIPELINE_COUNT];
+
+    // worker side
+    pipeline_cache_t cache;
+    arena_t scratch;
+    render_pipelines_shader_t shaders[RENDER_PIPELINE_COUNT * 2];
+    uint32_t num_shaders;
+
+    SDL_Thread *thread;
+    SDL_Mutex *mutex;
+    // the worker waits on `wake` for requests, render_pipelines_wait on `done` for the worker
+    SDL_Condition *wake;
+    SDL_Condition *done;
+    render_pipeline_id_t queue[RENDER_PIPELINE_COUNT];
+    uint32_t queue_head;
+    uint32_t queue_count;
+    bool quit;
+    render_pipelines_stats_t stats;
+} render_pipelines_t;
+
+const render_pipeline_desc_t *render_pipeline_desc(render_pipeline_id_t id);
+// hash of every field of `desc`, the shaders by their file names. it is taken before any shader is loaded, the
+// pipeline cache key covers the spirv itself
+uint64_t render_pipeline_desc_hash(const render_pipeline_desc_t *desc);
+
+// nothing is built here, `color_format` is what the descriptions without one render to
+bool render_pipelines_init(render_pipelines_t *pipelines, SDL_GPUDevice *device, SDL_GPUTextureFormat color_format);
+// waits for the worker and releases every shader and pipeline
+void render_pipelines_destroy(render_pipelines_t *pipelines);
+
+// queues `id` for the worker unless it was already, never blocks
+void render_pipelines_request(render_pipelines_t *pipelines, render_pipeline_id_t id);
+// the pipeline if it is ready. the first call queues it, draws that need it skip until then
+SDL_GPUGraphicsPipeline *render_pipelines_get(render_pipelines_t *pipelines, render_pipeline_id_t id);
+// blocks until `id` is built, for what the first frame can't do without. NULL with an error set if it failed
+SDL_GPUGraphicsPipeline *render_pipelines_wait(render_pipelines_t *pipelines, render_pipeline_id_t id);
+// true while requested pipelines are still being built
+bool render_pipelines_pending(render_pipelines_t *pipelines);
+void render_pipelines_get_stats(render_pipelines_t *pipelines, render_pipelines_stats_t *stats);
+
+#endif //KINGDOM_DEFENSE_RENDER_PIPELINES_H
@@ -5,12 +5,207 @@
 #ifndef KINGDOM_DEFENSE_SHADER_INPUTS_H
 #define KINGDOM_DEFENSE_SHADER_INPUTS_H
 
+// vertex layouts shared by the c and hlsl side, the shaders include this file too. the locations are the TEXCOORDn
+// semantics of the shader inputs, the formats what the pipelines feed them with. quad and sprite positions are in
+// world space and go through the camera uniform, simple_vert positions are in clip space
+
+#define SIMPLE_VERT_LOCATION_XY_POS 0
+#define SIMPLE_VERT_LOCATION_COLOR 1
+
+#define QUAD_VERT_LOCATION_XY_POS 0
+#define QUAD_VERT_LOCATION_UV 1
+#define QUAD_VERT_LOCATION_COLOR 2
+
+// sprite.vert.hlsl reads xy_pos and uv of the unit quad from slot 0, the rest comes per instance from slot 1
+#define SPRITE_INSTANCE_LOCATION_XY_POS 2
+#define SPRITE_INSTANCE_LOCATION_SCALE 3
+#define SPRITE_INSTANCE_LOCATION_UV_RECT 4
+#define SPRITE_INSTANCE_LOCATION_COLOR 5
+#define SPRITE_INSTANCE_LOCATION_ROTATION 6
+
+// vertex uniform slot of the camera in quad.vert.hlsl and sprite.vert.hlsl, register(b0, space1) there
+#define CAMERA_UNIFORM_SLOT 0
+
+// particles.c and the particle_*.hlsl shaders: threads per group of the compute passes and bursts per emit pass
+#define PARTICLE_GROUP_SIZE 64
+#define PARTICLE_MAX_EMITTERS 64
+// every particle buffer has an argument buffer of PARTICLE_ARGS_SIZE uints: an SDL_GPUIndirectDrawCommand whose
+// instance count is the number of particles, then an SDL_GPUIndirectDispatchCommand with a thread for each of them
+#define PARTICLE_ARGS_INSTANCES 1
+#define PARTICLE_ARGS_GROUPS 4
+#define PARTICLE_ARGS_SIZE 8
+// compute uniform slot of the emit and step parameters, register(b0, space2) there
+#define PARTICLE_UNIFORM_SLOT 0
+
+#ifdef __HLSL_VERSION
+
+// `float2 uv : VERTEX_INPUT(QUAD_VERT_LOCATION_UV);`, the extra level expands the location before pasting
+#define VERTEX_INPUT(location) VERTEX_INPUT_(location)
+#define VERTEX_INPUT_(location) TEXCOORD##location
+
+// see particle and particle_emitter
+struct Particle
+{
+    float2 pos;
+    float2 vel;
+    float age;
+    float lifetime;
+    float size;
+    uint color;
+};
+
+struct ParticleEmitter
+{
+    float2 pos;
+    float speed;
+    float lifetime;
+    float4 color;
+    float size;
+    uint first;
+    uint count;
+    uint padding;
+};
+
+#else
+
+#include <SDL3/SDL.h>
+
+#define SIMPLE_VERT_FORMAT_XY_POS SDL_GPU_VERTEXELEMENTFORMAT_SHORT2_NORM
+#define SIMPLE_VERT_FORMAT_COLOR SDL_GPU_VERTEXELEMENTFORMAT_UBYTE4_NORM
+
+typedef struct {
+    int16_t xy_pos[2];
+    uint8_t color[4];
+} simple_vert;
+
+#define QUAD_VERT_FORMAT_XY_POS SDL_GPU_VERTEXELEMENTFORMAT_SHORT2_NORM
+#define QUAD_VERT_FORMAT_UV SDL_GPU_VERTEXELEMENTFORMAT_USHORT2_NORM
+#define QUAD_VERT_FORMAT_COLOR SDL_GPU_VERTEXELEMENTFORMAT_UBYTE4_NORM
+
+typedef struct {
+    int16_t xy_pos[2];
+    uint16_t uv[2];
+    uint8_t color[4];
+} quad_vert;
+
+// the position stays a float, sprites can sit partly off screen and snorm would pin them to the edge
+#define SPRITE_INSTANCE_FORMAT_XY_POS SDL_GPU_VERTEXELEMENTFORMAT_FLOAT2
+#define SPRITE_INSTANCE_FORMAT_SCALE SDL_GPU_VERTEXELEMENTFORMAT_HALF2
+#define SPRITE_INSTANCE_FORMAT_UV_RECT SDL_GPU_VERTEXELEMENTFORMAT_USHORT4_NORM
+#define SPRITE_INSTANCE_FORMAT_COLOR SDL_GPU_VERTEXELEMENTFORMAT_UBYTE4_NORM
+#define SPRITE_INSTANCE_FORMAT_ROTATION SDL_GPU_VERTEXELEMENTFORMAT_SHORT2_NORM
+
+// per instance data of sprite.vert.hlsl, drawn on top of the quad_vert unit quad. filled from a sprite_t by
+// sprite_batch_submit
 typedef struct {
     float xy_pos[2];
-//    float padding0[2];
-    float uv[2];
-//    float padding1[2];
+    uint16_t scale[2];
+    // x, y, w, h in uv space
+    uint16_t uv_rect[4];
+    uint8_t color[4];
+    // cos and sin of the angle, saves the shader a sincos per vertex
+    int16_t rotation[2];
+} sprite_instance;
+
+// world to clip space, clip = world * scale + offset. cbuffer Camera on the hlsl side, same order
+typedef struct {
+    float scale[2];
+    float offset[2];
+} camera_uniform;
+
+// one element of the particle storage buffers, world space like the sprites. the particle is gone once age reaches
+// lifetime, color is rgba8
+typedef struct {
+    float pos[2];
+    float vel[2];
+    float age;
+    float lifetime;
+    float size;
+    uint32_t color;
+} particle;
+
+// a burst of `count` particles flying off from pos in every direction, the threads [first, first + count) of the
+// emit pass. laid out for a cbuffer array, 16 byte aligned
+typedef struct {
+    float pos[2];
+    float speed;
+    float lifetime;
     float color[4];
-} quad_vert;
+    float size;
+    uint32_t first;
+    uint32_t count;
+    uint32_t padding;
+} particle_emitter;
+
+// cbuffer Emit of particle_emit.comp.hlsl, one thread for each of the num_particles of all emitters
+typedef struct {
+    uint32_t num_emitters;
+    uint32_t num_particles;
+    uint32_t seed;
+    // index of the counter of the buffer emitted into
+    uint32_t source;
+    uint32_t capacity;
+    uint32_t padding[3];
+    particle_emitter emitters[PARTICLE_MAX_EMITTERS];
+} particle_emit_uniform;
+
+// cbuffer Step of particle_simulate.comp.hlsl and particle_compact.comp.hlsl, compaction goes from buffer
+// `source` to the other one
+typedef struct {
+    float dt;
+    // velocity factor for this step
+    float damping;
+    uint32_t source;
+    uint32_t capacity;
+} particle_step_uniform;
+
+SDL_COMPILE_TIME_ASSERT(simple_vert_size, sizeof(simple_vert) == 8);
+SDL_COMPILE_TIME_ASSERT(quad_vert_size, sizeof(quad_vert) == 12);
+SDL_COMPILE_TIME_ASSERT(sprite_instance_size, sizeof(sprite_instance) == 28);
+SDL_COMPILE_TIME_ASSERT(particle_size, sizeof(particle) == 32);
+SDL_COMPILE_TIME_ASSERT(particle_emitter_size, sizeof(particle_emitter) == 48);
+SDL_COMPILE_TIME_ASSERT(particle_emit_uniform_emitters, offsetof(particle_emit_uniform, emitters) == 32);
+
+// constant versions for initializers, the value has to be in range already
+#define SNORM16(_x) ((int16_t) ((_x) * 32767.0f + ((_x) < 0.0f ? -0.5f : 0.5f)))
+#define UNORM16(_x) ((uint16_t) ((_x) * 65535.0f + 0.5f))
+#define UNORM8(_x) ((uint8_t) ((_x) * 255.0f + 0.5f))
+
+static inline int16_t pack_snorm16(float value) {
+    return SNORM16(SDL_clamp(value, -1.0f, 1.0f));
+}
+
+static inline uint16_t pack_unorm16(float value) {
+    return UNORM16(SDL_clamp(value, 0.0f, 1.0f));
+}
+
+static inline uint8_t pack_unorm8(float value) {
+    return UNORM8(SDL_clamp(value, 0.0f, 1.0f));
+}
+
+// float to half, rounded to nearest even. too large values become infinity
+static inline uint16_t pack_half(float value) {
+    union {
+        float f;
+        uint32_t u;
+    } bits = {value};
+    uint32_t sign = (bits.u >> 16) & 0x8000;
+    uint32_t magnitude = bits.u & 0x7fffffff;
+    if (magnitude >= 0x47800000) {
+        // out of range, infinity or nan
+        return (uint16_t) (sign | (magnitude > 0x7f800000 ? 0x7e00 : 0x7c00));
+    }
+    if (magnitude < 0x38800000) {
+        // half denormal or zero, adding 0.5 shifts the mantissa into place and lets the fpu round it
+        bits.u = magnitude;
+        bits.f += 0.5f;
+        return (uint16_t) (sign | (bits.u - 0x3f000000));
+    }
+    // rebias the exponent from 127 to 15 and round the 13 dropped mantissa bits
+    magnitude += 0xc8000fff + ((magnitude >> 13) & 1);
+    return (uint16_t) (sign | (magnitude >> 13));
+}
+
+#endif
 
 #endif //KINGDOM_DEFENSE_SHADER_INPUTS_H
@@ -0,0 +1,52 @@
+#include "shader_reflection.h"
+
+// the generated header is included once per table, each time only one of the macros keeps its lines
+#define NOTHING(...)
+
+static const shader_reflection_t shader_reflections[] = {
+#define SHADER_REFLECTION(_name, _samplers, _storage_textures, _storage_buffers, _uniform_buffers) \
+        {_name, _samplers, _storage_textures, _storage_buffers, _uniform_buffers},
+#define COMPUTE_SHADER_REFLECTION NOTHING
+#include "shader_reflection.gen.h"
+#undef COMPUTE_SHADER_REFLECTION
+#undef SHADER_REFLECTION
+};
+
+static const compute_shader_reflection_t compute_shader_reflections[] = {
+#define SHADER_REFLECTION NOTHING
+#define COMPUTE_SHADER_REFLECTION(_name, _samplers, _readonly_storage_textures, _readonly_storage_buffers,       \
+                                  _readwrite_storage_textures, _readwrite_storage_buffers, _uniform_buffers, _x, _y, \
+                                  _z)                                                                                \
+        {_name, _samplers, _readonly_storage_textures, _readonly_storage_buffers, _readwrite_storage_textures,        \
+         _readwrite_storage_buffers, _uniform_buffers, _x, _y, _z},
+#include "shader_reflection.gen.h"
+#undef COMPUTE_SHADER_REFLECTION
+#undef SHADER_REFLECTION
+        // keeps the array from being empty in a build without compute shaders
+        {NULL},
+};
+
+static const char *file_name(const char *path) {
+    const char *name = SDL_strrchr(path, '/');
+    return name ? name + 1 : path;
+}
+
+const shader_reflection_t *shader_reflection_find(const char *path) {
+    const char *name = file_name(path);
+    for (size_t i = 0; i < SDL_arraysize(shader_reflections); i++) {
+        if (SDL_strcmp(shader_reflections[i].name, name) == 0) {
+            return &shader_reflections[i];
+        }
+    }
+    return NULL;
+}
+
+const compute_shader_reflection_t *compute_shader_reflection_find(const char *path) {
+    const char *name = file_name(path);
+    for (size_t i = 0; compute_shader_reflections[i].name != NULL; i++) {
+        if (SDL_strcmp(compute_shader_reflections[i].name, name) == 0) {
+            return &compute_shader_reflections[i];
+        }
+    }
+    return NULL;
+}
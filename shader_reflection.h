@@ -0,0 +1,35 @@
+#ifndef KINGDOM_DEFENSE_SHADER_REFLECTION_H
+#define KINGDOM_DEFENSE_SHADER_REFLECTION_H
+
+#include <SDL3/SDL.h>
+
+// resource counts SDL_CreateGPUShader needs, extracted from the shaders at build time
+typedef struct {
+    const char *name;
+    uint32_t num_samplers;
+    uint32_t num_storage_textures;
+    uint32_t num_storage_buffers;
+    uint32_t num_uniform_buffers;
+} shader_reflection_t;
+
+// looks up a compiled shader by file name (e.g. "quad.frag.hlsl.spirv"), leading directories are ignored.
+// returns NULL for shaders that were not part of the build
+const shader_reflection_t *shader_reflection_find(const char *path);
+
+// the same for compute shaders, SDL takes these with the pipeline
+typedef struct {
+    const char *name;
+    uint32_t num_samplers;
+    uint32_t num_readonly_storage_textures;
+    uint32_t num_readonly_storage_buffers;
+    uint32_t num_readwrite_storage_textures;
+    uint32_t num_readwrite_storage_buffers;
+    uint32_t num_uniform_buffers;
+    uint32_t threadcount_x;
+    uint32_t threadcount_y;
+    uint32_t threadcount_z;
+} compute_shader_reflection_t;
+
+const compute_shader_reflection_t *compute_shader_reflection_find(const char *path);
+
+#endif //KINGDOM_DEFENSE_SHADER_REFLECTION_H
@@ -0,0 +1,37 @@
+#include "shader_inputs.h"
+
+// world to clip space, see camera_uniform
+cbuffer Camera : register(b0, space1)
+{
+    float2 camera_scale;
+    float2 camera_offset;
+};
+
+StructuredBuffer<Particle> Particles : register(t0, space0);
+
+struct Output
+{
+    float4 Position : SV_Position;
+    float4 Color : TEXCOORD0;
+};
+
+// no vertex buffer, an instance per particle and two triangles per instance
+static const float2 corners[6] = {
+    float2(-0.5f, 0.5f), float2(0.5f, -0.5f), float2(0.5f, 0.5f),
+    float2(-0.5f, 0.5f), float2(-0.5f, -0.5f), float2(0.5f, -0.5f),
+};
+
+Output main(uint vertex_id : SV_VertexID, uint instance_id : SV_InstanceID)
+{
+    Particle particle = Particles[instance_id];
+    // fades out and shrinks to half over its lifetime
+    float fade = 1.0f - saturate(particle.age / particle.lifetime);
+    uint c = particle.color;
+    float4 color = float4(c & 0xFF, (c >> 8) & 0xFF, (c >> 16) & 0xFF, c >> 24) / 255.0f;
+    float2 pos = particle.pos + corners[vertex_id] * particle.size * (0.5f + 0.5f * fade);
+
+    Output output;
+    output.Color = float4(color.rgb, color.a * fade);
+    output.Position = float4(pos * camera_scale + camera_offset, 0.0f, 1.0f);
+    return output;
+}
@@ -0,0 +1,37 @@
+#include "shader_inputs.h"
+
+// see particle_step_uniform
+cbuffer Step : register(b0, space2)
+{
+    float dt;
+    float damping;
+    uint source;
+    uint capacity;
+};
+
+StructuredBuffer<Particle> Source : register(t0, space0);
+RWStructuredBuffer<Particle> Destination : register(u0, space1);
+RWStructuredBuffer<uint> Counters : register(u1, space1);
+// the arguments of Destination, reset to no particles before this pass
+RWStructuredBuffer<uint> Args : register(u2, space1);
+
+[numthreads(PARTICLE_GROUP_SIZE, 1, 1)]
+void main(uint3 id : SV_DispatchThreadID)
+{
+    uint index = id.x;
+    if (index >= min(Counters[source], capacity))
+    {
+        return;
+    }
+    Particle particle = Source[index];
+    if (particle.age >= particle.lifetime)
+    {
+        return;
+    }
+    // survivors keep no particular order, the draw doesn't care
+    uint slot;
+    InterlockedAdd(Counters[1 - source], 1, slot);
+    Destination[slot] = particle;
+    InterlockedMax(Args[PARTICLE_ARGS_INSTANCES], slot + 1);
+    InterlockedMax(Args[PARTICLE_ARGS_GROUPS], slot / PARTICLE_GROUP_SIZE + 1);
+}
@@ -0,0 +1,78 @@
+#include "shader_inputs.h"
+
+// see particle_emit_uniform, emitters[e] owns the threads [first, first + count)
+cbuffer Emit : register(b0, space2)
+{
+    uint num_emitters;
+    uint num_particles;
+    uint seed;
+    uint source;
+    uint capacity;
+    uint padding0;
+    uint padding1;
+    uint padding2;
+    ParticleEmitter emitters[PARTICLE_MAX_EMITTERS];
+};
+
+RWStructuredBuffer<Particle> Particles : register(u0, space1);
+RWStructuredBuffer<uint> Counters : register(u1, space1);
+RWStructuredBuffer<uint> Args : register(u2, space1);
+
+uint hash(uint x)
+{
+    // pcg
+    uint state = x * 747796405u + 2891336453u;
+    uint word = ((state >> ((state >> 28u) + 4u)) ^ state) * 277803737u;
+    return (word >> 22u) ^ word;
+}
+
+float random01(inout uint state)
+{
+    state = hash(state);
+    return float(state >> 8) / 16777216.0f;
+}
+
+uint pack_color(float4 color)
+{
+    uint4 c = uint4(saturate(color) * 255.0f + 0.5f);
+    return c.r | (c.g << 8) | (c.b << 16) | (c.a << 24);
+}
+
+[numthreads(PARTICLE_GROUP_SIZE, 1, 1)]
+void main(uint3 id : SV_DispatchThreadID)
+{
+    uint index = id.x;
+    if (index >= num_particles)
+    {
+        return;
+    }
+    uint e = 0;
+    while (e + 1 < num_emitters && index >= emitters[e + 1].first)
+    {
+        e++;
+    }
+    ParticleEmitter emitter = emitters[e];
+
+    // appended behind what is alive, a full buffer cuts the burst short
+    uint slot;
+    InterlockedAdd(Counters[source], 1, slot);
+    if (slot >= capacity)
+    {
+        return;
+    }
+
+    // the lifetime stays exact, only direction, speed and size vary
+    uint state = hash(index ^ hash(seed));
+    float angle = random01(state) * 6.28318531f;
+    float speed = emitter.speed * (0.25f + 0.75f * random01(state));
+    Particle particle;
+    particle.pos = emitter.pos;
+    particle.vel = float2(cos(angle), sin(angle)) * speed;
+    particle.age = 0.0f;
+    particle.lifetime = emitter.lifetime;
+    particle.size = emitter.size * (0.5f + 0.5f * random01(state));
+    particle.color = pack_color(emitter.color);
+    Particles[slot] = particle;
+    InterlockedMax(Args[PARTICLE_ARGS_INSTANCES], slot + 1);
+    InterlockedMax(Args[PARTICLE_ARGS_GROUPS], slot / PARTICLE_GROUP_SIZE + 1);
+}
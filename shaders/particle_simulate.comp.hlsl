@@ -0,0 +1,29 @@
+#include "shader_inputs.h"
+
+// see particle_step_uniform
+cbuffer Step : register(b0, space2)
+{
+    float dt;
+    float damping;
+    uint source;
+    uint capacity;
+};
+
+StructuredBuffer<uint> Counters : register(t0, space0);
+RWStructuredBuffer<Particle> Particles : register(u0, space1);
+
+[numthreads(PARTICLE_GROUP_SIZE, 1, 1)]
+void main(uint3 id : SV_DispatchThreadID)
+{
+    // the counter ran past the capacity if an emitter didn't fit
+    uint index = id.x;
+    if (index >= min(Counters[source], capacity))
+    {
+        return;
+    }
+    Particle particle = Particles[index];
+    particle.age += dt;
+    particle.vel *= damping;
+    particle.pos += particle.vel * dt;
+    Particles[index] = particle;
+}
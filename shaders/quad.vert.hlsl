@@ -1,8 +1,17 @@
+#include "shader_inputs.h"
+
+// world to clip space, see camera_uniform
+cbuffer Camera : register(b0, space1)
+{
+    float2 camera_scale;
+    float2 camera_offset;
+};
+
 struct Input
 {
-    float2 xy_pos : TEXCOORD0;
-    float2 uv : TEXCOORD1;
-    float4 color : TEXCOORD2;
+    float2 xy_pos : VERTEX_INPUT(QUAD_VERT_LOCATION_XY_POS);
+    float2 uv : VERTEX_INPUT(QUAD_VERT_LOCATION_UV);
+    float4 color : VERTEX_INPUT(QUAD_VERT_LOCATION_COLOR);
 };
 
 struct Output
@@ -17,6 +26,6 @@ Output main(Input input)
     Output output;
     output.Color = input.color;
     output.UV = input.uv;
-    output.Position = float4(input.xy_pos, 0.0f, 1.0f);
+    output.Position = float4(input.xy_pos * camera_scale + camera_offset, 0.0f, 1.0f);
     return output;
 }
@@ -1,7 +1,9 @@
+#include "shader_inputs.h"
+
 struct Input
 {
-    float2 vertex_pos : TEXCOORD0;
-    float4 color : TEXCOORD1;
+    float2 vertex_pos : VERTEX_INPUT(SIMPLE_VERT_LOCATION_XY_POS);
+    float4 color : VERTEX_INPUT(SIMPLE_VERT_LOCATION_COLOR);
 };
 
 struct Output
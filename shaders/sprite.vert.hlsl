@@ -0,0 +1,43 @@
+#include "shader_inputs.h"
+
+// world to clip space, see camera_uniform
+cbuffer Camera : register(b0, space1)
+{
+    float2 camera_scale;
+    float2 camera_offset;
+};
+
+struct Input
+{
+    // unit quad, shared by every instance
+    float2 xy_pos : VERTEX_INPUT(QUAD_VERT_LOCATION_XY_POS);
+    float2 uv : VERTEX_INPUT(QUAD_VERT_LOCATION_UV);
+    // per instance
+    float2 instance_pos : VERTEX_INPUT(SPRITE_INSTANCE_LOCATION_XY_POS);
+    float2 instance_scale : VERTEX_INPUT(SPRITE_INSTANCE_LOCATION_SCALE);
+    float4 instance_uv_rect : VERTEX_INPUT(SPRITE_INSTANCE_LOCATION_UV_RECT);
+    float4 instance_color : VERTEX_INPUT(SPRITE_INSTANCE_LOCATION_COLOR);
+    // cos and sin of the angle
+    float2 instance_rotation : VERTEX_INPUT(SPRITE_INSTANCE_LOCATION_ROTATION);
+};
+
+struct Output
+{
+    float4 Position : SV_Position;
+    float4 Color : TEXCOORD0;
+    float2 UV : TEXCOORD1;
+};
+
+Output main(Input input)
+{
+    float c = input.instance_rotation.x;
+    float s = input.instance_rotation.y;
+    float2 scaled = input.xy_pos * input.instance_scale;
+    float2 rotated = float2(scaled.x * c - scaled.y * s, scaled.x * s + scaled.y * c);
+
+    Output output;
+    output.Color = input.instance_color;
+    output.UV = input.instance_uv_rect.xy + input.uv * input.instance_uv_rect.zw;
+    output.Position = float4((input.instance_pos + rotated) * camera_scale + camera_offset, 0.0f, 1.0f);
+    return output;
+}
@@ -0,0 +1,422 @@
+#include "sim_kernels.h"
+
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || defined(_M_IX86)
+#define SIM_KERNELS_X86 1
+#include <immintrin.h>
+#if defined(__GNUC__) || defined(__clang__)
+#define TARGET_ISA(_isa) __attribute__((target(_isa)))
+#else
+#define TARGET_ISA(_isa)
+#endif
+#endif
+
+typedef void (*integrate_fun_t)(entity_store_t *store, uint32_t begin, uint32_t end, float dt);
+typedef void (*steer_fun_t)(entity_store_t *store, const flow_field_t *field, uint32_t begin, uint32_t end,
+                            float speed, float dt);
+typedef void (*expire_fun_t)(const entity_store_t *store, const flow_field_t *field, uint32_t begin, uint32_t end,
+                             float bound, uint8_t *expired);
+
+// tile under world coordinate `p` on an axis of `tiles` tiles. negative values wrap to huge ones and fall off the
+// grid like everything else out of range
+static inline uint32_t to_tile(float p, float tiles) {
+    return (uint32_t) (int32_t) SDL_floorf((p + 1.0f) * 0.5f * tiles);
+}
+
+static void integrate_scalar(entity_store_t *store, uint32_t begin, uint32_t end, float dt) {
+    float *restrict pos_x = store->pos_x;
+    float *restrict pos_y = store->pos_y;
+    float *restrict prev_x = store->prev_x;
+    float *restrict prev_y = store->prev_y;
+    const float *restrict vel_x = store->vel_x;
+    const float *restrict vel_y = store->vel_y;
+    for (uint32_t i = begin; i < end; i++) {
+        prev_x[i] = pos_x[i];
+        pos_x[i] += vel_x[i] * dt;
+    }
+    for (uint32_t i = begin; i < end; i++) {
+        prev_y[i] = pos_y[i];
+        pos_y[i] += vel_y[i] * dt;
+    }
+}
+
+static void steer_scalar(entity_store_t *store, const flow_field_t *field, uint32_t begin, uint32_t end,
+                         float speed, float dt) {
+    float tiles_x = (float) field->width;
+    float tiles_y = (float) field->height;
+    float progress = speed * dt;
+    for (uint32_t i = begin; i < end; i++) {
+        if (store->kind[i] != ENTITY_KIND_ENEMY) {
+            continue;
+        }
+        float dx;
+        float dy;
+        if (flow_field_sample(field, to_tile(store->pos_x[i], tiles_x), to_tile(store->pos_y[i], tiles_y), &dx,
+                              &dy)) {
+            store->vel_x[i] = dx * speed;
+            store->vel_y[i] = dy * speed;
+        }
+        store->path_progress[i] += progress;
+    }
+}
+
+static void expire_scalar(const entity_store_t *store, const flow_field_t *field, uint32_t begin, uint32_t end,
+                          float bound, uint8_t *expired) {
+    float tiles_x = (float) field->width;
+    float tiles_y = (float) field->height;
+    for (uint32_t i = begin; i < end; i++) {
+        bool lost = SDL_fabsf(store->pos_x[i]) > bound || SDL_fabsf(store->pos_y[i]) > bound;
+        bool arrived = false;
+        if (store->kind[i] == ENTITY_KIND_ENEMY) {
+            uint32_t tile_x = to_tile(store->pos_x[i], tiles_x);
+            uint32_t tile_y = to_tile(store->pos_y[i], tiles_y);
+            arrived = tile_x < field->width && tile_y < field->height &&
+                      flow_field_cell(field, tile_x, tile_y) == field->goal;
+        }
+        expired[i] = store->kind[i] != ENTITY_KIND_TOWER && (arrived || lost || store->health[i] <= 0.0f);
+    }
+}
+
+#ifdef SIM_KERNELS_X86
+
+TARGET_ISA("sse4.1")
+static inline __m128i load_kinds_sse41(const uint8_t *kind) {
+    int32_t bytes;
+    SDL_memcpy(&bytes, kind, sizeof(bytes));
+    return _mm_cvtepu8_epi32(_mm_cvtsi32_si128(bytes));
+}
+
+// to_tile for 4 lanes, out of range values convert to INT32_MIN just like the scalar cast does on x86
+TARGET_ISA("sse4.1")
+static inline __m128i to_tile_sse41(__m128 p, __m128 tiles) {
+    __m128 scaled = _mm_mul_ps(_mm_mul_ps(_mm_add_ps(p, _mm_set1_ps(1.0f)), _mm_set1_ps(0.5f)), tiles);
+    return _mm_cvttps_epi32(_mm_floor_ps(scaled));
+}
+
+// all ones where tile <= last as unsigned, which sse has no compare for
+TARGET_ISA("sse4.1")
+static inline __m128i tile_on_grid_sse41(__m128i tile, __m128i last) {
+    return _mm_cmpeq_epi32(_mm_min_epu32(tile, last), tile);
+}
+
+TARGET_ISA("sse4.1")
+static inline __m128i tile_cell_sse41(__m128i tile_x, __m128i tile_y, __m128i stride) {
+    __m128i one = _mm_set1_epi32(1);
+    return _mm_add_epi32(_mm_mullo_epi32(_mm_add_epi32(tile_y, one), stride), _mm_add_epi32(tile_x, one));
+}
+
+TARGET_ISA("sse4.1")
+static void integrate_sse41(entity_store_t *store, uint32_t begin, uint32_t end, float dt) {
+    __m128 step = _mm_set1_ps(dt);
+    uint32_t i = begin;
+    for (; i + 4 <= end; i += 4) {
+        __m128 x = _mm_loadu_ps(store->pos_x + i);
+        __m128 y = _mm_loadu_ps(store->pos_y + i);
+        _mm_storeu_ps(store->prev_x + i, x);
+        _mm_storeu_ps(store->prev_y + i, y);
+        _mm_storeu_ps(store->pos_x + i, _mm_add_ps(x, _mm_mul_ps(_mm_loadu_ps(store->vel_x + i), step)));
+        _mm_storeu_ps(store->pos_y + i, _mm_add_ps(y, _mm_mul_ps(_mm_loadu_ps(store->vel_y + i), step)));
+    }
+    integrate_scalar(store, i, end, dt);
+}
+
+TARGET_ISA("sse4.1")
+static void steer_sse41(entity_store_t *store, const flow_field_t *field, uint32_t begin, uint32_t end, float speed,
+                        float dt) {
+    __m128 tiles_x = _mm_set1_ps((float) field->width);
+    __m128 tiles_y = _mm_set1_ps((float) field->height);
+    __m128i last_x = _mm_set1_epi32((int32_t) field->width - 1);
+    __m128i last_y = _mm_set1_epi32((int32_t) field->height - 1);
+    __m128i stride = _mm_set1_epi32((int32_t) field->stride);
+    __m128i enemy_kind = _mm_set1_epi32(ENTITY_KIND_ENEMY);
+    __m128 speed4 = _mm_set1_ps(speed);
+    __m128 progress = _mm_set1_ps(speed * dt);
+    uint32_t i = begin;
+    for (; i + 4 <= end; i += 4) {
+        __m128i enemy = _mm_cmpeq_epi32(load_kinds_sse41(store->kind + i), enemy_kind);
+        if (_mm_testz_si128(enemy, enemy)) {
+            continue;
+        }
+        __m128i tile_x = to_tile_sse41(_mm_loadu_ps(store->pos_x + i), tiles_x);
+        __m128i tile_y = to_tile_sse41(_mm_loadu_ps(store->pos_y + i), tiles_y);
+        __m128i on_grid = _mm_and_si128(enemy, _mm_and_si128(tile_on_grid_sse41(tile_x, last_x),
+                                                              tile_on_grid_sse41(tile_y, last_y)));
+        uint32_t cells[4];
+        _mm_storeu_si128((__m128i *) cells, tile_cell_sse41(tile_x, tile_y, stride));
+        int lanes = _mm_movemask_ps(_mm_castsi128_ps(on_grid));
+
+        // there is no gather before avx2, the direction and its vector are looked up lane by lane
+        float dx[4] = {0};
+        float dy[4] = {0};
+        int32_t steer[4] = {0};
+        for (int lane = 0; lane < 4; lane++) {
+            uint8_t direction = lanes >> lane & 1 ? field->direction[cells[lane]] : FLOW_FIELD_NO_DIRECTION;
+            if (direction != FLOW_FIELD_NO_DIRECTION) {
+                dx[lane] = flow_field_direction_x[direction];
+                dy[lane] = flow_field_direction_y[direction];
+                steer[lane] = -1;
+            }
+        }
+        __m128 steer_mask = _mm_castsi128_ps(_mm_loadu_si128((const __m128i *) steer));
+        __m128 vel_x = _mm_blendv_ps(_mm_loadu_ps(store->vel_x + i), _mm_mul_ps(_mm_loadu_ps(dx), speed4), steer_mask);
+        __m128 vel_y = _mm_blendv_ps(_mm_loadu_ps(store->vel_y + i), _mm_mul_ps(_mm_loadu_ps(dy), speed4), steer_mask);
+        _mm_storeu_ps(store->vel_x + i, vel_x);
+        _mm_storeu_ps(store->vel_y + i, vel_y);
+        __m128 path = _mm_loadu_ps(store->path_progress + i);
+        _mm_storeu_ps(store->path_progress + i,
+                      _mm_blendv_ps(path, _mm_add_ps(path, progress), _mm_castsi128_ps(enemy)));
+    }
+    steer_scalar(store, field, i, end, speed, dt);
+}
+
+TARGET_ISA("sse4.1")
+static void expire_sse41(const entity_store_t *store, const flow_field_t *field, uint32_t begin, uint32_t end,
+                         float bound, uint8_t *expired) {
+    __m128 tiles_x = _mm_set1_ps((float) field->width);
+    __m128 tiles_y = _mm_set1_ps((float) field->height);
+    __m128i last_x = _mm_set1_epi32((int32_t) field->width - 1);
+    __m128i last_y = _mm_set1_epi32((int32_t) field->height - 1);
+    __m128i stride = _mm_set1_epi32((int32_t) field->stride);
+    __m128i goal = _mm_set1_epi32((int32_t) field->goal);
+    __m128i enemy_kind = _mm_set1_epi32(ENTITY_KIND_ENEMY);
+    __m128i tower_kind = _mm_set1_epi32(ENTITY_KIND_TOWER);
+    __m128 abs_mask = _mm_castsi128_ps(_mm_set1_epi32(INT32_MAX));
+    __m128 bound4 = _mm_set1_ps(bound);
+    uint32_t i = begin;
+    for (; i + 4 <= end; i += 4) {
+        __m128i kind = load_kinds_sse41(store->kind + i);
+        __m128 x = _mm_loadu_ps(store->pos_x + i);
+        __m128 y = _mm_loadu_ps(store->pos_y + i);
+        __m128 lost = _mm_or_ps(_mm_cmpgt_ps(_mm_and_ps(x, abs_mask), bound4),
+                                _mm_cmpgt_ps(_mm_and_ps(y, abs_mask), bound4));
+        __m128 dead = _mm_cmple_ps(_mm_loadu_ps(store->health + i), _mm_setzero_ps());
+        __m128i tile_x = to_tile_sse41(x, tiles_x);
+        __m128i tile_y = to_tile_sse41(y, tiles_y);
+        __m128i arrived = _mm_and_si128(
+                _mm_and_si128(_mm_cmpeq_epi32(kind, enemy_kind),
+                              _mm_cmpeq_epi32(tile_cell_sse41(tile_x, tile_y, stride), goal)),
+                _mm_and_si128(tile_on_grid_sse41(tile_x, last_x), tile_on_grid_sse41(tile_y, last_y)));
+        __m128i flags = _mm_andnot_si128(_mm_cmpeq_epi32(kind, tower_kind),
+                                         _mm_or_si128(arrived, _mm_castps_si128(_mm_or_ps(lost, dead))));
+        // all ones lanes down to a 1 byte each
+        __m128i words = _mm_packs_epi32(flags, flags);
+        int32_t bytes = _mm_cvtsi128_si32(_mm_and_si128(_mm_packs_epi16(words, words), _mm_set1_epi8(1)));
+        SDL_memcpy(expired + i, &bytes, sizeof(bytes));
+    }
+    expire_scalar(store, field, i, end, bound, expired);
+}
+
+TARGET_ISA("avx2")
+static inline __m256i load_kinds_avx2(const uint8_t *kind) {
+    return _mm256_cvtepu8_epi32(_mm_loadl_epi64((const __m128i *) kind));
+}
+
+TARGET_ISA("avx2")
+static inline __m256i to_tile_avx2(__m256 p, __m256 tiles) {
+    __m256 scaled = _mm256_mul_ps(_mm256_mul_ps(_mm256_add_ps(p, _mm256_set1_ps(1.0f)), _mm256_set1_ps(0.5f)), tiles);
+    return _mm256_cvttps_epi32(_mm256_floor_ps(scaled));
+}
+
+TARGET_ISA("avx2")
+static inline __m256i tile_on_grid_avx2(__m256i tile, __m256i last) {
+    return _mm256_cmpeq_epi32(_mm256_min_epu32(tile, last), tile);
+}
+
+TARGET_ISA("avx2")
+static inline __m256i tile_cell_avx2(__m256i tile_x, __m256i tile_y, __m256i stride) {
+    __m256i one = _mm256_set1_epi32(1);
+    return _mm256_add_epi32(_mm256_mullo_epi32(_mm256_add_epi32(tile_y, one), stride), _mm256_add_epi32(tile_x, one));
+}
+
+TARGET_ISA("avx2")
+static void integrate_avx2(entity_store_t *store, uint32_t begin, uint32_t end, float dt) {
+    __m256 step = _mm256_set1_ps(dt);
+    uint32_t i = begin;
+    for (; i + 8 <= end; i += 8) {
+        __m256 x = _mm256_loadu_ps(store->pos_x + i);
+        __m256 y = _mm256_loadu_ps(store->pos_y + i);
+        _mm256_storeu_ps(store->prev_x + i, x);
+        _mm256_storeu_ps(store->prev_y + i, y);
+        _mm256_storeu_ps(store->pos_x + i, _mm256_add_ps(x, _mm256_mul_ps(_mm256_loadu_ps(store->vel_x + i), step)));
+        _mm256_storeu_ps(store->pos_y + i, _mm256_add_ps(y, _mm256_mul_ps(_mm256_loadu_ps(store->vel_y + i), step)));
+    }
+    integrate_scalar(store, i, end, dt);
+}
+
+TARGET_ISA("avx2")
+static void steer_avx2(entity_store_t *store, const flow_field_t *field, uint32_t begin, uint32_t end, float speed,
+                       float dt) {
+    __m256 tiles_x = _mm256_set1_ps((float) field->width);
+    __m256 tiles_y = _mm256_set1_ps((float) field->height);
+    __m256i last_x = _mm256_set1_epi32((int32_t) field->width - 1);
+    __m256i last_y = _mm256_set1_epi32((int32_t) field->height - 1);
+    __m256i stride = _mm256_set1_epi32((int32_t) field->stride);
+    __m256i enemy_kind = _mm256_set1_epi32(ENTITY_KIND_ENEMY);
+    __m256i no_direction = _mm256_set1_epi32(FLOW_FIELD_NO_DIRECTION);
+    __m256 direction_x = _mm256_loadu_ps(flow_field_direction_x);
+    __m256 direction_y = _mm256_loadu_ps(flow_field_direction_y);
+    __m256 speed8 = _mm256_set1_ps(speed);
+    __m256 progress = _mm256_set1_ps(speed * dt);
+    uint32_t i = begin;
+    for (; i + 8 <= end; i += 8) {
+        __m256i enemy = _mm256_cmpeq_epi32(load_kinds_avx2(store->kind + i), enemy_kind);
+        if (_mm256_testz_si256(enemy, enemy)) {
+            continue;
+        }
+        __m256i tile_x = to_tile_avx2(_mm256_loadu_ps(store->pos_x + i), tiles_x);
+        __m256i tile_y = to_tile_avx2(_mm256_loadu_ps(store->pos_y + i), tiles_y);
+        __m256i on_grid = _mm256_and_si256(enemy, _mm256_and_si256(tile_on_grid_avx2(tile_x, last_x),
+                                                                    tile_on_grid_avx2(tile_y, last_y)));
+        // 4 bytes per lane starting at the cell, the blocked border after the last row keeps that inside the
+        // array. lanes off the grid aren't loaded and keep FLOW_FIELD_NO_DIRECTION
+        __m256i direction = _mm256_mask_i32gather_epi32(no_direction, (const int *) field->direction,
+                                                        tile_cell_avx2(tile_x, tile_y, stride), on_grid, 1);
+        direction = _mm256_and_si256(direction, no_direction);
+        __m256 steer = _mm256_castsi256_ps(_mm256_andnot_si256(_mm256_cmpeq_epi32(direction, no_direction), on_grid));
+        __m256 dx = _mm256_permutevar8x32_ps(direction_x, direction);
+        __m256 dy = _mm256_permutevar8x32_ps(direction_y, direction);
+        _mm256_storeu_ps(store->vel_x + i,
+                         _mm256_blendv_ps(_mm256_loadu_ps(store->vel_x + i), _mm256_mul_ps(dx, speed8), steer));
+        _mm256_storeu_ps(store->vel_y + i,
+                         _mm256_blendv_ps(_mm256_loadu_ps(store->vel_y + i), _mm256_mul_ps(dy, speed8), steer));
+        __m256 path = _mm256_loadu_ps(store->path_progress + i);
+        _mm256_storeu_ps(store->path_progress + i,
+                         _mm256_blendv_ps(path, _mm256_add_ps(path, progress), _mm256_castsi256_ps(enemy)));
+    }
+    steer_scalar(store, field, i, end, speed, dt);
+}
+
+TARGET_ISA("avx2")
+static void expire_avx2(const entity_store_t *store, const flow_field_t *field, uint32_t begin, uint32_t end,
+                        float bound, uint8_t *expired) {
+    __m256 tiles_x = _mm256_set1_ps((float) field->width);
+    __m256 tiles_y = _mm256_set1_ps((float) field->height);
+    __m256i last_x = _mm256_set1_epi32((int32_t) field->width - 1);
+    __m256i last_y = _mm256_set1_epi32((int32_t) field->height - 1);
+    __m256i stride = _mm256_set1_epi32((int32_t) field->stride);
+    __m256i goal = _mm256_set1_epi32((int32_t) field->goal);
+    __m256i enemy_kind = _mm256_set1_epi32(ENTITY_KIND_ENEMY);
+    __m256i tower_kind = _mm256_set1_epi32(ENTITY_KIND_TOWER);
+    __m256 abs_mask = _mm256_castsi256_ps(_mm256_set1_epi32(INT32_MAX));
+    __m256 bound8 = _mm256_set1_ps(bound);
+    uint32_t i = begin;
+    for (; i + 8 <= end; i += 8) {
+        __m256i kind = load_kinds_avx2(store->kind + i);
+        __m256 x = _mm256_loadu_ps(store->pos_x + i);
+        __m256 y = _mm256_loadu_ps(store->pos_y + i);
+        __m256 lost = _mm256_or_ps(_mm256_cmp_ps(_mm256_and_ps(x, abs_mask), bound8, _CMP_GT_OQ),
+                                   _mm256_cmp_ps(_mm256_and_ps(y, abs_mask), bound8, _CMP_GT_OQ));
+        __m256 dead = _mm256_cmp_ps(_mm256_loadu_ps(store->health + i), _mm256_setzero_ps(), _CMP_LE_OQ);
+        __m256i tile_x = to_tile_avx2(x, tiles_x);
+        __m256i tile_y = to_tile_avx2(y, tiles_y);
+        __m256i arrived = _mm256_and_si256(
+                _mm256_and_si256(_mm256_cmpeq_epi32(kind, enemy_kind),
+                                 _mm256_cmpeq_epi32(tile_cell_avx2(tile_x, tile_y, stride), goal)),
+                _mm256_and_si256(tile_on_grid_avx2(tile_x, last_x), tile_on_grid_avx2(tile_y, last_y)));
+        __m256i flags = _mm256_andnot_si256(_mm256_cmpeq_epi32(kind, tower_kind),
+                                            _mm256_or_si256(arrived, _mm256_castps_si256(_mm256_or_ps(lost, dead))));
+        __m128i words = _mm_packs_epi32(_mm256_castsi256_si128(flags), _mm256_extracti128_si256(flags, 1));
+        _mm_storel_epi64((__m128i *) (expired + i), _mm_and_si128(_mm_packs_epi16(words, words), _mm_set1_epi8(1)));
+    }
+    expire_scalar(store, field, i, end, bound, expired);
+}
+
+#endif
+
+static sim_kernels_isa_t active_isa = SIM_KERNELS_ISA_SCALAR;
+static integrate_fun_t integrate_impl = integrate_scalar;
+static steer_fun_t steer_impl = steer_scalar;
+static expire_fun_t expire_impl = expire_scalar;
+static SDL_InitState init_state;
+
+static bool isa_supported(sim_kernels_isa_t isa) {
+    switch (isa) {
+        case SIM_KERNELS_ISA_SCALAR:
+            return true;
+#ifdef SIM_KERNELS_X86
+        case SIM_KERNELS_ISA_SSE41:
+            return SDL_HasSSE41();
+        case SIM_KERNELS_ISA_AVX2:
+            return SDL_HasAVX2();
+#endif
+        default:
+            return false;
+    }
+}
+
+bool sim_kernels_set_isa(sim_kernels_isa_t isa) {
+    if (!isa_supported(isa)) {
+        return false;
+    }
+    switch (isa) {
+#ifdef SIM_KERNELS_X86
+        case SIM_KERNELS_ISA_SSE41:
+            integrate_impl = integrate_sse41;
+            steer_impl = steer_sse41;
+            expire_impl = expire_sse41;
+            break;
+        case SIM_KERNELS_ISA_AVX2:
+            integrate_impl = integrate_avx2;
+            steer_impl = steer_avx2;
+            expire_impl = expire_avx2;
+            break;
+#endif
+        default:
+            integrate_impl = integrate_scalar;
+            steer_impl = steer_scalar;
+            expire_impl = expire_scalar;
+            break;
+    }
+    active_isa = isa;
+    return true;
+}
+
+sim_kernels_isa_t sim_kernels_get_isa(void) {
+    return active_isa;
+}
+
+const char *sim_kernels_isa_name(sim_kernels_isa_t isa) {
+    switch (isa) {
+        case SIM_KERNELS_ISA_SCALAR:
+            return "scalar";
+        case SIM_KERNELS_ISA_SSE41:
+            return "sse41";
+        case SIM_KERNELS_ISA_AVX2:
+            return "avx2";
+        default:
+            return "unknown";
+    }
+}
+
+void sim_kernels_init(void) {
+    if (!SDL_ShouldInit(&init_state)) {
+        return;
+    }
+    bool forced = false;
+#ifdef SIM_KERNELS_FORCE_ISA
+    forced = sim_kernels_set_isa(SIM_KERNELS_FORCE_ISA);
+    if (!forced) {
+        SDL_Log("sim kernels: the build forces %s but the cpu can't run it",
+                sim_kernels_isa_name(SIM_KERNELS_FORCE_ISA));
+    }
+#endif
+    for (int isa = SIM_KERNELS_ISA_COUNT - 1; !forced && isa >= 0; isa--) {
+        if (sim_kernels_set_isa((sim_kernels_isa_t) isa)) {
+            break;
+        }
+    }
+    SDL_SetInitialized(&init_state, true);
+}
+
+void sim_kernels_integrate(entity_store_t *store, uint32_t begin, uint32_t end, float dt) {
+    integrate_impl(store, begin, end, dt);
+}
+
+void sim_kernels_steer(entity_store_t *store, const flow_field_t *field, uint32_t begin, uint32_t end, float speed,
+                       float dt) {
+    steer_impl(store, field, begin, end, speed, dt);
+}
+
+void sim_kernels_expire(const entity_store_t *store, const flow_field_t *field, uint32_t begin, uint32_t end,
+                        float bound, uint8_t *expired) {
+    expire_impl(store, field, begin, end, bound, expired);
+}
@@ -0,0 +1,40 @@
+#ifndef KINGDOM_DEFENSE_SIM_KERNELS_H
+#define KINGDOM_DEFENSE_SIM_KERNELS_H
+
+#include <SDL3/SDL.h>
+
+#include "entity.h"
+#include "flow_field.h"
+
+typedef enum {
+    SIM_KERNELS_ISA_SCALAR,
+    SIM_KERNELS_ISA_SSE41,
+    SIM_KERNELS_ISA_AVX2,
+    SIM_KERNELS_ISA_COUNT,
+} sim_kernels_isa_t;
+
+// the per tick loops over the entity arrays. every kernel set gives bit for bit the same results as the scalar
+// one: no fused multiply-add, the same operations in the same order, lanes past the last multiple of the width
+// run the scalar code. they only ever touch [begin, end), disjoint ranges can run on different threads
+
+// picks the best kernels for the running cpu unless the build forces a set with SIM_KERNELS_ISA, called by
+// entity_store_init. until then everything runs scalar
+void sim_kernels_init(void);
+
+// force a kernel set, returns false if the cpu does not support it
+bool sim_kernels_set_isa(sim_kernels_isa_t isa);
+sim_kernels_isa_t sim_kernels_get_isa(void);
+const char *sim_kernels_isa_name(sim_kernels_isa_t isa);
+
+// prev = pos, pos += vel * dt, enemies walking and projectiles flying alike
+void sim_kernels_integrate(entity_store_t *store, uint32_t begin, uint32_t end, float dt);
+// enemies on a tile of `field` with a direction walk that way at `speed`, everywhere else they keep their velocity.
+// every enemy's path_progress advances by speed * dt. the field covers [-1, 1] in both axes
+void sim_kernels_steer(entity_store_t *store, const flow_field_t *field, uint32_t begin, uint32_t end, float speed,
+                       float dt);
+// expired[i] = 1 for everything but towers that is dead or further than `bound` out on either axis, and for
+// enemies standing on the goal tile of `field`, 0 for the rest
+void sim_kernels_expire(const entity_store_t *store, const flow_field_t *field, uint32_t begin, uint32_t end,
+                        float bound, uint8_t *expired);
+
+#endif //KINGDOM_DEFENSE_SIM_KERNELS_H
@@ -0,0 +1,332 @@
+#include "spatial_hash.h"
+
+// t at which an axis parallel segment would cross the next cell boundary
+#define NEVER 1e30f
+
+static bool reserve(spatial_hash_t *hash, uint32_t capacity) {
+    if (capacity <= hash->capacity) {
+        return true;
+    }
+    uint32_t *items = SDL_realloc(hash->items, capacity * sizeof(uint32_t));
+    if (items == NULL) {
+        return false;
+    }
+    hash->items = items;
+    float *item_x = SDL_realloc(hash->item_x, capacity * sizeof(float));
+    if (item_x == NULL) {
+        return false;
+    }
+    hash->item_x = item_x;
+    float *item_y = SDL_realloc(hash->item_y, capacity * sizeof(float));
+    if (item_y == NULL) {
+        return false;
+    }
+    hash->item_y = item_y;
+    uint32_t *scratch_cell = SDL_realloc(hash->scratch_cell, capacity * sizeof(uint32_t));
+    if (scratch_cell == NULL) {
+        return false;
+    }
+    hash->scratch_cell = scratch_cell;
+    hash->capacity = capacity;
+    return true;
+}
+
+bool spatial_hash_init(spatial_hash_t *hash, float min_x, float min_y, float max_x, float max_y, float cell_size,
+                       uint32_t capacity) {
+    SDL_zerop(hash);
+    if (cell_size <= 0.0f || max_x <= min_x || max_y <= min_y) {
+        return SDL_SetError("invalid spatial hash bounds");
+    }
+    hash->min_x = min_x;
+    hash->min_y = min_y;
+    hash->cell_size = cell_size;
+    hash->inv_cell_size = 1.0f / cell_size;
+    hash->cols = (uint32_t) SDL_ceilf((max_x - min_x) / cell_size);
+    hash->rows = (uint32_t) SDL_ceilf((max_y - min_y) / cell_size);
+    hash->cell_start = SDL_calloc(hash->cols * hash->rows + 1, sizeof(uint32_t));
+    if (hash->cell_start == NULL || !reserve(hash, capacity > 0 ? capacity : 1024)) {
+        spatial_hash_destroy(hash);
+        return false;
+    }
+    return true;
+}
+
+void spatial_hash_destroy(spatial_hash_t *hash) {
+    SDL_free(hash->cell_start);
+    SDL_free(hash->items);
+    SDL_free(hash->item_x);
+    SDL_free(hash->item_y);
+    SDL_free(hash->scratch_cell);
+    SDL_zerop(hash);
+}
+
+// grid coordinate of a world position, clamped so anything outside the bounds lands in a border cell
+static int32_t cell_coord(float p, float min, float inv_cell_size, uint32_t cells) {
+    float f = (p - min) * inv_cell_size;
+    if (!(f >= 0.0f)) {
+        return 0;
+    }
+    if (f >= (float) cells) {
+        return (int32_t) cells - 1;
+    }
+    return (int32_t) f;
+}
+
+static int32_t clamp_coord(int32_t c, uint32_t cells) {
+    return c < 0 ? 0 : c >= (int32_t) cells ? (int32_t) cells - 1 : c;
+}
+
+bool spatial_hash_build(spatial_hash_t *hash, const float *x, const float *y, const uint8_t *tags, uint8_t tag,
+                        uint32_t n) {
+    uint32_t num_cells = hash->cols * hash->rows;
+    uint32_t *cell_start = hash->cell_start;
+    SDL_memset(cell_start, 0, (num_cells + 1) * sizeof(uint32_t));
+    if (!reserve(hash, n)) {
+        // left empty rather than holding indices from an older build
+        hash->count = 0;
+        return false;
+    }
+
+    // pass 1: histogram of items per cell, counted one slot ahead so the prefix sum lands on the start offsets
+    uint32_t *scratch_cell = hash->scratch_cell;
+    for (uint32_t i = 0; i < n; i++) {
+        if (tags && tags[i] != tag) {
+            scratch_cell[i] = UINT32_MAX;
+            continue;
+        }
+        uint32_t cx = (uint32_t) cell_coord(x[i], hash->min_x, hash->inv_cell_size, hash->cols);
+        uint32_t cy = (uint32_t) cell_coord(y[i], hash->min_y, hash->inv_cell_size, hash->rows);
+        uint32_t cell = cy * hash->cols + cx;
+        scratch_cell[i] = cell;
+        cell_start[cell + 1]++;
+    }
+    for (uint32_t c = 0; c < num_cells; c++) {
+        cell_start[c + 1] += cell_start[c];
+    }
+    hash->count = cell_start[num_cells];
+
+    // pass 2: scatter, cell_start[c] is used as the write cursor and ends up at the start of cell c + 1
+    for (uint32_t i = 0; i < n; i++) {
+        uint32_t cell = scratch_cell[i];
+        if (cell == UINT32_MAX) {
+            continue;
+        }
+        uint32_t dst = cell_start[cell]++;
+        hash->items[dst] = i;
+        hash->item_x[dst] = x[i];
+        hash->item_y[dst] = y[i];
+    }
+    // shift the cursors back into start offsets
+    for (uint32_t c = num_cells; c > 0; c--) {
+        cell_start[c] = cell_start[c - 1];
+    }
+    cell_start[0] = 0;
+    return true;
+}
+
+typedef struct {
+    int32_t x0;
+    int32_t y0;
+    int32_t x1;
+    int32_t y1;
+} cell_range_t;
+
+static cell_range_t cells_around(const spatial_hash_t *hash, float x, float y, float radius) {
+    return (cell_range_t) {
+            .x0 = cell_coord(x - radius, hash->min_x, hash->inv_cell_size, hash->cols),
+            .y0 = cell_coord(y - radius, hash->min_y, hash->inv_cell_size, hash->rows),
+            .x1 = cell_coord(x + radius, hash->min_x, hash->inv_cell_size, hash->cols),
+            .y1 = cell_coord(y + radius, hash->min_y, hash->inv_cell_size, hash->rows),
+    };
+}
+
+uint32_t spatial_hash_query_radius(const spatial_hash_t *hash, float x, float y, float radius, uint32_t *out,
+                                   uint32_t max_out) {
+    cell_range_t range = cells_around(hash, x, y, radius);
+    float radius2 = radius * radius;
+    uint32_t found = 0;
+    for (int32_t cy = range.y0; cy <= range.y1; cy++) {
+        // cells of a row are contiguous, so the whole row span is one run of items
+        uint32_t begin = hash->cell_start[(uint32_t) cy * hash->cols + (uint32_t) range.x0];
+        uint32_t end = hash->cell_start[(uint32_t) cy * hash->cols + (uint32_t) range.x1 + 1];
+        for (uint32_t i = begin; i < end; i++) {
+            float dx = hash->item_x[i] - x;
+            float dy = hash->item_y[i] - y;
+            if (dx * dx + dy * dy <= radius2) {
+                if (found < max_out) {
+                    out[found] = hash->items[i];
+                }
+                found++;
+            }
+        }
+    }
+    return found;
+}
+
+uint32_t spatial_hash_first_along_path(const spatial_hash_t *hash, float x, float y, float radius,
+                                       const float *progress) {
+    cell_range_t range = cells_around(hash, x, y, radius);
+    float radius2 = radius * radius;
+    uint32_t best = SPATIAL_HASH_NONE;
+    float best_progress = 0.0f;
+    for (int32_t cy = range.y0; cy <= range.y1; cy++) {
+        uint32_t begin = hash->cell_start[(uint32_t) cy * hash->cols + (uint32_t) range.x0];
+        uint32_t end = hash->cell_start[(uint32_t) cy * hash->cols + (uint32_t) range.x1 + 1];
+        for (uint32_t i = begin; i < end; i++) {
+            float dx = hash->item_x[i] - x;
+            float dy = hash->item_y[i] - y;
+            uint32_t item = hash->items[i];
+            // ties go to the lower index so the result does not depend on the cell layout
+            if (dx * dx + dy * dy <= radius2 &&
+                (best == SPATIAL_HASH_NONE || progress[item] > best_progress ||
+                 (progress[item] == best_progress && item < best))) {
+                best = item;
+                best_progress = progress[item];
+            }
+        }
+    }
+    return best;
+}
+
+// scans rings of cells around the query cell outwards, keeping the n closest so far sorted. a ring k cells out
+// can not hold anything closer than (k - 1) cells, which is when the search stops
+uint32_t spatial_hash_nearest(const spatial_hash_t *hash, float x, float y, float radius, uint32_t n,
+                              uint32_t *out) {
+    if (n == 0) {
+        return 0;
+    }
+    float best_d2[SPATIAL_HASH_MAX_NEAREST];
+    uint32_t limit = SDL_min(n, SPATIAL_HASH_MAX_NEAREST);
+    uint32_t found = 0;
+    float radius2 = radius * radius;
+
+    int32_t cx = cell_coord(x, hash->min_x, hash->inv_cell_size, hash->cols);
+    int32_t cy = cell_coord(y, hash->min_y, hash->inv_cell_size, hash->rows);
+    cell_range_t bounds = cells_around(hash, x, y, radius);
+    int32_t max_ring = SDL_max(SDL_max(cx - bounds.x0, bounds.x1 - cx), SDL_max(cy - bounds.y0, bounds.y1 - cy));
+
+    for (int32_t ring = 0; ring <= max_ring; ring++) {
+        float reach = (float) (ring - 1) * hash->cell_size;
+        if (ring > 0 && found == limit && reach * reach > best_d2[found - 1]) {
+            break;
+        }
+        int32_t y0 = SDL_max(cy - ring, bounds.y0);
+        int32_t y1 = SDL_min(cy + ring, bounds.y1);
+        for (int32_t ry = y0; ry <= y1; ry++) {
+            bool edge_row = ry == cy - ring || ry == cy + ring;
+            // inside rows only have the two cells on the ring, edge rows all of them
+            int32_t step = edge_row ? 1 : SDL_max(2 * ring, 1);
+            for (int32_t rx = cx - ring; rx <= cx + ring; rx += step) {
+                if (rx < bounds.x0 || rx > bounds.x1) {
+                    continue;
+                }
+                uint32_t cell = (uint32_t) ry * hash->cols + (uint32_t) rx;
+                for (uint32_t i = hash->cell_start[cell]; i < hash->cell_start[cell + 1]; i++) {
+                    float dx = hash->item_x[i] - x;
+                    float dy = hash->item_y[i] - y;
+                    float d2 = dx * dx + dy * dy;
+                    if (d2 > radius2 || (found == limit && d2 >= best_d2[found - 1])) {
+                        continue;
+                    }
+                    // insertion into the sorted list, dropping the furthest when full
+                    uint32_t pos = found < limit ? found++ : found - 1;
+                    while (pos > 0 && best_d2[pos - 1] > d2) {
+                        best_d2[pos] = best_d2[pos - 1];
+                        out[pos] = out[pos - 1];
+                        pos--;
+                    }
+                    best_d2[pos] = d2;
+                    out[pos] = hash->items[i];
+                }
+            }
+        }
+    }
+    return found;
+}
+
+// where the segment p0 + t * d first comes within `radius` of (cx, cy), false if it never does for t in [0, 1]
+static bool segment_circle(float x0, float y0, float dx, float dy, float cx, float cy, float radius, float *t) {
+    float fx = x0 - cx;
+    float fy = y0 - cy;
+    float c = fx * fx + fy * fy - radius * radius;
+    if (c <= 0.0f) {
+        *t = 0.0f;
+        return true;
+    }
+    float a = dx * dx + dy * dy;
+    float b = fx * dx + fy * dy;
+    if (a == 0.0f || b >= 0.0f) {
+        // not moving, or moving away from the circle
+        return false;
+    }
+    float discriminant = b * b - a * c;
+    if (discriminant < 0.0f) {
+        return false;
+    }
+    float hit = (-b - SDL_sqrtf(discriminant)) / a;
+    if (hit > 1.0f) {
+        return false;
+    }
+    *t = hit;
+    return true;
+}
+
+// walks the cells the segment passes through in order (amanatides & woo) and tests the items of the cells
+// within `radius` of each. cells are entered in increasing t, so once a cell is entered past the best hit so far
+// nothing later can beat it
+uint32_t spatial_hash_segment_cast(const spatial_hash_t *hash, float x0, float y0, float x1, float y1, float radius,
+                                   float *t) {
+    float inv = hash->inv_cell_size;
+    float gx0 = (x0 - hash->min_x) * inv;
+    float gy0 = (y0 - hash->min_y) * inv;
+    float gdx = (x1 - x0) * inv;
+    float gdy = (y1 - y0) * inv;
+    int32_t cx = (int32_t) SDL_floorf(gx0);
+    int32_t cy = (int32_t) SDL_floorf(gy0);
+    int32_t end_x = (int32_t) SDL_floorf(gx0 + gdx);
+    int32_t end_y = (int32_t) SDL_floorf(gy0 + gdy);
+    int32_t step_x = gdx > 0.0f ? 1 : -1;
+    int32_t step_y = gdy > 0.0f ? 1 : -1;
+    float t_delta_x = gdx != 0.0f ? SDL_fabsf(1.0f / gdx) : NEVER;
+    float t_delta_y = gdy != 0.0f ? SDL_fabsf(1.0f / gdy) : NEVER;
+    float t_max_x = gdx != 0.0f ? ((float) (cx + (gdx > 0.0f)) - gx0) / gdx : NEVER;
+    float t_max_y = gdy != 0.0f ? ((float) (cy + (gdy > 0.0f)) - gy0) / gdy : NEVER;
+    int32_t reach = (int32_t) SDL_ceilf(radius * inv);
+    uint32_t steps = (uint32_t) (SDL_abs(end_x - cx) + SDL_abs(end_y - cy));
+
+    uint32_t best = SPATIAL_HASH_NONE;
+    float best_t = 2.0f;
+    float t_enter = 0.0f;
+    for (uint32_t s = 0; s <= steps && t_enter <= best_t; s++) {
+        int32_t ry0 = clamp_coord(cy - reach, hash->rows);
+        int32_t ry1 = clamp_coord(cy + reach, hash->rows);
+        int32_t rx0 = clamp_coord(cx - reach, hash->cols);
+        int32_t rx1 = clamp_coord(cx + reach, hash->cols);
+        for (int32_t ry = ry0; ry <= ry1; ry++) {
+            uint32_t begin = hash->cell_start[(uint32_t) ry * hash->cols + (uint32_t) rx0];
+            uint32_t end = hash->cell_start[(uint32_t) ry * hash->cols + (uint32_t) rx1 + 1];
+            for (uint32_t i = begin; i < end; i++) {
+                float hit;
+                uint32_t item = hash->items[i];
+                if (segment_circle(x0, y0, x1 - x0, y1 - y0, hash->item_x[i], hash->item_y[i], radius, &hit) &&
+                    (hit < best_t || (hit == best_t && item < best))) {
+                    best = item;
+                    best_t = hit;
+                }
+            }
+        }
+        if (t_max_x < t_max_y) {
+            cx += step_x;
+            t_enter = t_max_x;
+            t_max_x += t_delta_x;
+        } else {
+            cy += step_y;
+            t_enter = t_max_y;
+            t_max_y += t_delta_y;
+        }
+    }
+    if (best != SPATIAL_HASH_NONE) {
+        *t = best_t;
+    }
+    return best;
+}
@@ -0,0 +1,56 @@
+#ifndef KINGDOM_DEFENSE_SPATIAL_HASH_H
+#define KINGDOM_DEFENSE_SPATIAL_HASH_H
+
+#include <SDL3/SDL.h>
+
+#define SPATIAL_HASH_NONE UINT32_MAX
+#define SPATIAL_HASH_MAX_NEAREST 16
+
+// uniform grid over a fixed rectangle, points outside of it are clamped into the border cells. rebuilt from
+// scratch every tick with a counting sort, so all items of a cell sit next to each other in one flat array and
+// nothing is allocated per cell. queries never modify the grid and can run concurrently
+typedef struct {
+    float min_x;
+    float min_y;
+    float cell_size;
+    float inv_cell_size;
+    uint32_t cols;
+    uint32_t rows;
+
+    // items of cell c are [cell_start[c], cell_start[c + 1])
+    uint32_t *cell_start;
+    // caller side index of every item plus its position, in cell order
+    uint32_t *items;
+    float *item_x;
+    float *item_y;
+    uint32_t count;
+    uint32_t capacity;
+
+    // cell of every input point, kept between the two counting sort passes
+    uint32_t *scratch_cell;
+} spatial_hash_t;
+
+bool spatial_hash_init(spatial_hash_t *hash, float min_x, float min_y, float max_x, float max_y, float cell_size,
+                       uint32_t capacity);
+void spatial_hash_destroy(spatial_hash_t *hash);
+
+// indexes the points i in [0, n) with `tags` == NULL or tags[i] == tag. query results are these i
+bool spatial_hash_build(spatial_hash_t *hash, const float *x, const float *y, const uint8_t *tags, uint8_t tag,
+                        uint32_t n);
+
+// every item within `radius` of (x, y), returns how many there are even if more than `max_out`
+uint32_t spatial_hash_query_radius(const spatial_hash_t *hash, float x, float y, float radius, uint32_t *out,
+                                   uint32_t max_out);
+// up to `n` (at most SPATIAL_HASH_MAX_NEAREST) items within `radius` of (x, y), closest first. returns how many
+// were found
+uint32_t spatial_hash_nearest(const spatial_hash_t *hash, float x, float y, float radius, uint32_t n,
+                              uint32_t *out);
+// the item within `radius` with the highest `progress[item]`, i.e. the enemy furthest along its path
+uint32_t spatial_hash_first_along_path(const spatial_hash_t *hash, float x, float y, float radius,
+                                       const float *progress);
+// first item whose circle of `radius` the segment (x0, y0) -> (x1, y1) touches, `t` is where along the segment
+// [0, 1]. SPATIAL_HASH_NONE if nothing is hit
+uint32_t spatial_hash_segment_cast(const spatial_hash_t *hash, float x0, float y0, float x1, float y1, float radius,
+                                   float *t);
+
+#endif //KINGDOM_DEFENSE_SPATIAL_HASH_H
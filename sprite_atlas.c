@@ -0,0 +1,25 @@
+#include "sprite_atlas.h"
+
+static const char *const atlas_pages[] = {
+#define ATLAS_PAGE(_name) _name,
+#define ATLAS_SPRITE(_name, _page, _u, _v, _w, _h)
+#include "atlas.gen.h"
+#undef ATLAS_SPRITE
+#undef ATLAS_PAGE
+};
+
+static const atlas_sprite_t atlas_sprites[] = {
+#define ATLAS_PAGE(_name)
+#define ATLAS_SPRITE(_name, _page, _u, _v, _w, _h) [SPRITE_ID_##_name] = {_page, {_u, _v, _w, _h}},
+#include "atlas.gen.h"
+#undef ATLAS_SPRITE
+#undef ATLAS_PAGE
+};
+
+const char *sprite_atlas_page_name(uint32_t page) {
+    return page < SDL_arraysize(atlas_pages) ? atlas_pages[page] : NULL;
+}
+
+const atlas_sprite_t *sprite_atlas_sprite(sprite_id_t id) {
+    return &atlas_sprites[id];
+}
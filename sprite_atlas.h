@@ -0,0 +1,37 @@
+#ifndef KINGDOM_DEFENSE_SPRITE_ATLAS_H
+#define KINGDOM_DEFENSE_SPRITE_ATLAS_H
+
+#include <SDL3/SDL.h>
+
+#include "atlas.h"
+
+// the table kingdom_defense_atlas generated from assets/*.bmp: one id per sprite, named after its file
+typedef enum {
+#define ATLAS_PAGE(_name)
+#define ATLAS_SPRITE(_name, _page, _u, _v, _w, _h) SPRITE_ID_##_name,
+#include "atlas.gen.h"
+#undef ATLAS_SPRITE
+#undef ATLAS_PAGE
+    SPRITE_ID_COUNT,
+} sprite_id_t;
+
+enum {
+    SPRITE_ATLAS_NUM_PAGES = 0
+#define ATLAS_PAGE(_name) + 1
+#define ATLAS_SPRITE(_name, _page, _u, _v, _w, _h)
+#include "atlas.gen.h"
+#undef ATLAS_SPRITE
+#undef ATLAS_PAGE
+};
+
+typedef struct {
+    uint32_t page;
+    // x, y, w, h in the uv space of the page
+    float uv_rect[4];
+} atlas_sprite_t;
+
+// asset name of a page, what asset_stream_request takes
+const char *sprite_atlas_page_name(uint32_t page);
+const atlas_sprite_t *sprite_atlas_sprite(sprite_id_t id);
+
+#endif //KINGDOM_DEFENSE_SPRITE_ATLAS_H
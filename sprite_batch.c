@@ -0,0 +1,299 @@
+#include "sprite_batch.h"
+#include "gpu_resources.h"
+
+static bool grow(sprite_batch_t *batch, uint32_t capacity) {
+    sprite_instance *instances = SDL_realloc(batch->instances, capacity * sizeof(sprite_instance));
+    if (instances == NULL) {
+        return false;
+    }
+    batch->instances = instances;
+
+    // the second half of keys and scratch are the radix sort ping pong buffers for keys and order
+    uint32_t *keys = SDL_realloc(batch->keys, capacity * 2 * sizeof(uint32_t));
+    if (keys == NULL) {
+        return false;
+    }
+    batch->keys = keys;
+    uint32_t *order = SDL_realloc(batch->order, capacity * sizeof(uint32_t));
+    if (order == NULL) {
+        return false;
+    }
+    batch->order = order;
+    uint32_t *scratch = SDL_realloc(batch->scratch, capacity * sizeof(uint32_t));
+    if (scratch == NULL) {
+        return false;
+    }
+    batch->scratch = scratch;
+
+    sprite_run_t *runs = SDL_realloc(batch->runs, capacity * sizeof(sprite_run_t));
+    if (runs == NULL) {
+        return false;
+    }
+    batch->runs = runs;
+    batch->capacity = capacity;
+    return true;
+}
+
+bool sprite_batch_init(sprite_batch_t *batch, SDL_GPUDevice *device, SDL_GPUGraphicsPipeline *pipeline,
+                       uint32_t capacity) {
+    SDL_zerop(batch);
+    batch->device = device;
+    batch->pipeline = pipeline;
+    batch->current_pipeline = pipeline;
+    return grow(batch, capacity > 0 ? capacity : 1024);
+}
+
+void sprite_batch_destroy(sprite_batch_t *batch) {
+    if (batch->device) {
+        gpu_release_buffer(batch->device, batch->instance_buffer);
+        gpu_release_transfer_buffer(batch->device, batch->transfer_buffer);
+    }
+    SDL_free(batch->instances);
+    SDL_free(batch->keys);
+    SDL_free(batch->order);
+    SDL_free(batch->scratch);
+    SDL_free(batch->runs);
+    SDL_zerop(batch);
+}
+
+void sprite_batch_begin(sprite_batch_t *batch) {
+    batch->count = 0;
+    batch->num_bindings = 0;
+    batch->num_pipelines = 0;
+    batch->num_runs = 0;
+    batch->current_pipeline = batch->pipeline;
+    SDL_zero(batch->stats);
+}
+
+void sprite_batch_set_pipeline(sprite_batch_t *batch, SDL_GPUGraphicsPipeline *pipeline) {
+    batch->current_pipeline = pipeline;
+}
+
+static int find_pipeline(sprite_batch_t *batch, SDL_GPUGraphicsPipeline *pipeline) {
+    for (uint32_t i = 0; i < batch->num_pipelines; i++) {
+        if (batch->pipelines[i] == pipeline) {
+            return (int) i;
+        }
+    }
+    if (batch->num_pipelines == SPRITE_BATCH_MAX_PIPELINES) {
+        return -1;
+    }
+    batch->pipelines[batch->num_pipelines] = pipeline;
+    return (int) batch->num_pipelines++;
+}
+
+static int find_binding(sprite_batch_t *batch, SDL_GPUTexture *texture, SDL_GPUSampler *sampler) {
+    // few distinct textures per frame, and consecutive sprites usually share one, so scan from the back
+    SDL_GPUGraphicsPipeline *pipeline = batch->current_pipeline;
+    for (int i = (int) batch->num_bindings - 1; i >= 0; i--) {
+        const sprite_binding_t *binding = &batch->bindings[i];
+        if (binding->texture == texture && binding->sampler == sampler && binding->pipeline == pipeline) {
+            return i;
+        }
+    }
+    if (batch->num_bindings == SPRITE_BATCH_MAX_BINDINGS) {
+        return -1;
+    }
+    // a new binding is the only place a new pipeline can show up
+    int slot = find_pipeline(batch, pipeline);
+    if (slot < 0) {
+        return -1;
+    }
+    batch->bindings[batch->num_bindings] = (sprite_binding_t) {pipeline, texture, sampler, (uint8_t) slot};
+    return (int) batch->num_bindings++;
+}
+
+void sprite_quantize(const sprite_t *sprite, sprite_instance *instance) {
+    *instance = (sprite_instance) {
+            .xy_pos = {sprite->xy_pos[0], sprite->xy_pos[1]},
+            .scale = {pack_half(sprite->scale[0]), pack_half(sprite->scale[1])},
+            .uv_rect = {pack_unorm16(sprite->uv_rect[0]), pack_unorm16(sprite->uv_rect[1]),
+                        pack_unorm16(sprite->uv_rect[2]), pack_unorm16(sprite->uv_rect[3])},
+            .color = {pack_unorm8(sprite->color[0]), pack_unorm8(sprite->color[1]),
+                      pack_unorm8(sprite->color[2]), pack_unorm8(sprite->color[3])},
+            .rotation = {SNORM16(1.0f), 0},
+    };
+    // most sprites aren't rotated, skip the sincos for them
+    if (sprite->rotation != 0.0f) {
+        instance->rotation[0] = pack_snorm16(SDL_cosf(sprite->rotation));
+        instance->rotation[1] = pack_snorm16(SDL_sinf(sprite->rotation));
+    }
+}
+
+bool sprite_batch_submit(sprite_batch_t *batch, SDL_GPUTexture *texture, SDL_GPUSampler *sampler, uint16_t layer,
+                         const sprite_t *sprite) {
+    if (batch->count == batch->capacity && !grow(batch, batch->capacity * 2)) {
+        return false;
+    }
+    int binding = find_binding(batch, texture, sampler);
+    if (binding < 0) {
+        return SDL_SetError("too many textures or pipelines in one sprite batch");
+    }
+    uint32_t index = batch->count++;
+    sprite_quantize(sprite, &batch->instances[index]);
+    batch->keys[index] = (uint32_t) layer << 16 | (uint32_t) batch->bindings[binding].pipeline_slot << 8 |
+                         (uint32_t) binding;
+    return true;
+}
+
+// stable lsd radix sort of (keys, order), bytes every key agrees on are skipped. most frames only use a
+// couple of layers and bindings, so usually one or two passes run
+static void radix_sort(sprite_batch_t *batch) {
+    uint32_t n = batch->count;
+    uint32_t *keys = batch->keys;
+    uint32_t *values = batch->order;
+    uint32_t *keys_tmp = batch->keys + batch->capacity;
+    uint32_t *values_tmp = batch->scratch;
+
+    for (uint32_t i = 0; i < n; i++) {
+        values[i] = i;
+    }
+
+    for (uint32_t shift = 0; shift < 32; shift += 8) {
+        uint32_t histogram[256] = {0};
+        for (uint32_t i = 0; i < n; i++) {
+            histogram[(keys[i] >> shift) & 0xFF]++;
+        }
+        if (histogram[(keys[0] >> shift) & 0xFF] == n) {
+            continue;
+        }
+        uint32_t sum = 0;
+        for (uint32_t b = 0; b < 256; b++) {
+            uint32_t count = histogram[b];
+            histogram[b] = sum;
+            sum += count;
+        }
+        for (uint32_t i = 0; i < n; i++) {
+            uint32_t dst = histogram[(keys[i] >> shift) & 0xFF]++;
+            keys_tmp[dst] = keys[i];
+            values_tmp[dst] = values[i];
+        }
+        uint32_t *swap = keys;
+        keys = keys_tmp;
+        keys_tmp = swap;
+        swap = values;
+        values = values_tmp;
+        values_tmp = swap;
+    }
+
+    // the sorted result may have ended up in the scratch halves
+    if (keys != batch->keys) {
+        SDL_memcpy(batch->keys, keys, n * sizeof(uint32_t));
+        SDL_memcpy(batch->order, values, n * sizeof(uint32_t));
+    }
+}
+
+void sprite_batch_pack(sprite_batch_t *batch, sprite_instance *out) {
+    batch->num_runs = 0;
+    if (batch->count == 0) {
+        return;
+    }
+    radix_sort(batch);
+
+    sprite_run_t *run = NULL;
+    for (uint32_t i = 0; i < batch->count; i++) {
+        out[i] = batch->instances[batch->order[i]];
+        uint16_t binding = (uint16_t) (batch->keys[i] & 0xFF);
+        if (run == NULL || run->binding != binding) {
+            run = &batch->runs[batch->num_runs++];
+            *run = (sprite_run_t) {
+                    .binding = binding,
+                    .first_instance = i,
+            };
+        }
+        run->num_instances++;
+    }
+}
+
+static bool ensure_gpu_capacity(sprite_batch_t *batch) {
+    if (batch->count <= batch->gpu_capacity) {
+        return true;
+    }
+    uint32_t capacity = batch->capacity;
+    uint32_t size = capacity * sizeof(sprite_instance);
+
+    gpu_release_buffer(batch->device, batch->instance_buffer);
+    gpu_release_transfer_buffer(batch->device, batch->transfer_buffer);
+    batch->gpu_capacity = 0;
+
+    batch->instance_buffer = gpu_create_buffer(batch->device, &(SDL_GPUBufferCreateInfo) {
+            .usage = SDL_GPU_BUFFERUSAGE_VERTEX,
+            .size = size,
+    }, GPU_CALLSITE);
+    batch->transfer_buffer = gpu_create_transfer_buffer(batch->device, &(SDL_GPUTransferBufferCreateInfo) {
+            .usage = SDL_GPU_TRANSFERBUFFERUSAGE_UPLOAD,
+            .size = size,
+    }, GPU_CALLSITE);
+    if (batch->instance_buffer == NULL || batch->transfer_buffer == NULL) {
+        return false;
+    }
+    batch->gpu_capacity = capacity;
+    return true;
+}
+
+bool sprite_batch_upload(sprite_batch_t *batch, SDL_GPUCommandBuffer *command_buffer) {
+    if (batch->count == 0) {
+        return true;
+    }
+    if (!ensure_gpu_capacity(batch)) {
+        return false;
+    }
+
+    sprite_instance *mem = SDL_MapGPUTransferBuffer(batch->device, batch->transfer_buffer, true);
+    if (mem == NULL) {
+        return false;
+    }
+    sprite_batch_pack(batch, mem);
+    SDL_UnmapGPUTransferBuffer(batch->device, batch->transfer_buffer);
+
+    SDL_GPUCopyPass *copy_pass = SDL_BeginGPUCopyPass(command_buffer);
+    SDL_UploadToGPUBuffer(copy_pass,
+                          &(SDL_GPUTransferBufferLocation) {
+                                  .transfer_buffer = batch->transfer_buffer,
+                          }, &(SDL_GPUBufferRegion) {
+                    .buffer = batch->instance_buffer,
+                    .size = batch->count * sizeof(sprite_instance),
+            }, true);
+    SDL_EndGPUCopyPass(copy_pass);
+    return true;
+}
+
+void sprite_batch_flush(sprite_batch_t *batch, SDL_GPURenderPass *render_pass, SDL_GPUBuffer *quad,
+                        SDL_GPUBuffer *quad_index) {
+    batch->stats.sprites = batch->count;
+    if (batch->num_runs == 0) {
+        return;
+    }
+
+    SDL_GPUGraphicsPipeline *bound = NULL;
+    for (uint32_t i = 0; i < batch->num_runs; i++) {
+        sprite_run_t *run = &batch->runs[i];
+        sprite_binding_t *binding = &batch->bindings[run->binding];
+        if (binding->pipeline == NULL) {
+            continue;
+        }
+        if (binding->pipeline != bound) {
+            SDL_BindGPUGraphicsPipeline(render_pass, binding->pipeline);
+            batch->stats.binds++;
+            // every pipeline of the batch reads the same vertex layout, the buffers stay bound across switches
+            if (bound == NULL) {
+                SDL_GPUBufferBinding vertex_buffers[] = {
+                        {.buffer = quad},
+                        {.buffer = batch->instance_buffer},
+                };
+                SDL_BindGPUVertexBuffers(render_pass, 0, vertex_buffers, SDL_arraysize(vertex_buffers));
+                SDL_BindGPUIndexBuffer(render_pass, &(SDL_GPUBufferBinding) {.buffer = quad_index},
+                                       SDL_GPU_INDEXELEMENTSIZE_16BIT);
+                batch->stats.binds += 2;
+            }
+            bound = binding->pipeline;
+        }
+        SDL_BindGPUFragmentSamplers(render_pass, 0, &(SDL_GPUTextureSamplerBinding) {
+                .texture = binding->texture,
+                .sampler = binding->sampler,
+        }, 1);
+        SDL_DrawGPUIndexedPrimitives(render_pass, 6, run->num_instances, 0, 0, run->first_instance);
+        batch->stats.binds++;
+        batch->stats.draws++;
+    }
+}
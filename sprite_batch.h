@@ -0,0 +1,98 @@
+#ifndef KINGDOM_DEFENSE_SPRITE_BATCH_H
+#define KINGDOM_DEFENSE_SPRITE_BATCH_H
+
+#include <SDL3/SDL.h>
+
+#include "shader_inputs.h"
+
+// binding and pipeline indices are one byte each of the sort key
+#define SPRITE_BATCH_MAX_BINDINGS 256
+#define SPRITE_BATCH_MAX_PIPELINES 256
+
+// what callers submit, quantized into a sprite_instance on the way in
+typedef struct {
+    float xy_pos[2];
+    float scale[2];
+    // x, y, w, h in uv space
+    float uv_rect[4];
+    float color[4];
+    float rotation;
+} sprite_t;
+
+typedef struct {
+    SDL_GPUGraphicsPipeline *pipeline;
+    SDL_GPUTexture *texture;
+    SDL_GPUSampler *sampler;
+    // index of the pipeline in the batch, sorts above the binding so a layer switches pipelines once per pipeline
+    uint8_t pipeline_slot;
+} sprite_binding_t;
+
+// consecutive instances sharing a binding, drawn with one instanced call
+typedef struct {
+    uint16_t binding;
+    uint32_t first_instance;
+    uint32_t num_instances;
+} sprite_run_t;
+
+typedef struct {
+    uint32_t sprites;
+    uint32_t draws;
+    uint32_t binds;
+} sprite_batch_stats_t;
+
+typedef struct {
+    SDL_GPUDevice *device;
+    // what sprites are drawn with unless sprite_batch_set_pipeline says otherwise
+    SDL_GPUGraphicsPipeline *pipeline;
+    SDL_GPUGraphicsPipeline *current_pipeline;
+
+    // gpu side, grown on demand and cycled every upload so frames in flight keep their copy
+    SDL_GPUBuffer *instance_buffer;
+    SDL_GPUTransferBuffer *transfer_buffer;
+    uint32_t gpu_capacity;
+
+    // cpu side, filled by sprite_batch_submit
+    sprite_instance *instances;
+    // (layer << 16 | pipeline slot << 8 | binding), sorted together with `order`
+    uint32_t *keys;
+    uint32_t *order;
+    uint32_t *scratch;
+    uint32_t count;
+    uint32_t capacity;
+
+    sprite_binding_t bindings[SPRITE_BATCH_MAX_BINDINGS];
+    uint32_t num_bindings;
+    SDL_GPUGraphicsPipeline *pipelines[SPRITE_BATCH_MAX_PIPELINES];
+    uint32_t num_pipelines;
+
+    sprite_run_t *runs;
+    uint32_t num_runs;
+
+    sprite_batch_stats_t stats;
+} sprite_batch_t;
+
+// packs a sprite into the instance format the sprite pipeline reads
+void sprite_quantize(const sprite_t *sprite, sprite_instance *instance);
+
+// device and pipeline may be NULL to only use the cpu side (sorting and packing)
+bool sprite_batch_init(sprite_batch_t *batch, SDL_GPUDevice *device, SDL_GPUGraphicsPipeline *pipeline,
+                       uint32_t capacity);
+void sprite_batch_destroy(sprite_batch_t *batch);
+
+void sprite_batch_begin(sprite_batch_t *batch);
+// sprites submitted from here on are drawn with `pipeline`, until the next call or sprite_batch_begin. every
+// pipeline of a batch reads the sprite vertex layout. runs whose pipeline is NULL, not built yet, aren't drawn
+void sprite_batch_set_pipeline(sprite_batch_t *batch, SDL_GPUGraphicsPipeline *pipeline);
+// sprites are drawn by ascending layer, inside a layer they are grouped by pipeline and binding and keep
+// submission order
+bool sprite_batch_submit(sprite_batch_t *batch, SDL_GPUTexture *texture, SDL_GPUSampler *sampler, uint16_t layer,
+                         const sprite_t *sprite);
+// sorts the submitted sprites into `out` and builds the draw runs
+void sprite_batch_pack(sprite_batch_t *batch, sprite_instance *out);
+// packs and records the instance upload, has to happen outside of a render pass
+bool sprite_batch_upload(sprite_batch_t *batch, SDL_GPUCommandBuffer *command_buffer);
+// one instanced draw per run, `quad` and `quad_index` are the unit quad the instances are placed with
+void sprite_batch_flush(sprite_batch_t *batch, SDL_GPURenderPass *render_pass, SDL_GPUBuffer *quad,
+                        SDL_GPUBuffer *quad_index);
+
+#endif //KINGDOM_DEFENSE_SPRITE_BATCH_H
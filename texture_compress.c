@@ -0,0 +1,647 @@
+#include "texture_compress.h"
+
+// rgba texels of one 4x4 block, row major
+typedef uint8_t block_t[16][4];
+
+// bc7 interpolation weights of 4 bit indices, out of 64
+static const int bc7_weights[16] = {0, 4, 9, 13, 17, 21, 26, 30, 34, 38, 43, 47, 51, 55, 60, 64};
+
+const char *texture_encoding_name(texture_encoding_t encoding) {
+    switch (encoding) {
+        case TEXTURE_ENCODING_RGBA8:
+            return "rgba8";
+        case TEXTURE_ENCODING_BC1:
+            return "bc1";
+        case TEXTURE_ENCODING_BC3:
+            return "bc3";
+        case TEXTURE_ENCODING_BC7:
+            return "bc7";
+        default:
+            return "unknown";
+    }
+}
+
+SDL_GPUTextureFormat texture_encoding_format(texture_encoding_t encoding) {
+    switch (encoding) {
+        case TEXTURE_ENCODING_RGBA8:
+            return SDL_GPU_TEXTUREFORMAT_R8G8B8A8_UNORM;
+        case TEXTURE_ENCODING_BC1:
+            return SDL_GPU_TEXTUREFORMAT_BC1_RGBA_UNORM;
+        case TEXTURE_ENCODING_BC3:
+            return SDL_GPU_TEXTUREFORMAT_BC3_RGBA_UNORM;
+        case TEXTURE_ENCODING_BC7:
+            return SDL_GPU_TEXTUREFORMAT_BC7_RGBA_UNORM;
+        default:
+            return SDL_GPU_TEXTUREFORMAT_INVALID;
+    }
+}
+
+size_t texture_encoded_size(texture_encoding_t encoding, uint32_t width, uint32_t height) {
+    size_t blocks = (size_t) ((width + 3) / 4) * ((height + 3) / 4);
+    switch (encoding) {
+        case TEXTURE_ENCODING_RGBA8:
+            return (size_t) width * height * 4;
+        case TEXTURE_ENCODING_BC1:
+            return blocks * 8;
+        case TEXTURE_ENCODING_BC3:
+        case TEXTURE_ENCODING_BC7:
+            return blocks * 16;
+        default:
+            return 0;
+    }
+}
+
+uint32_t texture_mip_count(uint32_t width, uint32_t height) {
+    uint32_t levels = 1;
+    for (uint32_t size = SDL_max(width, height); size > 1; size >>= 1) {
+        levels++;
+    }
+    return levels;
+}
+
+void texture_downsample(const uint8_t *rgba, uint32_t width, uint32_t height, uint8_t *out) {
+    uint32_t out_width = SDL_max(width >> 1, 1);
+    uint32_t out_height = SDL_max(height >> 1, 1);
+    for (uint32_t y = 0; y < out_height; y++) {
+        const uint8_t *row0 = rgba + (size_t) SDL_min(y * 2, height - 1) * width * 4;
+        const uint8_t *row1 = rgba + (size_t) SDL_min(y * 2 + 1, height - 1) * width * 4;
+        for (uint32_t x = 0; x < out_width; x++) {
+            uint32_t x0 = SDL_min(x * 2, width - 1) * 4;
+            uint32_t x1 = SDL_min(x * 2 + 1, width - 1) * 4;
+            const uint8_t *texels[4] = {row0 + x0, row0 + x1, row1 + x0, row1 + x1};
+            uint32_t alpha = 0;
+            uint32_t weighted[3] = {0};
+            uint32_t plain[3] = {0};
+            for (int i = 0; i < 4; i++) {
+                alpha += texels[i][3];
+                for (int c = 0; c < 3; c++) {
+                    weighted[c] += (uint32_t) texels[i][c] * texels[i][3];
+                    plain[c] += texels[i][c];
+                }
+            }
+            uint8_t *dst = out + ((size_t) y * out_width + x) * 4;
+            for (int c = 0; c < 3; c++) {
+                dst[c] = (uint8_t) (alpha ? (weighted[c] + alpha / 2) / alpha : (plain[c] + 2) / 4);
+            }
+            dst[3] = (uint8_t) ((alpha + 2) / 4);
+        }
+    }
+}
+
+bool texture_has_alpha(const uint8_t *rgba, uint32_t width, uint32_t height) {
+    for (size_t i = 0; i < (size_t) width * height; i++) {
+        if (rgba[i * 4 + 3] != 255) {
+            return true;
+        }
+    }
+    return false;
+}
+
+// edge blocks repeat the last row and column, which keeps the line fit from chasing texels nobody samples
+static void load_block(const uint8_t *rgba, uint32_t width, uint32_t height, uint32_t bx, uint32_t by,
+                       block_t block) {
+    for (uint32_t y = 0; y < 4; y++) {
+        uint32_t sy = SDL_min(by * 4 + y, height - 1);
+        for (uint32_t x = 0; x < 4; x++) {
+            uint32_t sx = SDL_min(bx * 4 + x, width - 1);
+            SDL_memcpy(block[y * 4 + x], rgba + ((size_t) sy * width + sx) * 4, 4);
+        }
+    }
+}
+
+static void store_block(const block_t block, uint32_t width, uint32_t height, uint32_t bx, uint32_t by,
+                        uint8_t *rgba) {
+    for (uint32_t y = 0; y < 4 && by * 4 + y < height; y++) {
+        for (uint32_t x = 0; x < 4 && bx * 4 + x < width; x++) {
+            SDL_memcpy(rgba + ((size_t) (by * 4 + y) * width + bx * 4 + x) * 4, block[y * 4 + x], 4);
+        }
+    }
+}
+
+// direction the points spread the most along, power iteration on their covariance. a zero axis when they are
+// all the same
+static void principal_axis(const float points[16][4], uint32_t count, int channels, float mean[4], float axis[4]) {
+    float cov[4][4] = {0};
+    for (int c = 0; c < 4; c++) {
+        mean[c] = 0.0f;
+        axis[c] = 0.0f;
+    }
+    for (uint32_t i = 0; i < count; i++) {
+        for (int c = 0; c < channels; c++) {
+            mean[c] += points[i][c] / (float) count;
+        }
+    }
+    for (uint32_t i = 0; i < count; i++) {
+        for (int a = 0; a < channels; a++) {
+            for (int b = 0; b < channels; b++) {
+                cov[a][b] += (points[i][a] - mean[a]) * (points[i][b] - mean[b]);
+            }
+        }
+    }
+    // start on the channel that varies most, a handful of steps is plenty for 16 points
+    int widest = 0;
+    for (int c = 1; c < channels; c++) {
+        if (cov[c][c] > cov[widest][widest]) {
+            widest = c;
+        }
+    }
+    axis[widest] = 1.0f;
+    for (int iteration = 0; iteration < 8; iteration++) {
+        float next[4] = {0};
+        float length = 0.0f;
+        for (int a = 0; a < channels; a++) {
+            for (int b = 0; b < channels; b++) {
+                next[a] += cov[a][b] * axis[b];
+            }
+            length += next[a] * next[a];
+        }
+        length = SDL_sqrtf(length);
+        if (length < 1e-6f) {
+            axis[widest] = 0.0f;
+            return;
+        }
+        for (int c = 0; c < channels; c++) {
+            axis[c] = next[c] / length;
+        }
+    }
+}
+
+// the two ends of the points' extent along the axis
+static void line_endpoints(const float points[16][4], uint32_t count, int channels, float e0[4], float e1[4]) {
+    float mean[4];
+    float axis[4];
+    principal_axis(points, count, channels, mean, axis);
+    float lo = 0.0f;
+    float hi = 0.0f;
+    for (uint32_t i = 0; i < count; i++) {
+        float t = 0.0f;
+        for (int c = 0; c < channels; c++) {
+            t += (points[i][c] - mean[c]) * axis[c];
+        }
+        lo = SDL_min(lo, t);
+        hi = SDL_max(hi, t);
+    }
+    for (int c = 0; c < 4; c++) {
+        e0[c] = SDL_clamp(mean[c] + axis[c] * hi, 0.0f, 255.0f);
+        e1[c] = SDL_clamp(mean[c] + axis[c] * lo, 0.0f, 255.0f);
+    }
+}
+
+// least squares endpoints for the indices picked so far, `weights[i]` is how much of e0 point i gets. false when
+// every point sits on the same weight and the system has no single answer
+static bool fit_endpoints(const float points[16][4], const float weights[16], uint32_t count, int channels,
+                          float e0[4], float e1[4]) {
+    float aa = 0.0f;
+    float ab = 0.0f;
+    float bb = 0.0f;
+    float ax[4] = {0};
+    float bx[4] = {0};
+    for (uint32_t i = 0; i < count; i++) {
+        float w = weights[i];
+        float v = 1.0f - w;
+        aa += w * w;
+        ab += w * v;
+        bb += v * v;
+        for (int c = 0; c < channels; c++) {
+            ax[c] += w * points[i][c];
+            bx[c] += v * points[i][c];
+        }
+    }
+    float det = aa * bb - ab * ab;
+    if (SDL_fabsf(det) < 1e-6f) {
+        return false;
+    }
+    for (int c = 0; c < channels; c++) {
+        e0[c] = SDL_clamp((ax[c] * bb - bx[c] * ab) / det, 0.0f, 255.0f);
+        e1[c] = SDL_clamp((bx[c] * aa - ax[c] * ab) / det, 0.0f, 255.0f);
+    }
+    return true;
+}
+
+static uint16_t pack_565(const float color[4]) {
+    int r = (int) SDL_clamp(SDL_lroundf(color[0] * 31.0f / 255.0f), 0, 31);
+    int g = (int) SDL_clamp(SDL_lroundf(color[1] * 63.0f / 255.0f), 0, 63);
+    int b = (int) SDL_clamp(SDL_lroundf(color[2] * 31.0f / 255.0f), 0, 31);
+    return (uint16_t) (r << 11 | g << 5 | b);
+}
+
+// bc1 palette. the decoder reads c0 <= c1 as three colour mode: a midpoint plus transparent black
+static void bc1_palette(uint16_t c0, uint16_t c1, bool three_color, int palette[4][4]) {
+    int a[3] = {(c0 >> 11) & 31, (c0 >> 5) & 63, c0 & 31};
+    int b[3] = {(c1 >> 11) & 31, (c1 >> 5) & 63, c1 & 31};
+    for (int c = 0; c < 3; c++) {
+        int shift = c == 1 ? 6 : 5;
+        a[c] = a[c] << (8 - shift) | a[c] >> (2 * shift - 8);
+        b[c] = b[c] << (8 - shift) | b[c] >> (2 * shift - 8);
+        palette[0][c] = a[c];
+        palette[1][c] = b[c];
+        palette[2][c] = three_color ? (a[c] + b[c]) / 2 : (2 * a[c] + b[c]) / 3;
+        palette[3][c] = three_color ? 0 : (a[c] + 2 * b[c]) / 3;
+    }
+    for (int i = 0; i < 4; i++) {
+        palette[i][3] = three_color && i == 3 ? 0 : 255;
+    }
+}
+
+// nearest palette entry per texel, transparent texels always take the transparent one. returns the squared error
+static uint32_t bc1_assign(const block_t block, const bool transparent[16], const int palette[4][4],
+                           bool three_color, uint8_t indices[16]) {
+    uint32_t total = 0;
+    for (int i = 0; i < 16; i++) {
+        if (transparent[i]) {
+            indices[i] = 3;
+            continue;
+        }
+        uint32_t best = UINT32_MAX;
+        for (int k = 0; k < (three_color ? 3 : 4); k++) {
+            uint32_t error = 0;
+            for (int c = 0; c < 3; c++) {
+                int d = block[i][c] - palette[k][c];
+                error += (uint32_t) (d * d);
+            }
+            if (error < best) {
+                best = error;
+                indices[i] = (uint8_t) k;
+            }
+        }
+        total += best;
+    }
+    return total;
+}
+
+// `punch_through` turns texels under half alpha into bc1's transparent black, bc3 colour blocks have no alpha
+static void encode_bc1_block(const block_t block, bool punch_through, uint8_t out[8]) {
+    static const float weights_four[4] = {1.0f, 0.0f, 2.0f / 3.0f, 1.0f / 3.0f};
+    static const float weights_three[4] = {1.0f, 0.0f, 0.5f, 0.0f};
+
+    bool transparent[16];
+    float points[16][4];
+    uint8_t slot[16];
+    uint32_t count = 0;
+    for (int i = 0; i < 16; i++) {
+        transparent[i] = punch_through && block[i][3] < 128;
+        if (!transparent[i]) {
+            for (int c = 0; c < 4; c++) {
+                points[count][c] = block[i][c];
+            }
+            slot[count++] = (uint8_t) i;
+        }
+    }
+    bool three_color = count < 16;
+    uint16_t c0 = 0;
+    uint16_t c1 = 0;
+    uint8_t indices[16];
+    SDL_memset(indices, 3, sizeof(indices));
+
+    if (count > 0) {
+        float e0[4];
+        float e1[4];
+        int palette[4][4];
+        line_endpoints(points, count, 3, e0, e1);
+        c0 = pack_565(e0);
+        c1 = pack_565(e1);
+        bc1_palette(c0, c1, three_color, palette);
+        uint32_t error = bc1_assign(block, transparent, palette, three_color, indices);
+
+        // one least squares pass over the indices the line fit picked
+        float weights[16];
+        for (uint32_t n = 0; n < count; n++) {
+            weights[n] = (three_color ? weights_three : weights_four)[indices[slot[n]]];
+        }
+        if (error > 0 && fit_endpoints(points, weights, count, 3, e0, e1)) {
+            uint16_t r0 = pack_565(e0);
+            uint16_t r1 = pack_565(e1);
+            uint8_t refined[16];
+            bc1_palette(r0, r1, three_color, palette);
+            if (bc1_assign(block, transparent, palette, three_color, refined) < error) {
+                c0 = r0;
+                c1 = r1;
+                SDL_memcpy(indices, refined, sizeof(indices));
+            }
+        }
+    }
+
+    // the decoder tells the modes apart by the order of the endpoints
+    if (three_color ? c0 > c1 : c0 < c1) {
+        uint16_t swap = c0;
+        c0 = c1;
+        c1 = swap;
+        for (int i = 0; i < 16; i++) {
+            if (!three_color || indices[i] < 2) {
+                indices[i] ^= 1;
+            }
+        }
+    } else if (!three_color && c0 == c1) {
+        // reads as three colour mode, where only the first entries still hold the colour
+        SDL_memset(indices, 0, sizeof(indices));
+    }
+    uint32_t bits = 0;
+    for (int i = 0; i < 16; i++) {
+        bits |= (uint32_t) indices[i] << (2 * i);
+    }
+    out[0] = (uint8_t) c0;
+    out[1] = (uint8_t) (c0 >> 8);
+    out[2] = (uint8_t) c1;
+    out[3] = (uint8_t) (c1 >> 8);
+    for (int b = 0; b < 4; b++) {
+        out[4 + b] = (uint8_t) (bits >> (8 * b));
+    }
+}
+
+static void decode_bc1_block(const uint8_t in[8], bool four_color_only, block_t block) {
+    uint16_t c0 = (uint16_t) (in[0] | in[1] << 8);
+    uint16_t c1 = (uint16_t) (in[2] | in[3] << 8);
+    uint32_t bits = (uint32_t) in[4] | (uint32_t) in[5] << 8 | (uint32_t) in[6] << 16 | (uint32_t) in[7] << 24;
+    int palette[4][4];
+    bc1_palette(c0, c1, !four_color_only && c0 <= c1, palette);
+    for (int i = 0; i < 16; i++) {
+        for (int c = 0; c < 4; c++) {
+            block[i][c] = (uint8_t) palette[(bits >> (2 * i)) & 3][c];
+        }
+    }
+}
+
+// bc3 and bc4 alpha: two endpoints and 3 bit indices, eight steps when a0 > a1, otherwise six plus 0 and 255
+static void alpha_palette(int a0, int a1, int palette[8]) {
+    palette[0] = a0;
+    palette[1] = a1;
+    if (a0 > a1) {
+        for (int i = 2; i < 8; i++) {
+            palette[i] = ((8 - i) * a0 + (i - 1) * a1) / 7;
+        }
+    } else {
+        for (int i = 2; i < 6; i++) {
+            palette[i] = ((6 - i) * a0 + (i - 1) * a1) / 5;
+        }
+        palette[6] = 0;
+        palette[7] = 255;
+    }
+}
+
+static void encode_alpha_block(const block_t block, uint8_t out[8]) {
+    int lo = 255;
+    int hi = 0;
+    for (int i = 0; i < 16; i++) {
+        lo = SDL_min(lo, block[i][3]);
+        hi = SDL_max(hi, block[i][3]);
+    }
+    int palette[8];
+    alpha_palette(hi, lo, palette);
+    uint64_t bits = 0;
+    for (int i = 0; i < 16; i++) {
+        int best = 0;
+        for (int k = 1; k < 8; k++) {
+            if (SDL_abs(block[i][3] - palette[k]) < SDL_abs(block[i][3] - palette[best])) {
+                best = k;
+            }
+        }
+        bits |= (uint64_t) best << (3 * i);
+    }
+    out[0] = (uint8_t) hi;
+    out[1] = (uint8_t) lo;
+    for (int b = 0; b < 6; b++) {
+        out[2 + b] = (uint8_t) (bits >> (8 * b));
+    }
+}
+
+static void decode_alpha_block(const uint8_t in[8], block_t block) {
+    int palette[8];
+    alpha_palette(in[0], in[1], palette);
+    uint64_t bits = 0;
+    for (int b = 0; b < 6; b++) {
+        bits |= (uint64_t) in[2 + b] << (8 * b);
+    }
+    for (int i = 0; i < 16; i++) {
+        block[i][3] = (uint8_t) palette[(bits >> (3 * i)) & 7];
+    }
+}
+
+static void put_bits(uint8_t out[16], uint32_t *pos, uint32_t value, uint32_t count) {
+    for (uint32_t i = 0; i < count; i++, (*pos)++) {
+        out[*pos >> 3] |= (uint8_t) (((value >> i) & 1) << (*pos & 7));
+    }
+}
+
+static uint32_t get_bits(const uint8_t in[16], uint32_t *pos, uint32_t count) {
+    uint32_t value = 0;
+    for (uint32_t i = 0; i < count; i++, (*pos)++) {
+        value |= (uint32_t) ((in[*pos >> 3] >> (*pos & 7)) & 1) << i;
+    }
+    return value;
+}
+
+// 7 bits per channel plus the endpoint's p bit as the lowest one, whichever p bit lands closer. only odd values
+// reach 255, so opaque blocks are held to p = 1
+static void bc7_quantize(const float endpoint[4], bool opaque, uint8_t quantized[4], uint8_t *pbit) {
+    float best = -1.0f;
+    for (int p = opaque ? 1 : 0; p < 2; p++) {
+        uint8_t q[4];
+        float error = 0.0f;
+        for (int c = 0; c < 4; c++) {
+            q[c] = (uint8_t) SDL_clamp(SDL_lroundf((endpoint[c] - (float) p) * 0.5f), 0, 127);
+            float d = (float) (q[c] << 1 | p) - endpoint[c];
+            error += d * d;
+        }
+        if (best < 0.0f || error < best) {
+            best = error;
+            SDL_memcpy(quantized, q, 4);
+            *pbit = (uint8_t) p;
+        }
+    }
+}
+
+static void bc7_palette(const uint8_t quantized[2][4], const uint8_t pbits[2], int palette[16][4]) {
+    for (int c = 0; c < 4; c++) {
+        int e0 = quantized[0][c] << 1 | pbits[0];
+        int e1 = quantized[1][c] << 1 | pbits[1];
+        for (int k = 0; k < 16; k++) {
+            palette[k][c] = ((64 - bc7_weights[k]) * e0 + bc7_weights[k] * e1 + 32) >> 6;
+        }
+    }
+}
+
+static uint32_t bc7_assign(const block_t block, const int palette[16][4], uint8_t indices[16]) {
+    uint32_t total = 0;
+    for (int i = 0; i < 16; i++) {
+        uint32_t best = UINT32_MAX;
+        for (int k = 0; k < 16; k++) {
+            uint32_t error = 0;
+            for (int c = 0; c < 4; c++) {
+                int d = block[i][c] - palette[k][c];
+                error += (uint32_t) (d * d);
+            }
+            if (error < best) {
+                best = error;
+                indices[i] = (uint8_t) k;
+            }
+        }
+        total += best;
+    }
+    return total;
+}
+
+// mode 6: one rgba line with 7 bit endpoints, a p bit each and 4 bit indices. the other seven modes split the
+// block into subsets or rotate channels, they win on blocks with several distinct colours but need a search over
+// partitions that costs far more than this
+static void encode_bc7_block(const block_t block, uint8_t out[16]) {
+    float points[16][4];
+    bool opaque = true;
+    for (int i = 0; i < 16; i++) {
+        for (int c = 0; c < 4; c++) {
+            points[i][c] = block[i][c];
+        }
+        opaque = opaque && block[i][3] == 255;
+    }
+    float e0[4];
+    float e1[4];
+    line_endpoints(points, 16, 4, e0, e1);
+    // the fit drifts a little off 255, opaque blocks have to stay exactly opaque for blending
+    if (opaque) {
+        e0[3] = 255.0f;
+        e1[3] = 255.0f;
+    }
+    uint8_t quantized[2][4];
+    uint8_t pbits[2];
+    bc7_quantize(e0, opaque, quantized[0], &pbits[0]);
+    bc7_quantize(e1, opaque, quantized[1], &pbits[1]);
+    int palette[16][4];
+    uint8_t indices[16];
+    bc7_palette(quantized, pbits, palette);
+    uint32_t error = bc7_assign(block, palette, indices);
+
+    float weights[16];
+    for (int i = 0; i < 16; i++) {
+        weights[i] = 1.0f - (float) bc7_weights[indices[i]] / 64.0f;
+    }
+    if (error > 0 && fit_endpoints(points, weights, 16, 4, e0, e1)) {
+        if (opaque) {
+            e0[3] = 255.0f;
+            e1[3] = 255.0f;
+        }
+        uint8_t refined_quantized[2][4];
+        uint8_t refined_pbits[2];
+        uint8_t refined[16];
+        bc7_quantize(e0, opaque, refined_quantized[0], &refined_pbits[0]);
+        bc7_quantize(e1, opaque, refined_quantized[1], &refined_pbits[1]);
+        bc7_palette(refined_quantized, refined_pbits, palette);
+        if (bc7_assign(block, palette, refined) < error) {
+            SDL_memcpy(quantized, refined_quantized, sizeof(quantized));
+            SDL_memcpy(pbits, refined_pbits, sizeof(pbits));
+            SDL_memcpy(indices, refined, sizeof(indices));
+        }
+    }
+
+    // the first texel's index is stored without its top bit, which has to be zero
+    if (indices[0] & 8) {
+        for (int c = 0; c < 4; c++) {
+            uint8_t swap = quantized[0][c];
+            quantized[0][c] = quantized[1][c];
+            quantized[1][c] = swap;
+        }
+        uint8_t swap = pbits[0];
+        pbits[0] = pbits[1];
+        pbits[1] = swap;
+        for (int i = 0; i < 16; i++) {
+            indices[i] = (uint8_t) (15 - indices[i]);
+        }
+    }
+
+    SDL_memset(out, 0, 16);
+    uint32_t pos = 0;
+    put_bits(out, &pos, 1u << 6, 7);
+    for (int c = 0; c < 4; c++) {
+        put_bits(out, &pos, quantized[0][c], 7);
+        put_bits(out, &pos, quantized[1][c], 7);
+    }
+    put_bits(out, &pos, pbits[0], 1);
+    put_bits(out, &pos, pbits[1], 1);
+    put_bits(out, &pos, indices[0], 3);
+    for (int i = 1; i < 16; i++) {
+        put_bits(out, &pos, indices[i], 4);
+    }
+}
+
+static void decode_bc7_block(const uint8_t in[16], block_t block) {
+    uint32_t pos = 0;
+    if (get_bits(in, &pos, 7) != 1u << 6) {
+        SDL_memset(block, 0, sizeof(block_t));
+        return;
+    }
+    uint8_t quantized[2][4];
+    uint8_t pbits[2];
+    for (int c = 0; c < 4; c++) {
+        quantized[0][c] = (uint8_t) get_bits(in, &pos, 7);
+        quantized[1][c] = (uint8_t) get_bits(in, &pos, 7);
+    }
+    pbits[0] = (uint8_t) get_bits(in, &pos, 1);
+    pbits[1] = (uint8_t) get_bits(in, &pos, 1);
+    int palette[16][4];
+    bc7_palette(quantized, pbits, palette);
+    for (int i = 0; i < 16; i++) {
+        uint32_t index = get_bits(in, &pos, i == 0 ? 3 : 4);
+        for (int c = 0; c < 4; c++) {
+            block[i][c] = (uint8_t) palette[index][c];
+        }
+    }
+}
+
+void texture_encode(texture_encoding_t encoding, const uint8_t *rgba, uint32_t width, uint32_t height, uint8_t *out) {
+    if (encoding == TEXTURE_ENCODING_RGBA8) {
+        SDL_memcpy(out, rgba, texture_encoded_size(encoding, width, height));
+        return;
+    }
+    block_t block;
+    for (uint32_t by = 0; by < (height + 3) / 4; by++) {
+        for (uint32_t bx = 0; bx < (width + 3) / 4; bx++) {
+            load_block(rgba, width, height, bx, by, block);
+            switch (encoding) {
+                case TEXTURE_ENCODING_BC1:
+                    encode_bc1_block(block, true, out);
+                    out += 8;
+                    break;
+                case TEXTURE_ENCODING_BC3:
+                    encode_alpha_block(block, out);
+                    encode_bc1_block(block, false, out + 8);
+                    out += 16;
+                    break;
+                case TEXTURE_ENCODING_BC7:
+                    encode_bc7_block(block, out);
+                    out += 16;
+                    break;
+                default:
+                    return;
+            }
+        }
+    }
+}
+
+void texture_decode(texture_encoding_t encoding, const uint8_t *in, uint32_t width, uint32_t height, uint8_t *rgba) {
+    if (encoding == TEXTURE_ENCODING_RGBA8) {
+        SDL_memcpy(rgba, in, texture_encoded_size(encoding, width, height));
+        return;
+    }
+    block_t block;
+    for (uint32_t by = 0; by < (height + 3) / 4; by++) {
+        for (uint32_t bx = 0; bx < (width + 3) / 4; bx++) {
+            switch (encoding) {
+                case TEXTURE_ENCODING_BC1:
+                    decode_bc1_block(in, false, block);
+                    in += 8;
+                    break;
+                case TEXTURE_ENCODING_BC3:
+                    // bc3 colour is always four colour, whatever the endpoint order
+                    decode_bc1_block(in + 8, true, block);
+                    decode_alpha_block(in, block);
+                    in += 16;
+                    break;
+                case TEXTURE_ENCODING_BC7:
+                    decode_bc7_block(in, block);
+                    in += 16;
+                    break;
+                default:
+                    return;
+            }
+            store_block(block, width, height, bx, by, rgba);
+        }
+    }
+}
@@ -0,0 +1,35 @@
+#ifndef KINGDOM_DEFENSE_TEXTURE_COMPRESS_H
+#define KINGDOM_DEFENSE_TEXTURE_COMPRESS_H
+
+#include <SDL3/SDL.h>
+
+// offline side of the asset build: mip chains and block compression of rgba8 images, rows tightly packed
+
+typedef enum {
+    TEXTURE_ENCODING_RGBA8,
+    // 4 bpp, rgb plus 1 bit alpha
+    TEXTURE_ENCODING_BC1,
+    // 8 bpp, bc1 colour plus an interpolated alpha block
+    TEXTURE_ENCODING_BC3,
+    // 8 bpp, only mode 6 (one rgba line per block, 16 weights), the mode that carries most of bc7's quality
+    TEXTURE_ENCODING_BC7,
+    TEXTURE_ENCODING_COUNT,
+} texture_encoding_t;
+
+const char *texture_encoding_name(texture_encoding_t encoding);
+SDL_GPUTextureFormat texture_encoding_format(texture_encoding_t encoding);
+// block formats round up to whole 4x4 blocks
+size_t texture_encoded_size(texture_encoding_t encoding, uint32_t width, uint32_t height);
+
+// levels down to 1x1, level i is max(1, size >> i) like the gpu expects
+uint32_t texture_mip_count(uint32_t width, uint32_t height);
+// 2x2 box filter into the next level. colour is weighted by alpha so transparent texels don't bleed their rgb
+// into the edges of a sprite, an odd last row or column is dropped the same way the gpu sizes the level
+void texture_downsample(const uint8_t *rgba, uint32_t width, uint32_t height, uint8_t *out);
+bool texture_has_alpha(const uint8_t *rgba, uint32_t width, uint32_t height);
+
+void texture_encode(texture_encoding_t encoding, const uint8_t *rgba, uint32_t width, uint32_t height, uint8_t *out);
+// the reverse, to measure the encoders. bc7 only understands the mode texture_encode writes
+void texture_decode(texture_encoding_t encoding, const uint8_t *in, uint32_t width, uint32_t height, uint8_t *rgba);
+
+#endif //KINGDOM_DEFENSE_TEXTURE_COMPRESS_H
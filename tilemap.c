@@ -0,0 +1,186 @@
+#include "tilemap.h"
+#include "gpu_resources.h"
+#include "sprite_batch.h"
+
+// there is a single ground texture so far, the kinds only differ in tint
+static const float tile_colors[TILE_KIND_COUNT][4] = {
+        [TILE_KIND_GRASS] = {1.0f, 1.0f, 1.0f, 1.0f},
+        [TILE_KIND_SPAWN] = {1.0f, 0.6f, 0.6f, 1.0f},
+        [TILE_KIND_GOAL] = {0.6f, 0.6f, 1.0f, 1.0f},
+        [TILE_KIND_BLOCKED] = {0.4f, 0.35f, 0.3f, 1.0f},
+};
+
+static tilemap_chunk_t *chunk_of(tilemap_t *tilemap, uint32_t x, uint32_t y) {
+    return &tilemap->chunks[(y / TILEMAP_CHUNK_SIZE) * tilemap->chunks_x + x / TILEMAP_CHUNK_SIZE];
+}
+
+bool tilemap_init(tilemap_t *tilemap, SDL_GPUDevice *device, uint32_t width, uint32_t height, float origin_x,
+                  float origin_y, float tile_size, const float uv_rect[4]) {
+    SDL_zerop(tilemap);
+    tilemap->device = device;
+    tilemap->width = width;
+    tilemap->height = height;
+    tilemap->origin[0] = origin_x;
+    tilemap->origin[1] = origin_y;
+    tilemap->tile_size = tile_size;
+    SDL_memcpy(tilemap->uv_rect, uv_rect, sizeof(tilemap->uv_rect));
+    tilemap->chunks_x = (width + TILEMAP_CHUNK_SIZE - 1) / TILEMAP_CHUNK_SIZE;
+    tilemap->chunks_y = (height + TILEMAP_CHUNK_SIZE - 1) / TILEMAP_CHUNK_SIZE;
+    tilemap->tiles = SDL_calloc((size_t) width * height, sizeof(uint8_t));
+    tilemap->chunks = SDL_calloc(tilemap->chunks_x * tilemap->chunks_y, sizeof(tilemap_chunk_t));
+    tilemap->scratch = SDL_malloc(TILEMAP_CHUNK_TILES * sizeof(sprite_instance));
+    if (tilemap->tiles == NULL || tilemap->chunks == NULL || tilemap->scratch == NULL) {
+        tilemap_destroy(tilemap);
+        return false;
+    }
+
+    for (uint32_t cy = 0; cy < tilemap->chunks_y; cy++) {
+        for (uint32_t cx = 0; cx < tilemap->chunks_x; cx++) {
+            tilemap_chunk_t *chunk = &tilemap->chunks[cy * tilemap->chunks_x + cx];
+            uint32_t w = SDL_min(width - cx * TILEMAP_CHUNK_SIZE, TILEMAP_CHUNK_SIZE);
+            uint32_t h = SDL_min(height - cy * TILEMAP_CHUNK_SIZE, TILEMAP_CHUNK_SIZE);
+            chunk->num_tiles = w * h;
+            chunk->dirty = true;
+            chunk->instance_buffer = gpu_create_buffer(device, &(SDL_GPUBufferCreateInfo) {
+                    .usage = SDL_GPU_BUFFERUSAGE_VERTEX,
+                    .size = chunk->num_tiles * (uint32_t) sizeof(sprite_instance),
+            }, GPU_CALLSITE);
+            if (chunk->instance_buffer == NULL) {
+                tilemap_destroy(tilemap);
+                return false;
+            }
+        }
+    }
+    tilemap->num_dirty = tilemap->chunks_x * tilemap->chunks_y;
+    return true;
+}
+
+void tilemap_destroy(tilemap_t *tilemap) {
+    if (tilemap->chunks != NULL) {
+        for (uint32_t i = 0; i < tilemap->chunks_x * tilemap->chunks_y; i++) {
+            gpu_release_buffer(tilemap->device, tilemap->chunks[i].instance_buffer);
+        }
+    }
+    SDL_free(tilemap->tiles);
+    SDL_free(tilemap->chunks);
+    SDL_free(tilemap->scratch);
+    SDL_zerop(tilemap);
+}
+
+void tilemap_set(tilemap_t *tilemap, uint32_t x, uint32_t y, tile_kind_t kind) {
+    if (x >= tilemap->width || y >= tilemap->height) {
+        return;
+    }
+    uint8_t *tile = &tilemap->tiles[(size_t) y * tilemap->width + x];
+    if (*tile == (uint8_t) kind) {
+        return;
+    }
+    *tile = (uint8_t) kind;
+    tilemap_chunk_t *chunk = chunk_of(tilemap, x, y);
+    if (!chunk->dirty) {
+        chunk->dirty = true;
+        tilemap->num_dirty++;
+    }
+}
+
+bool tilemap_world_to_tile(const tilemap_t *tilemap, float x, float y, uint32_t *tile_x, uint32_t *tile_y) {
+    float tx = SDL_floorf((x - tilemap->origin[0]) / tilemap->tile_size);
+    float ty = SDL_floorf((y - tilemap->origin[1]) / tilemap->tile_size);
+    if (tx < 0.0f || ty < 0.0f || tx >= (float) tilemap->width || ty >= (float) tilemap->height) {
+        return false;
+    }
+    *tile_x = (uint32_t) tx;
+    *tile_y = (uint32_t) ty;
+    return true;
+}
+
+// instances in row order, bottom left tile first
+static void build_chunk(tilemap_t *tilemap, uint32_t cx, uint32_t cy) {
+    uint32_t x0 = cx * TILEMAP_CHUNK_SIZE;
+    uint32_t y0 = cy * TILEMAP_CHUNK_SIZE;
+    uint32_t x1 = SDL_min(x0 + TILEMAP_CHUNK_SIZE, tilemap->width);
+    uint32_t y1 = SDL_min(y0 + TILEMAP_CHUNK_SIZE, tilemap->height);
+    sprite_instance *out = tilemap->scratch;
+    for (uint32_t y = y0; y < y1; y++) {
+        const uint8_t *row = &tilemap->tiles[(size_t) y * tilemap->width];
+        for (uint32_t x = x0; x < x1; x++) {
+            const float *color = tile_colors[row[x]];
+            sprite_t tile = {
+                    .xy_pos = {tilemap->origin[0] + ((float) x + 0.5f) * tilemap->tile_size,
+                               tilemap->origin[1] + ((float) y + 0.5f) * tilemap->tile_size},
+                    .scale = {tilemap->tile_size, tilemap->tile_size},
+                    .uv_rect = {tilemap->uv_rect[0], tilemap->uv_rect[1], tilemap->uv_rect[2],
+                                tilemap->uv_rect[3]},
+                    .color = {color[0], color[1], color[2], color[3]},
+            };
+            sprite_quantize(&tile, out++);
+        }
+    }
+}
+
+bool tilemap_upload(tilemap_t *tilemap, upload_ring_t *ring) {
+    for (uint32_t i = 0; tilemap->num_dirty > 0 && i < tilemap->chunks_x * tilemap->chunks_y; i++) {
+        tilemap_chunk_t *chunk = &tilemap->chunks[i];
+        if (!chunk->dirty) {
+            continue;
+        }
+        build_chunk(tilemap, i % tilemap->chunks_x, i / tilemap->chunks_x);
+        uint32_t size = chunk->num_tiles * (uint32_t) sizeof(sprite_instance);
+        if (!upload_ring_upload_buffer(ring, chunk->instance_buffer, 0, tilemap->scratch, size)) {
+            return false;
+        }
+        chunk->dirty = false;
+        tilemap->num_dirty--;
+        tilemap->stats.chunk_uploads++;
+        tilemap->stats.upload_bytes += size;
+    }
+    return true;
+}
+
+void tilemap_draw(tilemap_t *tilemap, SDL_GPURenderPass *render_pass, SDL_GPUGraphicsPipeline *sprite_pipeline,
+                  SDL_GPUBuffer *quad, SDL_GPUBuffer *quad_index, SDL_GPUTexture *texture, SDL_GPUSampler *sampler,
+                  const float view[4]) {
+    tilemap->stats.draws = 0;
+    tilemap->stats.binds = 0;
+    tilemap->stats.culled = 0;
+
+    // only the chunk range under the view is visited, the cost doesn't grow with the map
+    float inv_chunk = 1.0f / (tilemap->tile_size * TILEMAP_CHUNK_SIZE);
+    float first_x = SDL_floorf((view[0] - tilemap->origin[0]) * inv_chunk);
+    float first_y = SDL_floorf((view[1] - tilemap->origin[1]) * inv_chunk);
+    // a chunk that only touches the view's far edge is out
+    float last_x = SDL_ceilf((view[2] - tilemap->origin[0]) * inv_chunk) - 1.0f;
+    float last_y = SDL_ceilf((view[3] - tilemap->origin[1]) * inv_chunk) - 1.0f;
+    if (last_x < 0.0f || last_y < 0.0f || first_x >= (float) tilemap->chunks_x ||
+        first_y >= (float) tilemap->chunks_y) {
+        tilemap->stats.culled = tilemap->chunks_x * tilemap->chunks_y;
+        return;
+    }
+    uint32_t cx0 = (uint32_t) SDL_max(first_x, 0.0f);
+    uint32_t cy0 = (uint32_t) SDL_max(first_y, 0.0f);
+    uint32_t cx1 = (uint32_t) SDL_min(last_x, (float) (tilemap->chunks_x - 1));
+    uint32_t cy1 = (uint32_t) SDL_min(last_y, (float) (tilemap->chunks_y - 1));
+
+    SDL_BindGPUGraphicsPipeline(render_pass, sprite_pipeline);
+    SDL_BindGPUVertexBuffers(render_pass, 0, &(SDL_GPUBufferBinding) {.buffer = quad}, 1);
+    SDL_BindGPUIndexBuffer(render_pass, &(SDL_GPUBufferBinding) {.buffer = quad_index},
+                           SDL_GPU_INDEXELEMENTSIZE_16BIT);
+    SDL_BindGPUFragmentSamplers(render_pass, 0, &(SDL_GPUTextureSamplerBinding) {
+            .texture = texture,
+            .sampler = sampler,
+    }, 1);
+    // pipeline, unit quad, index buffer and sampler
+    tilemap->stats.binds += 4;
+
+    for (uint32_t cy = cy0; cy <= cy1; cy++) {
+        for (uint32_t cx = cx0; cx <= cx1; cx++) {
+            tilemap_chunk_t *chunk = &tilemap->chunks[cy * tilemap->chunks_x + cx];
+            // slot 1 only, the unit quad in slot 0 stays bound
+            SDL_BindGPUVertexBuffers(render_pass, 1, &(SDL_GPUBufferBinding) {.buffer = chunk->instance_buffer}, 1);
+            SDL_DrawGPUIndexedPrimitives(render_pass, 6, chunk->num_tiles, 0, 0, 0);
+            tilemap->stats.binds++;
+            tilemap->stats.draws++;
+        }
+    }
+    tilemap->stats.culled = tilemap->chunks_x * tilemap->chunks_y - tilemap->stats.draws;
+}
@@ -0,0 +1,81 @@
+#ifndef KINGDOM_DEFENSE_TILEMAP_H
+#define KINGDOM_DEFENSE_TILEMAP_H
+
+#include <SDL3/SDL.h>
+
+#include "shader_inputs.h"
+#include "upload_ring.h"
+
+#define TILEMAP_CHUNK_SIZE 32
+#define TILEMAP_CHUNK_TILES (TILEMAP_CHUNK_SIZE * TILEMAP_CHUNK_SIZE)
+
+typedef enum {
+    TILE_KIND_GRASS,
+    TILE_KIND_SPAWN,
+    TILE_KIND_GOAL,
+    // under a tower
+    TILE_KIND_BLOCKED,
+    TILE_KIND_COUNT,
+} tile_kind_t;
+
+// TILEMAP_CHUNK_SIZE^2 tiles (fewer on the right and top edge) with their instances in one gpu buffer
+typedef struct {
+    SDL_GPUBuffer *instance_buffer;
+    uint32_t num_tiles;
+    bool dirty;
+} tilemap_chunk_t;
+
+typedef struct {
+    // chunk rebuilds and what they staged in the upload ring
+    uint64_t chunk_uploads;
+    uint64_t upload_bytes;
+    // of the last tilemap_draw
+    uint32_t draws;
+    uint32_t binds;
+    uint32_t culled;
+} tilemap_stats_t;
+
+// the ground as a grid of tiles drawn through the sprite pipeline, one instance per tile. every chunk keeps its
+// instances on the gpu, so a frame only uploads the chunks that were edited and draws the ones in view
+typedef struct {
+    SDL_GPUDevice *device;
+    uint32_t width;
+    uint32_t height;
+    // world position of the bottom left corner of tile (0, 0)
+    float origin[2];
+    float tile_size;
+    // of the ground sprite, every kind samples it
+    float uv_rect[4];
+    // row major, width * height tile_kind_t
+    uint8_t *tiles;
+
+    tilemap_chunk_t *chunks;
+    uint32_t chunks_x;
+    uint32_t chunks_y;
+    uint32_t num_dirty;
+    // instances of one chunk, every rebuild goes through it
+    sprite_instance *scratch;
+
+    tilemap_stats_t stats;
+} tilemap_t;
+
+// every tile starts out as grass and every chunk dirty, the first tilemap_upload fills them all. `uv_rect` is
+// where the ground sprite sits in its texture
+bool tilemap_init(tilemap_t *tilemap, SDL_GPUDevice *device, uint32_t width, uint32_t height, float origin_x,
+                  float origin_y, float tile_size, const float uv_rect[4]);
+void tilemap_destroy(tilemap_t *tilemap);
+
+// marks the chunk of the tile dirty if the kind changed, out of range tiles are ignored
+void tilemap_set(tilemap_t *tilemap, uint32_t x, uint32_t y, tile_kind_t kind);
+// false when (x, y) is off the map
+bool tilemap_world_to_tile(const tilemap_t *tilemap, float x, float y, uint32_t *tile_x, uint32_t *tile_y);
+
+// stages the instances of every dirty chunk, goes out with the next upload_ring_submit
+bool tilemap_upload(tilemap_t *tilemap, upload_ring_t *ring);
+// one instanced draw per chunk overlapping `view` (min_x, min_y, max_x, max_y in world space), with the sprite
+// pipeline and its unit quad
+void tilemap_draw(tilemap_t *tilemap, SDL_GPURenderPass *render_pass, SDL_GPUGraphicsPipeline *sprite_pipeline,
+                  SDL_GPUBuffer *quad, SDL_GPUBuffer *quad_index, SDL_GPUTexture *texture, SDL_GPUSampler *sampler,
+                  const float view[4]);
+
+#endif //KINGDOM_DEFENSE_TILEMAP_H
@@ -0,0 +1,276 @@
+#include "upload_ring.h"
+#include "gpu_resources.h"
+
+#define BUFFER_UPLOAD_ALIGNMENT 16
+// covers the strictest texture copy offset requirement of the backends
+#define TEXTURE_UPLOAD_ALIGNMENT 512
+
+static uint32_t align_up(uint32_t value, uint32_t alignment) {
+    return (value + alignment - 1) & ~(alignment - 1);
+}
+
+bool upload_ring_init(upload_ring_t *ring, SDL_GPUDevice *device, uint32_t size) {
+    SDL_zerop(ring);
+    SDL_GPUTransferBufferCreateInfo info = {
+            .usage = SDL_GPU_TRANSFERBUFFERUSAGE_UPLOAD,
+            .size = size,
+    };
+    ring->transfer_buffer = gpu_create_transfer_buffer(device, &info, GPU_CALLSITE);
+    if (ring->transfer_buffer == NULL) {
+        return false;
+    }
+    ring->device = device;
+    ring->size = size;
+    return true;
+}
+
+static void wait_oldest_batch(upload_ring_t *ring) {
+    upload_batch_t *batch = &ring->batches[ring->first_batch];
+    SDL_WaitForGPUFences(ring->device, true, &batch->fence, 1);
+    upload_ring_retire(ring);
+}
+
+void upload_ring_destroy(upload_ring_t *ring) {
+    while (ring->num_batches > 0) {
+        wait_oldest_batch(ring);
+    }
+    if (ring->mapped) {
+        SDL_UnmapGPUTransferBuffer(ring->device, ring->transfer_buffer);
+    }
+    for (uint32_t i = 0; i < ring->num_pending; i++) {
+        if (ring->pending[i].dedicated) {
+            gpu_release_transfer_buffer(ring->device, ring->pending[i].transfer_buffer);
+        }
+    }
+    SDL_free(ring->pending);
+    gpu_release_transfer_buffer(ring->device, ring->transfer_buffer);
+    SDL_zerop(ring);
+}
+
+void upload_ring_retire(upload_ring_t *ring) {
+    while (ring->num_batches > 0) {
+        upload_batch_t *batch = &ring->batches[ring->first_batch];
+        if (!SDL_QueryGPUFence(ring->device, batch->fence)) {
+            break;
+        }
+        SDL_ReleaseGPUFence(ring->device, batch->fence);
+        ring->completed_serial = batch->serial;
+        ring->tail = (ring->tail + batch->bytes) % ring->size;
+        ring->used -= batch->bytes;
+        ring->first_batch = (ring->first_batch + 1) % UPLOAD_RING_MAX_BATCHES;
+        ring->num_batches--;
+    }
+}
+
+// live bytes are [tail, head) modulo size, `used` tells a full ring from an empty one
+static bool try_alloc(upload_ring_t *ring, uint32_t size, uint32_t alignment, uint32_t *offset) {
+    if (ring->used == 0) {
+        ring->head = 0;
+        ring->tail = 0;
+    }
+
+    uint32_t aligned = align_up(ring->head, alignment);
+    uint32_t consumed;
+    if (ring->head > ring->tail || ring->used == 0) {
+        if ((uint64_t) aligned + size <= ring->size) {
+            *offset = aligned;
+            consumed = aligned - ring->head + size;
+        } else if (size <= ring->tail) {
+            // wrap around, the tail end of the ring is wasted until this batch retires
+            *offset = 0;
+            consumed = ring->size - ring->head + size;
+        } else {
+            return false;
+        }
+    } else if (ring->head < ring->tail && (uint64_t) aligned + size <= ring->tail) {
+        *offset = aligned;
+        consumed = aligned - ring->head + size;
+    } else {
+        return false;
+    }
+
+    ring->head = (*offset + size) % ring->size;
+    ring->used += consumed;
+    ring->pending_bytes += consumed;
+    return true;
+}
+
+static upload_cmd_t *push_cmd(upload_ring_t *ring) {
+    if (ring->num_pending == ring->cap_pending) {
+        uint32_t cap = ring->cap_pending ? ring->cap_pending * 2 : 64;
+        upload_cmd_t *pending = SDL_realloc(ring->pending, cap * sizeof(upload_cmd_t));
+        if (pending == NULL) {
+            return NULL;
+        }
+        ring->pending = pending;
+        ring->cap_pending = cap;
+    }
+    upload_cmd_t *cmd = &ring->pending[ring->num_pending++];
+    SDL_zerop(cmd);
+    return cmd;
+}
+
+// reserves staging memory for one upload, falls back to a dedicated transfer buffer when the upload is
+// bigger than the whole ring
+static void *stage(upload_ring_t *ring, upload_cmd_t *cmd, uint32_t size, uint32_t alignment) {
+    if (size > ring->size) {
+        SDL_GPUTransferBufferCreateInfo info = {
+                .usage = SDL_GPU_TRANSFERBUFFERUSAGE_UPLOAD,
+                .size = size,
+        };
+        cmd->transfer_buffer = gpu_create_transfer_buffer(ring->device, &info, GPU_CALLSITE);
+        if (cmd->transfer_buffer == NULL) {
+            return NULL;
+        }
+        void *mem = SDL_MapGPUTransferBuffer(ring->device, cmd->transfer_buffer, false);
+        if (mem == NULL) {
+            gpu_release_transfer_buffer(ring->device, cmd->transfer_buffer);
+            return NULL;
+        }
+        cmd->dedicated = true;
+        cmd->offset = 0;
+        ring->stats.dedicated++;
+        return mem;
+    }
+
+    uint32_t offset;
+    while (!try_alloc(ring, size, alignment, &offset)) {
+        ring->stats.stalls++;
+        if (ring->num_pending > 1) {
+            // the ring is full of uploads nobody submitted yet, push them out first (minus the one being staged)
+            upload_cmd_t staged = *cmd;
+            ring->num_pending--;
+            if (!upload_ring_submit(ring)) {
+                return NULL;
+            }
+            cmd = push_cmd(ring);
+            *cmd = staged;
+        }
+        if (ring->num_batches == 0) {
+            return NULL;
+        }
+        wait_oldest_batch(ring);
+    }
+
+    if (ring->mapped == NULL) {
+        ring->mapped = SDL_MapGPUTransferBuffer(ring->device, ring->transfer_buffer, false);
+        if (ring->mapped == NULL) {
+            return NULL;
+        }
+    }
+    cmd->transfer_buffer = ring->transfer_buffer;
+    cmd->offset = offset;
+    return ring->mapped + offset;
+}
+
+bool upload_ring_upload_buffer(upload_ring_t *ring, SDL_GPUBuffer *buffer, uint32_t offset, const void *data,
+                               uint32_t size) {
+    upload_cmd_t *cmd = push_cmd(ring);
+    if (cmd == NULL) {
+        return false;
+    }
+    cmd->is_texture = false;
+    cmd->buffer = (SDL_GPUBufferRegion) {
+            .buffer = buffer,
+            .offset = offset,
+            .size = size,
+    };
+    void *mem = stage(ring, cmd, size, BUFFER_UPLOAD_ALIGNMENT);
+    if (mem == NULL) {
+        ring->num_pending--;
+        return false;
+    }
+    SDL_memcpy(mem, data, size);
+    ring->stats.uploads++;
+    ring->stats.bytes += size;
+    return true;
+}
+
+void *upload_ring_stage_texture(upload_ring_t *ring, const SDL_GPUTextureRegion *region, uint32_t pixels_per_row,
+                                uint32_t rows_per_layer, uint32_t size) {
+    upload_cmd_t *cmd = push_cmd(ring);
+    if (cmd == NULL) {
+        return NULL;
+    }
+    cmd->is_texture = true;
+    cmd->texture.region = *region;
+    cmd->texture.pixels_per_row = pixels_per_row;
+    cmd->texture.rows_per_layer = rows_per_layer;
+    void *mem = stage(ring, cmd, size, TEXTURE_UPLOAD_ALIGNMENT);
+    if (mem == NULL) {
+        ring->num_pending--;
+        return NULL;
+    }
+    ring->stats.uploads++;
+    ring->stats.bytes += size;
+    return mem;
+}
+
+bool upload_ring_submit(upload_ring_t *ring) {
+    if (ring->num_pending == 0) {
+        return true;
+    }
+    if (ring->num_batches == UPLOAD_RING_MAX_BATCHES) {
+        wait_oldest_batch(ring);
+    }
+
+    // transfer buffers have to be unmapped before their upload commands are encoded
+    if (ring->mapped) {
+        SDL_UnmapGPUTransferBuffer(ring->device, ring->transfer_buffer);
+        ring->mapped = NULL;
+    }
+    for (uint32_t i = 0; i < ring->num_pending; i++) {
+        upload_cmd_t *cmd = &ring->pending[i];
+        if (cmd->dedicated) {
+            SDL_UnmapGPUTransferBuffer(ring->device, cmd->transfer_buffer);
+        }
+    }
+
+    SDL_GPUCommandBuffer *command_buffer = SDL_AcquireGPUCommandBuffer(ring->device);
+    if (command_buffer == NULL) {
+        return false;
+    }
+    SDL_GPUCopyPass *copy_pass = SDL_BeginGPUCopyPass(command_buffer);
+    for (uint32_t i = 0; i < ring->num_pending; i++) {
+        upload_cmd_t *cmd = &ring->pending[i];
+        if (cmd->is_texture) {
+            SDL_UploadToGPUTexture(copy_pass,
+                                   &(SDL_GPUTextureTransferInfo) {
+                                           .transfer_buffer = cmd->transfer_buffer,
+                                           .offset = cmd->offset,
+                                           .pixels_per_row = cmd->texture.pixels_per_row,
+                                           .rows_per_layer = cmd->texture.rows_per_layer,
+                                   }, &cmd->texture.region, false);
+        } else {
+            SDL_UploadToGPUBuffer(copy_pass,
+                                  &(SDL_GPUTransferBufferLocation) {
+                                          .transfer_buffer = cmd->transfer_buffer,
+                                          .offset = cmd->offset,
+                                  }, &cmd->buffer, false);
+        }
+    }
+    SDL_EndGPUCopyPass(copy_pass);
+
+    SDL_GPUFence *fence = SDL_SubmitGPUCommandBufferAndAcquireFence(command_buffer);
+    if (fence == NULL) {
+        return false;
+    }
+    for (uint32_t i = 0; i < ring->num_pending; i++) {
+        // released once the gpu is done with them
+        if (ring->pending[i].dedicated) {
+            gpu_release_transfer_buffer(ring->device, ring->pending[i].transfer_buffer);
+        }
+    }
+
+    uint32_t slot = (ring->first_batch + ring->num_batches) % UPLOAD_RING_MAX_BATCHES;
+    ring->batches[slot] = (upload_batch_t) {
+            .fence = fence,
+            .bytes = ring->pending_bytes,
+            .serial = ++ring->submitted_serial,
+    };
+    ring->num_batches++;
+    ring->pending_bytes = 0;
+    ring->num_pending = 0;
+    ring->stats.submits++;
+    return true;
+}
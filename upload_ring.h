@@ -0,0 +1,91 @@
+#ifndef KINGDOM_DEFENSE_UPLOAD_RING_H
+#define KINGDOM_DEFENSE_UPLOAD_RING_H
+
+#include <SDL3/SDL.h>
+
+#define UPLOAD_RING_DEFAULT_SIZE (64 * 1024 * 1024)
+#define UPLOAD_RING_MAX_BATCHES 16
+
+// one submitted copy pass, the region it used is recycled once the fence signals
+typedef struct {
+    SDL_GPUFence *fence;
+    uint32_t bytes;
+    uint64_t serial;
+} upload_batch_t;
+
+typedef struct {
+    bool is_texture;
+    SDL_GPUTransferBuffer *transfer_buffer;
+    uint32_t offset;
+    // transfer buffer was created just for this upload because it did not fit in the ring
+    bool dedicated;
+    union {
+        SDL_GPUBufferRegion buffer;
+        struct {
+            SDL_GPUTextureRegion region;
+            uint32_t pixels_per_row;
+            uint32_t rows_per_layer;
+        } texture;
+    };
+} upload_cmd_t;
+
+typedef struct {
+    uint64_t uploads;
+    uint64_t bytes;
+    uint64_t submits;
+    uint64_t stalls;
+    uint64_t dedicated;
+} upload_ring_stats_t;
+
+// a single transfer buffer sub-allocated as a ring. uploads are staged into it and recorded into one copy pass
+// on upload_ring_submit, so N uploads cost one command buffer submission instead of N.
+typedef struct {
+    SDL_GPUDevice *device;
+    SDL_GPUTransferBuffer *transfer_buffer;
+    uint8_t *mapped;
+    uint32_t size;
+    uint32_t head;
+    uint32_t tail;
+    uint32_t used;
+    uint32_t pending_bytes;
+
+    upload_batch_t batches[UPLOAD_RING_MAX_BATCHES];
+    uint32_t first_batch;
+    uint32_t num_batches;
+
+    upload_cmd_t *pending;
+    uint32_t num_pending;
+    uint32_t cap_pending;
+
+    // every submit gets the next serial, a batch's serial is completed once its fence signaled and it retired
+    uint64_t submitted_serial;
+    uint64_t completed_serial;
+
+    upload_ring_stats_t stats;
+} upload_ring_t;
+
+bool upload_ring_init(upload_ring_t *ring, SDL_GPUDevice *device, uint32_t size);
+// waits for every in-flight batch, pending uploads that were never submitted are dropped
+void upload_ring_destroy(upload_ring_t *ring);
+
+bool upload_ring_upload_buffer(upload_ring_t *ring, SDL_GPUBuffer *buffer, uint32_t offset, const void *data,
+                               uint32_t size);
+// returns staging memory for `size` bytes the caller fills before the next upload_ring_submit
+void *upload_ring_stage_texture(upload_ring_t *ring, const SDL_GPUTextureRegion *region, uint32_t pixels_per_row,
+                                uint32_t rows_per_layer, uint32_t size);
+
+// records every pending upload into one copy pass and submits it. no-op when nothing is pending
+bool upload_ring_submit(upload_ring_t *ring);
+// recycles regions of batches whose fence already signaled, never blocks
+void upload_ring_retire(upload_ring_t *ring);
+
+// the serial of the batch that will carry everything staged so far
+static inline uint64_t upload_ring_staged_serial(const upload_ring_t *ring) {
+    return ring->submitted_serial + 1;
+}
+// true once the gpu finished the batch with `serial` and upload_ring_retire noticed
+static inline bool upload_ring_is_complete(const upload_ring_t *ring, uint64_t serial) {
+    return ring->completed_serial >= serial;
+}
+
+#endif //KINGDOM_DEFENSE_UPLOAD_RING_H